@@ -16,11 +16,14 @@
 
 #include "arp-cache.hpp"
 #include "core/utils.hpp"
+#include "core/logger.hpp"
 #include "core/interface.hpp"
+#include "core/probes.hpp"
 #include "simple-router.hpp"
 
 #include <algorithm>
 #include <iostream>
+#include <string.h>
 
 namespace simple_router {
 
@@ -38,7 +41,7 @@ ArpCache::periodicCheckArpRequestsAndCacheEntries()
     //send ARP request until ARP reply comes back
     if ((*queue_iterator)->nTimesSent < MAX_SENT_TIME){
       //debugging
-      std::cerr << "SENDING ARP REQUEST #" << (*queue_iterator)->nTimesSent << std::endl;
+      SR_LOG_DEBUG("SENDING ARP REQUEST #" << (*queue_iterator)->nTimesSent);
 
       //send ARP request
       uint8_t buff_length = sizeof(ethernet_hdr) + sizeof(arp_hdr);
@@ -65,10 +68,11 @@ ArpCache::periodicCheckArpRequestsAndCacheEntries()
       a_header_req->arp_tip = (*queue_iterator)->ip;   //set IP packet destination address as new target IP address
 
       //debugging
-      print_hdrs(request_buffer);
+      SR_LOG_TRACE_HDRS(request_buffer);
 
       //send ARP request back
-      m_router.sendPacket(request_buffer, (*queue_iterator)->packets.front().iface);
+      SR_PROBE2(arp_request, (*queue_iterator)->ip, (*queue_iterator)->nTimesSent + 1);
+      m_router.sendPacket(request_buffer, *iface);
 
       //update information
       (*queue_iterator)->timeSent = now;
@@ -81,21 +85,26 @@ ArpCache::periodicCheckArpRequestsAndCacheEntries()
     //and any packets that are queued for transmission that are associated with the request
     else{
       //debugging
-      std::cerr << "DELETING PENDING PACKET LIST OF SIZE: " << (*queue_iterator)->packets.size() << std::endl;
+      SR_LOG_DEBUG("DELETING PENDING PACKET LIST OF SIZE: " << (*queue_iterator)->packets.size());
+
+      m_router.getStats().drop(DROP_ARP_FAILURE, (*queue_iterator)->packets.size());
+      SR_PROBE2(arp_give_up, (*queue_iterator)->ip, (*queue_iterator)->packets.size());
+      SR_PROBE3(packet_drop, DROP_ARP_FAILURE, dropReasonToString(DROP_ARP_FAILURE),
+                (*queue_iterator)->packets.size());
 
       //iterate through pending packets and remove packets
       for (std::list<PendingPacket>::const_iterator pp_iterator = (*queue_iterator)->packets.begin(); pp_iterator != (*queue_iterator)->packets.end();) {
         pp_iterator = (*queue_iterator)->packets.erase(pp_iterator);
       } 
 
-      std::cerr << "AFTER PENDING PACKET LIST OF SIZE: " << (*queue_iterator)->packets.size() << std::endl;
+      SR_LOG_DEBUG("AFTER PENDING PACKET LIST OF SIZE: " << (*queue_iterator)->packets.size());
 
       //debugging
-      std::cerr << "ARP REQUEST SENT 5 TIMES. DELETING REQUEST" << std::endl;
-      std::cerr << "BEFORE LENGTH OF ARP REQUEST LIST: " << m_arpRequests.size() << std::endl;
+      SR_LOG_DEBUG("ARP REQUEST SENT 5 TIMES. DELETING REQUEST");
+      SR_LOG_DEBUG("BEFORE LENGTH OF ARP REQUEST LIST: " << m_arpRequests.size());
       queue_iterator = m_arpRequests.erase(queue_iterator); //remove pending request
       // removeRequest(*queue_iterator);
-      std::cerr << "AFTER LENGTH OF ARP REQUEST LIST: " << m_arpRequests.size() << std::endl;
+      SR_LOG_DEBUG("AFTER LENGTH OF ARP REQUEST LIST: " << m_arpRequests.size());
     }
   }
 
@@ -106,6 +115,7 @@ ArpCache::periodicCheckArpRequestsAndCacheEntries()
   for (std::list<std::shared_ptr<ArpEntry>>::iterator ae_iterator = m_cacheEntries.begin(); ae_iterator != m_cacheEntries.end();){
     //if arp entry is not valid, erase it form the cache
     if (!(*ae_iterator)->isValid) {
+      SR_PROBE1(arp_expire, (*ae_iterator)->ip);
       ae_iterator = m_cacheEntries.erase(ae_iterator);
     }
     //otherwise, continue
@@ -162,6 +172,7 @@ ArpCache::queueRequest(uint32_t ip, const Buffer& packet, const std::string& ifa
 
   // Add the packet to the list of packets for this request
   (*request)->packets.push_back({packet, iface});
+  SR_PROBE2(arp_queue, ip, (*request)->packets.size());
   return *request;
 }
 
@@ -177,6 +188,10 @@ ArpCache::insertArpEntry(const Buffer& mac, uint32_t ip)
 {
   std::lock_guard<std::mutex> lock(m_mutex);
 
+  m_cacheEntries.remove_if([ip] (const std::shared_ptr<ArpEntry>& entry) {
+      return entry->ip == ip;
+    });
+
   auto entry = std::make_shared<ArpEntry>();
   entry->mac = mac;
   entry->ip = ip;
@@ -222,26 +237,114 @@ ArpCache::ticker()
         }
       }
 
+      probeRestoredEntries();
       periodicCheckArpRequestsAndCacheEntries();
     }
   }
 }
 
+std::vector<ArpEntryInfo>
+ArpCache::getEntries() const
+{
+  std::vector<ArpEntryInfo> entries;
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  entries.reserve(m_cacheEntries.size());
+  for (const auto& entry : m_cacheEntries) {
+    ArpEntryInfo info;
+    memset(info.mac, 0, sizeof(info.mac));
+    memcpy(info.mac, entry->mac.data(), std::min(entry->mac.size(), sizeof(info.mac)));
+    info.ip = entry->ip;
+    info.timeAdded = entry->timeAdded;
+    info.isValid = entry->isValid;
+    entries.push_back(info);
+  }
+  return entries;
+}
+
+size_t
+ArpCache::restoreEntries(const std::vector<ArpEntryInfo>& entries)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  size_t nRestored = 0;
+  for (const auto& info : entries) {
+    if (!info.isValid) {
+      continue;
+    }
+    bool isKnown = std::any_of(m_cacheEntries.begin(), m_cacheEntries.end(),
+                               [&info] (const std::shared_ptr<ArpEntry>& entry) {
+                                 return entry->ip == info.ip;
+                               });
+    if (isKnown) {
+      continue;
+    }
+
+    auto entry = std::make_shared<ArpEntry>();
+    entry->mac = Buffer(info.mac, info.mac + ETHER_ADDR_LEN);
+    entry->ip = info.ip;
+    entry->timeAdded = info.timeAdded;
+    entry->isValid = true;
+    entry->isConfirmed = false;
+    m_cacheEntries.push_back(entry);
+    ++nRestored;
+  }
+  return nRestored;
+}
+
+void
+ArpCache::probeRestoredEntries()
+{
+  for (auto& entry : m_cacheEntries) {
+    if (!entry->isValid || entry->isConfirmed) {
+      continue;
+    }
+
+    const RoutingTableEntry* route = m_router.getRoutingTable().find(entry->ip);
+    const Interface* iface = route != nullptr ? m_router.findIfaceByName(route->ifName) : nullptr;
+    if (iface == nullptr || entry->nProbesSent >= MAX_SENT_TIME) {
+      SR_LOG_DEBUG("Restored ARP entry of " << ipToString(entry->ip) << " not confirmed, removing it");
+      entry->isValid = false;
+      continue;
+    }
+
+    //same request as periodicCheckArpRequestsAndCacheEntries() sends, but to the known MAC
+    Buffer request(sizeof(ethernet_hdr) + sizeof(arp_hdr));
+    ethernet_hdr* e_header = (ethernet_hdr*)request.data();
+    memcpy(e_header->ether_shost, iface->addr.data(), ETHER_ADDR_LEN);
+    memcpy(e_header->ether_dhost, entry->mac.data(), ETHER_ADDR_LEN);
+    e_header->ether_type = htons(ethertype_arp);
+
+    arp_hdr* a_header = (arp_hdr*)(request.data() + sizeof(ethernet_hdr));
+    a_header->arp_hrd = htons(arp_hrd_ethernet);
+    a_header->arp_pro = htons(ethertype_ip);
+    a_header->arp_hln = ETHER_ADDR_LEN;
+    a_header->arp_pln = 4;
+    a_header->arp_op = htons(arp_op_request);
+    memcpy(a_header->arp_sha, iface->addr.data(), ETHER_ADDR_LEN);
+    a_header->arp_sip = iface->ip;
+    memcpy(a_header->arp_tha, entry->mac.data(), ETHER_ADDR_LEN);
+    a_header->arp_tip = entry->ip;
+
+    SR_PROBE2(arp_request, entry->ip, entry->nProbesSent + 1);
+    m_router.sendPacket(request, *iface);
+    ++entry->nProbesSent;
+  }
+}
+
 std::ostream&
 operator<<(std::ostream& os, const ArpCache& cache)
 {
-  std::lock_guard<std::mutex> lock(cache.m_mutex);
-
   os << "\nMAC            IP         AGE                       VALID\n"
      << "-----------------------------------------------------------\n";
 
   auto now = steady_clock::now();
-  for (const auto& entry : cache.m_cacheEntries) {
+  for (const auto& entry : cache.getEntries()) {
 
-    os << macToString(entry->mac) << "   "
-       << ipToString(entry->ip) << "   "
-       << std::chrono::duration_cast<seconds>((now - entry->timeAdded)).count() << " seconds   "
-       << entry->isValid
+    os << macToString(Buffer(entry.mac, entry.mac + sizeof(entry.mac))) << "   "
+       << ipToString(entry.ip) << "   "
+       << std::chrono::duration_cast<seconds>((now - entry.timeAdded)).count() << " seconds   "
+       << entry.isValid
        << "\n";
   }
   os << std::endl;
@@ -25,6 +25,7 @@
 #include <thread>
 #include <chrono>
 #include <memory>
+#include <vector>
 
 namespace simple_router {
 class SimpleRouter;
@@ -70,6 +71,23 @@ struct ArpEntry {
   uint32_t ip = 0; //< IP addr in network byte order
   time_point timeAdded;
   bool isValid = false;
+
+  /**
+   * False for entries restored by ArpCache::restoreEntries() until the neighbor answers
+   * one of the unicast requests sent to it
+   */
+  bool isConfirmed = true;
+  uint32_t nProbesSent = 0;
+};
+
+/**
+ * Copy of a cache entry, see ArpCache::getEntries()
+ */
+struct ArpEntryInfo {
+  uint8_t mac[ETHER_ADDR_LEN];
+  uint32_t ip; //< IP addr in network byte order
+  time_point timeAdded;
+  bool isValid;
 };
 
 class ArpCache {
@@ -128,11 +146,30 @@ public:
    *
    * 1) Looks up this IP in the request queue. If it is found, returns a pointer
    *    to the ArpRequest with this IP. Otherwise, returns nullptr.
-   * 2) Inserts this IP to MAC mapping in the cache, and marks it valid.
+   * 2) Inserts this IP to MAC mapping in the cache (replacing any older mapping of
+   *    the IP), and marks it valid.
    */
   std::shared_ptr<ArpRequest>
   insertArpEntry(const Buffer& mac, uint32_t ip);
 
+  /**
+   * Copy all cache entries.  The lock is only held for the copy, so the caller can
+   * format or send them without blocking the forwarding path.
+   */
+  std::vector<ArpEntryInfo>
+  getEntries() const;
+
+  /**
+   * Add the valid \p entries not already in the cache, keeping their timeAdded, e.g.
+   * from a snapshot saved before a restart.  They are used right away, and re-validated
+   * with a unicast ARP request every second; entries whose neighbor does not answer
+   * MAX_SENT_TIME of them, or that no route leads to, are removed.
+   *
+   * @return number of entries added
+   */
+  size_t
+  restoreEntries(const std::vector<ArpEntryInfo>& entries);
+
   /**
    * Prints out the ARP table.
    */
@@ -153,6 +190,12 @@ private:
   void
   ticker();
 
+  /**
+   * Send the next unicast request of each unconfirmed entry, or invalidate it
+   */
+  void
+  probeRestoredEntries();
+
 private:
   SimpleRouter& m_router;
 
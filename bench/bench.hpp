@@ -0,0 +1,285 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * This header file defines the measurement harness shared by the benchmarks and
+ * helpers to build test frames and routers that run without POX.
+ *
+ * Every result is printed as one JSON object per line on stdout:
+ *
+ *     {"benchmark":"cksum","params":"bytes=20","iterations":1048576,"ns_per_op":9.81,"ops_per_sec":101936799}
+ */
+
+#ifndef SIMPLE_ROUTER_BENCH_BENCH_HPP
+#define SIMPLE_ROUTER_BENCH_BENCH_HPP
+
+#include "simple-router.hpp"
+#include "core/utils.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <unistd.h>
+
+namespace simple_router {
+namespace bench {
+
+/**
+ * Keep the compiler from optimizing away a computed value
+ */
+template<typename T>
+inline void
+doNotOptimize(const T& value)
+{
+  asm volatile("" : : "g"(&value) : "memory");
+}
+
+/**
+ * Benchmarks whose name does not contain this string are skipped
+ */
+extern std::string g_filter;
+
+inline bool
+isSelected(const std::string& name)
+{
+  return g_filter.empty() || name.find(g_filter) != std::string::npos;
+}
+
+inline void
+report(const std::string& name, const std::string& params, uint64_t iterations, double nsPerOp)
+{
+  printf("{\"benchmark\":\"%s\",\"params\":\"%s\",\"iterations\":%llu,\"ns_per_op\":%.2f,\"ops_per_sec\":%.0f}\n",
+         name.c_str(), params.c_str(), static_cast<unsigned long long>(iterations), nsPerOp,
+         nsPerOp > 0 ? 1e9 / nsPerOp : 0.0);
+  fflush(stdout);
+}
+
+/**
+ * Time \p body, which performs \p opsPerCall operations each call
+ *
+ * The number of calls is doubled until one run takes at least 20 ms; the median of
+ * five such runs is reported.
+ */
+template<typename Body>
+void
+run(const std::string& name, const std::string& params, Body body, uint64_t opsPerCall = 1)
+{
+  if (!isSelected(name)) {
+    return;
+  }
+
+  typedef std::chrono::steady_clock clock;
+  auto timeCalls = [&] (uint64_t nCalls) {
+    auto start = clock::now();
+    for (uint64_t i = 0; i < nCalls; ++i) {
+      body();
+    }
+    return std::chrono::duration<double, std::nano>(clock::now() - start).count();
+  };
+
+  uint64_t nCalls = 1;
+  while (timeCalls(nCalls) < 20e6 && nCalls < (uint64_t(1) << 32)) {
+    nCalls *= 2;
+  }
+
+  std::vector<double> samples;
+  for (int i = 0; i < 5; ++i) {
+    samples.push_back(timeCalls(nCalls) / (nCalls * opsPerCall));
+  }
+  std::sort(samples.begin(), samples.end());
+  report(name, params, nCalls * opsPerCall, samples[2]);
+}
+
+/**
+ * Build an Ethernet/IPv4 frame of \p size bytes with a valid header checksum
+ */
+inline Buffer
+makeIpFrame(size_t size, const uint8_t* dstMac, uint32_t src, uint32_t dst, uint8_t ttl = 64,
+            uint8_t protocol = 17)
+{
+  size = std::max(size, sizeof(ethernet_hdr) + sizeof(ip_hdr));
+  Buffer frame(size, 0);
+
+  ethernet_hdr* eth = reinterpret_cast<ethernet_hdr*>(frame.data());
+  memcpy(eth->ether_dhost, dstMac, ETHER_ADDR_LEN);
+  memset(eth->ether_shost, 0x02, ETHER_ADDR_LEN);
+  eth->ether_type = htons(ethertype_ip);
+
+  ip_hdr* ip = reinterpret_cast<ip_hdr*>(frame.data() + sizeof(ethernet_hdr));
+  ip->ip_v = 4;
+  ip->ip_hl = 5;
+  ip->ip_len = htons(size - sizeof(ethernet_hdr));
+  ip->ip_ttl = ttl;
+  ip->ip_p = protocol;
+  ip->ip_src = src;
+  ip->ip_dst = dst;
+  ip->ip_sum = 0;
+  ip->ip_sum = cksum(ip, sizeof(ip_hdr));
+  return frame;
+}
+
+/**
+ * Build an Ethernet/IPv6 frame of \p size bytes
+ */
+inline Buffer
+makeIpv6Frame(size_t size, const uint8_t* dstMac, const Ipv6Address& src, const Ipv6Address& dst,
+              uint8_t hopLimit = 64, uint8_t nextHeader = 17)
+{
+  size = std::max(size, sizeof(ethernet_hdr) + sizeof(ipv6_hdr));
+  Buffer frame(size, 0);
+
+  ethernet_hdr* eth = reinterpret_cast<ethernet_hdr*>(frame.data());
+  memcpy(eth->ether_dhost, dstMac, ETHER_ADDR_LEN);
+  memset(eth->ether_shost, 0x02, ETHER_ADDR_LEN);
+  eth->ether_type = htons(ethertype_ipv6);
+
+  ipv6_hdr* ip = reinterpret_cast<ipv6_hdr*>(frame.data() + sizeof(ethernet_hdr));
+  ip->ipv6_vtcf = htonl(6 << 28);
+  ip->ipv6_plen = htons(size - sizeof(ethernet_hdr) - sizeof(ipv6_hdr));
+  ip->ipv6_nxt = nextHeader;
+  ip->ipv6_hlim = hopLimit;
+  src.toBytes(ip->ipv6_src);
+  dst.toBytes(ip->ipv6_dst);
+  return frame;
+}
+
+/**
+ * Build an ARP request or reply frame
+ */
+inline Buffer
+makeArpFrame(uint16_t op, const uint8_t* senderMac, uint32_t senderIp,
+             const uint8_t* targetMac, uint32_t targetIp)
+{
+  Buffer frame(sizeof(ethernet_hdr) + sizeof(arp_hdr), 0);
+
+  ethernet_hdr* eth = reinterpret_cast<ethernet_hdr*>(frame.data());
+  memcpy(eth->ether_dhost, op == arp_op_request ? BroadcastEtherAddr : targetMac, ETHER_ADDR_LEN);
+  memcpy(eth->ether_shost, senderMac, ETHER_ADDR_LEN);
+  eth->ether_type = htons(ethertype_arp);
+
+  arp_hdr* arp = reinterpret_cast<arp_hdr*>(frame.data() + sizeof(ethernet_hdr));
+  arp->arp_hrd = htons(arp_hrd_ethernet);
+  arp->arp_pro = htons(ethertype_ip);
+  arp->arp_hln = ETHER_ADDR_LEN;
+  arp->arp_pln = 4;
+  arp->arp_op = htons(op);
+  memcpy(arp->arp_sha, senderMac, ETHER_ADDR_LEN);
+  arp->arp_sip = senderIp;
+  memcpy(arp->arp_tha, targetMac, ETHER_ADDR_LEN);
+  arp->arp_tip = targetIp;
+  return frame;
+}
+
+/**
+ * Counts what the router sends instead of passing it to POX
+ *
+ * The counters are atomic: the ArpCache thread sends queued packets and ARP
+ * requests while forwarding threads send the rest.
+ */
+class CountingInjector : public LocalPacketInjector
+{
+public:
+  void
+  sendPacket(const Buffer& packet, const std::string& outIface) override
+  {
+    nPackets.fetch_add(1, std::memory_order_relaxed);
+    nBytes.fetch_add(packet.size(), std::memory_order_relaxed);
+    if (onSend) {
+      onSend(packet, outIface);
+    }
+  }
+
+public:
+  std::atomic<uint64_t> nPackets{0};
+  std::atomic<uint64_t> nBytes{0};
+  std::function<void(const Buffer&, const std::string&)> onSend;
+};
+
+struct BenchIface
+{
+  std::string name;
+  std::string ip;
+};
+
+/**
+ * Configure \p router with interfaces \p ifaces (MAC 02:00:00:00:00:<index+1>) and
+ * the routing table \p routes, without a POX controller
+ */
+inline void
+setupRouter(SimpleRouter& router, const std::vector<BenchIface>& ifaces,
+            const std::vector<RoutingTableEntry>& routes, LocalPacketInjector& injector)
+{
+  char ifconfig[] = "/tmp/simple-router-bench-XXXXXX";
+  int fd = mkstemp(ifconfig);
+  if (fd < 0) {
+    throw std::runtime_error("Cannot create temporary interface configuration");
+  }
+  close(fd);
+  {
+    std::ofstream os(ifconfig);
+    for (const auto& iface : ifaces) {
+      os << iface.name << " " << iface.ip << "\n";
+    }
+  }
+  router.loadIfconfig(ifconfig);
+  unlink(ifconfig);
+
+  pox::Ifaces ports;
+  for (size_t i = 0; i < ifaces.size(); ++i) {
+    pox::Iface port;
+    port.name = ifaces[i].name;
+    port.mac = {0x02, 0x00, 0x00, 0x00, 0x00, static_cast<uint8_t>(i + 1)};
+    port.port = i + 1;
+    ports.push_back(port);
+  }
+  router.reset(ports);
+
+  for (const auto& route : routes) {
+    router.getRoutingTable().addEntry(route);
+  }
+  router.setLocalInjector(&injector);
+}
+
+/**
+ * @throw std::invalid_argument if \p address is not a dotted IPv4 address
+ */
+inline uint32_t
+ip(const char* address)
+{
+  in_addr addr;
+  if (inet_aton(address, &addr) == 0) {
+    throw std::invalid_argument(std::string("Invalid IPv4 address `") + address + "`");
+  }
+  return addr.s_addr;
+}
+
+inline Ipv6Address
+ip6(const char* address)
+{
+  Ipv6Address addr = {0, 0};
+  parseIpv6(address, addr);
+  return addr;
+}
+
+} // namespace bench
+} // namespace simple_router
+
+#endif // SIMPLE_ROUTER_BENCH_BENCH_HPP
@@ -0,0 +1,468 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * Routing table scaling benchmark: tables of 10 to 1M IPv4 prefixes with a BGP-like
+ * prefix length mix, and 10 to 100k IPv6 prefixes heavy at /48 and /64, timed for
+ * loading, building and lookups, and checked against a linear longest-prefix match.
+ *
+ * Usage: fib-bench [name-filter]
+ *
+ * Besides the lookup results printed by run(), prints per table size
+ *     {"benchmark":"fib-build","params":"prefixes=1000","load_ms":..,"build_ms":..,"bytes_per_prefix":..}
+ *     {"check":"fib","params":"prefixes=1000","probes":..,"mismatches":0}
+ *     {"check":"fib-compress","params":"prefixes=1000,next_hops=2","compressed_prefixes":..,"probes":..,"mismatches":0}
+ * and the same as fib6-build, fib6 and fib6-lookup for IPv6.
+ */
+
+#include "bench.hpp"
+
+#include <iostream>
+#include <set>
+
+namespace simple_router {
+namespace bench {
+
+std::string g_filter;
+
+/**
+ * Share of each prefix length /8 ... /32 in a global IPv4 BGP table: heavy at /24,
+ * with a tail of host routes as seen in IGP-injected tables
+ */
+static const double LENGTH_WEIGHTS[] = {
+  // /8  /9   /10  /11  /12  /13  /14  /15   /16
+  0.01, 0.01, 0.03, 0.08, 0.2, 0.4, 0.8, 1.2, 1.4,
+  // /17 /18  /19  /20  /21  /22   /23  /24
+  0.9, 1.5, 2.7, 4.2, 4.4, 11.5, 8.5, 60.0,
+  // /25 .. /31                           /32
+  0.05, 0.05, 0.05, 0.05, 0.05, 0.05, 0.1, 1.5,
+};
+
+static const char* IFACES[] = {"eth1", "eth2", "eth3"};
+
+/**
+ * Prefix lengths of an IPv6 table: provider allocations at /32, end sites at /48,
+ * and the /64 subnets of an enterprise or data center network
+ */
+static const std::pair<int, double> IPV6_LENGTH_WEIGHTS[] = {
+  {24, 0.5}, {28, 1.0}, {29, 2.0}, {32, 12.0}, {36, 3.0}, {40, 5.0}, {44, 8.0}, {46, 2.0},
+  {47, 2.0}, {48, 40.0}, {52, 1.0}, {56, 4.0}, {60, 1.0}, {64, 16.0}, {127, 0.5}, {128, 2.0},
+};
+
+/**
+ * \p size distinct random prefixes, then a default route
+ */
+static std::vector<RoutingTableEntry>
+makeTable(size_t size, std::mt19937& random)
+{
+  std::discrete_distribution<int> lengthChoice(std::begin(LENGTH_WEIGHTS), std::end(LENGTH_WEIGHTS));
+  std::set<std::pair<uint32_t, uint32_t>> seen;
+  std::vector<RoutingTableEntry> routes;
+
+  while (routes.size() < size) {
+    int length = 8 + lengthChoice(random);
+    uint32_t mask = htonl(~0u << (32 - length));
+    uint32_t dest = static_cast<uint32_t>(random()) & mask;
+    if (!seen.insert({dest, mask}).second) {
+      continue;
+    }
+    uint32_t gw = htonl(0x0a000000 | (random() % 16));
+    routes.push_back({dest, gw, mask, IFACES[random() % 3]});
+  }
+  routes.push_back({0, htonl(0x0a000001), 0, "eth1"});
+  return routes;
+}
+
+/**
+ * Destinations inside the table's prefixes, so that lookups reach every level of
+ * the structure; with \p isZipf, a few destinations take most of the traffic
+ */
+static std::vector<uint32_t>
+makeTraffic(const std::vector<RoutingTableEntry>& routes, size_t count, bool isZipf,
+            std::mt19937& random)
+{
+  const size_t N_DESTINATIONS = 100000;
+  std::vector<uint32_t> destinations(N_DESTINATIONS);
+  for (auto& destination : destinations) {
+    const RoutingTableEntry& route = routes[random() % routes.size()];
+    destination = route.dest | (static_cast<uint32_t>(random()) & ~route.mask);
+  }
+
+  std::vector<double> weights(N_DESTINATIONS, 1.0);
+  if (isZipf) {
+    for (size_t i = 0; i < weights.size(); ++i) {
+      weights[i] = 1.0 / (i + 1);
+    }
+  }
+  std::discrete_distribution<size_t> choice(weights.begin(), weights.end());
+
+  std::vector<uint32_t> traffic(count);
+  for (auto& address : traffic) {
+    address = destinations[choice(random)];
+  }
+  return traffic;
+}
+
+/**
+ * Reference longest-prefix match: \p sorted is ordered by decreasing mask length
+ */
+static const RoutingTableEntry*
+findLinear(const std::vector<RoutingTableEntry>& sorted, uint32_t ip)
+{
+  for (const auto& route : sorted) {
+    if ((ip & route.mask) == route.dest) {
+      return &route;
+    }
+  }
+  return nullptr;
+}
+
+static bool
+checkTable(const RoutingTable& table, const std::vector<RoutingTableEntry>& routes,
+           const std::string& params, std::mt19937& random)
+{
+  std::vector<RoutingTableEntry> sorted(routes);
+  std::stable_sort(sorted.begin(), sorted.end(), [] (const RoutingTableEntry& a, const RoutingTableEntry& b) {
+      return ntohl(a.mask) > ntohl(b.mask);
+    });
+
+  // about 2e8 reference comparisons per table size
+  size_t nProbes = std::max<size_t>(200, std::min<size_t>(200000, 200000000 / routes.size()));
+  std::vector<uint32_t> probes = makeTraffic(routes, nProbes / 2, false, random);
+  for (size_t i = 0; i < nProbes / 2; ++i) {
+    probes.push_back(random());
+  }
+
+  std::vector<const RoutingTableEntry*> batch(probes.size());
+  table.findBatch(probes.data(), probes.size(), batch.data());
+
+  size_t nMismatches = 0;
+  for (size_t i = 0; i < probes.size(); ++i) {
+    const RoutingTableEntry* expected = findLinear(sorted, probes[i]);
+    const RoutingTableEntry* single = table.find(probes[i]);
+    for (const RoutingTableEntry* actual : {single, batch[i]}) {
+      if ((expected == nullptr) != (actual == nullptr) ||
+          (expected != nullptr && (expected->dest != actual->dest || expected->mask != actual->mask))) {
+        ++nMismatches;
+      }
+    }
+  }
+
+  printf("{\"check\":\"fib\",\"params\":\"%s\",\"probes\":%zu,\"mismatches\":%zu}\n",
+         params.c_str(), probes.size(), nMismatches);
+  fflush(stdout);
+  return nMismatches == 0;
+}
+
+/**
+ * Compare lookups in the compress()ed table of \p routes with those in the table as
+ * it is: both must give the same next hop for every address.  Checked with the
+ * routes' own next hops and with only two, which lets most prefixes merge.
+ */
+static bool
+checkCompressed(const std::vector<RoutingTableEntry>& routes, const std::string& params,
+                std::mt19937& random)
+{
+  size_t nProbes = 200000;
+  std::vector<uint32_t> probes = makeTraffic(routes, nProbes / 2, false, random);
+  for (size_t i = 0; i < nProbes / 2; ++i) {
+    probes.push_back(random());
+  }
+  // the first and last address of every prefix, where merged neighbours meet
+  for (const auto& route : routes) {
+    probes.push_back(route.dest);
+    probes.push_back(route.dest | ~route.mask);
+  }
+
+  std::vector<RoutingTableEntry> twoHops(routes);
+  for (size_t i = 0; i < twoHops.size(); ++i) {
+    twoHops[i].gw = htonl(0x0a000001 + i % 2);
+    twoHops[i].ifName = IFACES[i % 2];
+  }
+
+  const std::vector<RoutingTableEntry>* variants[] = {&routes, &twoHops};
+  bool isOk = true;
+  for (const auto* variant : variants) {
+    RoutingTable table;
+    RoutingTable compressed;
+    for (const auto& route : *variant) {
+      table.addEntry(route);
+      compressed.addEntry(route);
+    }
+    if (!compressed.compress()) {
+      std::cerr << "fib-compress: table has non-contiguous masks" << std::endl;
+      return false;
+    }
+
+    size_t nMismatches = 0;
+    for (uint32_t probe : probes) {
+      const RoutingTableEntry* expected = table.find(probe);
+      const RoutingTableEntry* actual = compressed.find(probe);
+      if ((expected == nullptr) != (actual == nullptr) ||
+          (expected != nullptr && (expected->gw != actual->gw || expected->ifName != actual->ifName))) {
+        ++nMismatches;
+      }
+    }
+
+    printf("{\"check\":\"fib-compress\",\"params\":\"%s,next_hops=%s\",\"compressed_prefixes\":%zu,"
+           "\"probes\":%zu,\"mismatches\":%zu}\n",
+           params.c_str(), variant == &routes ? "table" : "2", compressed.size(), probes.size(), nMismatches);
+    fflush(stdout);
+    isOk = isOk && nMismatches == 0;
+  }
+  return isOk;
+}
+
+static bool
+benchTableSize(size_t size)
+{
+  typedef std::chrono::steady_clock clock;
+  std::string params = "prefixes=" + std::to_string(size);
+  std::mt19937 random(size);
+  std::vector<RoutingTableEntry> routes = makeTable(size, random);
+
+  // through the RTABLE parser, which builds the lookup structure at the end
+  char path[] = "/tmp/fib-bench-XXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0) {
+    perror("mkstemp");
+    return false;
+  }
+  close(fd);
+  {
+    std::ofstream file(path);
+    for (const auto& route : routes) {
+      file << ipToString(route.dest) << " " << ipToString(route.gw) << " "
+           << ipToString(route.mask) << " " << route.ifName << "\n";
+    }
+  }
+  RoutingTable loaded;
+  auto loadStart = clock::now();
+  bool isLoaded = loaded.load(path);
+  double loadMs = std::chrono::duration<double, std::milli>(clock::now() - loadStart).count();
+  unlink(path);
+  if (!isLoaded || loaded.size() != routes.size()) {
+    std::cerr << "fib-build: cannot load generated table" << std::endl;
+    return false;
+  }
+
+  // through addEntry, timing the build alone
+  RoutingTable table;
+  for (const auto& route : routes) {
+    table.addEntry(route);
+  }
+  auto buildStart = clock::now();
+  table.build();
+  double buildMs = std::chrono::duration<double, std::milli>(clock::now() - buildStart).count();
+
+  printf("{\"benchmark\":\"fib-build\",\"params\":\"%s\",\"load_ms\":%.2f,\"build_ms\":%.2f,"
+         "\"bytes_per_prefix\":%.1f}\n",
+         params.c_str(), loadMs, buildMs, static_cast<double>(table.getMemoryUsage()) / routes.size());
+  fflush(stdout);
+
+  if (isSelected("check") && (!checkTable(table, routes, params, random) ||
+                               !checkCompressed(routes, params, random))) {
+    return false;
+  }
+
+  const size_t N_ADDRESSES = 1 << 20;
+  const size_t BATCH = 64;
+  for (bool isZipf : {false, true}) {
+    std::vector<uint32_t> traffic = makeTraffic(routes, N_ADDRESSES, isZipf, random);
+    std::string trafficParams = params + (isZipf ? ",traffic=zipf" : ",traffic=random");
+
+    size_t next = 0;
+    run("fib-lookup", trafficParams + ",mode=single", [&] {
+      doNotOptimize(table.find(traffic[next++ & (N_ADDRESSES - 1)]));
+    });
+
+    const RoutingTableEntry* entries[BATCH];
+    next = 0;
+    run("fib-lookup", trafficParams + ",mode=batch" + std::to_string(BATCH), [&] {
+      table.findBatch(&traffic[next], BATCH, entries);
+      doNotOptimize(entries);
+      next = (next + BATCH) & (N_ADDRESSES - 1);
+    }, BATCH);
+  }
+  return true;
+}
+
+/**
+ * \p size distinct random prefixes in 2000::/3, then a default route
+ */
+static std::vector<RoutingTableEntry6>
+makeTable6(size_t size, std::mt19937& random)
+{
+  std::vector<double> weights;
+  for (const auto& length : IPV6_LENGTH_WEIGHTS) {
+    weights.push_back(length.second);
+  }
+  std::discrete_distribution<int> lengthChoice(weights.begin(), weights.end());
+  std::set<std::pair<Ipv6Address, int>> seen;
+  std::vector<RoutingTableEntry6> routes;
+
+  while (routes.size() < size) {
+    int length = IPV6_LENGTH_WEIGHTS[lengthChoice(random)].first;
+    Ipv6Address dest;
+    // few top-level allocations, so that longer prefixes nest below shorter ones
+    dest.hi = (uint64_t(0x2000) << 48) | (uint64_t(random() % 64) << 40) |
+              ((uint64_t(random()) << 8) & 0xffffffffff);
+    dest.lo = (uint64_t(random()) << 32) | random();
+    dest = dest.mask(length);
+    if (!seen.insert({dest, length}).second) {
+      continue;
+    }
+    Ipv6Address gw = {0xfe80000000000000, 1 + random() % 16};
+    routes.push_back({dest, static_cast<uint8_t>(length), gw, IFACES[random() % 3]});
+  }
+  routes.push_back({{0, 0}, 0, {0xfe80000000000000, 1}, "eth1"});
+  return routes;
+}
+
+/**
+ * Destinations inside the table's prefixes
+ */
+static std::vector<Ipv6Address>
+makeTraffic6(const std::vector<RoutingTableEntry6>& routes, size_t count, std::mt19937& random)
+{
+  const Ipv6Address ones = {~uint64_t(0), ~uint64_t(0)};
+  std::vector<Ipv6Address> traffic(count);
+  for (auto& address : traffic) {
+    const RoutingTableEntry6& route = routes[random() % routes.size()];
+    Ipv6Address mask = ones.mask(route.length);
+    address.hi = route.dest.hi | (((uint64_t(random()) << 32) | random()) & ~mask.hi);
+    address.lo = route.dest.lo | (((uint64_t(random()) << 32) | random()) & ~mask.lo);
+  }
+  return traffic;
+}
+
+static bool
+checkTable6(const RoutingTable& table, const std::vector<RoutingTableEntry6>& routes,
+            const std::string& params, std::mt19937& random)
+{
+  std::vector<RoutingTableEntry6> sorted(routes);
+  std::stable_sort(sorted.begin(), sorted.end(), [] (const RoutingTableEntry6& a, const RoutingTableEntry6& b) {
+      return a.length > b.length;
+    });
+
+  size_t nProbes = std::max<size_t>(200, std::min<size_t>(200000, 200000000 / routes.size()));
+  std::vector<Ipv6Address> probes = makeTraffic6(routes, nProbes / 2, random);
+  for (size_t i = 0; i < nProbes / 2; ++i) {
+    probes.push_back({(uint64_t(0x2000) << 48) | (uint64_t(random()) << 16) | (random() & 0xffff),
+                      (uint64_t(random()) << 32) | random()});
+  }
+
+  size_t nMismatches = 0;
+  for (const auto& probe : probes) {
+    const RoutingTableEntry6* expected = nullptr;
+    for (const auto& route : sorted) {
+      if (probe.mask(route.length) == route.dest) {
+        expected = &route;
+        break;
+      }
+    }
+    const RoutingTableEntry6* actual = table.findIpv6(probe);
+    if ((expected == nullptr) != (actual == nullptr) ||
+        (expected != nullptr && (expected->dest != actual->dest || expected->length != actual->length))) {
+      ++nMismatches;
+    }
+  }
+
+  printf("{\"check\":\"fib6\",\"params\":\"%s\",\"probes\":%zu,\"mismatches\":%zu}\n",
+         params.c_str(), probes.size(), nMismatches);
+  fflush(stdout);
+  return nMismatches == 0;
+}
+
+static bool
+benchTableSize6(size_t size)
+{
+  typedef std::chrono::steady_clock clock;
+  std::string params = "prefixes=" + std::to_string(size);
+  std::mt19937 random(size);
+  std::vector<RoutingTableEntry6> routes = makeTable6(size, random);
+
+  char path[] = "/tmp/fib-bench-XXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0) {
+    perror("mkstemp");
+    return false;
+  }
+  close(fd);
+  {
+    std::ofstream file(path);
+    for (const auto& route : routes) {
+      file << ipv6ToString(route.dest) << "/" << int(route.length) << " " << ipv6ToString(route.gw)
+           << " " << route.ifName << "\n";
+    }
+  }
+  RoutingTable loaded;
+  auto loadStart = clock::now();
+  bool isLoaded = loaded.load(path);
+  double loadMs = std::chrono::duration<double, std::milli>(clock::now() - loadStart).count();
+  unlink(path);
+  if (!isLoaded || loaded.getIpv6Entries().size() != routes.size()) {
+    std::cerr << "fib6-build: cannot load generated table" << std::endl;
+    return false;
+  }
+
+  RoutingTable table;
+  for (const auto& route : routes) {
+    table.addIpv6Entry(route);
+  }
+  auto buildStart = clock::now();
+  table.build();
+  double buildMs = std::chrono::duration<double, std::milli>(clock::now() - buildStart).count();
+
+  printf("{\"benchmark\":\"fib6-build\",\"params\":\"%s\",\"load_ms\":%.2f,\"build_ms\":%.2f,"
+         "\"bytes_per_prefix\":%.1f}\n",
+         params.c_str(), loadMs, buildMs, static_cast<double>(table.getMemoryUsage()) / routes.size());
+  fflush(stdout);
+
+  if (isSelected("check") && !checkTable6(table, routes, params, random)) {
+    return false;
+  }
+
+  const size_t N_ADDRESSES = 1 << 20;
+  std::vector<Ipv6Address> traffic = makeTraffic6(routes, N_ADDRESSES, random);
+  size_t next = 0;
+  run("fib6-lookup", params + ",traffic=random", [&] {
+    doNotOptimize(table.findIpv6(traffic[next++ & (N_ADDRESSES - 1)]));
+  });
+  return true;
+}
+
+} // namespace bench
+} // namespace simple_router
+
+int
+main(int argc, char* argv[])
+{
+  using namespace simple_router::bench;
+
+  if (argc > 1) {
+    g_filter = argv[1];
+  }
+
+  for (size_t size : {10, 100, 1000, 10000, 100000, 1000000}) {
+    if (!benchTableSize(size)) {
+      return 1;
+    }
+  }
+  for (size_t size : {10, 100, 1000, 10000, 100000}) {
+    if (!benchTableSize6(size)) {
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,370 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * POX stand-in: serves pox::PacketInjector in place of the POX controller, so the
+ * real router binary can be load tested through Ice without mininet.
+ *
+ * The router connects to it as it would to POX (SimpleRouter.Proxy in router.config)
+ * and gets the interfaces of IP_CONFIG.  The stand-in then injects UDP flows through
+ * PacketHandler::handlePacket at the requested rate, answers the ARP requests the
+ * router sends for its next hops, and times every packet that comes back through
+ * sendPacket.  The result is printed as one JSON object in the format of traffic-gen,
+ * so comparing the two gives the cost of the Ice path.
+ */
+
+#include "traffic.hpp"
+
+#include <Ice/Ice.h>
+
+#include <condition_variable>
+#include <iostream>
+
+#include <getopt.h>
+#include <string.h>
+
+namespace simple_router {
+namespace bench {
+
+/**
+ * Next hop MAC the stand-in answers ARP requests for \p ip with
+ */
+static void
+neighborMac(uint32_t ip, uint8_t* mac)
+{
+  const uint8_t prefix[] = {0x02, 0x00, 0x00, 0x01};
+  memcpy(mac, prefix, sizeof(prefix));
+  memcpy(mac + sizeof(prefix), reinterpret_cast<const uint8_t*>(&ip) + 2, 2);
+}
+
+class PoxStandIn : public pox::PacketInjector
+{
+public:
+  explicit PoxStandIn(const std::vector<BenchIface>& ifaces)
+    : m_ifaces(ifaces)
+    , m_firstMeasured(~0ull)
+    , m_nForwarded(0)
+    , m_nArpRequests(0)
+    , m_nOther(0)
+    , m_lastSend(0)
+    , m_isReady(false)
+  {
+  }
+
+  void
+  sendPacket(const std::pair<const ::Ice::Byte*, const ::Ice::Byte*>& packet, const std::string& outIface,
+             const ::Ice::Current&) override
+  {
+    uint64_t now = nowNs();
+    m_lastSend = now;
+    const uint8_t* data = packet.first;
+    size_t size = packet.second - packet.first;
+
+    if (size >= MIN_FRAME_SIZE && ethertype(data) == ethertype_ip) {
+      GeneratorPayload payload;
+      memcpy(&payload, data + PAYLOAD_OFFSET, sizeof(payload));
+      if (payload.magic == GENERATOR_MAGIC) {
+        if (payload.sequence >= m_firstMeasured) {
+          std::lock_guard<std::mutex> lock(m_mutex);
+          ++m_nForwarded;
+          ++m_latency.counts[LatencyHistogram::bucketOf(now - payload.timestamp)];
+        }
+        return;
+      }
+    }
+    else if (size >= sizeof(ethernet_hdr) + sizeof(arp_hdr) && ethertype(data) == ethertype_arp) {
+      const arp_hdr* request = reinterpret_cast<const arp_hdr*>(data + sizeof(ethernet_hdr));
+      if (ntohs(request->arp_op) == arp_op_request) {
+        ++m_nArpRequests;
+        uint8_t mac[ETHER_ADDR_LEN];
+        neighborMac(request->arp_tip, mac);
+        Buffer reply = makeArpFrame(arp_op_reply, mac, request->arp_tip, request->arp_sha, request->arp_sip);
+        // never block the dispatch thread on the router
+        m_oneway->begin_handlePacket(std::make_pair(reply.data(), reply.data() + reply.size()), outIface);
+        return;
+      }
+    }
+    ++m_nOther;
+  }
+
+  void
+  addPacketHandler(const ::Ice::Identity& identity, const ::Ice::Current& current) override
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_oneway = pox::PacketHandlerPrx::uncheckedCast(current.con->createProxy(identity)->ice_oneway());
+  }
+
+  pox::Ifaces
+  getIfaces(const ::Ice::Current&) override
+  {
+    pox::Ifaces ports;
+    for (size_t i = 0; i < m_ifaces.size(); ++i) {
+      pox::Iface port;
+      port.name = m_ifaces[i].name;
+      port.mac = {0x02, 0x00, 0x00, 0x00, 0x00, static_cast<uint8_t>(i + 1)};
+      port.port = i + 1;
+      ports.push_back(port);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_isReady = true;
+    m_ready.notify_all();
+    return ports;
+  }
+
+  /**
+   * Wait for a router to connect and ask for its interfaces
+   *
+   * @return handler proxy of the router, oneway
+   */
+  pox::PacketHandlerPrx
+  waitForRouter()
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_ready.wait(lock, [this] { return m_isReady && m_oneway; });
+    return m_oneway;
+  }
+
+  /**
+   * Count only packets with sequence numbers from \p sequence on
+   */
+  void
+  startMeasuring(uint64_t sequence)
+  {
+    m_firstMeasured = sequence;
+  }
+
+  uint64_t
+  getLastSend() const
+  {
+    return m_lastSend;
+  }
+
+public:
+  std::mutex m_mutex;
+  LatencyHistogram m_latency;
+  const std::vector<BenchIface> m_ifaces;
+  std::atomic<uint64_t> m_firstMeasured;
+  uint64_t m_nForwarded;
+  std::atomic<uint64_t> m_nArpRequests;
+  std::atomic<uint64_t> m_nOther;
+  std::atomic<uint64_t> m_lastSend;
+
+private:
+  std::condition_variable m_ready;
+  bool m_isReady;
+  pox::PacketHandlerPrx m_oneway;
+};
+
+static void
+usage(const char* program)
+{
+  std::cerr
+    << "Usage: " << program << " [Ice options] [options]\n"
+    << "  -e ENDPOINT endpoint the router connects to (default `tcp -h 127.0.0.1 -p 8888`)\n"
+    << "  -r FILE     routing table of the router (default RTABLE)\n"
+    << "  -c FILE     interface configuration of the router (default IP_CONFIG)\n"
+    << "  -i IFACE    interface to inject on (default: first interface)\n"
+    << "  -f N        number of flows (default 1024)\n"
+    << "  -s SIZES    frame sizes, comma separated, or `imix` (default 64)\n"
+    << "  -d DIST     destinations: routes, default or random (see traffic-gen)\n"
+    << "  -z          Zipf-distributed flow popularity instead of uniform\n"
+    << "  -R PPS      target rate in packets per second (default: unlimited)\n"
+    << "  -w SECONDS  warm-up, not measured, while next hops get resolved (default 1)\n"
+    << "  -t SECONDS  measured duration (default 5)\n"
+    << "  -S SEED     random seed (default 1)\n";
+}
+
+static int
+run(const Ice::CommunicatorPtr& communicator, const std::string& endpoint, double warmup,
+    const GeneratorConfig& config)
+{
+  std::mt19937 random(config.seed);
+
+  std::vector<RoutingTableEntry> routes = readRoutes(config.rtable);
+  std::vector<BenchIface> ifaces = readIfaces(config.ifconfig, routes);
+  if (ifaces.empty()) {
+    throw std::runtime_error("No router interface found in `" + config.ifconfig + "`");
+  }
+
+  size_t inIndex = 0;
+  if (!config.inIface.empty()) {
+    while (inIndex < ifaces.size() && ifaces[inIndex].name != config.inIface) {
+      ++inIndex;
+    }
+    if (inIndex == ifaces.size()) {
+      throw std::runtime_error("Unknown interface `" + config.inIface + "`");
+    }
+  }
+  const std::string& inIface = ifaces[inIndex].name;
+  const uint8_t inMac[] = {0x02, 0x00, 0x00, 0x00, 0x00, static_cast<uint8_t>(inIndex + 1)};
+
+  std::vector<Flow> flows = makeFlows(config, routes, ip(ifaces[inIndex].ip.c_str()), random);
+  std::discrete_distribution<size_t> sizeChoice(config.sizeWeights.begin(), config.sizeWeights.end());
+  std::vector<double> flowWeights(flows.size(), 1.0);
+  if (config.isZipf) {
+    for (size_t i = 0; i < flowWeights.size(); ++i) {
+      flowWeights[i] = 1.0 / (i + 1);
+    }
+  }
+  std::discrete_distribution<size_t> flowChoice(flowWeights.begin(), flowWeights.end());
+
+  std::vector<Buffer> frames;
+  for (size_t size : config.sizes) {
+    frames.push_back(Buffer(size));
+  }
+
+  IceUtil::Handle<PoxStandIn> standIn = new PoxStandIn(ifaces);
+  Ice::ObjectAdapterPtr adapter = communicator->createObjectAdapterWithEndpoints("PoxStandIn", endpoint);
+  adapter->add(standIn, communicator->stringToIdentity("SimpleRouter"));
+  adapter->activate();
+
+  std::cerr << "Waiting for the router on `" << endpoint << "`" << std::endl;
+  pox::PacketHandlerPrx router = standIn->waitForRouter();
+  // the router resets itself once it has its interfaces
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+  // oneway calls block once the connection is flow controlled, which paces an
+  // unlimited rate to what the router takes
+  uint64_t start = nowNs();
+  uint64_t measureStart = start + static_cast<uint64_t>(warmup * 1e9);
+  uint64_t end = measureStart + static_cast<uint64_t>(config.duration * 1e9);
+  double interval = config.rate > 0 ? 1e9 / config.rate : 0;
+  uint64_t nSent = 0;
+  uint64_t nMeasured = 0;
+  bool isMeasuring = false;
+
+  for (uint64_t now = start; now < end; now = nowNs()) {
+    if (!isMeasuring && now >= measureStart) {
+      standIn->startMeasuring(nSent);
+      isMeasuring = true;
+    }
+    if (interval > 0) {
+      uint64_t due = start + static_cast<uint64_t>(nSent * interval);
+      if (now < due) {
+        continue;
+      }
+    }
+
+    Buffer& frame = frames[sizeChoice(random)];
+    fillFrame(frame, inMac, flows[flowChoice(random)], nSent);
+    router->handlePacket(std::make_pair(frame.data(), frame.data() + frame.size()), inIface);
+    ++nSent;
+    if (isMeasuring) {
+      ++nMeasured;
+    }
+  }
+  uint64_t sendEnd = nowNs();
+
+  // drain: until nothing came back for 200 ms, at most 2 s
+  while (nowNs() - sendEnd < 2000000000ull && nowNs() - standIn->getLastSend() < 200000000ull) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+  double elapsed = (sendEnd - measureStart) / 1e9;
+
+  std::lock_guard<std::mutex> lock(standIn->m_mutex);
+  uint64_t nForwarded = standIn->m_nForwarded;
+  const LatencyHistogram& latency = standIn->m_latency;
+  printf("{\"generator\":\"pox-standin\",\"flows\":%zu,\"destinations\":\"%s\","
+         "\"target_pps\":%.0f,\"seconds\":%.3f,\"sent\":%llu,\"forwarded\":%llu,\"arp_requests\":%llu,"
+         "\"other\":%llu,\"offered_pps\":%.0f,\"achieved_pps\":%.0f,\"loss_pct\":%.3f,"
+         "\"latency_ns\":{\"p50\":%.0f,\"p99\":%.0f,\"p999\":%.0f,\"max\":%.0f}}\n",
+         flows.size(), config.destinations.c_str(), config.rate, elapsed,
+         static_cast<unsigned long long>(nMeasured), static_cast<unsigned long long>(nForwarded),
+         static_cast<unsigned long long>(standIn->m_nArpRequests.load()),
+         static_cast<unsigned long long>(standIn->m_nOther.load()),
+         nMeasured / elapsed, nForwarded / elapsed,
+         nMeasured > 0 ? 100.0 * (nMeasured - std::min(nForwarded, nMeasured)) / nMeasured : 0.0,
+         percentile(latency, nForwarded, 0.5), percentile(latency, nForwarded, 0.99),
+         percentile(latency, nForwarded, 0.999), percentile(latency, nForwarded, 1.0));
+  return 0;
+}
+
+} // namespace bench
+} // namespace simple_router
+
+int
+main(int argc, char* argv[])
+{
+  using namespace simple_router::bench;
+
+  Ice::CommunicatorPtr communicator = Ice::initialize(argc, argv);
+
+  GeneratorConfig config;
+  std::string endpoint = "tcp -h 127.0.0.1 -p 8888";
+  double warmup = 1;
+  int option;
+  while ((option = getopt(argc, argv, "e:r:c:i:f:s:d:zR:w:t:S:h")) != -1) {
+    switch (option) {
+    case 'e':
+      endpoint = optarg;
+      break;
+    case 'r':
+      config.rtable = optarg;
+      break;
+    case 'c':
+      config.ifconfig = optarg;
+      break;
+    case 'i':
+      config.inIface = optarg;
+      break;
+    case 'f':
+      config.nFlows = std::max(1ul, strtoul(optarg, nullptr, 10));
+      break;
+    case 's':
+      if (!parseSizes(optarg, config)) {
+        usage(argv[0]);
+        return 2;
+      }
+      break;
+    case 'd':
+      config.destinations = optarg;
+      if (config.destinations != "routes" && config.destinations != "default" &&
+          config.destinations != "random") {
+        usage(argv[0]);
+        return 2;
+      }
+      break;
+    case 'z':
+      config.isZipf = true;
+      break;
+    case 'R':
+      config.rate = strtod(optarg, nullptr);
+      break;
+    case 'w':
+      warmup = strtod(optarg, nullptr);
+      break;
+    case 't':
+      config.duration = strtod(optarg, nullptr);
+      break;
+    case 'S':
+      config.seed = strtoul(optarg, nullptr, 10);
+      break;
+    default:
+      usage(argv[0]);
+      communicator->destroy();
+      return option == 'h' ? 0 : 2;
+    }
+  }
+
+  int status = 0;
+  try {
+    status = run(communicator, endpoint, warmup, config);
+  }
+  catch (const std::exception& e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    status = 1;
+  }
+  communicator->destroy();
+  return status;
+}
@@ -0,0 +1,862 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * Microbenchmarks of the router's core primitives.
+ *
+ * Usage: router-bench [name-filter]
+ */
+
+#include "bench.hpp"
+#include "core/checksum.hpp"
+
+#include <iostream>
+
+namespace simple_router {
+namespace bench {
+
+std::string g_filter;
+
+static std::string
+param(const char* name, uint64_t value)
+{
+  return std::string(name) + "=" + std::to_string(value);
+}
+
+struct NamedKernel
+{
+  const char* name;
+  uint16_t (*kernel)(const void* data, size_t len);
+};
+
+static std::vector<NamedKernel>
+getChecksumKernels()
+{
+  std::vector<NamedKernel> kernels = {{"scalar", checksumScalar}, {"64bit", checksum64}};
+#if defined(__x86_64__)
+  kernels.push_back({"sse2", checksumSse2});
+  if (__builtin_cpu_supports("avx2")) {
+    kernels.push_back({"avx2", checksumAvx2});
+  }
+#endif
+  return kernels;
+}
+
+/**
+ * Compare all checksum kernels and the incremental TTL update against the scalar
+ * reference on random data of random length and alignment
+ */
+static bool
+verifyChecksums()
+{
+  std::mt19937 random(42);
+  std::vector<uint8_t> data(10000 + 64);
+  uint64_t nCases = 0;
+  uint64_t nMismatches = 0;
+
+  for (int i = 0; i < 200000; ++i) {
+    size_t len = i < 100 ? i : random() % (i % 10 == 0 ? 10000 : 1600);
+    size_t offset = random() % 64;
+    // runs of 0xff and 0x00 exercise the carry folding
+    int fill = random() % 4;
+    for (size_t j = 0; j < len; ++j) {
+      data[offset + j] = fill == 0 ? 0xff : fill == 1 ? 0x00 : random();
+    }
+
+    uint16_t expected = checksumScalar(data.data() + offset, len);
+    for (const auto& kernel : getChecksumKernels()) {
+      ++nCases;
+      if (kernel.kernel(data.data() + offset, len) != expected) {
+        std::cerr << "checksum mismatch: kernel=" << kernel.name << " len=" << len
+                  << " offset=" << offset << std::endl;
+        ++nMismatches;
+      }
+    }
+    ++nCases;
+    if (checksum(data.data() + offset, len) != expected) {
+      ++nMismatches;
+    }
+  }
+
+  for (int i = 0; i < 200000; ++i) {
+    ip_hdr header;
+    uint8_t* bytes = reinterpret_cast<uint8_t*>(&header);
+    for (size_t j = 0; j < sizeof(header); ++j) {
+      bytes[j] = i % 3 == 0 ? 0xff : random();
+    }
+    header.ip_ttl = 2 + random() % 254;
+    header.ip_sum = 0;
+    header.ip_sum = checksumScalar(&header, sizeof(header));
+
+    decrementTtl(&header);
+    uint16_t incremental = header.ip_sum;
+    header.ip_sum = 0;
+    ++nCases;
+    if (incremental != checksumScalar(&header, sizeof(header))) {
+      std::cerr << "incremental TTL update mismatch" << std::endl;
+      ++nMismatches;
+    }
+  }
+
+  printf("{\"check\":\"checksum\",\"kernel\":\"%s\",\"cases\":%llu,\"mismatches\":%llu}\n",
+         checksumKernelName(), static_cast<unsigned long long>(nCases),
+         static_cast<unsigned long long>(nMismatches));
+  return nMismatches == 0;
+}
+
+/**
+ * Send interleaved IPv4 and IPv6 datagrams through handlePackets with the flight
+ * recorder sampling every few packets, which splits vectors around the sampled ones,
+ * and check that the router forwards them in the order they were received
+ */
+static bool
+verifyPacketOrder()
+{
+  CountingInjector injector;
+  SimpleRouter router;
+  setupRouter(router, {{"eth1", "192.168.2.1"}, {"eth3", "10.0.1.1"}},
+              {{ip("192.168.2.0"), ip("192.168.2.2"), ip("255.255.255.0"), "eth1"}}, injector);
+  router.getRoutingTable().addIpv6Entry({ip6("2001:db8:2::"), 64, ip6("::"), "eth1"});
+
+  const uint8_t eth1Mac[] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+  const uint8_t eth3Mac[] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x02};
+  const uint8_t server1Mac[] = {0x02, 0x00, 0x00, 0x00, 0x01, 0x01};
+  router.handlePacket(makeArpFrame(arp_op_reply, server1Mac, ip("192.168.2.2"), eth1Mac, ip("192.168.2.1")), "eth1");
+  router.handlePacket(makeIpv6Frame(64, eth3Mac, ip6("2001:db8:1::100"), ip6("2001:db8:2::2")), "eth3");
+  uint8_t advertisement[NDP_FRAME_SIZE];
+  buildNeighborAdvertisement(advertisement, sizeof(advertisement), server1Mac, ip6("2001:db8:2::2"),
+                             eth1Mac, linkLocalAddress(eth1Mac));
+  router.handlePacket(Buffer(advertisement, advertisement + sizeof(advertisement)), "eth1");
+
+  FlightRecorder::Config config;
+  config.sampleRate = 7;
+  router.getFlightRecorder().configure(config);
+
+  // the sequence number of every datagram is the first word of its payload
+  const uint32_t nPackets = 1000;
+  std::vector<Buffer> packets;
+  for (uint32_t i = 0; i < nPackets; ++i) {
+    bool isIpv6 = i % 3 == 1;
+    packets.push_back(isIpv6 ? makeIpv6Frame(64, eth3Mac, ip6("2001:db8:1::100"), ip6("2001:db8:2::2"))
+                             : makeIpFrame(64, eth3Mac, ip("10.0.1.100"), ip("192.168.2.2")));
+    uint32_t sequence = htonl(i);
+    memcpy(packets.back().data() + sizeof(ethernet_hdr) + (isIpv6 ? sizeof(ipv6_hdr) : sizeof(ip_hdr)),
+           &sequence, sizeof(sequence));
+  }
+
+  std::vector<uint32_t> sent;
+  injector.onSend = [&] (const Buffer& packet, const std::string&) {
+    bool isIpv6 = ethertype(packet.data()) == ethertype_ipv6;
+    uint32_t sequence;
+    memcpy(&sequence, packet.data() + sizeof(ethernet_hdr) + (isIpv6 ? sizeof(ipv6_hdr) : sizeof(ip_hdr)),
+           sizeof(sequence));
+    sent.push_back(ntohl(sequence));
+  };
+  for (uint32_t start = 0; start < nPackets; start += GRAPH_VECTOR_SIZE) {
+    size_t count = std::min<size_t>(GRAPH_VECTOR_SIZE, nPackets - start);
+    std::vector<const uint8_t*> frames;
+    std::vector<size_t> sizes;
+    for (size_t i = start; i < start + count; ++i) {
+      frames.push_back(packets[i].data());
+      sizes.push_back(packets[i].size());
+    }
+    router.handlePackets(frames.data(), sizes.data(), count, "eth3");
+  }
+
+  uint64_t nMisplaced = 0;
+  for (size_t i = 0; i < sent.size(); ++i) {
+    if (sent[i] != i) {
+      ++nMisplaced;
+    }
+  }
+  printf("{\"check\":\"packet-order\",\"sample_rate\":%u,\"packets\":%u,\"sent\":%zu,\"misplaced\":%llu}\n",
+         config.sampleRate, nPackets, sent.size(), static_cast<unsigned long long>(nMisplaced));
+  return sent.size() == nPackets && nMisplaced == 0;
+}
+
+/**
+ * Checksum over the pseudo-header (but for ICMP) and the whole transport segment of
+ * \p ip, including its checksum field: 0xffff if the segment is valid
+ */
+static uint16_t
+transportChecksum(const ip_hdr* ip)
+{
+  size_t headerLen = ip->ip_hl * 4;
+  size_t len = ntohs(ip->ip_len) - headerLen;
+  const uint8_t* transport = reinterpret_cast<const uint8_t*>(ip) + headerLen;
+  if (ip->ip_p == ip_protocol_icmp) {
+    return checksumScalar(transport, len);
+  }
+
+  std::vector<uint8_t> pseudo(12 + len, 0);
+  memcpy(pseudo.data(), &ip->ip_src, 8);
+  pseudo[9] = ip->ip_p;
+  pseudo[10] = len >> 8;
+  pseudo[11] = len & 0xff;
+  memcpy(pseudo.data() + 12, transport, len);
+  return checksumScalar(pseudo.data(), pseudo.size());
+}
+
+static size_t
+checksumOffsetOf(uint8_t protocol)
+{
+  return protocol == ip_protocol_tcp ? 16 : protocol == ip_protocol_udp ? 6 : 2;
+}
+
+/**
+ * Whether the IP header and the transport checksums of \p ip are valid; a UDP
+ * checksum of zero, none, stays valid
+ */
+static bool
+isDatagramValid(const ip_hdr* ip)
+{
+  const uint8_t* transport = reinterpret_cast<const uint8_t*>(ip) + ip->ip_hl * 4;
+  bool hasChecksum = ip->ip_p != ip_protocol_udp || transport[6] != 0 || transport[7] != 0;
+  return checksumScalar(ip, ip->ip_hl * 4) == 0xffff && (!hasChecksum || transportChecksum(ip) == 0xffff);
+}
+
+/**
+ * Ethernet/IPv4 frame of a TCP or UDP segment, or an ICMP echo message of \p icmpType
+ * with identifier \p srcPort, with random payload and valid checksums
+ */
+static Buffer
+makeTransportFrame(uint8_t protocol, uint32_t src, uint16_t srcPort, uint32_t dst, uint16_t dstPort,
+                   uint8_t icmpType, bool hasChecksum, std::mt19937& random)
+{
+  const uint8_t mac[] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+  Buffer frame = makeIpFrame(74 + random() % 200, mac, src, dst, 64, protocol);
+  uint8_t* transport = frame.data() + sizeof(ethernet_hdr) + sizeof(ip_hdr);
+  for (uint8_t* byte = transport; byte != frame.data() + frame.size(); ++byte) {
+    *byte = random();
+  }
+
+  if (protocol == ip_protocol_icmp) {
+    transport[0] = icmpType;
+    transport[1] = 0;
+    memcpy(transport + 4, &srcPort, sizeof(srcPort));
+  }
+  else {
+    memcpy(transport, &srcPort, sizeof(srcPort));
+    memcpy(transport + 2, &dstPort, sizeof(dstPort));
+    if (protocol == ip_protocol_tcp) {
+      transport[12] = 0x50;
+      transport[13] = 0x10; // ACK
+    }
+  }
+
+  uint8_t* sum = transport + checksumOffsetOf(protocol);
+  memset(sum, 0, sizeof(uint16_t));
+  if (hasChecksum) {
+    uint16_t value = transportChecksum(reinterpret_cast<ip_hdr*>(frame.data() + sizeof(ethernet_hdr)));
+    memcpy(sum, &value, sizeof(value));
+  }
+  return frame;
+}
+
+/**
+ * Translate TCP, UDP and ICMP echo flows out and their replies back, and the ICMP
+ * errors about them both ways (RFC 5508), and check every address, port and checksum
+ * of the results against values recomputed from scratch
+ */
+static bool
+verifyNapt()
+{
+  std::mt19937 random(42);
+  NaptTable::Config config;
+  config.address = ip("10.0.1.1");
+  NaptTable napt(config);
+  const uint8_t protocols[] = {ip_protocol_tcp, ip_protocol_udp, ip_protocol_icmp};
+
+  uint64_t nCases = 0;
+  uint64_t nMismatches = 0;
+  auto expect = [&] (bool isCorrect, const char* what, uint8_t protocol) {
+    ++nCases;
+    if (!isCorrect) {
+      std::cerr << "NAPT mismatch: " << what << ", protocol " << int(protocol) << std::endl;
+      ++nMismatches;
+    }
+  };
+
+  for (int i = 0; i < 30000; ++i) {
+    uint8_t protocol = protocols[i % 3];
+    uint32_t inside = htonl(0xc0a80000 | (random() & 0xffff));
+    uint32_t remote = htonl(0x08000000 | (random() & 0xffffff));
+    uint16_t insidePort = random();
+    uint16_t remotePort = protocol == ip_protocol_icmp ? 0 : random();
+    bool hasChecksum = protocol != ip_protocol_udp || i % 10 != 1;
+
+    Buffer out = makeTransportFrame(protocol, inside, insidePort, remote, remotePort, ICMP_ECHO_REQUEST,
+                                    hasChecksum, random);
+    ip_hdr* outIp = reinterpret_cast<ip_hdr*>(out.data() + sizeof(ethernet_hdr));
+    const uint8_t* outTransport = out.data() + sizeof(ethernet_hdr) + sizeof(ip_hdr);
+    if (!napt.translateOutbound(outIp, out.size() - sizeof(ethernet_hdr))) {
+      expect(false, "outbound not translated", protocol);
+      continue;
+    }
+    uint16_t externalPort;
+    memcpy(&externalPort, outTransport + (protocol == ip_protocol_icmp ? 4 : 0), sizeof(externalPort));
+    expect(outIp->ip_src == config.address && isDatagramValid(outIp), "outbound", protocol);
+
+    Buffer in = makeTransportFrame(protocol, remote, protocol == ip_protocol_icmp ? externalPort : remotePort,
+                                   config.address, externalPort, ICMP_ECHO_REPLY, hasChecksum, random);
+    ip_hdr* inIp = reinterpret_cast<ip_hdr*>(in.data() + sizeof(ethernet_hdr));
+    const uint8_t* inTransport = in.data() + sizeof(ethernet_hdr) + sizeof(ip_hdr);
+    uint16_t port = 0;
+    bool isTranslated = napt.translateInbound(inIp, in.size() - sizeof(ethernet_hdr));
+    memcpy(&port, inTransport + (protocol == ip_protocol_icmp ? 4 : 2), sizeof(port));
+    expect(isTranslated && inIp->ip_dst == inside && port == insidePort && isDatagramValid(inIp), "inbound", protocol);
+
+    // a router on the way reports the outbound datagram to the NAT address...
+    uint8_t error[ICMP_ERROR_FRAME_SIZE];
+    buildIcmpError(error, sizeof(error), ICMP_TIME_EXCEEDED, 0, ip("203.0.113.1"), out.data(), out.size());
+    ip_hdr* errorIp = reinterpret_cast<ip_hdr*>(error + sizeof(ethernet_hdr));
+    const ip_hdr* quoted = reinterpret_cast<const ip_hdr*>(error + sizeof(ethernet_hdr) + sizeof(ip_hdr) + 8);
+    const uint8_t* quotedTransport = reinterpret_cast<const uint8_t*>(quoted) + sizeof(ip_hdr);
+    isTranslated = napt.translateInbound(errorIp, ICMP_ERROR_FRAME_SIZE - sizeof(ethernet_hdr));
+    memcpy(&port, quotedTransport + (protocol == ip_protocol_icmp ? 4 : 0), sizeof(port));
+    expect(isTranslated && errorIp->ip_dst == inside && quoted->ip_src == inside && port == insidePort &&
+           isDatagramValid(errorIp) && checksumScalar(quoted, sizeof(ip_hdr)) == 0xffff, "inbound ICMP error", protocol);
+
+    // ...and the inside host the inbound one, from its own address
+    if (protocol == ip_protocol_icmp) {
+      continue;
+    }
+    buildIcmpError(error, sizeof(error), ICMP_DEST_UNREACHABLE, ICMP_PORT_UNREACHABLE, inside, in.data(), in.size());
+    isTranslated = napt.translateOutbound(errorIp, ICMP_ERROR_FRAME_SIZE - sizeof(ethernet_hdr));
+    memcpy(&port, quotedTransport + 2, sizeof(port));
+    expect(isTranslated && errorIp->ip_src == config.address && quoted->ip_dst == config.address &&
+           port == externalPort && isDatagramValid(errorIp) && checksumScalar(quoted, sizeof(ip_hdr)) == 0xffff,
+           "outbound ICMP error", protocol);
+  }
+
+  printf("{\"check\":\"napt\",\"translations\":%zu,\"cases\":%llu,\"mismatches\":%llu}\n",
+         napt.size(), static_cast<unsigned long long>(nCases), static_cast<unsigned long long>(nMismatches));
+  return nMismatches == 0;
+}
+
+static void
+benchChecksum()
+{
+  for (size_t size : {20, 64, 576, 1500, 9000}) {
+    std::vector<uint8_t> data(size);
+    std::mt19937 random(size);
+    for (auto& byte : data) {
+      byte = random();
+    }
+    run("cksum", param("bytes", size), [&] {
+      doNotOptimize(cksum(data.data(), data.size()));
+    });
+    for (const auto& kernel : getChecksumKernels()) {
+      run("checksum-kernel", param("bytes", size) + ",kernel=" + kernel.name, [&] {
+        doNotOptimize(kernel.kernel(data.data(), data.size()));
+      });
+    }
+  }
+
+  ip_hdr header = {};
+  header.ip_ttl = 255;
+  run("checksum-ttl", "update=incremental", [&] {
+    if (header.ip_ttl <= 1) {
+      header.ip_ttl = 255;
+    }
+    decrementTtl(&header);
+    doNotOptimize(header);
+  });
+  run("checksum-ttl", "update=full", [&] {
+    if (header.ip_ttl <= 1) {
+      header.ip_ttl = 255;
+    }
+    --header.ip_ttl;
+    header.ip_sum = 0;
+    header.ip_sum = checksumScalar(&header, sizeof(header));
+    doNotOptimize(header);
+  });
+}
+
+/**
+ * Routing table of \p size random prefixes plus a default route.  With \p isUniform
+ * prefix lengths are uniform over /8../32, otherwise they follow a typical BGP table
+ * (mostly /24, then /16../23).
+ */
+static std::vector<RoutingTableEntry>
+makeRoutes(size_t size, bool isUniform, std::mt19937& random)
+{
+  std::vector<RoutingTableEntry> routes;
+  routes.push_back({0, ip("10.0.1.100"), 0, "eth3"});
+
+  std::discrete_distribution<int> bgpLength({0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1, 1, 2, 2,
+                                             10, 3, 4, 5, 8, 7, 8, 8, 55});
+  std::uniform_int_distribution<int> uniformLength(8, 32);
+  const char* ifaces[] = {"eth1", "eth2", "eth3"};
+
+  for (size_t i = 0; i < size; ++i) {
+    int length = isUniform ? uniformLength(random) : bgpLength(random);
+    uint32_t mask = length == 0 ? 0 : htonl(~uint32_t(0) << (32 - length));
+    uint32_t dest = static_cast<uint32_t>(random()) & mask;
+    routes.push_back({dest, dest, mask, ifaces[i % 3]});
+  }
+  return routes;
+}
+
+static void
+benchRoutingTable()
+{
+  for (size_t size : {10, 100, 1000, 10000}) {
+    for (bool isUniform : {true, false}) {
+      std::mt19937 random(size);
+      RoutingTable table;
+      for (const auto& route : makeRoutes(size, isUniform, random)) {
+        table.addEntry(route);
+      }
+
+      std::vector<uint32_t> addresses(1024);
+      for (auto& address : addresses) {
+        address = random();
+      }
+
+      size_t next = 0;
+      run("rtable-lookup", param("entries", size) + (isUniform ? ",lengths=uniform" : ",lengths=bgp"), [&] {
+        doNotOptimize(table.lookup(addresses[next++ % addresses.size()]));
+      });
+    }
+  }
+}
+
+static void
+benchArpCache()
+{
+  // ARP caches need a router to send their requests through
+  CountingInjector injector;
+  SimpleRouter router;
+  setupRouter(router, {{"eth1", "192.168.2.1"}}, {}, injector);
+
+  Buffer mac = {0x02, 0x00, 0x00, 0x00, 0x01, 0x01};
+
+  for (size_t size : {16, 256, 4096}) {
+    ArpCache cache(router);
+    std::vector<uint32_t> present;
+    for (size_t i = 0; i < size; ++i) {
+      present.push_back(htonl(0x0a000000 + i));
+      cache.insertArpEntry(mac, present.back());
+    }
+
+    size_t next = 0;
+    run("arp-lookup", param("entries", size) + ",result=hit", [&] {
+      doNotOptimize(cache.lookup(present[next++ % size]));
+    });
+    run("arp-lookup", param("entries", size) + ",result=miss", [&] {
+      doNotOptimize(cache.lookup(htonl(0xc0a80000 + (next++ & 0xffff))));
+    });
+  }
+
+  // entries are never replaced, so the cache is cleared every `size` insertions;
+  // "hit" inserts an address that has a pending request
+  for (size_t size : {16, 256, 4096}) {
+    for (bool isHit : {true, false}) {
+      ArpCache cache(router);
+      Buffer frame = makeIpFrame(64, mac.data(), ip("10.0.1.100"), ip("192.168.2.2"));
+      uint32_t pending = ip("192.168.2.2");
+      cache.queueRequest(pending, frame, "eth1");
+
+      size_t count = 0;
+      run("arp-insert", param("entries", size) + (isHit ? ",result=hit" : ",result=miss"), [&] {
+        if (++count == size) {
+          cache.clear();
+          cache.queueRequest(pending, frame, "eth1");
+          count = 0;
+        }
+        doNotOptimize(cache.insertArpEntry(mac, isHit ? pending : htonl(0x0a000000 + count)));
+      });
+    }
+  }
+}
+
+static void
+benchFlowTable()
+{
+  if (!isSelected("flow-update")) {
+    return;
+  }
+
+  // 100000 flows do not fit the default table, so that case includes early exports
+  for (size_t nFlows : {1000, 100000}) {
+    std::vector<Buffer> packets;
+    for (size_t i = 0; i < nFlows; ++i) {
+      packets.push_back(makeIpFrame(64, BroadcastEtherAddr, htonl(0x0a000000 + i / 64), ip("192.168.2.2")));
+      uint16_t port = htons(1024 + i % 64);
+      memcpy(packets.back().data() + sizeof(ethernet_hdr) + sizeof(ip_hdr), &port, sizeof(port));
+    }
+
+    for (uint32_t sampleRate : {1, 100}) {
+      FlowTable::Config config;
+      config.sampleRate = sampleRate;
+      FlowTable flows(config);
+
+      size_t next = 0;
+      run("flow-update", param("flows", nFlows) + "," + param("sampling", sampleRate), [&] {
+        const Buffer& packet = packets[next++ % nFlows];
+        flows.update(reinterpret_cast<const ip_hdr*>(packet.data() + sizeof(ethernet_hdr)),
+                     packet.size() - sizeof(ethernet_hdr));
+      });
+    }
+  }
+}
+
+/**
+ * \p size rules between 10.0.0.0/14 and 192.168.0.0/22 with mixed prefix lengths,
+ * protocols and ports, then `permit any any`
+ */
+static std::vector<AclClassifier::Rule>
+makeAclRules(size_t size, std::mt19937& random)
+{
+  const uint8_t srcLengths[] = {16, 24, 28, 32};
+  const uint8_t dstLengths[] = {0, 24, 32};
+  const uint8_t protocols[] = {0, ip_protocol_tcp, ip_protocol_udp, ip_protocol_icmp};
+
+  std::vector<AclClassifier::Rule> rules;
+  for (size_t i = 0; i < size; ++i) {
+    AclClassifier::Rule rule = {random() % 2 ? AclClassifier::ACTION_PERMIT : AclClassifier::ACTION_DENY,
+                                0, srcLengths[random() % 4], 0, dstLengths[random() % 3],
+                                protocols[random() % 4], 0, 65535, 0, 65535};
+    rule.src = htonl(0x0a000000 | (random() & 0x3ffff)) & (rule.srcLength == 0 ? 0 : htonl(~0u << (32 - rule.srcLength)));
+    rule.dst = htonl(0xc0a80000 | (random() & 0x3ff)) & (rule.dstLength == 0 ? 0 : htonl(~0u << (32 - rule.dstLength)));
+    if (rule.protocol == ip_protocol_tcp || rule.protocol == ip_protocol_udp) {
+      switch (random() % 3) {
+      case 0:
+        rule.dstPortMin = rule.dstPortMax = random() % 1024;
+        break;
+      case 1:
+        rule.dstPortMin = random() % 60000;
+        rule.dstPortMax = rule.dstPortMin + random() % 5000;
+        break;
+      }
+      if (random() % 4 == 0) {
+        rule.srcPortMin = 1024;
+      }
+    }
+    rules.push_back(rule);
+  }
+  rules.push_back({AclClassifier::ACTION_PERMIT, 0, 0, 0, 0, 0, 0, 65535, 0, 65535});
+  return rules;
+}
+
+static bool
+matchesAclRule(const AclClassifier::Rule& rule, const FlowKey& key)
+{
+  uint32_t srcMask = rule.srcLength == 0 ? 0 : htonl(~0u << (32 - rule.srcLength));
+  uint32_t dstMask = rule.dstLength == 0 ? 0 : htonl(~0u << (32 - rule.dstLength));
+  uint16_t srcPort = ntohs(key.srcPort);
+  uint16_t dstPort = ntohs(key.dstPort);
+  return (key.src & srcMask) == (rule.src & srcMask) && (key.dst & dstMask) == (rule.dst & dstMask) &&
+         (rule.protocol == 0 || rule.protocol == key.protocol) &&
+         srcPort >= rule.srcPortMin && srcPort <= rule.srcPortMax &&
+         dstPort >= rule.dstPortMin && dstPort <= rule.dstPortMax;
+}
+
+/**
+ * Compare the classifier against a linear first-match search on random rule sets,
+ * some given with host bits set in their addresses, and on random keys as well as
+ * keys at the edges of the rules
+ */
+static bool
+verifyAcl()
+{
+  const uint8_t protocols[] = {ip_protocol_tcp, ip_protocol_udp, ip_protocol_icmp, 47};
+  std::mt19937 random(7);
+  uint64_t nCases = 0;
+  uint64_t nMismatches = 0;
+
+  for (int i = 0; i < 200; ++i) {
+    std::vector<AclClassifier::Rule> rules = makeAclRules(1 + random() % (i % 10 == 0 ? 2000 : 50), random);
+    // without the final `permit any any`, some keys match no rule
+    if (random() % 2) {
+      rules.pop_back();
+    }
+    for (auto& rule : rules) {
+      if (random() % 4 == 0) {
+        rule.src |= htonl(random() & 0xff);
+        rule.dst |= htonl(random() & 0xff);
+      }
+      if (rule.protocol == ip_protocol_tcp || rule.protocol == ip_protocol_udp) {
+        if (random() % 3 == 0) {
+          rule.srcPortMin = random() % 65536;
+          rule.srcPortMax = rule.srcPortMin + random() % (65536 - rule.srcPortMin);
+        }
+      }
+    }
+    AclClassifier acl;
+    acl.replace(rules);
+
+    for (int j = 0; j < 2000; ++j) {
+      FlowKey key;
+      memset(&key, 0, sizeof(key));
+      key.src = htonl(0x0a000000 | (random() & 0x3ffff));
+      key.dst = htonl(0xc0a80000 | (random() & 0x3ff));
+      key.protocol = protocols[random() % 4];
+      if (key.protocol == ip_protocol_tcp || key.protocol == ip_protocol_udp) {
+        key.srcPort = htons(random() % 65536);
+        key.dstPort = htons(random() % 65536);
+      }
+      if (j % 2 == 0) {
+        // on or next to the addresses and ports of a rule
+        const AclClassifier::Rule& rule = rules[random() % rules.size()];
+        uint32_t hostBits = random() % 4 == 0 ? htonl(1u << (random() % 32)) : 0;
+        key.src = rule.src ^ (random() % 2 ? hostBits : 0);
+        key.dst = rule.dst ^ (random() % 2 ? 0 : hostBits);
+        if (rule.protocol != 0) {
+          key.protocol = rule.protocol;
+        }
+        if (key.protocol == ip_protocol_tcp || key.protocol == ip_protocol_udp) {
+          const uint16_t srcPorts[] = {rule.srcPortMin, rule.srcPortMax,
+                                       static_cast<uint16_t>(rule.srcPortMin - 1),
+                                       static_cast<uint16_t>(rule.srcPortMax + 1)};
+          const uint16_t dstPorts[] = {rule.dstPortMin, rule.dstPortMax,
+                                       static_cast<uint16_t>(rule.dstPortMin - 1),
+                                       static_cast<uint16_t>(rule.dstPortMax + 1)};
+          key.srcPort = htons(srcPorts[random() % 4]);
+          key.dstPort = htons(dstPorts[random() % 4]);
+        }
+      }
+
+      AclClassifier::Action expected = AclClassifier::ACTION_PERMIT;
+      for (const auto& rule : rules) {
+        if (matchesAclRule(rule, key)) {
+          expected = rule.action;
+          break;
+        }
+      }
+      ++nCases;
+      if (acl.classify(key) != expected) {
+        std::cerr << "ACL mismatch: rules=" << rules.size() << " src=" << ipToString(key.src)
+                  << " dst=" << ipToString(key.dst) << " protocol=" << int(key.protocol) << std::endl;
+        ++nMismatches;
+      }
+    }
+  }
+
+  printf("{\"check\":\"acl\",\"cases\":%llu,\"mismatches\":%llu}\n",
+         static_cast<unsigned long long>(nCases), static_cast<unsigned long long>(nMismatches));
+  return nMismatches == 0;
+}
+
+static void
+benchAcl()
+{
+  if (!isSelected("acl-classify")) {
+    return;
+  }
+
+  std::mt19937 random(1);
+  std::vector<FlowKey> keys(4096);
+  for (auto& key : keys) {
+    memset(&key, 0, sizeof(key));
+    key.src = htonl(0x0a000000 | (random() & 0x3ffff));
+    key.dst = htonl(0xc0a80000 | (random() & 0x3ff));
+    key.protocol = random() % 2 ? ip_protocol_tcp : ip_protocol_udp;
+    key.srcPort = htons(1024 + random() % 60000);
+    key.dstPort = htons(random() % 1024);
+  }
+
+  // the cost should depend on the prefix lengths and protocols in use, not the rule count
+  for (size_t size : {10, 100, 1000, 5000}) {
+    AclClassifier acl;
+    acl.replace(makeAclRules(size, random));
+
+    size_t next = 0;
+    run("acl-classify", param("rules", size), [&] {
+      doNotOptimize(acl.classify(keys[next++ % keys.size()]));
+    });
+  }
+
+  // rules that only differ in their port ranges
+  for (size_t size : {10, 100, 1000, 5000}) {
+    std::vector<AclClassifier::Rule> rules;
+    for (size_t i = 0; i < size; ++i) {
+      uint16_t first = random() % 60000;
+      rules.push_back({AclClassifier::ACTION_DENY, 0, 0, 0, 0, ip_protocol_udp, 0, 65535,
+                       first, static_cast<uint16_t>(first + random() % 5000)});
+    }
+    AclClassifier acl;
+    acl.replace(rules);
+
+    size_t next = 0;
+    run("acl-classify", param("rules", size) + ",same-addresses", [&] {
+      doNotOptimize(acl.classify(keys[next++ % keys.size()]));
+    });
+  }
+}
+
+static void
+benchHandlePacket()
+{
+  CountingInjector injector;
+  SimpleRouter router;
+  setupRouter(router,
+              {{"eth1", "192.168.2.1"}, {"eth2", "172.64.3.1"}, {"eth3", "10.0.1.1"}},
+              {{ip("0.0.0.0"), ip("10.0.1.100"), ip("0.0.0.0"), "eth3"},
+               {ip("192.168.2.0"), ip("192.168.2.2"), ip("255.255.255.0"), "eth1"},
+               {ip("172.64.0.0"), ip("172.64.3.10"), ip("255.255.0.0"), "eth2"}},
+              injector);
+
+  const uint8_t eth1Mac[] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+  const uint8_t eth2Mac[] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x02};
+  const uint8_t eth3Mac[] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x03};
+  const uint8_t server1Mac[] = {0x02, 0x00, 0x00, 0x00, 0x01, 0x01};
+  const uint8_t server2Mac[] = {0x02, 0x00, 0x00, 0x00, 0x01, 0x02};
+  const uint8_t clientMac[] = {0x02, 0x00, 0x00, 0x00, 0x01, 0x03};
+
+  // resolve all next hops, so forwarding never waits for ARP
+  router.handlePacket(makeArpFrame(arp_op_reply, server1Mac, ip("192.168.2.2"), eth1Mac, ip("192.168.2.1")), "eth1");
+  router.handlePacket(makeArpFrame(arp_op_reply, server2Mac, ip("172.64.3.10"), eth2Mac, ip("172.64.3.1")), "eth2");
+  router.handlePacket(makeArpFrame(arp_op_reply, clientMac, ip("10.0.1.100"), eth3Mac, ip("10.0.1.1")), "eth3");
+
+  for (size_t size : {64, 512, 1500}) {
+    Buffer frame = makeIpFrame(size, eth3Mac, ip("10.0.1.100"), ip("192.168.2.2"));
+    run("handle-packet", param("bytes", size) + ",path=forward", [&] {
+      router.handlePacket(frame, "eth3");
+    });
+  }
+
+  // the same frames a vector at a time through the packet graph
+  for (size_t size : {64, 512, 1500}) {
+    Buffer frame = makeIpFrame(size, eth3Mac, ip("10.0.1.100"), ip("192.168.2.2"));
+    std::vector<const uint8_t*> frames(GRAPH_VECTOR_SIZE, frame.data());
+    std::vector<size_t> sizes(GRAPH_VECTOR_SIZE, frame.size());
+    run("handle-packet", param("bytes", size) + ",path=forward,batch=" + std::to_string(frames.size()), [&] {
+      router.handlePackets(frames.data(), sizes.data(), frames.size(), "eth3");
+    }, frames.size());
+  }
+
+  // the same path over IPv6, with the next hop resolved by the advertisement answering
+  // the solicitation of a first packet
+  router.getRoutingTable().addIpv6Entry({ip6("2001:db8:2::"), 64, ip6("::"), "eth1"});
+  router.getRoutingTable().addIpv6Entry({ip6("::"), 0, ip6("fe80::1"), "eth3"});
+  router.handlePacket(makeIpv6Frame(64, eth3Mac, ip6("2001:db8:1::100"), ip6("2001:db8:2::2")), "eth3");
+  uint8_t advertisement[NDP_FRAME_SIZE];
+  buildNeighborAdvertisement(advertisement, sizeof(advertisement), server1Mac, ip6("2001:db8:2::2"),
+                             eth1Mac, linkLocalAddress(eth1Mac));
+  router.handlePacket(Buffer(advertisement, advertisement + sizeof(advertisement)), "eth1");
+
+  for (size_t size : {64, 512, 1500}) {
+    Buffer frame = makeIpv6Frame(size, eth3Mac, ip6("2001:db8:1::100"), ip6("2001:db8:2::2"));
+    run("handle-packet", param("bytes", size) + ",path=forward-ipv6", [&] {
+      router.handlePacket(frame, "eth3");
+    });
+  }
+
+  Buffer request = makeArpFrame(arp_op_request, clientMac, ip("10.0.1.100"), BroadcastEtherAddr, ip("10.0.1.1"));
+  run("handle-packet", "path=arp-request", [&] {
+    router.handlePacket(request, "eth3");
+  });
+
+  Buffer expired = makeIpFrame(64, eth3Mac, ip("10.0.1.100"), ip("192.168.2.2"), 1);
+  run("handle-packet", "path=ttl-expired", [&] {
+    router.handlePacket(expired, "eth3");
+  });
+
+  Buffer expired6 = makeIpv6Frame(64, eth3Mac, ip6("2001:db8:1::100"), ip6("2001:db8:2::2"), 1);
+  run("handle-packet", "path=hop-limit-expired", [&] {
+    router.handlePacket(expired6, "eth3");
+  });
+
+  Buffer notForUs = makeIpFrame(64, server1Mac, ip("10.0.1.100"), ip("192.168.2.2"));
+  run("handle-packet", "path=not-for-us", [&] {
+    router.handlePacket(notForUs, "eth3");
+  });
+
+  if (isSelected("handle-packet") && injector.nPackets == 0) {
+    std::cerr << "handle-packet: router did not send any packet" << std::endl;
+  }
+}
+
+static void
+benchNapt()
+{
+  if (!isSelected("handle-packet")) {
+    return;
+  }
+
+  CountingInjector injector;
+  SimpleRouter router;
+  router.enableNapt("eth3", NaptTable::Config());
+  setupRouter(router,
+              {{"eth1", "192.168.2.1"}, {"eth3", "10.0.1.1"}},
+              {{ip("0.0.0.0"), ip("10.0.1.100"), ip("0.0.0.0"), "eth3"},
+               {ip("192.168.0.0"), ip("192.168.2.2"), ip("255.255.0.0"), "eth1"}},
+              injector);
+
+  const uint8_t eth1Mac[] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+  const uint8_t eth3Mac[] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x02};
+  const uint8_t server1Mac[] = {0x02, 0x00, 0x00, 0x00, 0x01, 0x01};
+  const uint8_t clientMac[] = {0x02, 0x00, 0x00, 0x00, 0x01, 0x03};
+  router.handlePacket(makeArpFrame(arp_op_reply, server1Mac, ip("192.168.2.2"), eth1Mac, ip("192.168.2.1")), "eth1");
+  router.handlePacket(makeArpFrame(arp_op_reply, clientMac, ip("10.0.1.100"), eth3Mac, ip("10.0.1.1")), "eth3");
+
+  // UDP flows of different inside hosts; the replies are built from the translated datagrams
+  const size_t nFlows = 1000;
+  std::vector<Buffer> outbound;
+  std::vector<Buffer> inbound;
+  injector.onSend = [&] (const Buffer& packet, const std::string&) {
+    const ip_hdr* ip = reinterpret_cast<const ip_hdr*>(packet.data() + sizeof(ethernet_hdr));
+    Buffer reply = makeIpFrame(64, eth3Mac, ip->ip_dst, ip->ip_src);
+    memcpy(reply.data() + sizeof(ethernet_hdr) + sizeof(ip_hdr) + 2,
+           packet.data() + sizeof(ethernet_hdr) + sizeof(ip_hdr), sizeof(uint16_t));
+    inbound.push_back(reply);
+  };
+  for (size_t i = 0; i < nFlows; ++i) {
+    outbound.push_back(makeIpFrame(64, eth1Mac, htonl(0xc0a80000 + i), ip("10.0.1.100")));
+    router.handlePacket(outbound.back(), "eth1");
+  }
+  injector.onSend = nullptr;
+
+  size_t next = 0;
+  run("handle-packet", "bytes=64,path=napt-outbound," + param("flows", nFlows), [&] {
+    router.handlePacket(outbound[next++ % nFlows], "eth1");
+  });
+  next = 0;
+  run("handle-packet", "bytes=64,path=napt-inbound," + param("flows", inbound.size()), [&] {
+    router.handlePacket(inbound[next++ % inbound.size()], "eth3");
+  });
+}
+
+} // namespace bench
+} // namespace simple_router
+
+int
+main(int argc, char* argv[])
+{
+  using namespace simple_router::bench;
+
+  if (argc > 1) {
+    g_filter = argv[1];
+  }
+
+  if (isSelected("checksum") && !verifyChecksums()) {
+    return 1;
+  }
+  if (isSelected("handle-packet") && (!verifyPacketOrder() || !verifyNapt())) {
+    return 1;
+  }
+  if (isSelected("acl-classify") && !verifyAcl()) {
+    return 1;
+  }
+
+  benchChecksum();
+  benchRoutingTable();
+  benchArpCache();
+  benchFlowTable();
+  benchAcl();
+  benchHandlePacket();
+  benchNapt();
+  return 0;
+}
@@ -0,0 +1,231 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * Synthetic traffic generator: feeds UDP flows into SimpleRouter::handlePacket and
+ * measures what comes out of the in-process packet injector.
+ *
+ * Every generated packet carries a sequence number and a send timestamp after the UDP
+ * header, so forwarded packets give the forwarding latency and anything that never
+ * comes out is counted as lost.  The result is printed as one JSON object.
+ */
+
+#include "traffic.hpp"
+
+#include <iostream>
+
+#include <getopt.h>
+#include <string.h>
+
+namespace simple_router {
+namespace bench {
+
+static void
+usage(const char* program)
+{
+  std::cerr
+    << "Usage: " << program << " [options]\n"
+    << "  -r FILE     routing table (default RTABLE)\n"
+    << "  -c FILE     interface configuration (default IP_CONFIG)\n"
+    << "  -i IFACE    interface to inject on (default: first interface)\n"
+    << "  -f N        number of flows (default 1024)\n"
+    << "  -s SIZES    frame sizes, comma separated, or `imix` (default 64)\n"
+    << "  -d DIST     destinations: routes (inside RTABLE prefixes), default (only the\n"
+    << "              default route matches) or random (default routes)\n"
+    << "  -z          Zipf-distributed flow popularity instead of uniform\n"
+    << "  -a          do not resolve next hops first (ARP-miss storm)\n"
+    << "  -R PPS      target rate in packets per second (default: unlimited)\n"
+    << "  -t SECONDS  duration (default 5)\n"
+    << "  -S SEED     random seed (default 1)\n";
+}
+
+static int
+generate(const GeneratorConfig& config)
+{
+  std::mt19937 random(config.seed);
+
+  std::vector<RoutingTableEntry> routes = readRoutes(config.rtable);
+  std::vector<BenchIface> ifaces = readIfaces(config.ifconfig, routes);
+  if (ifaces.empty()) {
+    throw std::runtime_error("No router interface found in `" + config.ifconfig + "`");
+  }
+
+  size_t inIndex = 0;
+  if (!config.inIface.empty()) {
+    while (inIndex < ifaces.size() && ifaces[inIndex].name != config.inIface) {
+      ++inIndex;
+    }
+    if (inIndex == ifaces.size()) {
+      throw std::runtime_error("Unknown interface `" + config.inIface + "`");
+    }
+  }
+  const std::string& inIface = ifaces[inIndex].name;
+  const uint8_t inMac[] = {0x02, 0x00, 0x00, 0x00, 0x00, static_cast<uint8_t>(inIndex + 1)};
+
+  CountingInjector injector;
+  SimpleRouter router;
+  setupRouter(router, ifaces, routes, injector);
+
+  if (!config.isArpMiss) {
+    for (size_t i = 0; i < routes.size(); ++i) {
+      size_t ifIndex = 0;
+      while (ifIndex < ifaces.size() && ifaces[ifIndex].name != routes[i].ifName) {
+        ++ifIndex;
+      }
+      if (ifIndex == ifaces.size()) {
+        continue; // interface not in the interface configuration
+      }
+      const uint8_t ifMac[] = {0x02, 0x00, 0x00, 0x00, 0x00, static_cast<uint8_t>(ifIndex + 1)};
+      const uint8_t hopMac[] = {0x02, 0x00, 0x00, 0x01, static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i)};
+      router.handlePacket(makeArpFrame(arp_op_reply, hopMac, routes[i].gw,
+                                       ifMac, ip(ifaces[ifIndex].ip.c_str())), routes[i].ifName);
+    }
+  }
+
+  std::vector<Flow> flows = makeFlows(config, routes, ip(ifaces[inIndex].ip.c_str()), random);
+
+  std::discrete_distribution<size_t> sizeChoice(config.sizeWeights.begin(), config.sizeWeights.end());
+  std::vector<double> flowWeights(flows.size(), 1.0);
+  if (config.isZipf) {
+    for (size_t i = 0; i < flowWeights.size(); ++i) {
+      flowWeights[i] = 1.0 / (i + 1);
+    }
+  }
+  std::discrete_distribution<size_t> flowChoice(flowWeights.begin(), flowWeights.end());
+
+  std::vector<Buffer> frames;
+  for (size_t size : config.sizes) {
+    frames.push_back(Buffer(size));
+  }
+
+  LatencyHistogram latency;
+  uint64_t nForwarded = 0;
+  // ARP requests are also resent from the ARP cache thread
+  std::atomic<uint64_t> nArpRequests(0);
+  injector.onSend = [&] (const Buffer& packet, const std::string&) {
+    uint64_t now = nowNs();
+    if (packet.size() >= MIN_FRAME_SIZE && ethertype(packet.data()) == ethertype_ip) {
+      GeneratorPayload payload;
+      memcpy(&payload, packet.data() + PAYLOAD_OFFSET, sizeof(payload));
+      if (payload.magic == GENERATOR_MAGIC) {
+        ++nForwarded;
+        ++latency.counts[LatencyHistogram::bucketOf(now - payload.timestamp)];
+      }
+    }
+    else if (ethertype(packet.data()) == ethertype_arp) {
+      ++nArpRequests;
+    }
+  };
+
+  uint64_t start = nowNs();
+  uint64_t end = start + static_cast<uint64_t>(config.duration * 1e9);
+  double interval = config.rate > 0 ? 1e9 / config.rate : 0;
+  uint64_t nSent = 0;
+
+  for (uint64_t now = start; now < end; now = nowNs()) {
+    if (interval > 0) {
+      uint64_t due = start + static_cast<uint64_t>(nSent * interval);
+      if (now < due) {
+        continue;
+      }
+    }
+
+    Buffer& frame = frames[sizeChoice(random)];
+    fillFrame(frame, inMac, flows[flowChoice(random)], nSent);
+    router.handlePacket(frame, inIface);
+    ++nSent;
+  }
+  double elapsed = (nowNs() - start) / 1e9;
+
+  printf("{\"generator\":\"udp\",\"flows\":%zu,\"destinations\":\"%s\",\"arp_miss\":%s,"
+         "\"target_pps\":%.0f,\"seconds\":%.3f,\"sent\":%llu,\"forwarded\":%llu,\"arp_requests\":%llu,"
+         "\"offered_pps\":%.0f,\"achieved_pps\":%.0f,\"loss_pct\":%.3f,"
+         "\"latency_ns\":{\"p50\":%.0f,\"p99\":%.0f,\"p999\":%.0f,\"max\":%.0f}}\n",
+         flows.size(), config.destinations.c_str(), config.isArpMiss ? "true" : "false",
+         config.rate, elapsed,
+         static_cast<unsigned long long>(nSent), static_cast<unsigned long long>(nForwarded),
+         static_cast<unsigned long long>(nArpRequests.load()),
+         nSent / elapsed, nForwarded / elapsed,
+         nSent > 0 ? 100.0 * (nSent - nForwarded) / nSent : 0.0,
+         percentile(latency, nForwarded, 0.5), percentile(latency, nForwarded, 0.99),
+         percentile(latency, nForwarded, 0.999), percentile(latency, nForwarded, 1.0));
+  return 0;
+}
+
+} // namespace bench
+} // namespace simple_router
+
+int
+main(int argc, char* argv[])
+{
+  using namespace simple_router::bench;
+
+  GeneratorConfig config;
+  int option;
+  while ((option = getopt(argc, argv, "r:c:i:f:s:d:zaR:t:S:h")) != -1) {
+    switch (option) {
+    case 'r':
+      config.rtable = optarg;
+      break;
+    case 'c':
+      config.ifconfig = optarg;
+      break;
+    case 'i':
+      config.inIface = optarg;
+      break;
+    case 'f':
+      config.nFlows = std::max(1ul, strtoul(optarg, nullptr, 10));
+      break;
+    case 's':
+      if (!parseSizes(optarg, config)) {
+        usage(argv[0]);
+        return 2;
+      }
+      break;
+    case 'd':
+      config.destinations = optarg;
+      if (config.destinations != "routes" && config.destinations != "default" &&
+          config.destinations != "random") {
+        usage(argv[0]);
+        return 2;
+      }
+      break;
+    case 'z':
+      config.isZipf = true;
+      break;
+    case 'a':
+      config.isArpMiss = true;
+      break;
+    case 'R':
+      config.rate = strtod(optarg, nullptr);
+      break;
+    case 't':
+      config.duration = strtod(optarg, nullptr);
+      break;
+    case 'S':
+      config.seed = strtoul(optarg, nullptr, 10);
+      break;
+    default:
+      usage(argv[0]);
+      return option == 'h' ? 0 : 2;
+    }
+  }
+
+  try {
+    return generate(config);
+  }
+  catch (const std::exception& e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    return 1;
+  }
+}
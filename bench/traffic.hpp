@@ -0,0 +1,250 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * This header file defines the synthetic UDP traffic shared by the load generators:
+ * flows towards the routing table prefixes, frames that carry a sequence number and
+ * send timestamp, and the latency percentiles of the forwarded ones.
+ */
+
+#ifndef SIMPLE_ROUTER_BENCH_TRAFFIC_HPP
+#define SIMPLE_ROUTER_BENCH_TRAFFIC_HPP
+
+#include "bench.hpp"
+
+namespace simple_router {
+namespace bench {
+
+const uint32_t GENERATOR_MAGIC = 0x53524747; // "SRGG"
+
+/**
+ * Payload that follows the UDP header of every generated packet
+ */
+struct GeneratorPayload
+{
+  uint32_t magic;
+  uint64_t sequence;
+  uint64_t timestamp; //< steady_clock nanoseconds when the frame was injected
+} __attribute__ ((packed));
+
+const size_t UDP_HDR_LEN = 8;
+const size_t PAYLOAD_OFFSET = sizeof(ethernet_hdr) + sizeof(ip_hdr) + UDP_HDR_LEN;
+const size_t MIN_FRAME_SIZE = PAYLOAD_OFFSET + sizeof(GeneratorPayload);
+
+struct GeneratorConfig
+{
+  std::string rtable = "RTABLE";
+  std::string ifconfig = "IP_CONFIG";
+  std::string inIface;
+  size_t nFlows = 1024;
+  std::vector<size_t> sizes = {64};
+  std::vector<double> sizeWeights = {1};
+  std::string destinations = "routes";
+  bool isZipf = false;
+  bool isArpMiss = false;
+  double rate = 0;   //< packets per second, 0 for as fast as possible
+  double duration = 5;
+  uint32_t seed = 1;
+};
+
+struct Flow
+{
+  uint32_t src;
+  uint32_t dst;
+  uint16_t srcPort;
+  uint16_t dstPort;
+};
+
+inline uint64_t
+nowNs()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline bool
+parseSizes(const std::string& spec, GeneratorConfig& config)
+{
+  config.sizes.clear();
+  config.sizeWeights.clear();
+  if (spec == "imix") {
+    config.sizes = {64, 576, 1500};
+    config.sizeWeights = {7, 4, 1};
+    return true;
+  }
+
+  std::istringstream is(spec);
+  std::string size;
+  while (std::getline(is, size, ',')) {
+    size_t value = strtoul(size.c_str(), nullptr, 10);
+    if (value == 0) {
+      return false;
+    }
+    config.sizes.push_back(std::max(value, MIN_FRAME_SIZE));
+    config.sizeWeights.push_back(1);
+  }
+  return !config.sizes.empty();
+}
+
+/**
+ * IPv4 routes of the routing table; comments, blank lines and IPv6 routes are skipped
+ * the same way RoutingTable::load skips them
+ */
+inline std::vector<RoutingTableEntry>
+readRoutes(const std::string& file)
+{
+  std::ifstream is(file);
+  if (!is) {
+    throw std::runtime_error("Cannot open routing table `" + file + "`");
+  }
+
+  std::vector<RoutingTableEntry> routes;
+  std::string line;
+  while (std::getline(is, line)) {
+    std::istringstream fields(line);
+    std::string dest, gw, mask, iface;
+    if (!(fields >> dest) || dest[0] == '#' || dest.find(':') != std::string::npos) {
+      continue;
+    }
+    if (!(fields >> gw >> mask >> iface)) {
+      throw std::runtime_error("Invalid route `" + line + "` in `" + file + "`");
+    }
+    routes.push_back({ip(dest.c_str()), ip(gw.c_str()), ip(mask.c_str()), iface});
+  }
+  return routes;
+}
+
+/**
+ * Router interfaces are the interfaces that appear in the routing table, with the
+ * addresses given in the interface configuration
+ */
+inline std::vector<BenchIface>
+readIfaces(const std::string& file, const std::vector<RoutingTableEntry>& routes)
+{
+  std::ifstream is(file);
+  if (!is) {
+    throw std::runtime_error("Cannot open interface configuration `" + file + "`");
+  }
+
+  std::vector<BenchIface> ifaces;
+  std::string name, address;
+  while (is >> name >> address) {
+    for (const auto& route : routes) {
+      if (route.ifName == name) {
+        ifaces.push_back({name, address});
+        break;
+      }
+    }
+  }
+  return ifaces;
+}
+
+inline bool
+isCoveredBySpecificRoute(uint32_t address, const std::vector<RoutingTableEntry>& routes)
+{
+  for (const auto& route : routes) {
+    if (route.mask != 0 && (address & route.mask) == (route.dest & route.mask)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+inline std::vector<Flow>
+makeFlows(const GeneratorConfig& config, const std::vector<RoutingTableEntry>& routes,
+          uint32_t inIfaceIp, std::mt19937& random)
+{
+  std::vector<const RoutingTableEntry*> specific;
+  for (const auto& route : routes) {
+    if (route.mask != 0) {
+      specific.push_back(&route);
+    }
+  }
+  if (config.destinations == "routes" && specific.empty()) {
+    throw std::runtime_error("Routing table has no prefix other than the default route");
+  }
+
+  std::vector<Flow> flows(config.nFlows);
+  for (size_t i = 0; i < flows.size(); ++i) {
+    Flow& flow = flows[i];
+    // sources in the /24 of the injecting interface, as if behind it
+    flow.src = (inIfaceIp & htonl(0xffffff00)) | htonl(2 + i % 250);
+    flow.srcPort = 1024 + (i % 60000);
+    flow.dstPort = 9;
+
+    uint32_t address = random();
+    if (config.destinations == "routes") {
+      const RoutingTableEntry& route = *specific[random() % specific.size()];
+      address = (route.dest & route.mask) | (address & ~route.mask);
+    }
+    else if (config.destinations == "default") {
+      for (int tries = 0; tries < 100 && isCoveredBySpecificRoute(address, routes); ++tries) {
+        address = random();
+      }
+    }
+    flow.dst = address;
+  }
+  return flows;
+}
+
+/**
+ * Write a complete frame of \p frame.size() bytes for \p flow into \p frame
+ */
+inline void
+fillFrame(Buffer& frame, const uint8_t* dstMac, const Flow& flow, uint64_t sequence)
+{
+  uint8_t* data = frame.data();
+
+  ethernet_hdr* eth = reinterpret_cast<ethernet_hdr*>(data);
+  memcpy(eth->ether_dhost, dstMac, ETHER_ADDR_LEN);
+  memset(eth->ether_shost, 0x02, ETHER_ADDR_LEN);
+  eth->ether_type = htons(ethertype_ip);
+
+  ip_hdr* ip = reinterpret_cast<ip_hdr*>(data + sizeof(ethernet_hdr));
+  memset(ip, 0, sizeof(ip_hdr));
+  ip->ip_v = 4;
+  ip->ip_hl = 5;
+  ip->ip_len = htons(frame.size() - sizeof(ethernet_hdr));
+  ip->ip_id = htons(static_cast<uint16_t>(sequence));
+  ip->ip_ttl = 64;
+  ip->ip_p = 17;
+  ip->ip_src = flow.src;
+  ip->ip_dst = flow.dst;
+  ip->ip_sum = cksum(ip, sizeof(ip_hdr));
+
+  uint8_t* udp = data + sizeof(ethernet_hdr) + sizeof(ip_hdr);
+  uint16_t udpFields[] = {htons(flow.srcPort), htons(flow.dstPort),
+                          htons(frame.size() - sizeof(ethernet_hdr) - sizeof(ip_hdr)), 0};
+  memcpy(udp, udpFields, UDP_HDR_LEN);
+
+  GeneratorPayload payload = {GENERATOR_MAGIC, sequence, nowNs()};
+  memcpy(data + PAYLOAD_OFFSET, &payload, sizeof(payload));
+}
+
+inline double
+percentile(const LatencyHistogram& histogram, uint64_t total, double q)
+{
+  uint64_t seen = 0;
+  for (size_t i = 0; i < LatencyHistogram::N_BUCKETS; ++i) {
+    seen += histogram.counts[i];
+    if (total > 0 && seen >= q * total) {
+      return LatencyHistogram::lowestValueOf(i + 1) - 1;
+    }
+  }
+  return 0;
+}
+
+} // namespace bench
+} // namespace simple_router
+
+#endif // SIMPLE_ROUTER_BENCH_TRAFFIC_HPP
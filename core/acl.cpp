@@ -0,0 +1,654 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "acl.hpp"
+#include "logger.hpp"
+#include "thread-blocks.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+
+#include <sys/stat.h>
+
+namespace simple_router {
+
+/**
+ * Rules compiled into two levels of tuple spaces: one hash table per tuple of address
+ * prefix lengths, and in each of its keys, one per tuple of port prefix lengths
+ */
+class AclClassifier::Ruleset
+{
+public:
+  explicit
+  Ruleset(const std::vector<Rule>& rules);
+
+  /**
+   * Index of the first rule matching \p key, rules.size() if none does
+   */
+  size_t
+  classify(const FlowKey& key) const;
+
+  /**
+   * Count a hit on rule \p match, rules.size() for no match, in the calling thread's block
+   */
+  void
+  count(size_t match);
+
+  /**
+   * Hits per rule, then of datagrams no rule matched, including those carried over
+   */
+  std::vector<uint64_t>
+  getHits() const;
+
+  /**
+   * Carry over the hits of \p previous to the same rules here, and those of no match
+   */
+  void
+  carryHits(const Ruleset& previous);
+
+  /**
+   * Masked ports of the rules of an address key; of the rules that cover them, only
+   * the first ever matters
+   */
+  struct PortSlot
+  {
+    uint16_t srcPort;  //< host byte order
+    uint16_t dstPort;
+    uint32_t rule;     //< index + 1, 0 for an empty slot
+  };
+
+  struct PortTuple
+  {
+    uint16_t srcPortMask;
+    uint16_t dstPortMask;
+    uint32_t firstRule;
+    uint8_t shift;     //< 64 - log2 of the number of slots
+    uint32_t slots;    //< first of its slots in portSlots
+  };
+
+  /**
+   * Masked addresses and protocol of rules, with the port tuples of those rules
+   */
+  struct AddressSlot
+  {
+    uint32_t src;
+    uint32_t dst;
+    uint8_t protocol;
+    uint32_t firstPortTuple; //< in portTuples, by firstRule
+    uint32_t nPortTuples;    //< 0 for an empty slot
+  };
+
+  struct AddressTuple
+  {
+    uint32_t srcMask;
+    uint32_t dstMask;
+    uint8_t protocolMask;
+    uint32_t firstRule;
+    uint8_t shift;
+    std::vector<AddressSlot> slots; //< open addressing, linear probing
+  };
+
+  struct HitBlock
+  {
+    explicit
+    HitBlock(size_t size)
+      : hits(size)
+    {
+    }
+
+    std::vector<std::atomic<uint64_t>> hits; //< per rule, then of datagrams no rule matched
+  };
+
+  std::vector<Rule> rules;
+  std::vector<AddressTuple> tuples;        //< by firstRule
+  std::vector<PortTuple> portTuples;
+  std::vector<PortSlot> portSlots;
+  std::vector<uint64_t> carriedHits;       //< from the rule sets this one replaced
+  ThreadBlocks<HitBlock> hitBlocks;
+};
+
+static uint32_t
+prefixMask(uint8_t length)
+{
+  return length == 0 ? 0 : htonl(~0u << (32 - length));
+}
+
+static uint16_t
+portMask(uint8_t length)
+{
+  return length == 0 ? 0 : static_cast<uint16_t>(0xffff << (16 - length));
+}
+
+/**
+ * Split the port range \p first-\p last into the fewest prefixes covering it exactly,
+ * at most 30 of them
+ */
+static void
+splitPortRange(uint16_t first, uint16_t last, std::vector<std::pair<uint16_t, uint8_t>>& prefixes)
+{
+  prefixes.clear();
+  uint32_t port = first;
+  while (port <= last) {
+    // the largest block aligned at port that does not go past last
+    uint8_t length = 16;
+    while (length > 0 && (port & ((1u << (17 - length)) - 1)) == 0 &&
+           port + (1u << (17 - length)) - 1 <= last) {
+      --length;
+    }
+    prefixes.push_back({static_cast<uint16_t>(port), length});
+    port += 1u << (16 - length);
+  }
+}
+
+/**
+ * Slot of a key in a table of 2^(64 - \p shift) slots, from the high bits of a
+ * multiplicative hash; it is computed once per tuple, so it is kept cheap
+ */
+static size_t
+hashSlot(uint64_t key, uint8_t shift)
+{
+  return (key * 0xc2b2ae3d27d4eb4full) >> shift;
+}
+
+static uint64_t
+addressKey(uint32_t src, uint32_t dst, uint8_t protocol)
+{
+  return (uint64_t(dst) << 32 | src) ^ protocol * 0x9e3779b97f4a7c15ull;
+}
+
+static uint64_t
+portKey(uint16_t srcPort, uint16_t dstPort)
+{
+  return (uint32_t(srcPort) << 16 | dstPort) * 0x9e3779b97f4a7c15ull;
+}
+
+/**
+ * log2 of the number of slots for \p nKeys keys, at most half full
+ */
+static uint8_t
+slotBits(size_t nKeys)
+{
+  uint8_t bits = 1;
+  while ((size_t(1) << bits) < nKeys * 2) {
+    ++bits;
+  }
+  return bits;
+}
+
+AclClassifier::Ruleset::Ruleset(const std::vector<Rule>& unmasked)
+  : rules(unmasked)
+  , carriedHits(unmasked.size() + 1)
+  , hitBlocks([this] { return new HitBlock(rules.size() + 1); },
+              [] (HitBlock* block) { delete block; })
+{
+  // slots hold masked addresses, which rules given to replace() may not be
+  for (Rule& rule : rules) {
+    rule.src &= prefixMask(rule.srcLength);
+    rule.dst &= prefixMask(rule.dstLength);
+  }
+
+  // address keys by tuple (source and destination lengths, whether the protocol is
+  // given); their ports by tuple (source and destination port lengths), each masked
+  // key with the first rule that covers it
+  typedef std::tuple<uint32_t, uint32_t, uint8_t> AddressKey;
+  typedef std::map<uint32_t, std::map<std::pair<uint16_t, uint16_t>, uint32_t>> PortKeys;
+  std::map<uint32_t, size_t> tupleIndex;
+  std::vector<std::map<AddressKey, PortKeys>> keys;
+
+  std::vector<std::pair<uint16_t, uint8_t>> srcPorts;
+  std::vector<std::pair<uint16_t, uint8_t>> dstPorts;
+  for (size_t i = 0; i < rules.size(); ++i) {
+    const Rule& rule = rules[i];
+    uint32_t id = rule.srcLength | rule.dstLength << 6 | (rule.protocol != 0) << 12;
+    auto tuple = tupleIndex.find(id);
+    if (tuple == tupleIndex.end()) {
+      tuple = tupleIndex.insert({id, tuples.size()}).first;
+      tuples.push_back(AddressTuple{prefixMask(rule.srcLength), prefixMask(rule.dstLength),
+                                    static_cast<uint8_t>(rule.protocol != 0 ? 0xff : 0),
+                                    static_cast<uint32_t>(i), 0, {}});
+      keys.emplace_back();
+    }
+    PortKeys& ports = keys[tuple->second][AddressKey(rule.src, rule.dst, rule.protocol)];
+
+    splitPortRange(rule.srcPortMin, rule.srcPortMax, srcPorts);
+    splitPortRange(rule.dstPortMin, rule.dstPortMax, dstPorts);
+    for (const auto& srcPort : srcPorts) {
+      for (const auto& dstPort : dstPorts) {
+        // an earlier rule with the same ports shadows this one there
+        ports[srcPort.second << 5 | dstPort.second].insert({{srcPort.first, dstPort.first},
+                                                            static_cast<uint32_t>(i)});
+      }
+    }
+  }
+
+  for (size_t t = 0; t < tuples.size(); ++t) {
+    AddressTuple& tuple = tuples[t];
+    uint8_t bits = slotBits(keys[t].size());
+    tuple.shift = 64 - bits;
+    tuple.slots.assign(size_t(1) << bits, AddressSlot{0, 0, 0, 0, 0});
+
+    for (const auto& key : keys[t]) {
+      AddressSlot slot = {std::get<0>(key.first), std::get<1>(key.first), std::get<2>(key.first),
+                          static_cast<uint32_t>(portTuples.size()),
+                          static_cast<uint32_t>(key.second.size())};
+
+      for (const auto& ports : key.second) {
+        uint8_t portBits = slotBits(ports.second.size());
+        PortTuple portTuple = {portMask(ports.first >> 5), portMask(ports.first & 31),
+                               static_cast<uint32_t>(rules.size()), static_cast<uint8_t>(64 - portBits),
+                               static_cast<uint32_t>(portSlots.size())};
+        portSlots.resize(portSlots.size() + (size_t(1) << portBits), PortSlot{0, 0, 0});
+        for (const auto& port : ports.second) {
+          portTuple.firstRule = std::min(portTuple.firstRule, port.second);
+          size_t i = hashSlot(portKey(port.first.first, port.first.second), portTuple.shift);
+          while (portSlots[portTuple.slots + i].rule != 0) {
+            i = (i + 1) & ((size_t(1) << portBits) - 1);
+          }
+          portSlots[portTuple.slots + i] = PortSlot{port.first.first, port.first.second, port.second + 1};
+        }
+        portTuples.push_back(portTuple);
+      }
+      std::sort(portTuples.begin() + slot.firstPortTuple, portTuples.end(),
+                [] (const PortTuple& a, const PortTuple& b) {
+                  return a.firstRule < b.firstRule;
+                });
+
+      size_t i = hashSlot(addressKey(slot.src, slot.dst, slot.protocol), tuple.shift);
+      while (tuple.slots[i].nPortTuples != 0) {
+        i = (i + 1) & (tuple.slots.size() - 1);
+      }
+      tuple.slots[i] = slot;
+    }
+  }
+
+  std::sort(tuples.begin(), tuples.end(), [] (const AddressTuple& a, const AddressTuple& b) {
+      return a.firstRule < b.firstRule;
+    });
+}
+
+size_t
+AclClassifier::Ruleset::classify(const FlowKey& key) const
+{
+  uint16_t srcPort = ntohs(key.srcPort);
+  uint16_t dstPort = ntohs(key.dstPort);
+
+  uint32_t match = rules.size();
+  for (const AddressTuple& tuple : tuples) {
+    if (tuple.firstRule >= match) {
+      break;
+    }
+
+    uint32_t src = key.src & tuple.srcMask;
+    uint32_t dst = key.dst & tuple.dstMask;
+    uint8_t protocol = key.protocol & tuple.protocolMask;
+    const AddressSlot* slots = tuple.slots.data();
+    size_t mask = tuple.slots.size() - 1;
+    const AddressSlot* slot = nullptr;
+    for (size_t i = hashSlot(addressKey(src, dst, protocol), tuple.shift); slots[i].nPortTuples != 0;
+         i = (i + 1) & mask) {
+      if (slots[i].src == src && slots[i].dst == dst && slots[i].protocol == protocol) {
+        slot = &slots[i];
+        break;
+      }
+    }
+    if (slot == nullptr) {
+      continue;
+    }
+
+    // only the port tuples of rules with these very addresses are probed
+    const PortTuple* portTuple = &portTuples[slot->firstPortTuple];
+    for (const PortTuple* end = portTuple + slot->nPortTuples; portTuple != end; ++portTuple) {
+      if (portTuple->firstRule >= match) {
+        break;
+      }
+      uint16_t maskedSrcPort = srcPort & portTuple->srcPortMask;
+      uint16_t maskedDstPort = dstPort & portTuple->dstPortMask;
+      const PortSlot* ports = &portSlots[portTuple->slots];
+      size_t portsMask = (size_t(1) << (64 - portTuple->shift)) - 1;
+      for (size_t i = hashSlot(portKey(maskedSrcPort, maskedDstPort), portTuple->shift);
+           ports[i].rule != 0; i = (i + 1) & portsMask) {
+        if (ports[i].srcPort == maskedSrcPort && ports[i].dstPort == maskedDstPort) {
+          match = std::min(match, ports[i].rule - 1);
+          break;
+        }
+      }
+    }
+  }
+  return match;
+}
+
+inline void
+AclClassifier::Ruleset::count(size_t match)
+{
+  // single writer per block: no need for an atomic read-modify-write
+  std::atomic<uint64_t>& counter = hitBlocks.get().hits[match];
+  counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+std::vector<uint64_t>
+AclClassifier::Ruleset::getHits() const
+{
+  std::vector<uint64_t> hits = carriedHits;
+  hitBlocks.forEach([&hits] (const HitBlock& block) {
+      for (size_t i = 0; i < hits.size(); ++i) {
+        hits[i] += block.hits[i].load(std::memory_order_relaxed);
+      }
+    });
+  return hits;
+}
+
+typedef std::tuple<int, uint32_t, uint8_t, uint32_t, uint8_t, uint8_t,
+                   uint16_t, uint16_t, uint16_t, uint16_t> RuleTuple;
+
+static RuleTuple
+ruleTuple(const AclClassifier::Rule& rule)
+{
+  return std::make_tuple(static_cast<int>(rule.action), rule.src, rule.srcLength, rule.dst, rule.dstLength,
+                         rule.protocol, rule.srcPortMin, rule.srcPortMax, rule.dstPortMin, rule.dstPortMax);
+}
+
+void
+AclClassifier::Ruleset::carryHits(const Ruleset& previous)
+{
+  std::vector<uint64_t> previousHits = previous.getHits();
+
+  // a rule repeated in both sets takes the hits of its occurrences in order
+  std::map<RuleTuple, std::vector<size_t>> indexes;
+  for (size_t i = previous.rules.size(); i-- > 0; ) {
+    indexes[ruleTuple(previous.rules[i])].push_back(i);
+  }
+  for (size_t i = 0; i < rules.size(); ++i) {
+    auto index = indexes.find(ruleTuple(rules[i]));
+    if (index != indexes.end() && !index->second.empty()) {
+      carriedHits[i] += previousHits[index->second.back()];
+      index->second.pop_back();
+    }
+  }
+  carriedHits.back() += previousHits.back();
+}
+
+AclClassifier::AclClassifier()
+  : m_current(nullptr)
+{
+  replace({});
+}
+
+AclClassifier::~AclClassifier()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_watchMutex);
+    m_shouldStop = true;
+  }
+  m_watchCv.notify_all();
+  if (m_watchThread.joinable()) {
+    m_watchThread.join();
+  }
+}
+
+static bool
+parsePrefix(const std::string& text, uint32_t& address, uint8_t& length)
+{
+  if (text == "any") {
+    address = 0;
+    length = 0;
+    return true;
+  }
+
+  int parsedLength;
+  if (!parseIpv4Prefix(text, address, parsedLength)) {
+    return false;
+  }
+  length = parsedLength;
+  address &= prefixMask(length);
+  return true;
+}
+
+static bool
+parseProtocol(const std::string& text, uint8_t& protocol)
+{
+  if (text == "any" || text == "ip") {
+    protocol = 0;
+  }
+  else if (text == "tcp") {
+    protocol = ip_protocol_tcp;
+  }
+  else if (text == "udp") {
+    protocol = ip_protocol_udp;
+  }
+  else if (text == "icmp") {
+    protocol = ip_protocol_icmp;
+  }
+  else {
+    char* end = nullptr;
+    long number = strtol(text.c_str(), &end, 10);
+    if (text.empty() || *end != '\0' || number < 0 || number > 255) {
+      return false;
+    }
+    protocol = number;
+  }
+  return true;
+}
+
+static bool
+parsePortRange(const std::string& text, uint16_t& first, uint16_t& last)
+{
+  if (text == "any") {
+    first = 0;
+    last = 65535;
+    return true;
+  }
+
+  char* end = nullptr;
+  long low = strtol(text.c_str(), &end, 10);
+  long high = low;
+  if (*end == '-') {
+    high = strtol(end + 1, &end, 10);
+  }
+  if (text.empty() || *end != '\0' || low < 0 || high > 65535 || low > high) {
+    return false;
+  }
+  first = low;
+  last = high;
+  return true;
+}
+
+void
+AclClassifier::load(const std::string& file)
+{
+  std::ifstream input(file.c_str());
+  if (!input) {
+    throw std::runtime_error("Cannot open ACL rules `" + file + "`");
+  }
+
+  std::vector<Rule> rules;
+  std::string line;
+  while (std::getline(input, line)) {
+    line = line.substr(0, line.find('#'));
+    std::istringstream ruleLine(line);
+    std::string action, src, dst, protocol = "any", srcPorts = "any", dstPorts = "any", extra;
+    if (!(ruleLine >> action)) {
+      continue;
+    }
+    if (!(ruleLine >> src >> dst)) {
+      throw std::runtime_error("ACL rule `" + line + "` needs a source and a destination");
+    }
+    ruleLine >> protocol >> srcPorts >> dstPorts;
+
+    Rule rule;
+    if (action != "permit" && action != "deny") {
+      throw std::runtime_error("Invalid ACL action `" + action + "`, expected permit or deny");
+    }
+    rule.action = action == "permit" ? ACTION_PERMIT : ACTION_DENY;
+    if (!parsePrefix(src, rule.src, rule.srcLength) || !parsePrefix(dst, rule.dst, rule.dstLength)) {
+      throw std::runtime_error("Invalid prefix in ACL rule `" + line + "`");
+    }
+    if (!parseProtocol(protocol, rule.protocol)) {
+      throw std::runtime_error("Invalid protocol `" + protocol + "` in ACL rule");
+    }
+    if (!parsePortRange(srcPorts, rule.srcPortMin, rule.srcPortMax) ||
+        !parsePortRange(dstPorts, rule.dstPortMin, rule.dstPortMax) || (ruleLine >> extra)) {
+      throw std::runtime_error("Invalid ports in ACL rule `" + line + "`");
+    }
+    if (rule.protocol != ip_protocol_tcp && rule.protocol != ip_protocol_udp &&
+        (srcPorts != "any" || dstPorts != "any")) {
+      throw std::runtime_error("ACL rule `" + line + "` has ports, but is not for tcp or udp");
+    }
+    rules.push_back(rule);
+  }
+
+  replace(rules);
+}
+
+void
+AclClassifier::replace(const std::vector<Rule>& rules)
+{
+  std::unique_ptr<Ruleset> next(new Ruleset(rules));
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_active != nullptr) {
+    // hits counted on the current rule set between this and the swap are not carried over
+    next->carryHits(*m_active);
+  }
+  // classifications that loaded the retired rule set had until this swap to finish
+  m_retired = std::move(m_active);
+  m_active = std::move(next);
+  m_current.store(m_active.get(), std::memory_order_release);
+}
+
+void
+AclClassifier::watch(const std::string& file, std::chrono::milliseconds interval)
+{
+  m_watchThread = std::thread(std::bind(&AclClassifier::run, this, file, interval));
+}
+
+void
+AclClassifier::run(std::string file, std::chrono::milliseconds interval)
+{
+  struct stat info;
+  timespec modified = {0, 0};
+  if (stat(file.c_str(), &info) == 0) {
+    modified = info.st_mtim;
+  }
+
+  std::unique_lock<std::mutex> lock(m_watchMutex);
+  while (!m_shouldStop) {
+    m_watchCv.wait_for(lock, interval);
+    if (m_shouldStop || stat(file.c_str(), &info) != 0 ||
+        (info.st_mtim.tv_sec == modified.tv_sec && info.st_mtim.tv_nsec == modified.tv_nsec)) {
+      continue;
+    }
+
+    modified = info.st_mtim;
+    try {
+      load(file);
+    }
+    catch (const std::runtime_error& e) {
+      SR_LOG_WARN("Cannot reload ACL rules: " << e.what());
+    }
+  }
+}
+
+AclClassifier::Action
+AclClassifier::classify(const FlowKey& key)
+{
+  Ruleset& ruleset = *m_current.load(std::memory_order_acquire);
+  size_t match = ruleset.classify(key);
+  ruleset.count(match);
+  return match < ruleset.rules.size() ? ruleset.rules[match].action : ACTION_PERMIT;
+}
+
+size_t
+AclClassifier::size() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_active->rules.size();
+}
+
+static std::string
+prefixToString(uint32_t address, uint8_t length)
+{
+  if (length == 0) {
+    return "any";
+  }
+  return ipToString(address) + (length == 32 ? "" : "/" + std::to_string(length));
+}
+
+static std::string
+protocolToString(uint8_t protocol)
+{
+  switch (protocol) {
+  case ip_protocol_tcp:
+    return "tcp";
+  case ip_protocol_udp:
+    return "udp";
+  case ip_protocol_icmp:
+    return "icmp";
+  default:
+    return std::to_string(protocol);
+  }
+}
+
+static std::string
+portsToString(uint16_t first, uint16_t last)
+{
+  if (first == 0 && last == 65535) {
+    return "any";
+  }
+  return std::to_string(first) + (first == last ? "" : "-" + std::to_string(last));
+}
+
+void
+AclClassifier::print(std::ostream& os) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  const Ruleset& ruleset = *m_active;
+  std::vector<uint64_t> hits = ruleset.getHits();
+
+  os << "\nACL rule                                                                    Hits\n"
+     << "--------------------------------------------------------------------------------\n";
+  for (size_t i = 0; i < ruleset.rules.size(); ++i) {
+    const Rule& rule = ruleset.rules[i];
+    std::string text = std::string(rule.action == ACTION_PERMIT ? "permit " : "deny ") +
+                       prefixToString(rule.src, rule.srcLength) + " " + prefixToString(rule.dst, rule.dstLength);
+    if (rule.protocol != 0) {
+      text += " " + protocolToString(rule.protocol);
+    }
+    if (rule.protocol == ip_protocol_tcp || rule.protocol == ip_protocol_udp) {
+      text += " " + portsToString(rule.srcPortMin, rule.srcPortMax) +
+              " " + portsToString(rule.dstPortMin, rule.dstPortMax);
+    }
+    os << std::left << std::setw(64) << text << std::right
+       << std::setw(16) << hits[i] << "\n";
+  }
+  os << std::left << std::setw(64) << "(no match, permitted)" << std::right
+     << std::setw(16) << hits.back() << "\n"
+     << ruleset.rules.size() << " rules in " << ruleset.tuples.size() << " address tuples, "
+     << ruleset.portTuples.size() << " port tuples\n";
+}
+
+std::ostream&
+operator<<(std::ostream& os, const AclClassifier& acl)
+{
+  acl.print(os);
+  return os;
+}
+
+} // namespace simple_router
@@ -0,0 +1,139 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * This header file defines the access control list that permits or denies IPv4
+ * datagrams by their 5-tuple.
+ */
+
+#ifndef SIMPLE_ROUTER_CORE_ACL_HPP
+#define SIMPLE_ROUTER_CORE_ACL_HPP
+
+#include "protocol.hpp"
+#include "flow-table.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+
+namespace simple_router {
+
+/**
+ * Ordered permit/deny rules on the 5-tuple, the first matching rule deciding
+ *
+ * The rules are compiled into a tuple space on two levels.  Rules are grouped by the
+ * tuple of their address prefix lengths and whether the protocol is given, each group
+ * being a hash table of masked addresses and protocol.  Each such key holds a tuple
+ * space of the ports of its rules: port ranges are split into prefixes and grouped by
+ * source and destination port prefix length, each group a hash table of masked ports
+ * with the first rule that covers them.  A datagram is classified with one probe per
+ * address group, plus one per port group of the keys it matches, however many rules
+ * there are.  Groups are probed in the order of the first rule they hold, and the
+ * search stops once no remaining group can hold an earlier rule than the one found.
+ *
+ * classify() takes no lock.  A new rule set is compiled aside and swapped in
+ * atomically; the one it replaces is kept until the next swap, so classifications
+ * in progress never use a freed rule set.  Hits are counted per thread, and a new
+ * rule set takes over those of the rules it has in common with the one it replaces.
+ */
+class AclClassifier
+{
+public:
+  enum Action {
+    ACTION_PERMIT,
+    ACTION_DENY,
+  };
+
+  struct Rule
+  {
+    Action action;
+    uint32_t src;           //< network byte order
+    uint8_t srcLength;
+    uint32_t dst;
+    uint8_t dstLength;
+    uint8_t protocol;       //< 0 for any
+    uint16_t srcPortMin;    //< host byte order, 0-65535 for any
+    uint16_t srcPortMax;
+    uint16_t dstPortMin;
+    uint16_t dstPortMax;
+  };
+
+  AclClassifier();
+
+  ~AclClassifier();
+
+  /**
+   * Replace the rules with those in \p file, one per line:
+   * `permit|deny <src> <dst> [<protocol> [<src port> [<dst port>]]]`, where addresses
+   * are `any`, `address` or `address/length`, the protocol `any`, `tcp`, `udp`,
+   * `icmp` or a number, and ports (TCP and UDP only) `any`, `port` or `first-last`.
+   * Blank lines and `#` comments are ignored.  Datagrams no rule matches are permitted.
+   *
+   * @throws std::runtime_error on a malformed line, leaving the rules unchanged
+   */
+  void
+  load(const std::string& file);
+
+  /**
+   * Compile \p rules and swap them in; their addresses are masked to their lengths
+   */
+  void
+  replace(const std::vector<Rule>& rules);
+
+  /**
+   * load() \p file again whenever its modification time changes, checking every
+   * \p interval
+   */
+  void
+  watch(const std::string& file, std::chrono::milliseconds interval);
+
+  /**
+   * Action of the first rule matching \p key, counting a hit on it
+   */
+  Action
+  classify(const FlowKey& key);
+
+  size_t
+  size() const;
+
+  void
+  print(std::ostream& os) const;
+
+private:
+  class Ruleset;
+
+  void
+  run(std::string file, std::chrono::milliseconds interval);
+
+private:
+  std::atomic<Ruleset*> m_current;
+  std::unique_ptr<Ruleset> m_active;
+  std::unique_ptr<Ruleset> m_retired;
+  mutable std::mutex m_mutex;
+
+  std::mutex m_watchMutex;
+  std::condition_variable m_watchCv;
+  bool m_shouldStop = false;
+  std::thread m_watchThread;
+};
+
+std::ostream&
+operator<<(std::ostream& os, const AclClassifier& acl);
+
+} // namespace simple_router
+
+#endif // SIMPLE_ROUTER_CORE_ACL_HPP
@@ -0,0 +1,365 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "capture.hpp"
+#include "logger.hpp"
+
+#include <chrono>
+#include <functional>
+#include <stdexcept>
+
+#include <string.h>
+#include <time.h>
+
+#define PCAPNG_BLOCK_SHB 0x0A0D0D0A
+#define PCAPNG_BLOCK_IDB 0x00000001
+#define PCAPNG_BLOCK_EPB 0x00000006
+#define PCAPNG_BYTE_ORDER_MAGIC 0x1A2B3C4D
+
+#define PCAPNG_OPT_ENDOFOPT 0
+#define PCAPNG_OPT_IF_NAME 2
+#define PCAPNG_OPT_IF_TSRESOL 9
+#define PCAPNG_OPT_EPB_FLAGS 2
+
+#define LINKTYPE_ETHERNET 1
+
+namespace simple_router {
+
+static const size_t FLUSH_THRESHOLD = 1 << 20;
+
+static thread_local uint32_t t_sampleCount = 0;
+
+static size_t
+pad4(size_t length)
+{
+  return (length + 3) & ~size_t(3);
+}
+
+static void
+put32(std::vector<uint8_t>& out, uint32_t value)
+{
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(&value);
+  out.insert(out.end(), p, p + sizeof(value));
+}
+
+static void
+put16(std::vector<uint8_t>& out, uint16_t value)
+{
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(&value);
+  out.insert(out.end(), p, p + sizeof(value));
+}
+
+static void
+putPadded(std::vector<uint8_t>& out, const void* data, size_t length)
+{
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+  out.insert(out.end(), p, p + length);
+  out.resize(out.size() + pad4(length) - length, 0);
+}
+
+static uint64_t
+nowNanoseconds()
+{
+  timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+PacketCapture::PacketCapture(const Config& config)
+  : m_config(config)
+  , m_enqueuePos(0)
+  , m_captured(0)
+  , m_dropped(0)
+  , m_dequeuePos(0)
+  , m_nWrittenIfaces(0)
+  , m_file(nullptr)
+  , m_nFiles(0)
+  , m_fileBytes(0)
+  , m_shouldStop(false)
+{
+  if (m_config.sampleRate == 0) {
+    m_config.sampleRate = 1;
+  }
+  if (m_config.snaplen == 0 || m_config.snaplen > IP_MAXPACKET) {
+    m_config.snaplen = IP_MAXPACKET;
+  }
+
+  size_t nSlots = 1;
+  while (nSlots < m_config.ringSize) {
+    nSlots <<= 1;
+  }
+  m_mask = nSlots - 1;
+  m_slotStride = (sizeof(Slot) + m_config.snaplen + 63) & ~size_t(63);
+  m_ring.reset(new uint8_t[nSlots * m_slotStride + 64]);
+  for (size_t i = 0; i < nSlots; ++i) {
+    new (&slotAt(i)) Slot;
+    slotAt(i).sequence.store(i, std::memory_order_relaxed);
+  }
+
+  m_out.reserve(FLUSH_THRESHOLD + 2 * m_slotStride);
+  if (!openFile()) {
+    throw std::runtime_error("Cannot open capture file `" + m_config.file + "`");
+  }
+
+  m_writerThread = std::thread(std::bind(&PacketCapture::writer, this));
+}
+
+PacketCapture::~PacketCapture()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_stopMutex);
+    m_shouldStop = true;
+  }
+  m_stopCv.notify_one();
+  m_writerThread.join();
+
+  if (m_file != nullptr) {
+    fclose(m_file);
+  }
+}
+
+PacketCapture::Slot&
+PacketCapture::slotAt(size_t position) const
+{
+  uintptr_t base = (reinterpret_cast<uintptr_t>(m_ring.get()) + 63) & ~uintptr_t(63);
+  return *reinterpret_cast<Slot*>(base + (position & m_mask) * m_slotStride);
+}
+
+uint8_t*
+PacketCapture::slotData(Slot& slot) const
+{
+  return reinterpret_cast<uint8_t*>(&slot) + sizeof(Slot);
+}
+
+void
+PacketCapture::setInterfaces(const std::vector<std::string>& names)
+{
+  std::lock_guard<std::mutex> lock(m_ifMutex);
+  m_ifNames = names;
+}
+
+void
+PacketCapture::capture(const uint8_t* data, size_t size, uint32_t ifIndex, Direction direction)
+{
+  if (m_config.sampleRate > 1) {
+    if (++t_sampleCount < m_config.sampleRate) {
+      return;
+    }
+    t_sampleCount = 0;
+  }
+
+  Slot* slot;
+  size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+  for (;;) {
+    slot = &slotAt(pos);
+    size_t seq = slot->sequence.load(std::memory_order_acquire);
+    intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+    if (diff == 0) {
+      if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    }
+    else if (diff < 0) {
+      // writer is behind, capture must not wait for it
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    else {
+      pos = m_enqueuePos.load(std::memory_order_relaxed);
+    }
+  }
+
+  slot->timestamp = nowNanoseconds();
+  slot->ifIndex = ifIndex;
+  slot->length = size;
+  slot->captured = std::min<size_t>(size, m_config.snaplen);
+  slot->direction = direction;
+  memcpy(slotData(*slot), data, slot->captured);
+  slot->sequence.store(pos + 1, std::memory_order_release);
+
+  m_captured.fetch_add(1, std::memory_order_relaxed);
+}
+
+void
+PacketCapture::writer()
+{
+  std::unique_lock<std::mutex> lock(m_stopMutex);
+  while (!m_shouldStop) {
+    lock.unlock();
+    bool isIdle = drain() == 0;
+    if (isIdle && !m_out.empty()) {
+      flush();
+    }
+    lock.lock();
+    if (isIdle) {
+      m_stopCv.wait_for(lock, std::chrono::milliseconds(1));
+    }
+  }
+  lock.unlock();
+
+  drain();
+  flush();
+}
+
+size_t
+PacketCapture::drain()
+{
+  size_t nDrained = 0;
+  for (;;) {
+    Slot& slot = slotAt(m_dequeuePos);
+    if (slot.sequence.load(std::memory_order_acquire) != m_dequeuePos + 1) {
+      break;
+    }
+
+    appendPacket(slot, slotData(slot));
+    slot.sequence.store(m_dequeuePos + m_mask + 1, std::memory_order_release);
+    ++m_dequeuePos;
+    ++nDrained;
+
+    if (m_out.size() >= FLUSH_THRESHOLD) {
+      flush();
+    }
+  }
+  return nDrained;
+}
+
+void
+PacketCapture::appendPacket(const Slot& slot, const uint8_t* data)
+{
+  if (slot.ifIndex >= m_nWrittenIfaces) {
+    appendInterfaces(slot.ifIndex + 1);
+  }
+
+  // Enhanced Packet Block with a single epb_flags option
+  uint32_t blockLength = 28 + pad4(slot.captured) + 12 + 4;
+  put32(m_out, PCAPNG_BLOCK_EPB);
+  put32(m_out, blockLength);
+  put32(m_out, slot.ifIndex);
+  put32(m_out, static_cast<uint32_t>(slot.timestamp >> 32));
+  put32(m_out, static_cast<uint32_t>(slot.timestamp));
+  put32(m_out, slot.captured);
+  put32(m_out, slot.length);
+  putPadded(m_out, data, slot.captured);
+  put16(m_out, PCAPNG_OPT_EPB_FLAGS);
+  put16(m_out, 4);
+  put32(m_out, slot.direction);
+  put32(m_out, PCAPNG_OPT_ENDOFOPT);
+  put32(m_out, blockLength);
+}
+
+void
+PacketCapture::appendInterfaces(size_t count)
+{
+  std::vector<std::string> names;
+  {
+    std::lock_guard<std::mutex> lock(m_ifMutex);
+    names = m_ifNames;
+  }
+
+  // pcapng interface IDs are assigned in IDB order, so IDBs for interfaces that
+  // were not yet known are appended.  Unknown indices get an unnamed IDB.
+  count = std::max(count, names.size());
+  for (; m_nWrittenIfaces < count; ++m_nWrittenIfaces) {
+    std::string name = m_nWrittenIfaces < names.size() ? names[m_nWrittenIfaces] : "";
+    size_t nameLength = name.empty() ? 0 : 4 + pad4(name.size());
+
+    uint32_t blockLength = 16 + nameLength + 8 + 4 + 4;
+    put32(m_out, PCAPNG_BLOCK_IDB);
+    put32(m_out, blockLength);
+    put16(m_out, LINKTYPE_ETHERNET);
+    put16(m_out, 0);
+    put32(m_out, m_config.snaplen);
+    if (!name.empty()) {
+      put16(m_out, PCAPNG_OPT_IF_NAME);
+      put16(m_out, name.size());
+      putPadded(m_out, name.data(), name.size());
+    }
+    put16(m_out, PCAPNG_OPT_IF_TSRESOL);
+    put16(m_out, 1);
+    m_out.push_back(9); // nanoseconds
+    m_out.resize(m_out.size() + 3, 0);
+    put32(m_out, PCAPNG_OPT_ENDOFOPT);
+    put32(m_out, blockLength);
+  }
+}
+
+void
+PacketCapture::flush()
+{
+  if (m_file != nullptr && !m_out.empty()) {
+    if (fwrite(m_out.data(), m_out.size(), 1, m_file) != 1) {
+      SR_LOG_WARN("Cannot write capture file `" << m_config.file << "`");
+    }
+    fflush(m_file);
+    m_fileBytes += m_out.size();
+  }
+  m_out.clear();
+
+  if (m_file != nullptr && m_config.rotateBytes > 0 && m_fileBytes >= m_config.rotateBytes) {
+    fclose(m_file);
+    if (!openFile()) {
+      SR_LOG_WARN("Cannot open next capture file, capture stopped");
+    }
+  }
+}
+
+bool
+PacketCapture::openFile()
+{
+  std::string name = m_config.file;
+  if (m_nFiles > 0) {
+    uint32_t n = m_config.maxFiles > 0 ? m_nFiles % m_config.maxFiles : m_nFiles;
+    if (n > 0) {
+      name += "." + std::to_string(n);
+    }
+  }
+  ++m_nFiles;
+
+  m_file = fopen(name.c_str(), "w");
+  if (m_file == nullptr) {
+    return false;
+  }
+  m_fileBytes = 0;
+
+  // Section Header Block, section length unspecified
+  put32(m_out, PCAPNG_BLOCK_SHB);
+  put32(m_out, 28);
+  put32(m_out, PCAPNG_BYTE_ORDER_MAGIC);
+  put16(m_out, 1);
+  put16(m_out, 0);
+  put32(m_out, 0xffffffff);
+  put32(m_out, 0xffffffff);
+  put32(m_out, 28);
+
+  m_nWrittenIfaces = 0;
+  appendInterfaces(0);
+  return true;
+}
+
+void
+PacketCapture::print(std::ostream& os) const
+{
+  os << "Capture to " << m_config.file
+     << ", captured: " << getCaptured()
+     << ", dropped: " << getDropped() << "\n";
+}
+
+std::ostream&
+operator<<(std::ostream& os, const PacketCapture& capture)
+{
+  capture.print(os);
+  return os;
+}
+
+} // namespace simple_router
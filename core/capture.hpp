@@ -0,0 +1,176 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * This header file defines an asynchronous capture tap that records frames seen by
+ * the router into pcapng files without blocking the forwarding path.
+ */
+
+#ifndef SIMPLE_ROUTER_CORE_CAPTURE_HPP
+#define SIMPLE_ROUTER_CORE_CAPTURE_HPP
+
+#include "protocol.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <stdio.h>
+
+namespace simple_router {
+
+/**
+ * Ring-buffered pcapng capture tap
+ *
+ * Forwarding threads copy (at most snaplen bytes of) every Nth frame into a bounded
+ * lock-free ring.  A background writer drains the ring into large sequential writes
+ * and rotates the output file.  When the ring is full the frame is not captured and
+ * the drop counter is incremented; capture never waits.
+ */
+class PacketCapture
+{
+public:
+  enum Direction {
+    DIRECTION_IN = 1,  //< Received by the router (pcapng epb_flags inbound)
+    DIRECTION_OUT = 2, //< Sent by the router (pcapng epb_flags outbound)
+  };
+
+  struct Config
+  {
+    std::string file;                  //< Output file name, rotated files get a .N suffix
+    uint32_t snaplen = 128;            //< Maximum number of bytes saved from each frame
+    uint32_t sampleRate = 1;           //< Capture one out of sampleRate frames
+    size_t ringSize = 4096;            //< Number of ring slots, rounded up to a power of two
+    uint64_t rotateBytes = 64 << 20;   //< Start a new file after this many bytes (0: never)
+    uint32_t maxFiles = 0;             //< Number of rotated files to cycle through (0: unlimited)
+  };
+
+  explicit
+  PacketCapture(const Config& config);
+
+  ~PacketCapture();
+
+  /**
+   * Set the names of the interfaces, indexed by Interface::index.  Each name
+   * becomes a pcapng interface description block.
+   */
+  void
+  setInterfaces(const std::vector<std::string>& names);
+
+  /**
+   * Copy the frame into the ring, subject to sampling.  Never blocks.
+   */
+  void
+  capture(const uint8_t* data, size_t size, uint32_t ifIndex, Direction direction);
+
+  /**
+   * Number of frames written to the ring
+   */
+  uint64_t
+  getCaptured() const;
+
+  /**
+   * Number of sampled frames that were lost because the ring was full
+   */
+  uint64_t
+  getDropped() const;
+
+  void
+  print(std::ostream& os) const;
+
+private:
+  struct Slot
+  {
+    std::atomic<size_t> sequence;
+    uint64_t timestamp; //< nanoseconds since the epoch
+    uint32_t ifIndex;
+    uint32_t length;
+    uint32_t captured;
+    uint32_t direction;
+  };
+
+  Slot&
+  slotAt(size_t position) const;
+
+  uint8_t*
+  slotData(Slot& slot) const;
+
+  void
+  writer();
+
+  size_t
+  drain();
+
+  void
+  appendPacket(const Slot& slot, const uint8_t* data);
+
+  void
+  appendInterfaces(size_t count);
+
+  void
+  flush();
+
+  bool
+  openFile();
+
+private:
+  Config m_config;
+
+  std::unique_ptr<uint8_t[]> m_ring;
+  size_t m_slotStride;
+  size_t m_mask;
+
+  // producers and the writer touch different cache lines
+  char m_pad0[64];
+  std::atomic<size_t> m_enqueuePos;
+  std::atomic<uint64_t> m_captured;
+  std::atomic<uint64_t> m_dropped;
+  char m_pad1[64];
+  size_t m_dequeuePos;
+  char m_pad2[64];
+
+  mutable std::mutex m_ifMutex;
+  std::vector<std::string> m_ifNames;
+  size_t m_nWrittenIfaces;
+
+  FILE* m_file;
+  uint32_t m_nFiles;
+  uint64_t m_fileBytes;
+  std::vector<uint8_t> m_out;
+
+  std::mutex m_stopMutex;
+  std::condition_variable m_stopCv;
+  bool m_shouldStop;
+  std::thread m_writerThread;
+};
+
+inline uint64_t
+PacketCapture::getCaptured() const
+{
+  return m_captured.load(std::memory_order_relaxed);
+}
+
+inline uint64_t
+PacketCapture::getDropped() const
+{
+  return m_dropped.load(std::memory_order_relaxed);
+}
+
+std::ostream&
+operator<<(std::ostream& os, const PacketCapture& capture);
+
+} // namespace simple_router
+
+#endif // SIMPLE_ROUTER_CORE_CAPTURE_HPP
@@ -0,0 +1,218 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "checksum.hpp"
+
+#include <algorithm>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace simple_router {
+
+/**
+ * Below this size the vector kernels do not pay for their setup
+ */
+const size_t VECTOR_MIN_LEN = 128;
+
+/**
+ * Fold a 64-bit one's complement accumulator to 16 bits and complement it
+ */
+static inline uint16_t
+finish(uint64_t sum)
+{
+  sum = (sum & 0xffffffff) + (sum >> 32);
+  sum = (sum & 0xffffffff) + (sum >> 32);
+  sum = (sum & 0xffff) + (sum >> 16);
+  sum = (sum & 0xffff) + (sum >> 16);
+  sum = (sum & 0xffff) + (sum >> 16);
+  uint16_t result = ~static_cast<uint16_t>(sum);
+  return result ? result : 0xffff;
+}
+
+/**
+ * The trailing odd byte counts as the first byte of a zero-padded word
+ */
+static inline uint64_t
+tail(const uint8_t* data, size_t len)
+{
+  uint64_t sum = 0;
+  for (; len >= 2; data += 2, len -= 2) {
+    uint16_t word;
+    memcpy(&word, data, sizeof(word));
+    sum += word;
+  }
+  if (len > 0) {
+    uint8_t padded[2] = {data[0], 0};
+    uint16_t word;
+    memcpy(&word, padded, sizeof(word));
+    sum += word;
+  }
+  return sum;
+}
+
+/**
+ * The original word-at-a-time implementation, kept as the reference for the others
+ */
+uint16_t
+checksumScalar(const void* data, size_t len)
+{
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  uint32_t sum = 0;
+
+  for (; len >= 2; bytes += 2, len -= 2) {
+    sum += bytes[0] << 8 | bytes[1];
+  }
+  if (len > 0) {
+    sum += bytes[0] << 8;
+  }
+  while (sum > 0xffff) {
+    sum = (sum >> 16) + (sum & 0xffff);
+  }
+  sum = htons(~sum);
+  return sum ? sum : 0xffff;
+}
+
+/**
+ * Sum of the 32-bit halves of 64-bit loads; a 64-bit accumulator cannot overflow
+ * for any packet size
+ */
+static inline uint64_t
+sum64(const uint8_t* data, size_t len)
+{
+  uint64_t sum = 0;
+  for (; len >= 32; data += 32, len -= 32) {
+    uint64_t words[4];
+    memcpy(words, data, sizeof(words));
+    sum += (words[0] & 0xffffffff) + (words[0] >> 32);
+    sum += (words[1] & 0xffffffff) + (words[1] >> 32);
+    sum += (words[2] & 0xffffffff) + (words[2] >> 32);
+    sum += (words[3] & 0xffffffff) + (words[3] >> 32);
+  }
+  for (; len >= 8; data += 8, len -= 8) {
+    uint64_t word;
+    memcpy(&word, data, sizeof(word));
+    sum += (word & 0xffffffff) + (word >> 32);
+  }
+  return sum + tail(data, len);
+}
+
+uint16_t
+checksum64(const void* data, size_t len)
+{
+  return finish(sum64(static_cast<const uint8_t*>(data), len));
+}
+
+#if defined(__x86_64__)
+
+uint16_t
+checksumSse2(const void* data, size_t len)
+{
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  const __m128i zero = _mm_setzero_si128();
+  uint64_t sum = 0;
+
+  while (len >= 16) {
+    // each 32-bit lane takes two 16-bit words per block: flush before it can overflow
+    size_t nBlocks = std::min(len / 16, size_t(32768));
+    __m128i acc = _mm_setzero_si128();
+    for (size_t i = 0; i < nBlocks; ++i, bytes += 16) {
+      __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+      acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(x, zero));
+      acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(x, zero));
+    }
+    len -= nBlocks * 16;
+
+    uint32_t lanes[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    sum += uint64_t(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+  }
+  return finish(sum + sum64(bytes, len));
+}
+
+__attribute__((target("avx2")))
+uint16_t
+checksumAvx2(const void* data, size_t len)
+{
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  const __m256i zero = _mm256_setzero_si256();
+  uint64_t sum = 0;
+
+  while (len >= 32) {
+    size_t nBlocks = std::min(len / 32, size_t(32768));
+    __m256i acc = _mm256_setzero_si256();
+    for (size_t i = 0; i < nBlocks; ++i, bytes += 32) {
+      __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes));
+      acc = _mm256_add_epi32(acc, _mm256_unpacklo_epi16(x, zero));
+      acc = _mm256_add_epi32(acc, _mm256_unpackhi_epi16(x, zero));
+    }
+    len -= nBlocks * 32;
+
+    uint32_t lanes[8];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    for (uint32_t lane : lanes) {
+      sum += lane;
+    }
+  }
+  return finish(sum + sum64(bytes, len));
+}
+
+#endif // __x86_64__
+
+typedef uint16_t (*ChecksumKernel)(const void* data, size_t len);
+
+struct KernelChoice
+{
+  ChecksumKernel kernel;
+  const char* name;
+};
+
+static KernelChoice
+selectKernel()
+{
+#if defined(__x86_64__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return {checksumAvx2, "avx2"};
+  }
+  return {checksumSse2, "sse2"};
+#else
+  return {checksum64, "64bit"};
+#endif
+}
+
+static const KernelChoice&
+getKernel()
+{
+  static const KernelChoice choice = selectKernel();
+  return choice;
+}
+
+uint16_t
+checksum(const void* data, size_t len)
+{
+  if (len < VECTOR_MIN_LEN) {
+    return checksum64(data, len);
+  }
+  return getKernel().kernel(data, len);
+}
+
+const char*
+checksumKernelName()
+{
+  return getKernel().name;
+}
+
+} // namespace simple_router
@@ -0,0 +1,95 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * This header file defines the Internet checksum (RFC 1071) kernels and the
+ * incremental update of RFC 1624.
+ *
+ * All functions work on checksums as they are stored in a packet: the 16-bit value is
+ * read from and written to the header without byte order conversion.  Since the
+ * one's complement sum does not depend on byte order, native loads are used
+ * throughout.  Like the original cksum(), a resulting checksum of 0 is returned as
+ * 0xffff.
+ */
+
+#ifndef SIMPLE_ROUTER_CORE_CHECKSUM_HPP
+#define SIMPLE_ROUTER_CORE_CHECKSUM_HPP
+
+#include "protocol.hpp"
+
+#include <string.h>
+
+namespace simple_router {
+
+/**
+ * Internet checksum of \p len bytes at \p data, using the fastest kernel of the CPU
+ */
+uint16_t
+checksum(const void* data, size_t len);
+
+/**
+ * Name of the kernel checksum() uses, e.g. "avx2"
+ */
+const char*
+checksumKernelName();
+
+/**
+ * The individual kernels; all return the same value as checksum()
+ */
+uint16_t
+checksumScalar(const void* data, size_t len);
+
+uint16_t
+checksum64(const void* data, size_t len);
+
+#if defined(__x86_64__)
+uint16_t
+checksumSse2(const void* data, size_t len);
+
+uint16_t
+checksumAvx2(const void* data, size_t len);
+#endif // __x86_64__
+
+/**
+ * Update checksum \p sum after a 16-bit word of the covered data changed from
+ * \p oldWord to \p newWord (RFC 1624, equation 3)
+ */
+inline uint16_t
+checksumAdjust(uint16_t sum, uint16_t oldWord, uint16_t newWord)
+{
+  uint32_t value = static_cast<uint16_t>(~sum) + static_cast<uint16_t>(~oldWord) + newWord;
+  value = (value & 0xffff) + (value >> 16);
+  value = (value & 0xffff) + (value >> 16);
+  uint16_t result = ~value;
+  return result ? result : 0xffff;
+}
+
+/**
+ * Decrement the TTL of \p ip and update its header checksum incrementally
+ */
+inline void
+decrementTtl(ip_hdr* ip)
+{
+  // TTL shares a 16-bit word of the header with the protocol
+  uint16_t oldWord;
+  memcpy(&oldWord, &ip->ip_ttl, sizeof(oldWord));
+  --ip->ip_ttl;
+  uint16_t newWord;
+  memcpy(&newWord, &ip->ip_ttl, sizeof(newWord));
+
+  ip->ip_sum = checksumAdjust(ip->ip_sum, oldWord, newWord);
+}
+
+} // namespace simple_router
+
+#endif // SIMPLE_ROUTER_CORE_CHECKSUM_HPP
@@ -0,0 +1,96 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * Shared FIB loader: builds the routing table into the shared memory segment that
+ * routers configured with RoutingTable.SharedMemory attach to.  Running it again
+ * publishes a new generation, which the attached routers switch to.
+ */
+
+#include "routing-table.hpp"
+#include "core/shared-fib.hpp"
+
+#include <iostream>
+
+#include <getopt.h>
+
+static void
+usage(const char* program)
+{
+  std::cerr
+    << "Usage: " << program << " [options]\n"
+    << "  -r FILE     routing table (default RTABLE)\n"
+    << "  -n NAME     shared memory segment (default /simple-router-fib)\n"
+    << "  -c          compress the table first (see RoutingTable.Compress)\n"
+    << "  -d          remove the segment instead of publishing\n";
+}
+
+int
+main(int argc, char* argv[])
+{
+  using namespace simple_router;
+
+  std::string rtFile = "RTABLE";
+  std::string name = "/simple-router-fib";
+  bool isCompressed = false;
+  bool isRemove = false;
+  int option;
+  while ((option = getopt(argc, argv, "r:n:cdh")) != -1) {
+    switch (option) {
+    case 'r':
+      rtFile = optarg;
+      break;
+    case 'n':
+      name = optarg;
+      break;
+    case 'c':
+      isCompressed = true;
+      break;
+    case 'd':
+      isRemove = true;
+      break;
+    default:
+      usage(argv[0]);
+      return option == 'h' ? 0 : 2;
+    }
+  }
+
+  if (isRemove) {
+    SharedFib::remove(name);
+    return 0;
+  }
+
+  RoutingTable table;
+  if (!table.load(rtFile)) {
+    std::cerr << "ERROR: Cannot load routing table from `" << rtFile << "`" << std::endl;
+    return 1;
+  }
+  size_t nLoaded = table.size();
+  if (isCompressed && !table.compress()) {
+    std::cerr << "WARNING: Routing table has non-contiguous masks, not compressing it" << std::endl;
+  }
+
+  try {
+    uint64_t generation = table.publishShared(name);
+    SharedFib published(name);
+    std::cout << "Published `" << name << "` generation " << generation << ": "
+              << nLoaded << " routes loaded, " << published.getRoutes().size() << " published, "
+              << published.getIpv6Routes().size() << " IPv6, "
+              << published.getSegmentSize() << " bytes" << std::endl;
+  }
+  catch (const std::runtime_error& e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,298 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "fib.hpp"
+
+#include <algorithm>
+#include <arpa/inet.h>
+
+namespace simple_router {
+
+int
+maskToLength(uint32_t mask)
+{
+  uint32_t host = ntohl(mask);
+  int length = __builtin_popcount(host);
+  if (length != 0 && host != ~0u << (32 - length)) {
+    return -1;
+  }
+  return length;
+}
+
+namespace {
+
+/**
+ * Binary trie used by the three ORTC passes
+ */
+class OrtcTrie
+{
+public:
+  OrtcTrie()
+    : m_nodes(1)
+  {
+  }
+
+  void
+  insert(const FibPrefix& prefix)
+  {
+    uint32_t node = 0;
+    for (uint8_t depth = 0; depth < prefix.length; ++depth) {
+      int bit = (prefix.prefix >> (31 - depth)) & 1;
+      if (m_nodes[node].child[bit] == NONE) {
+        m_nodes[node].child[bit] = m_nodes.size();
+        m_nodes.push_back(Node());
+      }
+      node = m_nodes[node].child[bit];
+    }
+    if (m_nodes[node].value == 0) {
+      m_nodes[node].value = prefix.value;
+    }
+  }
+
+  /**
+   * Passes 1 and 2: for every node, the values that could serve its whole subtree with
+   * the fewest prefixes.  \p inherited is the value of the closest prefix above.
+   */
+  void
+  computeSets(uint32_t node, uint32_t inherited)
+  {
+    if (m_sets.size() != m_nodes.size()) {
+      m_sets.resize(m_nodes.size());
+    }
+
+    uint32_t own = m_nodes[node].value != 0 ? m_nodes[node].value : inherited;
+    if (isLeaf(node)) {
+      m_sets[node] = own;
+      return;
+    }
+
+    std::vector<uint32_t> sets[2];
+    for (int bit = 0; bit < 2; ++bit) {
+      uint32_t child = m_nodes[node].child[bit];
+      if (child == NONE) {
+        // Pass 1: a missing child is a leaf holding the value inherited from above,
+        // which makes the trie complete without materializing those nodes
+        sets[bit] = {own};
+      }
+      else {
+        computeSets(child, own);
+        loadSet(child, sets[bit]);
+      }
+    }
+
+    std::vector<uint32_t> result;
+    // sets holding "no match" (0) are only ever united, so that 0 wins all the way up
+    // and an uncovered address never ends up below a prefix that would need a hole
+    if (sets[0][0] != 0 && sets[1][0] != 0) {
+      std::set_intersection(sets[0].begin(), sets[0].end(), sets[1].begin(), sets[1].end(),
+                            std::back_inserter(result));
+    }
+    if (result.empty()) {
+      std::set_union(sets[0].begin(), sets[0].end(), sets[1].begin(), sets[1].end(),
+                     std::back_inserter(result));
+    }
+    storeSet(node, result);
+  }
+
+  /**
+   * Pass 3: emit a prefix wherever the value chosen above does not serve the subtree
+   */
+  void
+  assign(uint32_t node, uint8_t depth, uint32_t prefix, uint32_t chosenAbove, uint32_t inherited,
+         std::vector<FibPrefix>& out)
+  {
+    uint32_t own = m_nodes[node].value != 0 ? m_nodes[node].value : inherited;
+
+    uint32_t chosen = chosenAbove;
+    if (!(m_sets[node] & MULTI_FLAG)) {
+      chosen = m_sets[node];
+    }
+    else {
+      const std::vector<uint32_t>& set = m_multiSets[m_sets[node] & ~MULTI_FLAG];
+      if (!std::binary_search(set.begin(), set.end(), chosenAbove)) {
+        chosen = set.front();
+      }
+    }
+    if (chosen != chosenAbove) {
+      out.push_back({prefix, depth, chosen});
+    }
+    if (isLeaf(node)) {
+      return;
+    }
+
+    for (int bit = 0; bit < 2; ++bit) {
+      uint32_t childPrefix = prefix | (uint32_t(bit) << (31 - depth));
+      uint32_t child = m_nodes[node].child[bit];
+      if (child != NONE) {
+        assign(child, depth + 1, childPrefix, chosen, own, out);
+      }
+      else if (own != chosen) {
+        out.push_back({childPrefix, static_cast<uint8_t>(depth + 1), own});
+      }
+    }
+  }
+
+private:
+  bool
+  isLeaf(uint32_t node) const
+  {
+    return m_nodes[node].child[0] == NONE && m_nodes[node].child[1] == NONE;
+  }
+
+  // most sets hold one value, which is stored inline
+
+  void
+  storeSet(uint32_t node, std::vector<uint32_t>& set)
+  {
+    if (set.size() == 1) {
+      m_sets[node] = set[0];
+      return;
+    }
+    m_sets[node] = MULTI_FLAG | m_multiSets.size();
+    m_multiSets.push_back(std::move(set));
+  }
+
+  void
+  loadSet(uint32_t node, std::vector<uint32_t>& set) const
+  {
+    if (m_sets[node] & MULTI_FLAG) {
+      set = m_multiSets[m_sets[node] & ~MULTI_FLAG];
+    }
+    else {
+      set.assign(1, m_sets[node]);
+    }
+  }
+
+private:
+  static const uint32_t NONE = ~0u;
+  static const uint32_t MULTI_FLAG = 0x80000000;
+
+  struct Node
+  {
+    uint32_t child[2] = {NONE, NONE};
+    uint32_t value = 0;
+  };
+
+  std::vector<Node> m_nodes;
+  std::vector<uint32_t> m_sets; //< value, or MULTI_FLAG and index into m_multiSets
+  std::vector<std::vector<uint32_t>> m_multiSets;
+};
+
+} // namespace
+
+std::vector<FibPrefix>
+compressPrefixes(const std::vector<FibPrefix>& prefixes)
+{
+  OrtcTrie trie;
+  for (const auto& prefix : prefixes) {
+    if (prefix.value != 0) {
+      trie.insert(prefix);
+    }
+  }
+
+  trie.computeSets(0, 0);
+  std::vector<FibPrefix> compressed;
+  trie.assign(0, 0, 0, 0, 0, compressed);
+  return compressed;
+}
+
+const uint32_t FibView::CHUNK_FLAG;
+const size_t FibView::ROOT_SIZE;
+
+Fib::Fib()
+  : m_root(FibView::ROOT_SIZE, 0)
+{
+}
+
+uint32_t
+Fib::addChunk(uint32_t entry)
+{
+  uint32_t index = m_chunks.size() >> 8;
+  m_chunks.resize(m_chunks.size() + 256, entry);
+  return index;
+}
+
+void
+Fib::build(const std::vector<FibPrefix>& prefixes)
+{
+  std::fill(m_root.begin(), m_root.end(), 0);
+  m_chunks.clear();
+
+  // shorter prefixes first, so longer ones overwrite the entries they cover; among
+  // equal lengths the first prefix is written last
+  std::vector<uint32_t> order(prefixes.size());
+  for (uint32_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), [&prefixes] (uint32_t a, uint32_t b) {
+      if (prefixes[a].length != prefixes[b].length) {
+        return prefixes[a].length < prefixes[b].length;
+      }
+      return a > b;
+    });
+
+  for (uint32_t i : order) {
+    uint32_t prefix = prefixes[i].prefix;
+    uint8_t length = prefixes[i].length;
+    uint32_t value = prefixes[i].value;
+
+    if (length <= 16) {
+      std::fill_n(m_root.begin() + (prefix >> 16), 1 << (16 - length), value);
+      continue;
+    }
+
+    if (!(m_root[prefix >> 16] & CHUNK_FLAG)) {
+      m_root[prefix >> 16] = CHUNK_FLAG | addChunk(m_root[prefix >> 16]);
+    }
+    size_t level2 = (m_root[prefix >> 16] & ~CHUNK_FLAG) << 8;
+    if (length <= 24) {
+      std::fill_n(m_chunks.begin() + level2 + ((prefix >> 8) & 0xff), 1 << (24 - length), value);
+      continue;
+    }
+
+    size_t entry = level2 + ((prefix >> 8) & 0xff);
+    if (!(m_chunks[entry] & CHUNK_FLAG)) {
+      uint32_t chunk = addChunk(m_chunks[entry]);
+      m_chunks[entry] = CHUNK_FLAG | chunk;
+    }
+    size_t level3 = (m_chunks[entry] & ~CHUNK_FLAG) << 8;
+    std::fill_n(m_chunks.begin() + level3 + (prefix & 0xff), 1 << (32 - length), value);
+  }
+}
+
+void
+FibView::lookupBatch(const uint32_t* addresses, size_t count, uint32_t* values) const
+{
+  for (size_t i = 0; i < count; ++i) {
+    values[i] = root[addresses[i] >> 16];
+    if (values[i] & CHUNK_FLAG) {
+      __builtin_prefetch(&chunks[((values[i] & ~CHUNK_FLAG) << 8) | ((addresses[i] >> 8) & 0xff)]);
+    }
+  }
+  for (size_t i = 0; i < count; ++i) {
+    if (values[i] & CHUNK_FLAG) {
+      values[i] = chunks[((values[i] & ~CHUNK_FLAG) << 8) | ((addresses[i] >> 8) & 0xff)];
+      if (values[i] & CHUNK_FLAG) {
+        __builtin_prefetch(&chunks[((values[i] & ~CHUNK_FLAG) << 8) | (addresses[i] & 0xff)]);
+      }
+    }
+  }
+  for (size_t i = 0; i < count; ++i) {
+    if (values[i] & CHUNK_FLAG) {
+      values[i] = chunks[((values[i] & ~CHUNK_FLAG) << 8) | (addresses[i] & 0xff)];
+    }
+  }
+}
+
+} // namespace simple_router
@@ -0,0 +1,173 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * This header file defines the compiled IPv4 forwarding table and the prefix
+ * compression applied before it is built.
+ */
+
+#ifndef SIMPLE_ROUTER_CORE_FIB_HPP
+#define SIMPLE_ROUTER_CORE_FIB_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace simple_router {
+
+/**
+ * IPv4 prefix mapped to an opaque value (a route or next hop index)
+ */
+struct FibPrefix
+{
+  uint32_t prefix; //< host byte order, bits past length are zero
+  uint8_t length;
+  uint32_t value;
+};
+
+/**
+ * Number of leading one bits of the network byte order \p mask, or -1 if the
+ * mask is not contiguous
+ */
+int
+maskToLength(uint32_t mask);
+
+/**
+ * Smallest set of prefixes that maps every address to the same value as
+ * \p prefixes under longest-prefix match (Optimal Routing Table Constructor,
+ * Draves et al., 1999)
+ *
+ * Value 0 is reserved for "no match".  Addresses that \p prefixes do not cover
+ * remain uncovered, so the result never needs a prefix that maps to 0.  Of several
+ * equal-length prefixes, the first one in \p prefixes wins, as it does in
+ * RoutingTable::lookup().
+ */
+std::vector<FibPrefix>
+compressPrefixes(const std::vector<FibPrefix>& prefixes);
+
+/**
+ * Lookup side of a Fib: its tables, wherever they are stored (see SharedFib)
+ */
+struct FibView
+{
+  static const uint32_t CHUNK_FLAG = 0x80000000;
+  static const size_t ROOT_SIZE = 1 << 16;
+
+  const uint32_t* root = nullptr; //< ROOT_SIZE entries
+  const uint32_t* chunks = nullptr;
+  size_t nChunkEntries = 0;       //< 256 per chunk
+
+  /**
+   * @return value of the longest prefix matching \p address (host byte order),
+   *         or 0 if none matches
+   */
+  uint32_t
+  lookup(uint32_t address) const
+  {
+    uint32_t entry = root[address >> 16];
+    if (entry & CHUNK_FLAG) {
+      entry = chunks[((entry & ~CHUNK_FLAG) << 8) | ((address >> 8) & 0xff)];
+      if (entry & CHUNK_FLAG) {
+        entry = chunks[((entry & ~CHUNK_FLAG) << 8) | (address & 0xff)];
+      }
+    }
+    return entry;
+  }
+
+  /**
+   * lookup() of \p count addresses at once: each level is resolved for the whole
+   * batch before the next, with the next level prefetched, so the cache misses of
+   * different addresses overlap instead of queueing behind each other
+   */
+  void
+  lookupBatch(const uint32_t* addresses, size_t count, uint32_t* values) const;
+};
+
+/**
+ * Multibit trie with 16, 8 and 8-bit strides (DIR-16-8-8)
+ *
+ * The first 16 bits index a table of 65536 entries; an entry is either a value or
+ * a reference to a chunk of 256 entries indexed by the next 8 bits, and the same
+ * once more for the last 8 bits.  A lookup is at most three dependent loads;
+ * prefixes are expanded into the entries they cover when the table is built.
+ */
+class Fib
+{
+public:
+  Fib();
+
+  /**
+   * Replace the contents with \p prefixes.  Of several equal-length prefixes, the
+   * first one wins.
+   */
+  void
+  build(const std::vector<FibPrefix>& prefixes);
+
+  /**
+   * @return value of the longest prefix matching \p address (host byte order),
+   *         or 0 if none matches
+   */
+  uint32_t
+  lookup(uint32_t address) const
+  {
+    return getView().lookup(address);
+  }
+
+  /**
+   * See FibView::lookupBatch
+   */
+  void
+  lookupBatch(const uint32_t* addresses, size_t count, uint32_t* values) const
+  {
+    getView().lookupBatch(addresses, count, values);
+  }
+
+  /**
+   * Tables of the trie, valid until the next build()
+   */
+  FibView
+  getView() const
+  {
+    FibView view;
+    view.root = m_root.data();
+    view.chunks = m_chunks.data();
+    view.nChunkEntries = m_chunks.size();
+    return view;
+  }
+
+  /**
+   * Memory used by the tables
+   */
+  size_t
+  getMemoryUsage() const
+  {
+    return (m_root.size() + m_chunks.size()) * sizeof(uint32_t);
+  }
+
+private:
+  /**
+   * Index of a chunk pre-filled with \p entry
+   */
+  uint32_t
+  addChunk(uint32_t entry);
+
+private:
+  static const uint32_t CHUNK_FLAG = FibView::CHUNK_FLAG;
+
+  std::vector<uint32_t> m_root;
+  std::vector<uint32_t> m_chunks;
+};
+
+} // namespace simple_router
+
+#endif // SIMPLE_ROUTER_CORE_FIB_HPP
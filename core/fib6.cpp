@@ -0,0 +1,162 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "fib6.hpp"
+
+#include <algorithm>
+#include <map>
+
+namespace simple_router {
+
+const uint8_t Fib6::EMPTY_LENGTH;
+const uint8_t Fib6::FLAG_PREFIX;
+const uint8_t Fib6::FLAG_MARKER;
+
+Fib6::Fib6()
+{
+  build({});
+}
+
+Fib6::Entry&
+Fib6::insert(const Ipv6Address& masked, uint8_t length)
+{
+  for (size_t i = hash(masked.hi, masked.lo, length) & m_mask; ; i = (i + 1) & m_mask) {
+    Entry& entry = m_entries[i];
+    if (entry.length == EMPTY_LENGTH) {
+      entry.hi = masked.hi;
+      entry.lo = masked.lo;
+      entry.length = length;
+      return entry;
+    }
+    if (entry.length == length && entry.hi == masked.hi && entry.lo == masked.lo) {
+      return entry;
+    }
+  }
+}
+
+int
+Fib6::buildTree(const std::vector<std::pair<uint8_t, size_t>>& lengths, size_t first, size_t last)
+{
+  if (first >= last) {
+    return -1;
+  }
+
+  // the pivot splits the prefixes of the range as evenly as possible, so lengths
+  // holding many prefixes end up near the root
+  size_t total = 0;
+  for (size_t i = first; i < last; ++i) {
+    total += lengths[i].second;
+  }
+  size_t pivot = first;
+  size_t below = 0;
+  size_t bestImbalance = total + 1;
+  for (size_t i = first; i < last; ++i) {
+    size_t above = total - below - lengths[i].second;
+    size_t imbalance = below > above ? below - above : above - below;
+    if (imbalance < bestImbalance) {
+      bestImbalance = imbalance;
+      pivot = i;
+    }
+    below += lengths[i].second;
+  }
+
+  const Ipv6Address ones = {~uint64_t(0), ~uint64_t(0)};
+  Ipv6Address mask = ones.mask(lengths[pivot].first);
+  int index = m_nodes.size();
+  m_nodes.push_back({mask.hi, mask.lo, lengths[pivot].first, -1, -1});
+  int left = buildTree(lengths, first, pivot);
+  int right = buildTree(lengths, pivot + 1, last);
+  m_nodes[index].left = left;
+  m_nodes[index].right = right;
+  return index;
+}
+
+void
+Fib6::build(const std::vector<Fib6Prefix>& prefixes)
+{
+  std::map<uint8_t, size_t> counts;
+  for (const auto& prefix : prefixes) {
+    ++counts[std::min<uint8_t>(prefix.length, 128)];
+  }
+  std::vector<std::pair<uint8_t, size_t>> lengths(counts.begin(), counts.end());
+
+  m_nodes.clear();
+  m_root = buildTree(lengths, 0, lengths.size());
+
+  // every prefix, and a marker wherever its search goes on to longer lengths
+  struct Key
+  {
+    Ipv6Address bits;
+    uint8_t length;
+    uint8_t flag;
+    uint32_t value;
+  };
+  std::vector<Key> keys;
+  for (const auto& prefix : prefixes) {
+    uint8_t length = std::min<uint8_t>(prefix.length, 128);
+    for (int node = m_root; node >= 0; ) {
+      const Node& n = m_nodes[node];
+      if (n.length == length) {
+        break;
+      }
+      if (n.length < length) {
+        keys.push_back({prefix.prefix.mask(n.length), n.length, FLAG_MARKER, 0});
+        node = n.right;
+      }
+      else {
+        node = n.left;
+      }
+    }
+    keys.push_back({prefix.prefix.mask(length), length, FLAG_PREFIX, prefix.value});
+  }
+
+  size_t capacity = 16;
+  while (capacity < keys.size() * 2) {
+    capacity <<= 1;
+  }
+  Entry empty = {0, 0, 0, EMPTY_LENGTH, 0, {0, 0}};
+  m_entries.assign(capacity, empty);
+  m_mask = capacity - 1;
+
+  for (const auto& key : keys) {
+    Entry& entry = insert(key.bits, key.length);
+    if (key.flag == FLAG_PREFIX && !(entry.flags & FLAG_PREFIX)) {
+      entry.value = key.value;
+    }
+    entry.flags |= key.flag;
+  }
+
+  // a marker that is not a prefix itself stands for its longest matching prefix
+  for (auto& entry : m_entries) {
+    if (entry.length == EMPTY_LENGTH || (entry.flags & FLAG_PREFIX)) {
+      continue;
+    }
+    Ipv6Address bits;
+    bits.hi = entry.hi;
+    bits.lo = entry.lo;
+    for (auto length = lengths.rbegin(); length != lengths.rend(); ++length) {
+      if (length->first >= entry.length) {
+        continue;
+      }
+      const Entry* shorter = find(bits.mask(length->first), length->first);
+      if (shorter != nullptr && (shorter->flags & FLAG_PREFIX)) {
+        entry.value = shorter->value;
+        break;
+      }
+    }
+  }
+}
+
+} // namespace simple_router
@@ -0,0 +1,165 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * This header file defines the compiled IPv6 forwarding table.
+ */
+
+#ifndef SIMPLE_ROUTER_CORE_FIB6_HPP
+#define SIMPLE_ROUTER_CORE_FIB6_HPP
+
+#include "ipv6.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace simple_router {
+
+/**
+ * IPv6 prefix mapped to an opaque value (a route index)
+ */
+struct Fib6Prefix
+{
+  Ipv6Address prefix; //< bits past length are ignored
+  uint8_t length;
+  uint32_t value;
+};
+
+/**
+ * Binary search on prefix lengths (Waldvogel et al., 1997)
+ *
+ * All prefixes live in one open-addressing hash table keyed by (bits, length).  A
+ * lookup walks a binary search tree over the prefix lengths in use: a hit at a
+ * length continues with the longer lengths, a miss with the shorter ones.  Prefixes
+ * leave markers at the shorter lengths their search passes through, and each marker
+ * carries its own best matching prefix, so a hit never has to backtrack.
+ *
+ * IPv6 tables are dominated by /48 and /64 (and /32 allocations), so the tree is
+ * weighted by the number of prefixes per length rather than balanced: the common
+ * lengths sit near the root, and a hit on a prefix without longer prefixes below it
+ * ends the search at once.  A lookup takes at most one probe per tree level, about
+ * log2 of the number of distinct lengths.
+ */
+class Fib6
+{
+public:
+  Fib6();
+
+  /**
+   * Replace the contents with \p prefixes.  Of several equal prefixes, the first one
+   * wins.
+   */
+  void
+  build(const std::vector<Fib6Prefix>& prefixes);
+
+  /**
+   * @return value of the longest prefix matching \p address, or 0 if none matches
+   */
+  uint32_t
+  lookup(const Ipv6Address& address) const;
+
+  /**
+   * Memory used by the tables
+   */
+  size_t
+  getMemoryUsage() const
+  {
+    return m_entries.size() * sizeof(Entry) + m_nodes.size() * sizeof(Node);
+  }
+
+private:
+  struct Entry
+  {
+    uint64_t hi;
+    uint64_t lo;
+    uint32_t value;  //< own value of a prefix, best matching prefix of a marker
+    uint8_t length;  //< EMPTY_LENGTH for a free slot
+    uint8_t flags;
+    uint8_t pad[2];
+  };
+
+  struct Node
+  {
+    uint64_t maskHi; //< the mask of length, so that lookups do not compute it
+    uint64_t maskLo;
+    uint8_t length;
+    int16_t left;    //< index in m_nodes, or -1
+    int16_t right;
+  };
+
+  static const uint8_t EMPTY_LENGTH = 0xff;
+  static const uint8_t FLAG_PREFIX = 0x01;
+  static const uint8_t FLAG_MARKER = 0x02;
+
+  static size_t
+  hash(uint64_t hi, uint64_t lo, uint8_t length)
+  {
+    uint64_t h = (hi * 0x9e3779b97f4a7c15) ^ (lo * 0xc2b2ae3d27d4eb4f) ^ length;
+    return h ^ (h >> 31);
+  }
+
+  const Entry*
+  find(const Ipv6Address& masked, uint8_t length) const
+  {
+    for (size_t i = hash(masked.hi, masked.lo, length) & m_mask; ; i = (i + 1) & m_mask) {
+      const Entry& entry = m_entries[i];
+      if (entry.length == length && entry.hi == masked.hi && entry.lo == masked.lo) {
+        return &entry;
+      }
+      if (entry.length == EMPTY_LENGTH) {
+        return nullptr;
+      }
+    }
+  }
+
+  Entry&
+  insert(const Ipv6Address& masked, uint8_t length);
+
+  int
+  buildTree(const std::vector<std::pair<uint8_t, size_t>>& lengths, size_t first, size_t last);
+
+private:
+  std::vector<Entry> m_entries;
+  size_t m_mask;
+  std::vector<Node> m_nodes;
+  int m_root;
+};
+
+inline uint32_t
+Fib6::lookup(const Ipv6Address& address) const
+{
+  uint32_t best = 0;
+  int node = m_root;
+  while (node >= 0) {
+    const Node& n = m_nodes[node];
+    Ipv6Address masked;
+    masked.hi = address.hi & n.maskHi;
+    masked.lo = address.lo & n.maskLo;
+    const Entry* entry = find(masked, n.length);
+    if (entry == nullptr) {
+      node = n.left;
+      continue;
+    }
+    best = entry->value;
+    if (!(entry->flags & FLAG_MARKER)) {
+      break;
+    }
+    node = n.right;
+  }
+  return best;
+}
+
+} // namespace simple_router
+
+#endif // SIMPLE_ROUTER_CORE_FIB6_HPP
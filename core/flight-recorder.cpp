@@ -0,0 +1,257 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "flight-recorder.hpp"
+#include "utils.hpp"
+#include "logger.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+
+#include <signal.h>
+#include <stdlib.h>
+#include <time.h>
+
+namespace simple_router {
+
+static_assert(sizeof(FlightRecord) == 64, "FlightRecord must fill one cache line");
+
+static volatile sig_atomic_t g_isDumpRequested = 0;
+
+static void
+requestDump(int)
+{
+  g_isDumpRequested = 1;
+}
+
+const char*
+flightVerdictToString(uint8_t verdict)
+{
+  if (verdict < N_DROP_REASONS) {
+    return dropReasonToString(static_cast<DropReason>(verdict));
+  }
+  switch (verdict) {
+  case VERDICT_FORWARDED:
+    return "forwarded";
+  case VERDICT_ARP_PENDING:
+    return "arp-pending";
+  case VERDICT_LOCAL:
+    return "local";
+  default:
+    return "none";
+  }
+}
+
+FlightRecorder::FlightRecorder()
+  : m_sampleRate(Config().sampleRate)
+  , m_ringSize(Config().ringSize)
+  , m_rings([this] { return newRing(); }, &FlightRecorder::deleteRing)
+  , m_shouldStop(false)
+{
+}
+
+FlightRecorder::~FlightRecorder()
+{
+  if (m_dumpThread.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(m_stopMutex);
+      m_shouldStop = true;
+    }
+    m_stopCv.notify_one();
+    m_dumpThread.join();
+  }
+}
+
+void
+FlightRecorder::configure(const Config& config)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  size_t ringSize = 1;
+  while (ringSize < config.ringSize) {
+    ringSize <<= 1;
+  }
+  m_ringSize = ringSize;
+  m_sampleRate = config.sampleRate;
+}
+
+FlightRecorder::Ring*
+FlightRecorder::newRing()
+{
+  size_t ringSize;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ringSize = m_ringSize;
+  }
+
+  void* memory = nullptr;
+  if (posix_memalign(&memory, 64, ringSize * sizeof(FlightRecord)) != 0) {
+    throw std::bad_alloc();
+  }
+  Ring* ring = new Ring;
+  ring->head = 0;
+  ring->mask = ringSize - 1;
+  ring->sampleCount = 0;
+  ring->current = nullptr;
+  ring->suspended = nullptr;
+  ring->records = static_cast<FlightRecord*>(memory);
+  std::fill(ring->records, ring->records + ringSize, FlightRecord());
+  return ring;
+}
+
+void
+FlightRecorder::deleteRing(Ring* ring)
+{
+  free(ring->records);
+  delete ring;
+}
+
+std::vector<FlightRecord>
+FlightRecorder::snapshot() const
+{
+  std::vector<FlightRecord> records;
+  m_rings.forEach([&records] (const Ring& ring) {
+    uint64_t size = ring.mask + 1;
+    uint64_t head = ring.head.load(std::memory_order_acquire);
+    uint64_t first = head > size ? head - size : 0;
+
+    size_t offset = records.size();
+    for (uint64_t i = first; i < head; ++i) {
+      records.push_back(ring.records[i & ring.mask]);
+    }
+
+    // the writer may have moved on while we copied: its current slot and everything
+    // it published since are overwritten, so only keep what is still older than that
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t headAfter = ring.head.load(std::memory_order_relaxed);
+    uint64_t firstValid = headAfter + 1 > size ? headAfter + 1 - size : 0;
+    if (firstValid > first) {
+      size_t nOverwritten = std::min(firstValid - first, head - first);
+      records.erase(records.begin() + offset, records.begin() + offset + nOverwritten);
+    }
+  });
+
+  std::sort(records.begin(), records.end(), [] (const FlightRecord& a, const FlightRecord& b) {
+      return a.timestamp < b.timestamp;
+    });
+  return records;
+}
+
+void
+FlightRecorder::print(std::ostream& os, size_t maxRecords) const
+{
+  std::vector<FlightRecord> records = snapshot();
+  size_t first = maxRecords != 0 && records.size() > maxRecords ? records.size() - maxRecords : 0;
+
+  double cyclesPerNs = getCyclesPerNanosecond();
+  uint64_t nowCycles = readCycles();
+  timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+  double nowSec = now.tv_sec + now.tv_nsec / 1e9;
+
+  os << "\nTime             If Type  Source                Destination           Proto TTL  Length"
+     << "  Verdict            Stage end (us)\n";
+  for (size_t i = first; i < records.size(); ++i) {
+    const FlightRecord& record = records[i];
+
+    double timeSec = nowSec - (nowCycles - record.timestamp) / cyclesPerNs / 1e9;
+    time_t seconds = static_cast<time_t>(timeSec);
+    tm local;
+    localtime_r(&seconds, &local);
+    char timeStr[32];
+    snprintf(timeStr, sizeof(timeStr), "%02d:%02d:%02d.%06d", local.tm_hour, local.tm_min, local.tm_sec,
+             static_cast<int>((timeSec - seconds) * 1e6));
+
+    std::string type = record.etherType == ethertype_ip ? "ip" :
+                       record.etherType == ethertype_ipv6 ? "ipv6" :
+                       record.etherType == ethertype_arp ? "arp" : "-";
+    bool isIpv6 = record.etherType == ethertype_ipv6;
+    std::string src = isIpv6 ? "-" : ipToString(record.src);
+    std::string dst = isIpv6 ? "-" : ipToString(record.dst);
+    if (record.srcPort != 0 || record.dstPort != 0) {
+      src += ":" + std::to_string(ntohs(record.srcPort));
+      dst += ":" + std::to_string(ntohs(record.dstPort));
+    }
+
+    os << std::left << std::setw(17) << timeStr << std::right << std::setw(2) << int(record.ifIndex)
+       << " " << std::left << std::setw(5) << type << std::setw(22) << src << std::setw(22) << dst
+       << std::right << std::setw(5) << int(record.proto) << std::setw(4) << int(record.ttl)
+       << std::setw(8) << record.length << "  " << std::left << std::setw(19)
+       << flightVerdictToString(record.verdict) << std::right;
+    for (size_t stage = 0; stage < N_PIPELINE_STAGES; ++stage) {
+      if (record.stageEnd[stage] != 0) {
+        os << pipelineStageToString(static_cast<PipelineStage>(stage)) << "=" << std::fixed
+           << std::setprecision(2) << record.stageEnd[stage] / cyclesPerNs / 1e3 << " ";
+      }
+    }
+    os << "\n";
+  }
+  os.unsetf(std::ios::floatfield);
+  os << std::endl;
+}
+
+void
+FlightRecorder::enableSignalDump(const std::string& file)
+{
+  if (m_dumpThread.joinable()) {
+    return;
+  }
+  m_dumpFile = file;
+
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = &requestDump;
+  sigemptyset(&action.sa_mask);
+  action.sa_flags = SA_RESTART;
+  sigaction(SIGUSR2, &action, nullptr);
+
+  m_dumpThread = std::thread(std::bind(&FlightRecorder::runSignalDump, this));
+}
+
+void
+FlightRecorder::runSignalDump()
+{
+  // the signal handler can only set a flag, so it is still polled
+  std::unique_lock<std::mutex> lock(m_stopMutex);
+  while (!m_shouldStop) {
+    m_stopCv.wait_for(lock, std::chrono::milliseconds(100));
+    if (m_shouldStop || !g_isDumpRequested) {
+      continue;
+    }
+    g_isDumpRequested = 0;
+    lock.unlock();
+
+    std::ofstream os(m_dumpFile.c_str(), std::ios::app);
+    if (!os) {
+      SR_LOG_WARN("Cannot open flight recorder dump file `" << m_dumpFile << "`");
+    }
+    else {
+      print(os);
+      SR_LOG_INFO("Flight recorder dumped to `" << m_dumpFile << "`");
+    }
+    lock.lock();
+  }
+}
+
+std::ostream&
+operator<<(std::ostream& os, const FlightRecorder& recorder)
+{
+  recorder.print(os);
+  return os;
+}
+
+} // namespace simple_router
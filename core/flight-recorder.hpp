@@ -0,0 +1,324 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * This header file defines the always-on flight recorder, which keeps the last
+ * packets of every forwarding thread for post-mortem inspection.
+ */
+
+#ifndef SIMPLE_ROUTER_CORE_FLIGHT_RECORDER_HPP
+#define SIMPLE_ROUTER_CORE_FLIGHT_RECORDER_HPP
+
+#include "protocol.hpp"
+#include "latency.hpp"
+#include "stats.hpp"
+#include "thread-blocks.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <ostream>
+#include <thread>
+
+namespace simple_router {
+
+/**
+ * What happened to a recorded packet.  Values below N_DROP_REASONS are the
+ * DropReason of a dropped packet.
+ */
+enum FlightVerdict {
+  VERDICT_FORWARDED = 0x80,   //< Sent towards the next hop
+  VERDICT_ARP_PENDING = 0x81, //< Queued until the next hop answers ARP
+  VERDICT_LOCAL = 0x82,       //< Consumed or answered by the router itself
+  VERDICT_NONE = 0xff         //< Still in progress, or no verdict was given
+};
+
+const char*
+flightVerdictToString(uint8_t verdict);
+
+/**
+ * Record of one packet, one cache line
+ */
+struct FlightRecord
+{
+  uint64_t timestamp;                   //< readCycles() when the packet was received
+  uint32_t stageEnd[N_PIPELINE_STAGES]; //< cycles from timestamp to the end of each stage, 0 if not reached
+  uint32_t src;                         //< IPv4 source (ARP sender), network byte order; 0 for IPv6
+  uint32_t dst;                         //< IPv4 destination (ARP target), network byte order; 0 for IPv6
+  uint16_t srcPort;                     //< TCP/UDP ports, network byte order
+  uint16_t dstPort;
+  uint16_t etherType;
+  uint16_t length;                      //< frame length
+  uint8_t ifIndex;
+  uint8_t proto;                        //< IP protocol, or ARP operation
+  uint8_t ttl;
+  uint8_t verdict;                      //< FlightVerdict or DropReason
+  uint8_t pad[64 - 28 - 4 * N_PIPELINE_STAGES];
+};
+
+/**
+ * Always-on packet flight recorder
+ *
+ * Every sampled packet gets a FlightRecord in a ring owned by the thread that handles
+ * it: key header fields at begin(), the time each pipeline stage ends at mark(), the
+ * verdict, and end() publishes it.  Writers never lock or wait and only ever touch
+ * their own ring, so an unsampled packet costs a thread-local check and a sampled
+ * one a cache line of stores and a cycle counter read per stage.  Readers copy the
+ * rings and discard the records that were overwritten meanwhile.
+ */
+class FlightRecorder
+{
+public:
+  struct Config
+  {
+    uint32_t sampleRate = 64; //< Record one out of sampleRate packets (0: none)
+    size_t ringSize = 4096;   //< Records per thread, rounded up to a power of two
+  };
+
+  FlightRecorder();
+
+  ~FlightRecorder();
+
+  /**
+   * Change the configuration.  A new ring size only applies to threads that have not
+   * recorded yet.
+   */
+  void
+  configure(const Config& config);
+
+  /**
+   * Start the record of the frame received on \p ifIndex, if it is sampled
+   *
+   * @return whether the frame is sampled
+   */
+  bool
+  begin(uint32_t ifIndex, const uint8_t* frame, size_t size);
+
+  /**
+   * Note the end of \p stage in the current record
+   */
+  void
+  mark(PipelineStage stage);
+
+  /**
+   * Set the verdict of the current record, unless it already has one
+   */
+  void
+  setVerdict(uint8_t verdict);
+
+  /**
+   * Publish the current record
+   */
+  void
+  end();
+
+  /**
+   * Set the current record aside, so that stages marked until resume() are not its own
+   */
+  void
+  suspend();
+
+  /**
+   * Continue the record set aside by suspend(), its stage times counting from now
+   */
+  void
+  resume();
+
+  /**
+   * Copy of the recorded packets of all threads, oldest first
+   */
+  std::vector<FlightRecord>
+  snapshot() const;
+
+  /**
+   * Print the last \p maxRecords recorded packets (all if 0), oldest first
+   */
+  void
+  print(std::ostream& os, size_t maxRecords = 0) const;
+
+  /**
+   * Append all recorded packets to \p file whenever the process gets SIGUSR2
+   */
+  void
+  enableSignalDump(const std::string& file);
+
+private:
+  struct Ring
+  {
+    std::atomic<uint64_t> head; //< index of the record being written, all below are published
+    uint64_t mask;
+    uint32_t sampleCount;
+    FlightRecord* current;
+    FlightRecord* suspended;
+    FlightRecord* records;
+  };
+
+  Ring*
+  newRing();
+
+  static void
+  deleteRing(Ring* ring);
+
+  void
+  runSignalDump();
+
+private:
+  std::atomic<uint32_t> m_sampleRate;
+  size_t m_ringSize;
+  std::mutex m_mutex;
+  ThreadBlocks<Ring> m_rings;
+
+  std::string m_dumpFile;
+  std::mutex m_stopMutex;
+  std::condition_variable m_stopCv;
+  bool m_shouldStop;
+  std::thread m_dumpThread;
+};
+
+std::ostream&
+operator<<(std::ostream& os, const FlightRecorder& recorder);
+
+/**
+ * Records the packet handled in the scope, marking STAGE_TOTAL at its end
+ */
+class FlightScope
+{
+public:
+  FlightScope(FlightRecorder& recorder, uint32_t ifIndex, const uint8_t* frame, size_t size)
+    : m_recorder(recorder)
+  {
+    m_recorder.begin(ifIndex, frame, size);
+  }
+
+  ~FlightScope()
+  {
+    m_recorder.mark(STAGE_TOTAL);
+    m_recorder.end();
+  }
+
+private:
+  FlightRecorder& m_recorder;
+};
+
+inline bool
+FlightRecorder::begin(uint32_t ifIndex, const uint8_t* frame, size_t size)
+{
+  uint32_t sampleRate = m_sampleRate.load(std::memory_order_relaxed);
+  if (sampleRate == 0) {
+    return false;
+  }
+  Ring& ring = m_rings.get();
+  if (++ring.sampleCount < sampleRate) {
+    return false;
+  }
+  ring.sampleCount = 0;
+
+  FlightRecord& record = ring.records[ring.head.load(std::memory_order_relaxed) & ring.mask];
+  record = FlightRecord();
+  record.timestamp = readCycles();
+  record.ifIndex = ifIndex;
+  record.length = std::min<size_t>(size, 0xffff);
+  record.verdict = VERDICT_NONE;
+
+  if (size >= sizeof(ethernet_hdr)) {
+    record.etherType = ntohs(reinterpret_cast<const ethernet_hdr*>(frame)->ether_type);
+    const uint8_t* payload = frame + sizeof(ethernet_hdr);
+    size_t payloadSize = size - sizeof(ethernet_hdr);
+
+    if (record.etherType == ethertype_ip && payloadSize >= sizeof(ip_hdr)) {
+      const ip_hdr* ip = reinterpret_cast<const ip_hdr*>(payload);
+      record.src = ip->ip_src;
+      record.dst = ip->ip_dst;
+      record.proto = ip->ip_p;
+      record.ttl = ip->ip_ttl;
+      size_t headerSize = ip->ip_hl * 4;
+      if ((ip->ip_p == ip_protocol_tcp || ip->ip_p == ip_protocol_udp) && payloadSize >= headerSize + 4) {
+        memcpy(&record.srcPort, payload + headerSize, 2);
+        memcpy(&record.dstPort, payload + headerSize + 2, 2);
+      }
+    }
+    else if (record.etherType == ethertype_ipv6 && payloadSize >= sizeof(ipv6_hdr)) {
+      // addresses do not fit the record; the ports identify the flow well enough
+      const ipv6_hdr* ip = reinterpret_cast<const ipv6_hdr*>(payload);
+      record.proto = ip->ipv6_nxt;
+      record.ttl = ip->ipv6_hlim;
+      if ((ip->ipv6_nxt == ip_protocol_tcp || ip->ipv6_nxt == ip_protocol_udp) &&
+          payloadSize >= sizeof(ipv6_hdr) + 4) {
+        memcpy(&record.srcPort, payload + sizeof(ipv6_hdr), 2);
+        memcpy(&record.dstPort, payload + sizeof(ipv6_hdr) + 2, 2);
+      }
+    }
+    else if (record.etherType == ethertype_arp && payloadSize >= sizeof(arp_hdr)) {
+      const arp_hdr* arp = reinterpret_cast<const arp_hdr*>(payload);
+      record.src = arp->arp_sip;
+      record.dst = arp->arp_tip;
+      record.proto = ntohs(arp->arp_op);
+    }
+  }
+  ring.current = &record;
+  return true;
+}
+
+inline void
+FlightRecorder::mark(PipelineStage stage)
+{
+  Ring* ring = m_rings.find();
+  if (ring != nullptr && ring->current != nullptr) {
+    FlightRecord* record = ring->current;
+    record->stageEnd[stage] = static_cast<uint32_t>(readCycles() - record->timestamp);
+  }
+}
+
+inline void
+FlightRecorder::setVerdict(uint8_t verdict)
+{
+  Ring* ring = m_rings.find();
+  if (ring != nullptr && ring->current != nullptr && ring->current->verdict == VERDICT_NONE) {
+    ring->current->verdict = verdict;
+  }
+}
+
+inline void
+FlightRecorder::end()
+{
+  Ring* ring = m_rings.find();
+  if (ring != nullptr && ring->current != nullptr) {
+    ring->current = nullptr;
+    ring->head.store(ring->head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+}
+
+inline void
+FlightRecorder::suspend()
+{
+  Ring* ring = m_rings.find();
+  if (ring != nullptr) {
+    ring->suspended = ring->current;
+    ring->current = nullptr;
+  }
+}
+
+inline void
+FlightRecorder::resume()
+{
+  Ring* ring = m_rings.find();
+  if (ring != nullptr && ring->suspended != nullptr) {
+    ring->current = ring->suspended;
+    ring->suspended = nullptr;
+    ring->current->timestamp = readCycles();
+  }
+}
+
+} // namespace simple_router
+
+#endif // SIMPLE_ROUTER_CORE_FLIGHT_RECORDER_HPP
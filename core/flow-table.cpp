@@ -0,0 +1,442 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "flow-table.hpp"
+#include "token-bucket.hpp"
+
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <stdexcept>
+
+#include <errno.h>
+#include <time.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+namespace simple_router {
+
+FlowKey
+makeFlowKey(const ip_hdr* ip, size_t len)
+{
+  FlowKey key;
+  memset(&key, 0, sizeof(key));
+  key.src = ip->ip_src;
+  key.dst = ip->ip_dst;
+  key.protocol = ip->ip_p;
+
+  size_t headerLen = ip->ip_hl * 4;
+  if ((ip->ip_p == ip_protocol_tcp || ip->ip_p == ip_protocol_udp) &&
+      (ntohs(ip->ip_off) & IP_OFFMASK) == 0 && len >= headerLen + 4) {
+    const uint8_t* transport = reinterpret_cast<const uint8_t*>(ip) + headerLen;
+    memcpy(&key.srcPort, transport, sizeof(key.srcPort));
+    memcpy(&key.dstPort, transport + 2, sizeof(key.dstPort));
+  }
+  return key;
+}
+
+/**
+ * Same clock as TokenBucket::nowNs(), at tick resolution (a few milliseconds), for
+ * a fraction of the cost per packet
+ */
+static uint64_t
+coarseNowNs()
+{
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+  return now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+static uint64_t
+hashFlow(const FlowKey& key)
+{
+  uint64_t addresses = (uint64_t(key.src) << 32) | key.dst;
+  uint64_t rest = (uint64_t(key.srcPort) << 24) | (uint64_t(key.dstPort) << 8) | key.protocol;
+  uint64_t hash = addresses * 0x9e3779b97f4a7c15ull ^ rest * 0xc2b2ae3d27d4eb4full;
+  return hash ^ (hash >> 29);
+}
+
+/**
+ * IPFIX information elements of an exported record, in wire order
+ */
+static const uint16_t TEMPLATE_FIELDS[][2] = {
+  {8, 4},   // sourceIPv4Address
+  {12, 4},  // destinationIPv4Address
+  {7, 2},   // sourceTransportPort
+  {11, 2},  // destinationTransportPort
+  {4, 1},   // protocolIdentifier
+  {210, 3}, // paddingOctets
+  {305, 4}, // samplingPacketInterval
+  {2, 8},   // packetDeltaCount
+  {1, 8},   // octetDeltaCount
+  {152, 8}, // flowStartMilliseconds
+  {153, 8}, // flowEndMilliseconds
+};
+static const size_t N_TEMPLATE_FIELDS = sizeof(TEMPLATE_FIELDS) / sizeof(TEMPLATE_FIELDS[0]);
+static const uint16_t IPFIX_VERSION = 10;
+static const uint16_t TEMPLATE_SET_ID = 2;
+static const uint16_t FLOW_TEMPLATE_ID = 256;
+static const size_t MESSAGE_HEADER_SIZE = 16;
+static const size_t SET_HEADER_SIZE = 4;
+static const size_t TEMPLATE_SET_SIZE = SET_HEADER_SIZE + 4 + N_TEMPLATE_FIELDS * 4;
+static const size_t RECORD_SIZE = 52;
+static const size_t MAX_PENDING_EVICTED = 4096;
+
+static_assert(MESSAGE_HEADER_SIZE + TEMPLATE_SET_SIZE + SET_HEADER_SIZE +
+              FlowExporter::MAX_RECORDS_PER_MESSAGE * RECORD_SIZE <= 1472,
+              "a full message must fit one UDP datagram in a 1500-byte MTU");
+
+static uint8_t*
+put16(uint8_t* out, uint16_t value)
+{
+  value = htons(value);
+  memcpy(out, &value, sizeof(value));
+  return out + sizeof(value);
+}
+
+static uint8_t*
+put32(uint8_t* out, uint32_t value)
+{
+  value = htonl(value);
+  memcpy(out, &value, sizeof(value));
+  return out + sizeof(value);
+}
+
+static uint8_t*
+put64(uint8_t* out, uint64_t value)
+{
+  out = put32(out, value >> 32);
+  return put32(out, value);
+}
+
+const size_t FlowExporter::MAX_RECORDS_PER_MESSAGE;
+const size_t FlowTable::FLOW_BUCKET_WAYS;
+
+FlowExporter::FlowExporter(const std::string& file, const std::string& collector, uint32_t sampleRate)
+  : m_file(nullptr)
+  , m_socket(-1)
+  , m_sampleRate(sampleRate)
+  , m_sequence(0)
+{
+  if (!file.empty()) {
+    m_file = fopen(file.c_str(), "ab");
+    if (m_file == nullptr) {
+      throw std::runtime_error("Cannot open flow export file `" + file + "`: " + strerror(errno));
+    }
+  }
+
+  if (!collector.empty()) {
+    size_t colon = collector.rfind(':');
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    if (colon == std::string::npos ||
+        inet_aton(collector.substr(0, colon).c_str(), &address.sin_addr) == 0) {
+      throw std::runtime_error("Invalid flow collector `" + collector + "`, expected ip:port");
+    }
+    address.sin_port = htons(atoi(collector.c_str() + colon + 1));
+
+    m_socket = socket(AF_INET, SOCK_DGRAM, 0);
+    if (m_socket < 0 ||
+        connect(m_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+      throw std::runtime_error("Cannot connect to flow collector `" + collector + "`: " + strerror(errno));
+    }
+  }
+}
+
+FlowExporter::~FlowExporter()
+{
+  if (m_file != nullptr) {
+    fclose(m_file);
+  }
+  if (m_socket >= 0) {
+    close(m_socket);
+  }
+}
+
+bool
+FlowExporter::send(const FlowRecord* records, size_t count)
+{
+  using namespace std::chrono;
+
+  uint8_t message[MESSAGE_HEADER_SIZE + TEMPLATE_SET_SIZE + SET_HEADER_SIZE +
+                  MAX_RECORDS_PER_MESSAGE * RECORD_SIZE];
+  count = std::min(count, MAX_RECORDS_PER_MESSAGE);
+  size_t length = sizeof(message) - (MAX_RECORDS_PER_MESSAGE - count) * RECORD_SIZE;
+
+  // records hold steady_clock times; IPFIX wants wall-clock milliseconds
+  uint64_t wallNs = duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
+  uint64_t steadyNs = TokenBucket::nowNs();
+  auto toWallMs = [=] (uint64_t steady) {
+    return (wallNs - (steadyNs - std::min(steady, steadyNs))) / 1000000;
+  };
+
+  uint8_t* out = message;
+  out = put16(out, IPFIX_VERSION);
+  out = put16(out, length);
+  out = put32(out, wallNs / 1000000000);
+  out = put32(out, m_sequence);
+  out = put32(out, 0); // observation domain
+
+  out = put16(out, TEMPLATE_SET_ID);
+  out = put16(out, TEMPLATE_SET_SIZE);
+  out = put16(out, FLOW_TEMPLATE_ID);
+  out = put16(out, N_TEMPLATE_FIELDS);
+  for (const auto& field : TEMPLATE_FIELDS) {
+    out = put16(out, field[0]);
+    out = put16(out, field[1]);
+  }
+
+  out = put16(out, FLOW_TEMPLATE_ID);
+  out = put16(out, SET_HEADER_SIZE + count * RECORD_SIZE);
+  for (size_t i = 0; i < count; ++i) {
+    const FlowRecord& record = records[i];
+    // addresses and ports are kept in network byte order
+    memcpy(out, &record.key.src, 4);
+    memcpy(out + 4, &record.key.dst, 4);
+    memcpy(out + 8, &record.key.srcPort, 2);
+    memcpy(out + 10, &record.key.dstPort, 2);
+    out[12] = record.key.protocol;
+    memset(out + 13, 0, 3);
+    out = put32(out + 16, m_sampleRate);
+    out = put64(out, record.packets);
+    out = put64(out, record.bytes);
+    out = put64(out, toWallMs(record.firstSeen));
+    out = put64(out, toWallMs(record.lastSeen));
+  }
+  m_sequence += count;
+
+  bool isOk = true;
+  if (m_file != nullptr) {
+    isOk = fwrite(message, length, 1, m_file) == 1 && fflush(m_file) == 0;
+  }
+  if (m_socket >= 0) {
+    isOk = ::send(m_socket, message, length, 0) == static_cast<ssize_t>(length) && isOk;
+  }
+  return isOk;
+}
+
+class FlowTable::BucketLock
+{
+public:
+  explicit
+  BucketLock(Bucket& bucket)
+    : m_lock(bucket.lock)
+  {
+    while (m_lock.exchange(1, std::memory_order_acquire) != 0) {
+      while (m_lock.load(std::memory_order_relaxed) != 0) {
+      }
+    }
+  }
+
+  ~BucketLock()
+  {
+    m_lock.store(0, std::memory_order_release);
+  }
+
+private:
+  std::atomic<uint32_t>& m_lock;
+};
+
+FlowTable::FlowTable(const Config& config)
+  : m_config(config)
+  , m_exporter(config.file, config.collector, std::max<uint32_t>(config.sampleRate, 1))
+  , m_nExported(0)
+  , m_nEvicted(0)
+  , m_nLost(0)
+  , m_nExportErrors(0)
+  , m_shouldStop(false)
+{
+  static_assert(sizeof(Bucket) == 256, "a bucket should be exactly four cache lines");
+
+  size_t nBuckets = 1;
+  while (nBuckets < m_config.nBuckets) {
+    nBuckets <<= 1;
+  }
+  m_mask = nBuckets - 1;
+  m_config.batchSize = std::max<size_t>(1, std::min(m_config.batchSize,
+                                                    FlowExporter::MAX_RECORDS_PER_MESSAGE));
+
+  void* memory = nullptr;
+  if (posix_memalign(&memory, 64, nBuckets * sizeof(Bucket)) != 0) {
+    throw std::bad_alloc();
+  }
+  memset(memory, 0, nBuckets * sizeof(Bucket));
+  m_buckets = static_cast<Bucket*>(memory);
+
+  m_thread = std::thread(std::bind(&FlowTable::run, this));
+}
+
+FlowTable::~FlowTable()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_stopMutex);
+    m_shouldStop = true;
+  }
+  m_stopCv.notify_one();
+  m_thread.join();
+
+  expire(TokenBucket::nowNs(), true);
+  free(m_buckets);
+}
+
+void
+FlowTable::account(const FlowKey& key, size_t len)
+{
+  uint64_t now = coarseNowNs();
+  Bucket& bucket = m_buckets[hashFlow(key) & m_mask];
+  FlowRecord victim;
+  {
+    BucketLock lock(bucket);
+
+    FlowRecord* slot = nullptr;
+    FlowRecord* oldest = &bucket.records[0];
+    for (auto& record : bucket.records) {
+      if (record.packets == 0) {
+        slot = slot != nullptr ? slot : &record;
+        continue;
+      }
+      if (record.key == key) {
+        ++record.packets;
+        record.bytes += len;
+        record.lastSeen = now;
+        return;
+      }
+      if (record.lastSeen < oldest->lastSeen) {
+        oldest = &record;
+      }
+    }
+
+    victim.packets = 0;
+    if (slot == nullptr) {
+      victim = *oldest;
+      slot = oldest;
+    }
+    *slot = FlowRecord{key, 1, len, now, now};
+  }
+
+  if (victim.packets != 0) {
+    m_nEvicted.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(m_evictedMutex);
+    // bounded, in case flows churn faster than the export thread drains them
+    if (m_evicted.size() < std::max<size_t>(MAX_PENDING_EVICTED, m_mask + 1)) {
+      m_evicted.push_back(victim);
+    }
+    else {
+      m_nLost.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+}
+
+void
+FlowTable::run()
+{
+  std::unique_lock<std::mutex> lock(m_stopMutex);
+  while (!m_shouldStop) {
+    m_stopCv.wait_for(lock, std::chrono::seconds(1));
+    if (m_shouldStop) {
+      break;
+    }
+    lock.unlock();
+    expire(TokenBucket::nowNs(), false);
+    lock.lock();
+  }
+}
+
+void
+FlowTable::expire(uint64_t now, bool isFinal)
+{
+  const uint64_t idleNs = m_config.idleTimeoutSec * 1000000000ull;
+  const uint64_t activeNs = m_config.activeTimeoutSec * 1000000000ull;
+
+  for (size_t i = 0; i <= m_mask; ++i) {
+    FlowRecord expired[FLOW_BUCKET_WAYS];
+    size_t nExpired = 0;
+    {
+      BucketLock lock(m_buckets[i]);
+      for (auto& record : m_buckets[i].records) {
+        if (record.packets != 0 &&
+            (isFinal || now - record.lastSeen > idleNs || now - record.firstSeen > activeNs)) {
+          expired[nExpired++] = record;
+          record.packets = 0;
+        }
+      }
+    }
+    for (size_t j = 0; j < nExpired; ++j) {
+      exportRecord(expired[j]);
+    }
+  }
+
+  std::vector<FlowRecord> evicted;
+  {
+    std::lock_guard<std::mutex> lock(m_evictedMutex);
+    evicted.swap(m_evicted);
+  }
+  for (const auto& record : evicted) {
+    exportRecord(record);
+  }
+  flush();
+}
+
+void
+FlowTable::exportRecord(const FlowRecord& record)
+{
+  m_batch.push_back(record);
+  if (m_batch.size() >= m_config.batchSize) {
+    flush();
+  }
+}
+
+void
+FlowTable::flush()
+{
+  if (m_batch.empty()) {
+    return;
+  }
+  if (!m_exporter.send(m_batch.data(), m_batch.size())) {
+    m_nExportErrors.fetch_add(1, std::memory_order_relaxed);
+  }
+  m_nExported.fetch_add(m_batch.size(), std::memory_order_relaxed);
+  m_batch.clear();
+}
+
+void
+FlowTable::print(std::ostream& os) const
+{
+  size_t nActive = 0;
+  for (size_t i = 0; i <= m_mask; ++i) {
+    BucketLock lock(m_buckets[i]);
+    for (const auto& record : m_buckets[i].records) {
+      nActive += record.packets != 0;
+    }
+  }
+
+  os << "Flows active: " << nActive << " of " << (m_mask + 1) * FLOW_BUCKET_WAYS
+     << ", exported: " << m_nExported.load(std::memory_order_relaxed)
+     << ", evicted early: " << m_nEvicted.load(std::memory_order_relaxed)
+     << ", lost: " << m_nLost.load(std::memory_order_relaxed)
+     << ", export errors: " << m_nExportErrors.load(std::memory_order_relaxed)
+     << ", sampling 1 in " << std::max<uint32_t>(m_config.sampleRate, 1) << "\n";
+}
+
+std::ostream&
+operator<<(std::ostream& os, const FlowTable& flows)
+{
+  flows.print(os);
+  return os;
+}
+
+} // namespace simple_router
@@ -0,0 +1,214 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * This header file defines the flow table that accounts forwarded traffic per
+ * 5-tuple and exports expired flows as IPFIX records.
+ */
+
+#ifndef SIMPLE_ROUTER_CORE_FLOW_TABLE_HPP
+#define SIMPLE_ROUTER_CORE_FLOW_TABLE_HPP
+
+#include "protocol.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <ostream>
+#include <thread>
+
+namespace simple_router {
+
+struct FlowKey
+{
+  uint32_t src;
+  uint32_t dst;
+  uint16_t srcPort; //< 0 unless TCP or UDP
+  uint16_t dstPort;
+  uint8_t protocol;
+  uint8_t pad[3];
+};
+
+inline bool
+operator==(const FlowKey& a, const FlowKey& b)
+{
+  return a.src == b.src && a.dst == b.dst && a.srcPort == b.srcPort &&
+         a.dstPort == b.dstPort && a.protocol == b.protocol;
+}
+
+/**
+ * Flow of the IPv4 datagram \p ip of \p len bytes; ports are read only from
+ * TCP and UDP datagrams that carry them (no non-initial fragments)
+ */
+FlowKey
+makeFlowKey(const ip_hdr* ip, size_t len);
+
+struct FlowRecord
+{
+  FlowKey key;
+  uint64_t packets; //< 0 marks a free slot
+  uint64_t bytes;
+  uint64_t firstSeen; //< steady_clock nanoseconds
+  uint64_t lastSeen;
+};
+
+/**
+ * Sink for expired flow records: IPFIX (RFC 7011) messages appended to a file or
+ * sent to a UDP collector.  Every message carries the template before its data
+ * set, so a collector can decode any message on its own.
+ */
+class FlowExporter
+{
+public:
+  /**
+   * Most records that fit one message in a 1500-byte MTU datagram
+   */
+  static const size_t MAX_RECORDS_PER_MESSAGE = 26;
+
+  /**
+   * @param file      path to append messages to, or empty
+   * @param collector `ip:port` of a UDP collector, or empty
+   * @throw std::runtime_error if the file cannot be opened or the address is invalid
+   */
+  FlowExporter(const std::string& file, const std::string& collector, uint32_t sampleRate);
+
+  ~FlowExporter();
+
+  /**
+   * Send \p count records (at most MAX_RECORDS_PER_MESSAGE) as one message
+   *
+   * @return false if writing failed
+   */
+  bool
+  send(const FlowRecord* records, size_t count);
+
+private:
+  FILE* m_file;
+  int m_socket;
+  uint32_t m_sampleRate;
+  uint32_t m_sequence;
+};
+
+/**
+ * Per-flow packet and byte counters of forwarded traffic
+ *
+ * Fixed-size table of buckets of FLOW_BUCKET_WAYS records, one bucket per hash,
+ * each guarded by its own spin lock, so memory is bounded and an update touches
+ * one bucket (four cache lines) and takes no shared lock.  When a bucket is full,
+ * its least recently seen flow is exported early to make room.  A background
+ * thread exports flows idle for longer than the idle timeout, or active for
+ * longer than the active timeout, in batches.
+ */
+class FlowTable
+{
+public:
+  struct Config
+  {
+    size_t nBuckets = 16384; //< rounded up to a power of two
+    uint32_t idleTimeoutSec = 15;
+    uint32_t activeTimeoutSec = 60;
+    uint32_t sampleRate = 1; //< account one packet in N
+    size_t batchSize = FlowExporter::MAX_RECORDS_PER_MESSAGE;
+    std::string file;
+    std::string collector;
+  };
+
+  /**
+   * @throw std::runtime_error if the exporter cannot be set up
+   */
+  explicit
+  FlowTable(const Config& config);
+
+  /**
+   * Exports all remaining flows
+   */
+  ~FlowTable();
+
+  /**
+   * Account the IPv4 datagram \p ip of \p len bytes
+   */
+  void
+  update(const ip_hdr* ip, size_t len)
+  {
+    if (m_config.sampleRate > 1) {
+      static thread_local uint32_t countdown = 0;
+      if (countdown-- != 0) {
+        return;
+      }
+      countdown = m_config.sampleRate - 1;
+    }
+    account(makeFlowKey(ip, len), len);
+  }
+
+  void
+  print(std::ostream& os) const;
+
+public:
+  static const size_t FLOW_BUCKET_WAYS = 5;
+
+private:
+  struct Bucket
+  {
+    std::atomic<uint32_t> lock;
+    uint32_t pad[3];
+    FlowRecord records[FLOW_BUCKET_WAYS];
+  };
+
+  class BucketLock;
+
+  void
+  account(const FlowKey& key, size_t len);
+
+  void
+  run();
+
+  /**
+   * Export flows that timed out at \p now, or all flows if \p isFinal
+   */
+  void
+  expire(uint64_t now, bool isFinal);
+
+  void
+  exportRecord(const FlowRecord& record);
+
+  void
+  flush();
+
+private:
+  Config m_config;
+  FlowExporter m_exporter;
+  Bucket* m_buckets;
+  size_t m_mask;
+
+  std::mutex m_evictedMutex;
+  std::vector<FlowRecord> m_evicted; //< pushed out of full buckets, waiting for export
+  std::vector<FlowRecord> m_batch;   //< used by the export thread only
+
+  std::atomic<uint64_t> m_nExported;
+  std::atomic<uint64_t> m_nEvicted;
+  std::atomic<uint64_t> m_nLost;
+  std::atomic<uint64_t> m_nExportErrors;
+
+  std::mutex m_stopMutex;
+  std::condition_variable m_stopCv;
+  bool m_shouldStop;
+  std::thread m_thread;
+};
+
+std::ostream&
+operator<<(std::ostream& os, const FlowTable& flows);
+
+} // namespace simple_router
+
+#endif // SIMPLE_ROUTER_CORE_FLOW_TABLE_HPP
@@ -0,0 +1,199 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "icmp.hpp"
+#include "checksum.hpp"
+
+#include <algorithm>
+
+#include <string.h>
+
+namespace simple_router {
+
+const uint8_t ICMP_DEFAULT_TTL = 64;
+
+static void
+fillIpHeader(ip_hdr* ip, size_t totalLen, uint32_t src, uint32_t dst)
+{
+  memset(ip, 0, sizeof(ip_hdr));
+  ip->ip_v = 4;
+  ip->ip_hl = sizeof(ip_hdr) / 4;
+  ip->ip_len = htons(totalLen);
+  ip->ip_ttl = ICMP_DEFAULT_TTL;
+  ip->ip_p = ip_protocol_icmp;
+  ip->ip_src = src;
+  ip->ip_dst = dst;
+  ip->ip_sum = checksum(ip, sizeof(ip_hdr));
+}
+
+size_t
+buildIcmpEchoReply(uint8_t* out, size_t capacity, const uint8_t* request, size_t len)
+{
+  if (len < sizeof(ethernet_hdr) + sizeof(ip_hdr)) {
+    return 0;
+  }
+  const ip_hdr* requestIp = reinterpret_cast<const ip_hdr*>(request + sizeof(ethernet_hdr));
+  size_t headerLen = requestIp->ip_hl * 4;
+  size_t totalLen = ntohs(requestIp->ip_len);
+  if (headerLen < sizeof(ip_hdr) || totalLen < headerLen + sizeof(icmp_hdr) ||
+      len < sizeof(ethernet_hdr) + totalLen) {
+    return 0;
+  }
+
+  // the reply carries no IP options and none of the Ethernet padding of the request
+  const size_t icmpOffset = sizeof(ethernet_hdr) + sizeof(ip_hdr);
+  size_t icmpLen = totalLen - headerLen;
+  if (capacity < icmpOffset + icmpLen) {
+    return 0;
+  }
+  uint32_t requester = requestIp->ip_src;
+  uint32_t address = requestIp->ip_dst;
+  memmove(out + icmpOffset, request + sizeof(ethernet_hdr) + headerLen, icmpLen);
+  if (out != request) {
+    memcpy(out, request, sizeof(ethernet_hdr));
+  }
+  fillIpHeader(reinterpret_cast<ip_hdr*>(out + sizeof(ethernet_hdr)), sizeof(ip_hdr) + icmpLen,
+               address, requester);
+
+  // only the type changes, so the echo checksum is adjusted rather than recomputed
+  icmp_hdr* icmp = reinterpret_cast<icmp_hdr*>(out + icmpOffset);
+  uint16_t oldWord;
+  memcpy(&oldWord, icmp, sizeof(oldWord));
+  icmp->icmp_type = ICMP_ECHO_REPLY;
+  uint16_t newWord;
+  memcpy(&newWord, icmp, sizeof(newWord));
+  icmp->icmp_sum = checksumAdjust(icmp->icmp_sum, oldWord, newWord);
+  return icmpOffset + icmpLen;
+}
+
+size_t
+buildIcmpError(uint8_t* out, size_t capacity, uint8_t type, uint8_t code, uint32_t srcIp,
+               const uint8_t* original, size_t len)
+{
+  if (capacity < ICMP_ERROR_FRAME_SIZE || len < sizeof(ethernet_hdr) + sizeof(ip_hdr)) {
+    return 0;
+  }
+
+  const ip_hdr* originalIp = reinterpret_cast<const ip_hdr*>(original + sizeof(ethernet_hdr));
+  uint32_t dst = originalIp->ip_src;
+
+  memset(out, 0, sizeof(ethernet_hdr));
+  reinterpret_cast<ethernet_hdr*>(out)->ether_type = htons(ethertype_ip);
+
+  icmp_t3_hdr* icmp = reinterpret_cast<icmp_t3_hdr*>(out + sizeof(ethernet_hdr) + sizeof(ip_hdr));
+  memset(icmp, 0, sizeof(icmp_t3_hdr));
+  icmp->icmp_type = type;
+  icmp->icmp_code = code;
+  size_t quoted = std::min(len - sizeof(ethernet_hdr), sizeof(icmp->data));
+  memcpy(icmp->data, original + sizeof(ethernet_hdr), quoted);
+  icmp->icmp_sum = checksum(icmp, sizeof(icmp_t3_hdr));
+
+  fillIpHeader(reinterpret_cast<ip_hdr*>(out + sizeof(ethernet_hdr)),
+               sizeof(ip_hdr) + sizeof(icmp_t3_hdr), srcIp, dst);
+  return ICMP_ERROR_FRAME_SIZE;
+}
+
+static bool
+isSpecialAddress(uint32_t address)
+{
+  uint32_t host = ntohl(address);
+  return host == 0 ||                    // unspecified
+         host == 0xffffffff ||           // limited broadcast
+         (host >> 24) == 127 ||          // loopback
+         (host >> 28) == 0xe;            // multicast
+}
+
+bool
+isIcmpErrorAllowed(const uint8_t* original, size_t len)
+{
+  if (len < sizeof(ethernet_hdr) + sizeof(ip_hdr)) {
+    return false;
+  }
+
+  const ip_hdr* ip = reinterpret_cast<const ip_hdr*>(original + sizeof(ethernet_hdr));
+  if ((ntohs(ip->ip_off) & IP_OFFMASK) != 0) {
+    return false;
+  }
+  if (isSpecialAddress(ip->ip_src) || isSpecialAddress(ip->ip_dst)) {
+    return false;
+  }
+
+  if (ip->ip_p == ip_protocol_icmp) {
+    size_t icmpOffset = sizeof(ethernet_hdr) + ip->ip_hl * 4;
+    if (len < icmpOffset + sizeof(icmp_hdr)) {
+      return false;
+    }
+    // only queries may trigger errors, never other errors
+    uint8_t type = original[icmpOffset];
+    return type == ICMP_ECHO_REQUEST || type == ICMP_ECHO_REPLY;
+  }
+  return true;
+}
+
+IcmpResponder::IcmpResponder()
+  : m_nSent(0)
+  , m_nSuppressed(0)
+{
+  configure(Config());
+}
+
+void
+IcmpResponder::configure(const Config& config)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  m_config = config;
+  m_global.configure(config.globalRate, config.globalBurst);
+  for (auto& dest : m_dests) {
+    dest.dst = 0;
+    dest.bucket.configure(config.perDestRate, config.perDestBurst);
+  }
+}
+
+bool
+IcmpResponder::admit(uint32_t dst)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  if (!m_config.isEnabled) {
+    return false;
+  }
+
+  uint64_t now = TokenBucket::nowNs();
+  // multiplicative hash, top 10 bits
+  static_assert(N_DEST_BUCKETS == 1 << 10, "hash width must match the table size");
+  DestBucket& dest = m_dests[(dst * 2654435761u) >> 22];
+  if (dest.dst != dst) {
+    dest.dst = dst;
+    dest.bucket.configure(m_config.perDestRate, m_config.perDestBurst);
+  }
+
+  // per-destination first, so that one noisy destination does not drain the global bucket
+  if (!dest.bucket.consume(now) || !m_global.consume(now)) {
+    m_nSuppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  m_nSent.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+std::ostream&
+operator<<(std::ostream& os, const IcmpResponder& icmp)
+{
+  os << "ICMP messages sent: " << icmp.getSent()
+     << ", suppressed by rate limit: " << icmp.getSuppressed() << "\n";
+  return os;
+}
+
+} // namespace simple_router
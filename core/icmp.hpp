@@ -0,0 +1,147 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * This header file defines the ICMP message builders and the rate limiter that
+ * decides whether the router may answer at all.
+ */
+
+#ifndef SIMPLE_ROUTER_CORE_ICMP_HPP
+#define SIMPLE_ROUTER_CORE_ICMP_HPP
+
+#include "protocol.hpp"
+#include "token-bucket.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <ostream>
+
+namespace simple_router {
+
+enum IcmpType {
+  ICMP_ECHO_REPLY = 0,
+  ICMP_DEST_UNREACHABLE = 3,
+  ICMP_ECHO_REQUEST = 8,
+  ICMP_TIME_EXCEEDED = 11,
+  ICMP_PARAMETER_PROBLEM = 12,
+};
+
+enum IcmpUnreachableCode {
+  ICMP_NET_UNREACHABLE = 0,
+  ICMP_HOST_UNREACHABLE = 1,
+  ICMP_PORT_UNREACHABLE = 3,
+};
+
+/**
+ * Size of an ICMP error frame: Ethernet, IPv4 and ICMP headers plus the quoted
+ * IPv4 header and first 8 bytes of the offending datagram
+ */
+const size_t ICMP_ERROR_FRAME_SIZE = sizeof(ethernet_hdr) + sizeof(ip_hdr) + sizeof(icmp_t3_hdr);
+
+/**
+ * Turn the echo request frame \p request of \p len bytes into an echo reply in \p out,
+ * which can be the same memory.  The reply is sized by the request's IP total length,
+ * without its options.  Ethernet addresses are left for the caller.
+ *
+ * @return size of the reply, or 0 if \p capacity is too small or the request is truncated
+ */
+size_t
+buildIcmpEchoReply(uint8_t* out, size_t capacity, const uint8_t* request, size_t len);
+
+/**
+ * Build an ICMP error of \p type / \p code about the IPv4 frame \p original into \p out,
+ * sent from \p srcIp.  Ethernet addresses are left for the caller.
+ *
+ * @return size of the message (ICMP_ERROR_FRAME_SIZE), or 0 if \p capacity is too small
+ */
+size_t
+buildIcmpError(uint8_t* out, size_t capacity, uint8_t type, uint8_t code, uint32_t srcIp,
+               const uint8_t* original, size_t len);
+
+/**
+ * Whether RFC 1812 allows an ICMP error about the IPv4 frame \p original: never
+ * about ICMP errors, non-initial fragments, or datagrams from or to broadcast,
+ * multicast, loopback or unspecified addresses
+ */
+bool
+isIcmpErrorAllowed(const uint8_t* original, size_t len);
+
+/**
+ * Rate limiter for all ICMP messages generated by the router
+ *
+ * A message is sent only if both the global bucket and the bucket of its destination
+ * have a token.  Per-destination buckets live in a fixed table indexed by address
+ * hash; a colliding address takes the slot over with a full bucket, so spoofed
+ * sources cannot grow memory and remain bounded by the global bucket.
+ */
+class IcmpResponder
+{
+public:
+  struct Config
+  {
+    bool isEnabled = true;
+    double globalRate = 1000;   //< messages per second, 0 for unlimited
+    double globalBurst = 50;
+    double perDestRate = 10;    //< messages per second to one address, 0 for unlimited
+    double perDestBurst = 10;
+  };
+
+  IcmpResponder();
+
+  void
+  configure(const Config& config);
+
+  /**
+   * Take a token for a message to \p dst
+   *
+   * @return false if ICMP is disabled or the message must be suppressed
+   */
+  bool
+  admit(uint32_t dst);
+
+  uint64_t
+  getSent() const
+  {
+    return m_nSent.load(std::memory_order_relaxed);
+  }
+
+  uint64_t
+  getSuppressed() const
+  {
+    return m_nSuppressed.load(std::memory_order_relaxed);
+  }
+
+private:
+  static const size_t N_DEST_BUCKETS = 1024;
+
+  struct DestBucket
+  {
+    uint32_t dst = 0;
+    TokenBucket bucket;
+  };
+
+  Config m_config;
+  std::mutex m_mutex;
+  TokenBucket m_global;
+  DestBucket m_dests[N_DEST_BUCKETS];
+
+  std::atomic<uint64_t> m_nSent;
+  std::atomic<uint64_t> m_nSuppressed;
+};
+
+std::ostream&
+operator<<(std::ostream& os, const IcmpResponder& icmp);
+
+} // namespace simple_router
+
+#endif // SIMPLE_ROUTER_CORE_ICMP_HPP
@@ -19,19 +19,41 @@
 
 namespace simple_router {
 
-Interface::Interface(const std::string& name, const Buffer& addr, uint32_t ip)
+Interface::Interface(const std::string& name, const Buffer& addr, uint32_t ip, uint32_t index)
   : name(name)
   , addr(addr)
   , ip(ip)
+  , ip6({0, 0})
+  , linkLocal({0, 0})
+  , index(index)
+  , mac(addr.size() >= ETHER_ADDR_LEN ? macToInteger(addr.data()) : 0)
 {
+  if (addr.size() >= ETHER_ADDR_LEN) {
+    linkLocal = linkLocalAddress(addr.data());
+  }
+}
+
+void
+Interface::joinMulticast(const uint8_t* group)
+{
+  uint64_t value = macToInteger(group);
+  for (uint64_t joined : multicastMacs) {
+    if (joined == value) {
+      return;
+    }
+  }
+  multicastMacs.push_back(value);
 }
 
 std::ostream&
 operator<<(std::ostream& os, const Interface& iface)
 {
   os << iface.name
-     << " (" << ipToString(iface.ip)
-     << ", " << macToString(iface.addr) << ")";
+     << " (" << ipToString(iface.ip);
+  if (!iface.ip6.isUnspecified()) {
+    os << ", " << ipv6ToString(iface.ip6);
+  }
+  os << ", " << macToString(iface.addr) << ")";
   return os;
 }
 
@@ -18,18 +18,45 @@
 #define SIMPLE_ROUTER_INTERFACE_HPP
 
 #include "protocol.hpp"
+#include "ipv6.hpp"
 
 #include <ostream>
 
+#include <string.h>
+
 namespace simple_router {
 
+/**
+ * Load a 6-byte MAC address as an integer, for comparisons without byte loops
+ */
+inline uint64_t
+macToInteger(const uint8_t* mac)
+{
+  uint64_t value = 0;
+  memcpy(&value, mac, ETHER_ADDR_LEN);
+  return value;
+}
+
+const uint64_t BROADCAST_MAC = macToInteger(BroadcastEtherAddr);
+
+/**
+ * Whether \p mac (as returned by macToInteger) has the group bit set
+ */
+inline bool
+isMulticastMac(uint64_t mac)
+{
+  uint8_t first;
+  memcpy(&first, &mac, 1);
+  return (first & 0x01) != 0;
+}
+
 /**
  * Network interface abstraction
  */
 class Interface
 {
 public:
-  Interface(const std::string& name, const Buffer& addr, uint32_t ip);
+  Interface(const std::string& name, const Buffer& addr, uint32_t ip, uint32_t index = 0);
 
   void
   print();
@@ -37,10 +64,34 @@ public:
   bool
   operator<(const Interface& rh) const;
 
+  /**
+   * Whether a frame with destination \p dstMac (see macToInteger) is addressed to
+   * this interface: its own address, broadcast, or a joined multicast group
+   */
+  bool
+  accepts(uint64_t dstMac) const;
+
+  void
+  joinMulticast(const uint8_t* group);
+
+  /**
+   * Source address of IPv6 messages the router sends on this interface
+   */
+  const Ipv6Address&
+  ipv6Source() const
+  {
+    return ip6.isUnspecified() ? linkLocal : ip6;
+  }
+
 public:
   std::string name;
   Buffer addr;
   uint32_t ip;
+  Ipv6Address ip6;       //< Global address from IP6_CONFIG, unspecified if none
+  Ipv6Address linkLocal; //< fe80:: address derived from the MAC
+  uint32_t index; //< Position of the interface in the list reported by POX
+  uint64_t mac;   //< addr as returned by macToInteger()
+  std::vector<uint64_t> multicastMacs;
 };
 
 inline bool
@@ -49,6 +100,23 @@ Interface::operator<(const Interface& rh) const
   return name < rh.name;
 }
 
+inline bool
+Interface::accepts(uint64_t dstMac) const
+{
+  if (dstMac == mac || dstMac == BROADCAST_MAC) {
+    return true;
+  }
+  if (!isMulticastMac(dstMac)) {
+    return false;
+  }
+  for (uint64_t group : multicastMacs) {
+    if (dstMac == group) {
+      return true;
+    }
+  }
+  return false;
+}
+
 std::ostream&
 operator<<(std::ostream& os, const Interface& iface);
 
@@ -0,0 +1,305 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "ipv6.hpp"
+#include "checksum.hpp"
+
+#include <algorithm>
+
+#include <arpa/inet.h>
+#include <endian.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace simple_router {
+
+const uint8_t ICMP6_DEFAULT_HOP_LIMIT = 64;
+
+void
+Ipv6Address::toBytes(uint8_t* bytes) const
+{
+  uint64_t half = htobe64(hi);
+  memcpy(bytes, &half, sizeof(half));
+  half = htobe64(lo);
+  memcpy(bytes + 8, &half, sizeof(half));
+}
+
+std::string
+ipv6ToString(const Ipv6Address& address)
+{
+  uint8_t bytes[16];
+  address.toBytes(bytes);
+  char text[INET6_ADDRSTRLEN];
+  if (inet_ntop(AF_INET6, bytes, text, sizeof(text)) == nullptr) {
+    return "?";
+  }
+  return text;
+}
+
+bool
+parseIpv6(const std::string& text, Ipv6Address& address)
+{
+  uint8_t bytes[16];
+  if (inet_pton(AF_INET6, text.c_str(), bytes) != 1) {
+    return false;
+  }
+  address = Ipv6Address::fromBytes(bytes);
+  return true;
+}
+
+bool
+parseIpv6Prefix(const std::string& text, Ipv6Address& address, int& length)
+{
+  size_t slash = text.find('/');
+  length = 128;
+  if (slash != std::string::npos) {
+    char* end = nullptr;
+    long value = strtol(text.c_str() + slash + 1, &end, 10);
+    if (end == text.c_str() + slash + 1 || *end != '\0' || value < 0 || value > 128) {
+      return false;
+    }
+    length = value;
+  }
+  return parseIpv6(text.substr(0, slash), address);
+}
+
+Ipv6Address
+linkLocalAddress(const uint8_t* mac)
+{
+  uint8_t bytes[16] = {0xfe, 0x80};
+  bytes[8] = mac[0] ^ 0x02;
+  bytes[9] = mac[1];
+  bytes[10] = mac[2];
+  bytes[11] = 0xff;
+  bytes[12] = 0xfe;
+  bytes[13] = mac[3];
+  bytes[14] = mac[4];
+  bytes[15] = mac[5];
+  return Ipv6Address::fromBytes(bytes);
+}
+
+Ipv6Address
+solicitedNodeAddress(const Ipv6Address& address)
+{
+  Ipv6Address group;
+  group.hi = 0xff02000000000000;
+  group.lo = 0x00000001ff000000 | (address.lo & 0xffffff);
+  return group;
+}
+
+void
+multicastMac(const Ipv6Address& group, uint8_t* mac)
+{
+  mac[0] = 0x33;
+  mac[1] = 0x33;
+  for (int i = 0; i < 4; ++i) {
+    mac[2 + i] = (group.lo >> (24 - 8 * i)) & 0xff;
+  }
+}
+
+uint16_t
+icmp6Checksum(const ipv6_hdr* ip, const uint8_t* message, size_t len)
+{
+  // generated and validated messages are rare, so the pseudo-header is simply
+  // summed together with the message
+  static thread_local Buffer scratch;
+  scratch.resize(40 + len);
+  memcpy(scratch.data(), ip->ipv6_src, 32);
+  uint32_t upperLength = htonl(len);
+  memcpy(scratch.data() + 32, &upperLength, 4);
+  memset(scratch.data() + 36, 0, 3);
+  scratch[39] = ip_protocol_icmpv6;
+  memcpy(scratch.data() + 40, message, len);
+  return checksum(scratch.data(), scratch.size());
+}
+
+static void
+fillIpv6Header(ipv6_hdr* ip, size_t payloadLen, uint8_t hopLimit, const Ipv6Address& src,
+               const Ipv6Address& dst)
+{
+  ip->ipv6_vtcf = htonl(6 << 28);
+  ip->ipv6_plen = htons(payloadLen);
+  ip->ipv6_nxt = ip_protocol_icmpv6;
+  ip->ipv6_hlim = hopLimit;
+  src.toBytes(ip->ipv6_src);
+  dst.toBytes(ip->ipv6_dst);
+}
+
+static size_t
+buildNdp(uint8_t* out, size_t capacity, uint8_t type, uint32_t flags, uint8_t option,
+         const uint8_t* srcMac, const Ipv6Address& src, const uint8_t* dstMac, const Ipv6Address& dst,
+         const Ipv6Address& target)
+{
+  if (capacity < NDP_FRAME_SIZE) {
+    return 0;
+  }
+  memset(out, 0, NDP_FRAME_SIZE);
+
+  ethernet_hdr* eth = reinterpret_cast<ethernet_hdr*>(out);
+  memcpy(eth->ether_shost, srcMac, ETHER_ADDR_LEN);
+  memcpy(eth->ether_dhost, dstMac, ETHER_ADDR_LEN);
+  eth->ether_type = htons(ethertype_ipv6);
+
+  ipv6_hdr* ip = reinterpret_cast<ipv6_hdr*>(out + sizeof(ethernet_hdr));
+  size_t messageLen = sizeof(ndp_hdr) + sizeof(ndp_lladdr_opt);
+  fillIpv6Header(ip, messageLen, NDP_HOP_LIMIT, src, dst);
+
+  uint8_t* message = out + sizeof(ethernet_hdr) + sizeof(ipv6_hdr);
+  ndp_hdr* ndp = reinterpret_cast<ndp_hdr*>(message);
+  ndp->ndp_type = type;
+  ndp->ndp_flags = htonl(flags);
+  target.toBytes(ndp->ndp_target);
+
+  ndp_lladdr_opt* opt = reinterpret_cast<ndp_lladdr_opt*>(message + sizeof(ndp_hdr));
+  opt->ndp_opt_type = option;
+  opt->ndp_opt_len = 1;
+  memcpy(opt->ndp_opt_mac, srcMac, ETHER_ADDR_LEN);
+
+  ndp->ndp_sum = icmp6Checksum(ip, message, messageLen);
+  return NDP_FRAME_SIZE;
+}
+
+size_t
+buildNeighborSolicitation(uint8_t* out, size_t capacity, const uint8_t* srcMac, const Ipv6Address& src,
+                          const Ipv6Address& target, const uint8_t* dstMac)
+{
+  if (dstMac != nullptr) {
+    return buildNdp(out, capacity, ICMP6_NEIGHBOR_SOLICITATION, 0, NDP_OPT_SOURCE_LLADDR,
+                    srcMac, src, dstMac, target, target);
+  }
+
+  Ipv6Address group = solicitedNodeAddress(target);
+  uint8_t groupMac[ETHER_ADDR_LEN];
+  multicastMac(group, groupMac);
+  return buildNdp(out, capacity, ICMP6_NEIGHBOR_SOLICITATION, 0, NDP_OPT_SOURCE_LLADDR,
+                  srcMac, src, groupMac, group, target);
+}
+
+size_t
+buildNeighborAdvertisement(uint8_t* out, size_t capacity, const uint8_t* srcMac, const Ipv6Address& target,
+                           const uint8_t* dstMac, const Ipv6Address& dst)
+{
+  return buildNdp(out, capacity, ICMP6_NEIGHBOR_ADVERTISEMENT,
+                  NDP_FLAG_ROUTER | NDP_FLAG_SOLICITED | NDP_FLAG_OVERRIDE, NDP_OPT_TARGET_LLADDR,
+                  srcMac, target, dstMac, dst, target);
+}
+
+const uint8_t*
+findLinkLayerAddress(const uint8_t* options, size_t len, uint8_t option)
+{
+  // options are type, length in units of 8 bytes, data; a zero length is invalid
+  while (len >= 8) {
+    size_t optionLen = options[1] * 8;
+    if (optionLen == 0 || optionLen > len) {
+      return nullptr;
+    }
+    if (options[0] == option) {
+      return options + 2;
+    }
+    options += optionLen;
+    len -= optionLen;
+  }
+  return nullptr;
+}
+
+size_t
+buildIcmp6EchoReply(uint8_t* out, size_t capacity, const uint8_t* request, size_t len)
+{
+  const size_t icmpOffset = sizeof(ethernet_hdr) + sizeof(ipv6_hdr);
+  if (capacity < len || len < icmpOffset + sizeof(icmp_hdr)) {
+    return 0;
+  }
+  if (out != request) {
+    memcpy(out, request, len);
+  }
+
+  // swapping the addresses leaves the pseudo-header sum unchanged, and only the type
+  // changes in the message, so the checksum is adjusted rather than recomputed
+  ipv6_hdr* ip = reinterpret_cast<ipv6_hdr*>(out + sizeof(ethernet_hdr));
+  uint8_t requester[16];
+  memcpy(requester, ip->ipv6_src, 16);
+  memcpy(ip->ipv6_src, ip->ipv6_dst, 16);
+  memcpy(ip->ipv6_dst, requester, 16);
+  ip->ipv6_hlim = ICMP6_DEFAULT_HOP_LIMIT;
+
+  icmp_hdr* icmp = reinterpret_cast<icmp_hdr*>(out + icmpOffset);
+  uint16_t oldWord;
+  memcpy(&oldWord, icmp, sizeof(oldWord));
+  icmp->icmp_type = ICMP6_ECHO_REPLY;
+  uint16_t newWord;
+  memcpy(&newWord, icmp, sizeof(newWord));
+  icmp->icmp_sum = checksumAdjust(icmp->icmp_sum, oldWord, newWord);
+  return len;
+}
+
+size_t
+buildIcmp6Error(uint8_t* out, size_t capacity, uint8_t type, uint8_t code, const Ipv6Address& src,
+                const uint8_t* original, size_t len)
+{
+  const size_t headerLen = sizeof(ethernet_hdr) + sizeof(ipv6_hdr) + sizeof(icmp_hdr) + 4;
+  if (len < sizeof(ethernet_hdr) + sizeof(ipv6_hdr)) {
+    return 0;
+  }
+  size_t quoted = std::min(len - sizeof(ethernet_hdr), ICMP6_ERROR_FRAME_MAX_SIZE - headerLen);
+  if (capacity < headerLen + quoted) {
+    return 0;
+  }
+
+  const ipv6_hdr* originalIp = reinterpret_cast<const ipv6_hdr*>(original + sizeof(ethernet_hdr));
+  Ipv6Address dst = Ipv6Address::fromBytes(originalIp->ipv6_src);
+
+  memset(out, 0, headerLen);
+  reinterpret_cast<ethernet_hdr*>(out)->ether_type = htons(ethertype_ipv6);
+
+  uint8_t* message = out + sizeof(ethernet_hdr) + sizeof(ipv6_hdr);
+  size_t messageLen = sizeof(icmp_hdr) + 4 + quoted;
+  memcpy(message + sizeof(icmp_hdr) + 4, original + sizeof(ethernet_hdr), quoted);
+
+  ipv6_hdr* ip = reinterpret_cast<ipv6_hdr*>(out + sizeof(ethernet_hdr));
+  fillIpv6Header(ip, messageLen, ICMP6_DEFAULT_HOP_LIMIT, src, dst);
+
+  icmp_hdr* icmp = reinterpret_cast<icmp_hdr*>(message);
+  icmp->icmp_type = type;
+  icmp->icmp_code = code;
+  icmp->icmp_sum = icmp6Checksum(ip, message, messageLen);
+  return headerLen + quoted;
+}
+
+bool
+isIcmp6ErrorAllowed(const uint8_t* original, size_t len)
+{
+  if (len < sizeof(ethernet_hdr) + sizeof(ipv6_hdr)) {
+    return false;
+  }
+
+  const ipv6_hdr* ip = reinterpret_cast<const ipv6_hdr*>(original + sizeof(ethernet_hdr));
+  Ipv6Address src = Ipv6Address::fromBytes(ip->ipv6_src);
+  Ipv6Address dst = Ipv6Address::fromBytes(ip->ipv6_dst);
+  if (src.isUnspecified() || src.isMulticast() || dst.isMulticast()) {
+    return false;
+  }
+
+  if (ip->ipv6_nxt == ip_protocol_icmpv6) {
+    size_t icmpOffset = sizeof(ethernet_hdr) + sizeof(ipv6_hdr);
+    if (len < icmpOffset + sizeof(icmp_hdr)) {
+      return false;
+    }
+    // error messages have the types below 128
+    return original[icmpOffset] >= 128;
+  }
+  return true;
+}
+
+} // namespace simple_router
@@ -0,0 +1,263 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * This header file defines the IPv6 address type, and the ICMPv6 and neighbor
+ * discovery (NDP) message builders.
+ */
+
+#ifndef SIMPLE_ROUTER_CORE_IPV6_HPP
+#define SIMPLE_ROUTER_CORE_IPV6_HPP
+
+#include "protocol.hpp"
+
+#include <functional>
+#include <string>
+
+#include <endian.h>
+#include <string.h>
+
+namespace simple_router {
+
+/**
+ * IPv6 address as two 64-bit halves in host byte order, so that masking and
+ * comparing addresses are integer operations
+ */
+struct Ipv6Address
+{
+  uint64_t hi;
+  uint64_t lo;
+
+  /**
+   * Address stored in network byte order at \p bytes (16 bytes)
+   */
+  static Ipv6Address
+  fromBytes(const uint8_t* bytes)
+  {
+    Ipv6Address address;
+    memcpy(&address.hi, bytes, sizeof(address.hi));
+    memcpy(&address.lo, bytes + 8, sizeof(address.lo));
+    address.hi = be64toh(address.hi);
+    address.lo = be64toh(address.lo);
+    return address;
+  }
+
+  void
+  toBytes(uint8_t* bytes) const;
+
+  /**
+   * The first \p length bits of the address, the rest zero
+   */
+  Ipv6Address
+  mask(int length) const
+  {
+    Ipv6Address masked;
+    masked.hi = length >= 64 ? hi : length == 0 ? 0 : hi & (~uint64_t(0) << (64 - length));
+    masked.lo = length >= 128 ? lo : length <= 64 ? 0 : lo & (~uint64_t(0) << (128 - length));
+    return masked;
+  }
+
+  bool
+  isUnspecified() const
+  {
+    return hi == 0 && lo == 0;
+  }
+
+  bool
+  isMulticast() const
+  {
+    return (hi >> 56) == 0xff;
+  }
+
+  bool
+  isLinkLocal() const
+  {
+    return (hi >> 54) == (0xfe80 >> 6);
+  }
+
+  bool
+  operator==(const Ipv6Address& other) const
+  {
+    return hi == other.hi && lo == other.lo;
+  }
+
+  bool
+  operator!=(const Ipv6Address& other) const
+  {
+    return !(*this == other);
+  }
+
+  bool
+  operator<(const Ipv6Address& other) const
+  {
+    return hi < other.hi || (hi == other.hi && lo < other.lo);
+  }
+};
+
+struct Ipv6AddressHash
+{
+  size_t
+  operator()(const Ipv6Address& address) const
+  {
+    uint64_t h = (address.hi ^ (address.lo * 0x9e3779b97f4a7c15)) * 0xff51afd7ed558ccd;
+    return h ^ (h >> 32);
+  }
+};
+
+std::string
+ipv6ToString(const Ipv6Address& address);
+
+/**
+ * @return false if \p text is not an IPv6 address
+ */
+bool
+parseIpv6(const std::string& text, Ipv6Address& address);
+
+/**
+ * Parse "address/length"; a plain address is a /128
+ *
+ * @return false if \p text is not an IPv6 prefix
+ */
+bool
+parseIpv6Prefix(const std::string& text, Ipv6Address& address, int& length);
+
+/**
+ * fe80::/64 address with the modified EUI-64 interface identifier of \p mac
+ */
+Ipv6Address
+linkLocalAddress(const uint8_t* mac);
+
+/**
+ * Solicited-node multicast group ff02::1:ffXX:XXXX of \p address
+ */
+Ipv6Address
+solicitedNodeAddress(const Ipv6Address& address);
+
+/**
+ * Ethernet group address 33:33:XX:XX:XX:XX of the IPv6 multicast \p group
+ */
+void
+multicastMac(const Ipv6Address& group, uint8_t* mac);
+
+const Ipv6Address ALL_NODES_ADDRESS = {0xff02000000000000, 1};
+
+enum Icmp6Type {
+  ICMP6_DEST_UNREACHABLE = 1,
+  ICMP6_TIME_EXCEEDED = 3,
+  ICMP6_ECHO_REQUEST = 128,
+  ICMP6_ECHO_REPLY = 129,
+  ICMP6_NEIGHBOR_SOLICITATION = 135,
+  ICMP6_NEIGHBOR_ADVERTISEMENT = 136,
+};
+
+enum Icmp6UnreachableCode {
+  ICMP6_NO_ROUTE = 0,
+  ICMP6_BEYOND_SCOPE = 2,
+  ICMP6_ADDRESS_UNREACHABLE = 3,
+  ICMP6_PORT_UNREACHABLE = 4,
+};
+
+enum NdpOption {
+  NDP_OPT_SOURCE_LLADDR = 1,
+  NDP_OPT_TARGET_LLADDR = 2,
+};
+
+const uint32_t NDP_FLAG_ROUTER = 0x80000000;
+const uint32_t NDP_FLAG_SOLICITED = 0x40000000;
+const uint32_t NDP_FLAG_OVERRIDE = 0x20000000;
+
+/**
+ * Hop limit of all NDP messages; received ones with another value are not from the link
+ */
+const uint8_t NDP_HOP_LIMIT = 255;
+
+/**
+ * Size of an Ethernet frame with an NDP message and one link-layer address option
+ */
+const size_t NDP_FRAME_SIZE = sizeof(ethernet_hdr) + sizeof(ipv6_hdr) + sizeof(ndp_hdr) +
+                              sizeof(ndp_lladdr_opt);
+
+/**
+ * Largest ICMPv6 error frame: the message must fit the IPv6 minimum MTU of 1280
+ */
+const size_t ICMP6_ERROR_FRAME_MAX_SIZE = sizeof(ethernet_hdr) + 1280;
+
+/**
+ * ICMPv6 checksum of the \p len byte message at \p message carried in \p ip
+ * (RFC 4443 section 2.3, over the pseudo-header)
+ */
+uint16_t
+icmp6Checksum(const ipv6_hdr* ip, const uint8_t* message, size_t len);
+
+/**
+ * Build a neighbor solicitation for \p target, sent from \p src / \p srcMac.  It is
+ * multicast to the solicited-node group of \p target, or unicast to \p target at
+ * \p dstMac if given (to confirm a known neighbor is still reachable).
+ *
+ * @return size of the frame (NDP_FRAME_SIZE), or 0 if \p capacity is too small
+ */
+size_t
+buildNeighborSolicitation(uint8_t* out, size_t capacity, const uint8_t* srcMac, const Ipv6Address& src,
+                          const Ipv6Address& target, const uint8_t* dstMac = nullptr);
+
+/**
+ * Build a solicited neighbor advertisement of \p target (owned by \p srcMac) to
+ * \p dst / \p dstMac
+ *
+ * @return size of the frame (NDP_FRAME_SIZE), or 0 if \p capacity is too small
+ */
+size_t
+buildNeighborAdvertisement(uint8_t* out, size_t capacity, const uint8_t* srcMac, const Ipv6Address& target,
+                           const uint8_t* dstMac, const Ipv6Address& dst);
+
+/**
+ * Link-layer address carried in the \p option (NDP_OPT_SOURCE_LLADDR or
+ * NDP_OPT_TARGET_LLADDR) of the \p len bytes of NDP options at \p options
+ *
+ * @return pointer to the 6-byte address, or nullptr if there is no such option or
+ *         the options are malformed
+ */
+const uint8_t*
+findLinkLayerAddress(const uint8_t* options, size_t len, uint8_t option);
+
+/**
+ * Turn the ICMPv6 echo request frame \p request of \p len bytes into an echo reply
+ * in \p out, which can be the same memory.  Ethernet addresses are left for the caller.
+ *
+ * @return size of the reply, or 0 if \p capacity is too small
+ */
+size_t
+buildIcmp6EchoReply(uint8_t* out, size_t capacity, const uint8_t* request, size_t len);
+
+/**
+ * Build an ICMPv6 error of \p type / \p code about the IPv6 frame \p original into
+ * \p out, sent from \p src, quoting as much of the original as fits the minimum MTU.
+ * Ethernet addresses are left for the caller.
+ *
+ * @return size of the message, or 0 if \p capacity is too small
+ */
+size_t
+buildIcmp6Error(uint8_t* out, size_t capacity, uint8_t type, uint8_t code, const Ipv6Address& src,
+                const uint8_t* original, size_t len);
+
+/**
+ * Whether RFC 4443 allows an ICMPv6 error about the IPv6 frame \p original: never
+ * about ICMPv6 errors, or datagrams from unspecified or multicast sources or to
+ * multicast groups
+ */
+bool
+isIcmp6ErrorAllowed(const uint8_t* original, size_t len);
+
+} // namespace simple_router
+
+#endif // SIMPLE_ROUTER_CORE_IPV6_HPP
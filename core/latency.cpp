@@ -0,0 +1,184 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "latency.hpp"
+
+#include <chrono>
+#include <iomanip>
+
+namespace simple_router {
+
+const char*
+pipelineStageToString(PipelineStage stage)
+{
+  switch (stage) {
+  case STAGE_TOTAL:
+    return "total";
+  case STAGE_ARP_INPUT:
+    return "arp-input";
+  case STAGE_IP_VALIDATE:
+    return "ip-validate";
+  case STAGE_ROUTE_LOOKUP:
+    return "route-lookup";
+  case STAGE_ARP_LOOKUP:
+    return "arp-lookup";
+  case STAGE_SEND:
+    return "send";
+  default:
+    return "unknown";
+  }
+}
+
+double
+getCyclesPerNanosecond()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  static double cyclesPerNs = [] {
+    auto startTime = std::chrono::steady_clock::now();
+    uint64_t startCycles = readCycles();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    uint64_t cycles = readCycles() - startCycles;
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                                   startTime).count();
+    return static_cast<double>(cycles) / ns;
+  }();
+  return cyclesPerNs;
+#else
+  return 1.0;
+#endif
+}
+
+LatencyRecorder::LatencyRecorder()
+  : m_blocks(&LatencyRecorder::newBlock, [] (Block* block) { delete block; })
+  , m_isEnabled(false)
+  , m_baseline(N_PIPELINE_STAGES)
+{
+}
+
+void
+LatencyRecorder::setEnabled(bool isEnabled)
+{
+  if (isEnabled) {
+    getCyclesPerNanosecond();
+  }
+  m_isEnabled.store(isEnabled, std::memory_order_relaxed);
+}
+
+LatencyRecorder::Block*
+LatencyRecorder::newBlock()
+{
+  Block* block = new Block;
+  for (auto& stage : block->counts) {
+    for (auto& counter : stage) {
+      counter.store(0, std::memory_order_relaxed);
+    }
+  }
+  return block;
+}
+
+void
+LatencyRecorder::sum(LatencyHistogram* histograms) const
+{
+  m_blocks.forEach([=] (const Block& block) {
+    for (size_t stage = 0; stage < N_PIPELINE_STAGES; ++stage) {
+      for (size_t i = 0; i < LatencyHistogram::N_BUCKETS; ++i) {
+        histograms[stage].counts[i] += block.counts[stage][i].load(std::memory_order_relaxed);
+      }
+    }
+  });
+}
+
+void
+LatencyRecorder::reset()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  std::vector<LatencyHistogram> current(N_PIPELINE_STAGES);
+  sum(current.data());
+  m_baseline.swap(current);
+}
+
+LatencySnapshot
+LatencyRecorder::aggregate() const
+{
+  std::vector<LatencyHistogram> histograms(N_PIPELINE_STAGES);
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    sum(histograms.data());
+    for (size_t stage = 0; stage < N_PIPELINE_STAGES; ++stage) {
+      for (size_t i = 0; i < LatencyHistogram::N_BUCKETS; ++i) {
+        histograms[stage].counts[i] -= m_baseline[stage].counts[i];
+      }
+    }
+  }
+
+  double cyclesPerNs = getCyclesPerNanosecond();
+  LatencySnapshot snapshot;
+  snapshot.isEnabled = isEnabled();
+
+  for (size_t stage = 0; stage < N_PIPELINE_STAGES; ++stage) {
+    const LatencyHistogram& histogram = histograms[stage];
+    StageLatency& result = snapshot.stages[stage];
+
+    for (uint64_t count : histogram.counts) {
+      result.count += count;
+    }
+    if (result.count == 0) {
+      continue;
+    }
+
+    struct Quantile {
+      double q;
+      double* value;
+    };
+    Quantile quantiles[] = {{0.5, &result.p50}, {0.99, &result.p99}, {0.999, &result.p999}};
+
+    uint64_t seen = 0;
+    size_t next = 0;
+    for (size_t i = 0; i < LatencyHistogram::N_BUCKETS; ++i) {
+      if (histogram.counts[i] == 0) {
+        continue;
+      }
+      seen += histogram.counts[i];
+      // report the upper end of the bucket, so percentiles are never underestimated
+      double upper = (LatencyHistogram::lowestValueOf(i + 1) - 1) / cyclesPerNs;
+      while (next < 3 && seen >= quantiles[next].q * result.count) {
+        *quantiles[next].value = upper;
+        ++next;
+      }
+      result.max = upper;
+    }
+  }
+  return snapshot;
+}
+
+std::ostream&
+operator<<(std::ostream& os, const LatencySnapshot& latency)
+{
+  os << "\nLatency measurement is " << (latency.isEnabled ? "enabled" : "disabled") << "\n"
+     << "\nStage              Count      p50 ns      p99 ns    p99.9 ns      max ns\n"
+     << "--------------------------------------------------------------------------\n";
+  os << std::fixed << std::setprecision(0);
+  for (size_t stage = 0; stage < N_PIPELINE_STAGES; ++stage) {
+    const StageLatency& s = latency.stages[stage];
+    os << std::left << std::setw(14) << pipelineStageToString(static_cast<PipelineStage>(stage))
+       << std::right << std::setw(11) << s.count
+       << std::setw(12) << s.p50 << std::setw(12) << s.p99
+       << std::setw(12) << s.p999 << std::setw(12) << s.max << "\n";
+  }
+  os << std::endl;
+  return os;
+}
+
+} // namespace simple_router
@@ -0,0 +1,254 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * This header file defines cycle-counter based timing of the packet pipeline stages.
+ */
+
+#ifndef SIMPLE_ROUTER_CORE_LATENCY_HPP
+#define SIMPLE_ROUTER_CORE_LATENCY_HPP
+
+#include "protocol.hpp"
+#include "thread-blocks.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <ostream>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+namespace simple_router {
+
+enum PipelineStage {
+  STAGE_TOTAL,        //< Whole handlePacket call, or its share of a handlePackets call
+  STAGE_ARP_INPUT,    //< handleARP
+  STAGE_IP_VALIDATE,  //< IPv4 header validation and TTL/checksum update
+  STAGE_ROUTE_LOOKUP, //< RoutingTable::lookup
+  STAGE_ARP_LOOKUP,   //< ArpCache::lookup
+  STAGE_SEND,         //< sendPacket hand-off to the transport or the output queue
+  N_PIPELINE_STAGES
+};
+
+const char*
+pipelineStageToString(PipelineStage stage);
+
+/**
+ * Read the CPU cycle counter (or a nanosecond clock where there is none)
+ */
+inline uint64_t
+readCycles()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+/**
+ * Number of readCycles() ticks per nanosecond, measured once against steady_clock
+ */
+double
+getCyclesPerNanosecond();
+
+/**
+ * Log-linear (HDR-style) histogram of cycle counts: values below 16 have exact
+ * buckets, larger values 16 buckets per power of two (about 6% resolution).
+ */
+struct LatencyHistogram
+{
+  static const size_t SUB_BUCKET_BITS = 4;
+  static const size_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+  static const size_t N_BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+  static size_t
+  bucketOf(uint64_t value)
+  {
+    if (value < SUB_BUCKETS) {
+      return value;
+    }
+    size_t msb = 63 - __builtin_clzll(value);
+    size_t magnitude = msb - SUB_BUCKET_BITS + 1;
+    return magnitude * SUB_BUCKETS + ((value >> (msb - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1));
+  }
+
+  /**
+   * Smallest value that falls into \p bucket
+   */
+  static uint64_t
+  lowestValueOf(size_t bucket)
+  {
+    size_t magnitude = bucket / SUB_BUCKETS;
+    uint64_t sub = bucket % SUB_BUCKETS;
+    if (magnitude == 0) {
+      return sub;
+    }
+    return (SUB_BUCKETS + sub) << (magnitude - 1);
+  }
+
+  uint64_t counts[N_BUCKETS] = {};
+};
+
+/**
+ * Percentiles of one stage, in nanoseconds
+ */
+struct StageLatency
+{
+  uint64_t count = 0;
+  double p50 = 0;
+  double p99 = 0;
+  double p999 = 0;
+  double max = 0;
+};
+
+struct LatencySnapshot
+{
+  bool isEnabled = false;
+  StageLatency stages[N_PIPELINE_STAGES];
+};
+
+std::ostream&
+operator<<(std::ostream& os, const LatencySnapshot& latency);
+
+/**
+ * Per-stage latency histograms of the packet pipeline
+ *
+ * Each thread records into its own set of histograms (plain relaxed stores, no
+ * sharing).  While disabled, start() is a single relaxed load and record() does
+ * nothing.  reset() does not touch the per-thread histograms: it remembers their
+ * current sum and later reports are relative to it.
+ */
+class LatencyRecorder
+{
+public:
+  LatencyRecorder();
+
+  void
+  setEnabled(bool isEnabled);
+
+  bool
+  isEnabled() const;
+
+  /**
+   * Timestamp to pass to record(), or 0 if timing is disabled
+   */
+  uint64_t
+  start() const;
+
+  /**
+   * Record the time elapsed since \p startCycles (as returned by start()) for \p stage
+   */
+  void
+  record(PipelineStage stage, uint64_t startCycles);
+
+  /**
+   * Record \p count samples of the time elapsed since \p startCycles divided by \p count,
+   * i.e. the per-packet cost of a stage run over a vector of \p count packets
+   */
+  void
+  record(PipelineStage stage, uint64_t startCycles, size_t count);
+
+  void
+  reset();
+
+  LatencySnapshot
+  aggregate() const;
+
+private:
+  struct Block
+  {
+    std::atomic<uint64_t> counts[N_PIPELINE_STAGES][LatencyHistogram::N_BUCKETS];
+  };
+
+  static Block*
+  newBlock();
+
+  void
+  sum(LatencyHistogram* histograms) const;
+
+private:
+  ThreadBlocks<Block> m_blocks;
+  std::atomic<bool> m_isEnabled;
+  mutable std::mutex m_mutex;
+  std::vector<LatencyHistogram> m_baseline;
+};
+
+/**
+ * Records the lifetime of the scope as \p stage
+ */
+class LatencyScope
+{
+public:
+  LatencyScope(LatencyRecorder& recorder, PipelineStage stage)
+    : m_recorder(recorder)
+    , m_stage(stage)
+    , m_start(recorder.start())
+  {
+  }
+
+  ~LatencyScope()
+  {
+    m_recorder.record(m_stage, m_start);
+  }
+
+private:
+  LatencyRecorder& m_recorder;
+  PipelineStage m_stage;
+  uint64_t m_start;
+};
+
+inline bool
+LatencyRecorder::isEnabled() const
+{
+  return m_isEnabled.load(std::memory_order_relaxed);
+}
+
+inline uint64_t
+LatencyRecorder::start() const
+{
+  return isEnabled() ? readCycles() : 0;
+}
+
+inline void
+LatencyRecorder::record(PipelineStage stage, uint64_t startCycles)
+{
+  if (startCycles == 0) {
+    return;
+  }
+
+  uint64_t elapsed = readCycles() - startCycles;
+  std::atomic<uint64_t>& counter = m_blocks.get().counts[stage][LatencyHistogram::bucketOf(elapsed)];
+  counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+inline void
+LatencyRecorder::record(PipelineStage stage, uint64_t startCycles, size_t count)
+{
+  if (startCycles == 0 || count == 0) {
+    return;
+  }
+  uint64_t elapsed = (readCycles() - startCycles) / count;
+  std::atomic<uint64_t>& counter = m_blocks.get().counts[stage][LatencyHistogram::bucketOf(elapsed)];
+  counter.store(counter.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+}
+
+} // namespace simple_router
+
+#endif // SIMPLE_ROUTER_CORE_LATENCY_HPP
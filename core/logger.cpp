@@ -0,0 +1,339 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "logger.hpp"
+#include "utils.hpp"
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <streambuf>
+#include <thread>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace simple_router {
+namespace logging {
+
+std::atomic<int> g_level(LEVEL_INFO);
+
+static const size_t MAX_MESSAGE = 240;
+static const uint32_t RING_SIZE = 1024; // per thread, power of two
+
+struct Entry
+{
+  uint64_t timestamp; //< nanoseconds since the epoch
+  uint32_t level;
+  uint32_t length;
+  char text[MAX_MESSAGE];
+};
+
+/**
+ * Single-producer (the owning thread), single-consumer (the flusher) ring
+ */
+struct ThreadRing
+{
+  Entry entries[RING_SIZE];
+  char pad0[64];
+  std::atomic<uint32_t> head{0};
+  char pad1[64];
+  std::atomic<uint32_t> tail{0};
+  std::atomic<uint64_t> dropped{0};
+};
+
+/**
+ * Stream buffer over a fixed array; text beyond the array is discarded
+ */
+class FixedStreamBuf : public std::streambuf
+{
+public:
+  void
+  reset()
+  {
+    setp(m_buffer, m_buffer + MAX_MESSAGE);
+  }
+
+  size_t
+  size() const
+  {
+    return pptr() - pbase();
+  }
+
+  const char*
+  data() const
+  {
+    return m_buffer;
+  }
+
+protected:
+  int_type
+  overflow(int_type c) override
+  {
+    return traits_type::not_eof(c);
+  }
+
+private:
+  char m_buffer[MAX_MESSAGE];
+};
+
+class Logger
+{
+public:
+  Logger()
+    : m_dropped(0)
+    , m_thread(&Logger::run, this)
+  {
+    m_thread.detach();
+  }
+
+  std::shared_ptr<ThreadRing>
+  registerThread()
+  {
+    auto ring = std::make_shared<ThreadRing>();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_rings.push_back(ring);
+    return ring;
+  }
+
+  /**
+   * Write out everything queued in all rings, ordered by timestamp
+   */
+  void
+  collect()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    struct Item {
+      const Entry* entry;
+      ThreadRing* ring;
+    };
+    std::vector<Item> items;
+    std::vector<uint32_t> heads(m_rings.size());
+
+    for (size_t i = 0; i < m_rings.size(); ++i) {
+      ThreadRing* ring = m_rings[i].get();
+      heads[i] = ring->head.load(std::memory_order_acquire);
+      for (uint32_t pos = ring->tail.load(std::memory_order_relaxed); pos != heads[i]; ++pos) {
+        items.push_back({&ring->entries[pos & (RING_SIZE - 1)], ring});
+      }
+      m_dropped += ring->dropped.exchange(0, std::memory_order_relaxed);
+    }
+
+    std::stable_sort(items.begin(), items.end(), [] (const Item& a, const Item& b) {
+        return a.entry->timestamp < b.entry->timestamp;
+      });
+
+    static const char* names[] = {"TRACE", "DEBUG", "INFO", "WARN", "ERROR"};
+    m_out.clear();
+    for (const auto& item : items) {
+      time_t seconds = item.entry->timestamp / 1000000000;
+      tm local;
+      localtime_r(&seconds, &local);
+      char prefix[48];
+      int n = snprintf(prefix, sizeof(prefix), "%02d:%02d:%02d.%06u %-5s ",
+                       local.tm_hour, local.tm_min, local.tm_sec,
+                       static_cast<unsigned>(item.entry->timestamp % 1000000000 / 1000),
+                       names[item.entry->level]);
+      m_out.append(prefix, n);
+      m_out.append(item.entry->text, item.entry->length);
+      m_out.push_back('\n');
+    }
+
+    if (m_dropped > m_reportedDropped) {
+      m_out += "WARN: " + std::to_string(m_dropped - m_reportedDropped) +
+        " log messages dropped (ring full)\n";
+      m_reportedDropped = m_dropped;
+    }
+
+    for (size_t written = 0; written < m_out.size(); ) {
+      ssize_t n = ::write(STDERR_FILENO, m_out.data() + written, m_out.size() - written);
+      if (n <= 0) {
+        break;
+      }
+      written += n;
+    }
+
+    // release the slots and forget rings of threads that have exited
+    for (size_t i = 0; i < m_rings.size(); ++i) {
+      m_rings[i]->tail.store(heads[i], std::memory_order_release);
+    }
+    m_rings.erase(std::remove_if(m_rings.begin(), m_rings.end(),
+                                 [] (const std::shared_ptr<ThreadRing>& ring) {
+                                   return ring.use_count() == 1;
+                                 }),
+                  m_rings.end());
+  }
+
+  uint64_t
+  getDropped()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_dropped;
+  }
+
+private:
+  void
+  run()
+  {
+    for (;;) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      collect();
+    }
+  }
+
+private:
+  std::mutex m_mutex;
+  std::vector<std::shared_ptr<ThreadRing>> m_rings;
+  std::string m_out;
+  uint64_t m_dropped;
+  uint64_t m_reportedDropped = 0;
+  std::thread m_thread;
+};
+
+static void
+flushAtExit()
+{
+  flush();
+}
+
+static Logger&
+getLogger()
+{
+  // never destroyed, so that threads can log during static destruction
+  static Logger* logger = [] {
+    Logger* l = new Logger;
+    atexit(&flushAtExit);
+    return l;
+  }();
+  return *logger;
+}
+
+struct ThreadState
+{
+  ThreadState()
+    : ring(getLogger().registerThread())
+    , os(&buffer)
+  {
+  }
+
+  std::shared_ptr<ThreadRing> ring;
+  FixedStreamBuf buffer;
+  std::ostream os;
+};
+
+static ThreadState&
+getThreadState()
+{
+  static thread_local ThreadState state;
+  return state;
+}
+
+static void
+push(Level level, const char* text, size_t length)
+{
+  ThreadRing& ring = *getThreadState().ring;
+
+  uint32_t head = ring.head.load(std::memory_order_relaxed);
+  if (head - ring.tail.load(std::memory_order_acquire) >= RING_SIZE) {
+    ring.dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  Entry& entry = ring.entries[head & (RING_SIZE - 1)];
+  timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  entry.timestamp = static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+  entry.level = level;
+  entry.length = std::min(length, MAX_MESSAGE);
+  memcpy(entry.text, text, entry.length);
+  ring.head.store(head + 1, std::memory_order_release);
+}
+
+void
+setLevel(Level level)
+{
+  g_level.store(level, std::memory_order_relaxed);
+}
+
+Level
+parseLevel(const std::string& name)
+{
+  static const char* names[] = {"trace", "debug", "info", "warn", "error", "none"};
+  for (int level = LEVEL_TRACE; level <= LEVEL_NONE; ++level) {
+    if (name == names[level]) {
+      return static_cast<Level>(level);
+    }
+  }
+  throw std::invalid_argument("Unknown log level `" + name + "`");
+}
+
+void
+flush()
+{
+  getLogger().collect();
+}
+
+uint64_t
+getDropped()
+{
+  return getLogger().getDropped();
+}
+
+Record::Record(Level level)
+  : m_level(level)
+{
+  getThreadState().buffer.reset();
+}
+
+Record::~Record()
+{
+  const FixedStreamBuf& buffer = getThreadState().buffer;
+  push(m_level, buffer.data(), buffer.size());
+}
+
+std::ostream&
+Record::stream()
+{
+  return getThreadState().os;
+}
+
+void
+logHeaders(Level level, const uint8_t* buf, uint32_t length)
+{
+  char* text = nullptr;
+  size_t size = 0;
+  FILE* out = open_memstream(&text, &size);
+  if (out == nullptr) {
+    return;
+  }
+  print_hdrs(buf, length, out);
+  fclose(out);
+
+  for (const char* line = text; line < text + size; ) {
+    const char* end = static_cast<const char*>(memchr(line, '\n', text + size - line));
+    if (end == nullptr) {
+      end = text + size;
+    }
+    push(level, line, end - line);
+    line = end + 1;
+  }
+  free(text);
+}
+
+} // namespace logging
+} // namespace simple_router
@@ -0,0 +1,154 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * This header file defines the leveled, asynchronous logging facility.
+ *
+ * Messages below SR_LOG_MIN_LEVEL are removed at compile time.  The remaining ones
+ * are checked against the runtime level before any argument is evaluated; enabled
+ * messages are formatted on the calling thread into a per-thread lock-free ring and
+ * written to stderr in batches by a background thread.
+ *
+ *     SR_LOG_DEBUG("Got packet of size " << packet.size() << " on " << inIface);
+ */
+
+#ifndef SIMPLE_ROUTER_CORE_LOGGER_HPP
+#define SIMPLE_ROUTER_CORE_LOGGER_HPP
+
+#include "protocol.hpp"
+
+#include <atomic>
+#include <ostream>
+
+#define SR_LOG_LEVEL_TRACE 0
+#define SR_LOG_LEVEL_DEBUG 1
+#define SR_LOG_LEVEL_INFO  2
+#define SR_LOG_LEVEL_WARN  3
+#define SR_LOG_LEVEL_ERROR 4
+#define SR_LOG_LEVEL_NONE  5
+
+#ifndef SR_LOG_MIN_LEVEL
+#define SR_LOG_MIN_LEVEL SR_LOG_LEVEL_DEBUG
+#endif
+
+namespace simple_router {
+namespace logging {
+
+enum Level {
+  LEVEL_TRACE = SR_LOG_LEVEL_TRACE,
+  LEVEL_DEBUG = SR_LOG_LEVEL_DEBUG,
+  LEVEL_INFO = SR_LOG_LEVEL_INFO,
+  LEVEL_WARN = SR_LOG_LEVEL_WARN,
+  LEVEL_ERROR = SR_LOG_LEVEL_ERROR,
+  LEVEL_NONE = SR_LOG_LEVEL_NONE,
+};
+
+extern std::atomic<int> g_level;
+
+/**
+ * Check whether messages of \p level are currently written
+ */
+inline bool
+isEnabled(Level level)
+{
+  return level >= g_level.load(std::memory_order_relaxed);
+}
+
+/**
+ * Set the runtime log level
+ */
+void
+setLevel(Level level);
+
+/**
+ * Parse level name (trace, debug, info, warn, error, none)
+ *
+ * @throw std::invalid_argument if the name is not known
+ */
+Level
+parseLevel(const std::string& name);
+
+/**
+ * Block until all messages logged so far have been written
+ */
+void
+flush();
+
+/**
+ * Number of messages lost because a thread's ring was full
+ */
+uint64_t
+getDropped();
+
+/**
+ * One log message being formatted.  The text is written into a thread-local buffer
+ * and handed to the ring when the record goes out of scope.
+ */
+class Record
+{
+public:
+  explicit
+  Record(Level level);
+
+  ~Record();
+
+  std::ostream&
+  stream();
+
+private:
+  Level m_level;
+};
+
+/**
+ * Log the headers of \p length bytes at \p buf, one message per line
+ */
+void
+logHeaders(Level level, const uint8_t* buf, uint32_t length);
+
+} // namespace logging
+} // namespace simple_router
+
+#define SR_LOG(level, expr)                                              \
+  do {                                                                   \
+    if (level >= SR_LOG_MIN_LEVEL &&                                     \
+        ::simple_router::logging::isEnabled(level)) {                    \
+      ::simple_router::logging::Record record__(level);                  \
+      record__.stream() << expr;                                         \
+    }                                                                    \
+  } while (false)
+
+#define SR_LOG_TRACE(expr) SR_LOG(::simple_router::logging::LEVEL_TRACE, expr)
+#define SR_LOG_DEBUG(expr) SR_LOG(::simple_router::logging::LEVEL_DEBUG, expr)
+#define SR_LOG_INFO(expr)  SR_LOG(::simple_router::logging::LEVEL_INFO, expr)
+#define SR_LOG_WARN(expr)  SR_LOG(::simple_router::logging::LEVEL_WARN, expr)
+#define SR_LOG_ERROR(expr) SR_LOG(::simple_router::logging::LEVEL_ERROR, expr)
+
+/**
+ * Dump headers of the \p size byte frame at \p frame (as print_hdrs does) at trace level
+ */
+#define SR_LOG_TRACE_FRAME(frame, size)                                  \
+  do {                                                                   \
+    if (SR_LOG_LEVEL_TRACE >= SR_LOG_MIN_LEVEL &&                        \
+        ::simple_router::logging::isEnabled(                             \
+          ::simple_router::logging::LEVEL_TRACE)) {                      \
+      ::simple_router::logging::logHeaders(                              \
+        ::simple_router::logging::LEVEL_TRACE, (frame), (size));         \
+    }                                                                    \
+  } while (false)
+
+/**
+ * Dump headers of a Buffer (as print_hdrs does) at trace level
+ */
+#define SR_LOG_TRACE_HDRS(buffer) SR_LOG_TRACE_FRAME((buffer).data(), (buffer).size())
+
+#endif // SIMPLE_ROUTER_CORE_LOGGER_HPP
@@ -15,6 +15,8 @@
  */
 
 #include "simple-router.hpp"
+#include "core/logger.hpp"
+#include "core/table-dump.hpp"
 
 #include <Ice/Ice.h>
 #include <IceUtil/IceUtil.h>
@@ -30,9 +32,10 @@ public:
   }
 
   void
-  handlePacket(const pox::Buffer& packet, const std::string& inIface, const ::Ice::Current&) override
+  handlePacket(const std::pair<const ::Ice::Byte*, const ::Ice::Byte*>& packet, const std::string& inIface,
+               const ::Ice::Current&) override
   {
-    m_router.handlePacket(packet, inIface);
+    m_router.handlePacket(packet.first, packet.second - packet.first, inIface);
   }
 
   void
@@ -50,6 +53,12 @@ class Tester : public pox::Tester
 public:
   Tester(SimpleRouter& router)
     : m_router(router)
+    , m_arpDumps(ARP_DUMP_RECORD_SIZE, [&router] (Buffer& records) {
+        encodeArpEntries(router.getArp().getEntries(), steady_clock::now(), records);
+      })
+    , m_routeDumps(ROUTE_DUMP_RECORD_SIZE, [&router] (Buffer& records) {
+        encodeRoutingEntries(router.getRoutingTable().getEntries(), records);
+      })
   {
   }
 
@@ -61,6 +70,14 @@ public:
     return os.str();
   }
 
+  std::string
+  getNeighbors(const ::Ice::Current&) override
+  {
+    std::ostringstream os;
+    os << m_router.getNeighbors();
+    return os.str();
+  }
+
   std::string
   getRoutingTable(const ::Ice::Current&) override
   {
@@ -69,8 +86,95 @@ public:
     return os.str();
   }
 
+  std::string
+  getStats(const ::Ice::Current&) override
+  {
+    std::ostringstream os;
+    os << m_router.getStats().aggregate() << m_router.getIcmp();
+    if (m_router.getCapture() != nullptr) {
+      os << *m_router.getCapture();
+    }
+    if (m_router.getFlows() != nullptr) {
+      os << *m_router.getFlows();
+    }
+    if (m_router.getPolicer() != nullptr) {
+      os << *m_router.getPolicer();
+    }
+    if (m_router.getAcl() != nullptr) {
+      os << *m_router.getAcl();
+    }
+    if (m_router.getNapt() != nullptr) {
+      os << *m_router.getNapt();
+    }
+    if (m_router.getOutputQueues() != nullptr) {
+      os << *m_router.getOutputQueues();
+    }
+    return os.str();
+  }
+
+  std::string
+  getLatency(const ::Ice::Current&) override
+  {
+    std::ostringstream os;
+    os << m_router.getLatency().aggregate();
+    return os.str();
+  }
+
+  void
+  resetLatency(const ::Ice::Current&) override
+  {
+    m_router.getLatency().reset();
+  }
+
+  void
+  setLatencyEnabled(bool isEnabled, const ::Ice::Current&) override
+  {
+    m_router.getLatency().setEnabled(isEnabled);
+  }
+
+  std::string
+  getFlightRecorder(::Ice::Int maxRecords, const ::Ice::Current&) override
+  {
+    std::ostringstream os;
+    m_router.getFlightRecorder().print(os, std::max(maxRecords, 0));
+    return os.str();
+  }
+
+  pox::DumpPage
+  dumpArp(::Ice::Long cursor, ::Ice::Int maxRecords, const ::Ice::Current&) override
+  {
+    return dump(m_arpDumps, cursor, maxRecords);
+  }
+
+  pox::DumpPage
+  dumpRoutingTable(::Ice::Long cursor, ::Ice::Int maxRecords, const ::Ice::Current&) override
+  {
+    return dump(m_routeDumps, cursor, maxRecords);
+  }
+
+private:
+  static pox::DumpPage
+  dump(DumpCursors& cursors, ::Ice::Long cursor, ::Ice::Int maxRecords)
+  {
+    DumpCursors::Page page;
+    try {
+      page = cursors.next(static_cast<uint64_t>(cursor), std::max(maxRecords, 0));
+    }
+    catch (const std::out_of_range&) {
+      throw pox::InvalidCursor();
+    }
+
+    pox::DumpPage result;
+    result.cursor = static_cast<::Ice::Long>(page.cursor);
+    result.recordSize = static_cast<::Ice::Int>(cursors.getRecordSize());
+    result.records.swap(page.records);
+    return result;
+  }
+
 private:
   SimpleRouter& m_router;
+  DumpCursors m_arpDumps;
+  DumpCursors m_routeDumps;
 };
 
 class Router : public Ice::Application
@@ -79,10 +183,50 @@ public:
   int
   run(int, char*[]) override
   {
-    auto rtFile = communicator()->getProperties()->getPropertyWithDefault("RoutingTable", "RTABLE");
-    if (!m_router.loadRoutingTable(rtFile)) {
-      std::cerr << "ERROR: Cannot load routing table from `" << rtFile << "`" << std::endl;
-      return EXIT_FAILURE;
+    auto properties = communicator()->getProperties();
+    logging::setLevel(logging::parseLevel(properties->getPropertyWithDefault("Log.Level", "info")));
+
+    auto sharedFib = properties->getProperty("RoutingTable.SharedMemory");
+    bool isFibPublisher = properties->getPropertyAsIntWithDefault("RoutingTable.SharedMemory.Publish", 0) != 0;
+    if (!sharedFib.empty() && !isFibPublisher) {
+      try {
+        m_router.getRoutingTable().attachShared(sharedFib);
+      }
+      catch (const std::runtime_error& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+      }
+      SR_LOG_INFO("Attached shared FIB `" << sharedFib << "` generation "
+                  << m_router.getRoutingTable().getSharedGeneration());
+    }
+    else {
+      auto rtFile = communicator()->getProperties()->getPropertyWithDefault("RoutingTable", "RTABLE");
+      if (!m_router.loadRoutingTable(rtFile)) {
+        std::cerr << "ERROR: Cannot load routing table from `" << rtFile << "`" << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      if (properties->getPropertyAsIntWithDefault("RoutingTable.Compress", 0) != 0) {
+        auto& table = m_router.getRoutingTable();
+        size_t before = table.size();
+        if (table.compress()) {
+          SR_LOG_INFO("Compressed routing table from " << before << " to " << table.size() << " prefixes");
+        }
+        else {
+          SR_LOG_WARN("Routing table has non-contiguous masks, not compressing it");
+        }
+      }
+
+      if (!sharedFib.empty()) {
+        try {
+          uint64_t generation = m_router.getRoutingTable().publishShared(sharedFib);
+          SR_LOG_INFO("Published shared FIB `" << sharedFib << "` generation " << generation);
+        }
+        catch (const std::runtime_error& e) {
+          std::cerr << "ERROR: " << e.what() << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
     }
 
     m_router.m_pox = pox::PacketInjectorPrx::checkedCast(communicator()
@@ -96,6 +240,139 @@ public:
 
     auto ifFile = communicator()->getProperties()->getPropertyWithDefault("Ifconfig", "IP_CONFIG");
     m_router.loadIfconfig(ifFile);
+    m_router.loadIfconfig6(properties->getPropertyWithDefault("Ifconfig6", "IP6_CONFIG"));
+
+    PacketCapture::Config capture;
+    capture.file = properties->getProperty("Capture.File");
+    if (!capture.file.empty()) {
+      capture.snaplen = properties->getPropertyAsIntWithDefault("Capture.Snaplen", capture.snaplen);
+      capture.sampleRate = properties->getPropertyAsIntWithDefault("Capture.SampleRate", capture.sampleRate);
+      capture.ringSize = properties->getPropertyAsIntWithDefault("Capture.RingSize", capture.ringSize);
+      capture.rotateBytes = properties->getPropertyAsIntWithDefault("Capture.RotateMegabytes",
+                                                                    capture.rotateBytes >> 20);
+      capture.rotateBytes <<= 20;
+      capture.maxFiles = properties->getPropertyAsIntWithDefault("Capture.MaxFiles", capture.maxFiles);
+      try {
+        m_router.enableCapture(capture);
+      }
+      catch (const std::runtime_error& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    m_router.getLatency().setEnabled(properties->getPropertyAsIntWithDefault("Latency.Enabled", 0) != 0);
+
+    FlightRecorder::Config flight;
+    flight.sampleRate = properties->getPropertyAsIntWithDefault("FlightRecorder.SampleRate", flight.sampleRate);
+    flight.ringSize = properties->getPropertyAsIntWithDefault("FlightRecorder.RingSize", flight.ringSize);
+    m_router.getFlightRecorder().configure(flight);
+    auto flightDumpFile = properties->getProperty("FlightRecorder.DumpFile");
+    if (!flightDumpFile.empty()) {
+      m_router.getFlightRecorder().enableSignalDump(flightDumpFile);
+    }
+
+    IcmpResponder::Config icmp;
+    icmp.isEnabled = properties->getPropertyAsIntWithDefault("Icmp.Enabled", 1) != 0;
+    icmp.globalRate = properties->getPropertyAsIntWithDefault("Icmp.GlobalRate", icmp.globalRate);
+    icmp.globalBurst = properties->getPropertyAsIntWithDefault("Icmp.GlobalBurst", icmp.globalBurst);
+    icmp.perDestRate = properties->getPropertyAsIntWithDefault("Icmp.PerDestinationRate", icmp.perDestRate);
+    icmp.perDestBurst = properties->getPropertyAsIntWithDefault("Icmp.PerDestinationBurst", icmp.perDestBurst);
+    m_router.getIcmp().configure(icmp);
+
+    if (properties->getPropertyAsIntWithDefault("Flow.Enabled", 0) != 0) {
+      FlowTable::Config flows;
+      flows.nBuckets = properties->getPropertyAsIntWithDefault("Flow.Buckets", flows.nBuckets);
+      flows.idleTimeoutSec = properties->getPropertyAsIntWithDefault("Flow.IdleTimeoutSec", flows.idleTimeoutSec);
+      flows.activeTimeoutSec = properties->getPropertyAsIntWithDefault("Flow.ActiveTimeoutSec",
+                                                                       flows.activeTimeoutSec);
+      flows.sampleRate = properties->getPropertyAsIntWithDefault("Flow.SampleRate", flows.sampleRate);
+      flows.batchSize = properties->getPropertyAsIntWithDefault("Flow.BatchSize", flows.batchSize);
+      flows.file = properties->getProperty("Flow.ExportFile");
+      flows.collector = properties->getProperty("Flow.Collector");
+      try {
+        m_router.enableFlowExport(flows);
+      }
+      catch (const std::runtime_error& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    auto aclFile = properties->getProperty("Acl.File");
+    if (!aclFile.empty()) {
+      auto interval = properties->getPropertyAsIntWithDefault("Acl.ReloadIntervalSec", 0);
+      try {
+        m_router.loadAcl(aclFile, std::chrono::seconds(interval));
+      }
+      catch (const std::runtime_error& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    auto naptOutside = properties->getProperty("Nat.OutsideInterface");
+    if (!naptOutside.empty()) {
+      NaptTable::Config napt;
+      auto address = properties->getProperty("Nat.Address");
+      in_addr externalAddress;
+      if (!address.empty() && inet_aton(address.c_str(), &externalAddress) == 0) {
+        std::cerr << "ERROR: Invalid Nat.Address `" << address << "`" << std::endl;
+        return EXIT_FAILURE;
+      }
+      napt.address = address.empty() ? 0 : externalAddress.s_addr;
+      napt.portMin = properties->getPropertyAsIntWithDefault("Nat.PortMin", napt.portMin);
+      napt.portMax = properties->getPropertyAsIntWithDefault("Nat.PortMax", napt.portMax);
+      napt.nShards = properties->getPropertyAsIntWithDefault("Nat.Shards", napt.nShards);
+      napt.maxTranslations = properties->getPropertyAsIntWithDefault("Nat.MaxTranslations", napt.maxTranslations);
+      napt.udpTimeoutSec = properties->getPropertyAsIntWithDefault("Nat.UdpTimeoutSec", napt.udpTimeoutSec);
+      napt.tcpTimeoutSec = properties->getPropertyAsIntWithDefault("Nat.TcpTimeoutSec", napt.tcpTimeoutSec);
+      napt.tcpTransitoryTimeoutSec = properties->getPropertyAsIntWithDefault("Nat.TcpTransitoryTimeoutSec",
+                                                                             napt.tcpTransitoryTimeoutSec);
+      napt.icmpTimeoutSec = properties->getPropertyAsIntWithDefault("Nat.IcmpTimeoutSec", napt.icmpTimeoutSec);
+      try {
+        m_router.enableNapt(naptOutside, napt);
+      }
+      catch (const std::invalid_argument& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    auto policerFile = properties->getProperty("Policer.File");
+    if (!policerFile.empty()) {
+      try {
+        m_router.loadPolicer(policerFile);
+      }
+      catch (const std::runtime_error& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    if (properties->getPropertyAsIntWithDefault("Queue.Enabled", 0) != 0) {
+      OutputQueue::Config queue;
+      queue.rateBps = properties->getPropertyAsIntWithDefault("Queue.RateMbps", 0) * 1e6;
+      for (size_t c = 0; c < N_TRAFFIC_CLASSES; ++c) {
+        std::string prefix = std::string("Queue.") + trafficClassToString(static_cast<TrafficClass>(c));
+        queue.limitBytes[c] = properties->getPropertyAsIntWithDefault(prefix + ".LimitBytes",
+                                                                      queue.limitBytes[c]);
+        queue.quantum[c] = properties->getPropertyAsIntWithDefault(prefix + ".Quantum", queue.quantum[c]);
+      }
+      m_router.enableOutputQueues(queue);
+    }
+
+    auto statsSegment = properties->getProperty("Stats.SharedMemory");
+    if (!statsSegment.empty()) {
+      auto interval = properties->getPropertyAsIntWithDefault("Stats.PublishIntervalMs", 1000);
+      m_router.enableStatsExport(statsSegment, std::chrono::milliseconds(interval));
+    }
+
+    auto warmRestartFile = properties->getProperty("WarmRestart.File");
+    if (!warmRestartFile.empty()) {
+      auto interval = properties->getPropertyAsIntWithDefault("WarmRestart.IntervalSec", 10);
+      m_router.enableWarmRestart(warmRestartFile, std::chrono::seconds(interval));
+    }
 
     Ice::ObjectAdapterPtr adapter = communicator()->createObjectAdapter("");
     Ice::Identity ident;
@@ -0,0 +1,719 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "napt.hpp"
+#include "checksum.hpp"
+#include "icmp.hpp"
+#include "utils.hpp"
+
+#include <functional>
+#include <stdexcept>
+
+#include <string.h>
+#include <sys/mman.h>
+
+namespace simple_router {
+
+/**
+ * Chain links a lock-free lookup follows before it suspects it was led astray and
+ * retries; chains average below one entry
+ */
+static const size_t MAX_LOCK_FREE_HOPS = 64;
+static const int MAX_LOCK_FREE_ATTEMPTS = 3;
+
+/**
+ * expire() checks every translation within this many ticks, a second apart, and at
+ * most EXPIRE_BATCH entries of a shard per hold of its mutex
+ */
+static const uint32_t EXPIRE_SWEEP_TICKS = 10;
+static const uint32_t EXPIRE_BATCH = 1024;
+
+static const uint8_t TCP_FIN = 0x01;
+static const uint8_t TCP_SYN = 0x02;
+static const uint8_t TCP_RST = 0x04;
+
+static uint16_t
+load16(const uint8_t* data)
+{
+  uint16_t value;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+static void
+store16(uint8_t* data, uint16_t value)
+{
+  memcpy(data, &value, sizeof(value));
+}
+
+/**
+ * Finalizer of MurmurHash3: every bit of the result depends on every bit of the key,
+ * as both the shard and the chain are taken from the hash of keys that mostly differ
+ * in a few bytes of an address or port
+ */
+static uint64_t
+mix(uint64_t hash)
+{
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdull;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ull;
+  return hash ^ (hash >> 33);
+}
+
+static uint64_t
+hashOutbound(uint8_t protocol, uint32_t insideAddr, uint16_t insidePort, uint32_t remoteAddr,
+             uint16_t remotePort)
+{
+  uint64_t addresses = (uint64_t(insideAddr) << 32) | remoteAddr;
+  uint64_t rest = (uint64_t(insidePort) << 24) | (uint64_t(remotePort) << 8) | protocol;
+  return mix(addresses ^ mix(rest));
+}
+
+static uint64_t
+hashInbound(uint8_t protocol, uint32_t remoteAddr, uint16_t remotePort, uint16_t externalPort)
+{
+  uint64_t key = (uint64_t(remoteAddr) << 32) | (uint64_t(externalPort) << 16) | remotePort;
+  return mix(key ^ (uint64_t(protocol) << 56));
+}
+
+/**
+ * Shard of an outbound flow; the low bits of the hash select its chain
+ */
+static size_t
+shardOfHash(uint64_t hash, size_t shardMask)
+{
+  return (hash >> 40) & shardMask;
+}
+
+/**
+ * Transport header of \p ip if the NAPT translates it: TCP, UDP, or an ICMP echo request
+ * (\p isOutbound) or reply, not a non-initial fragment and long enough for its ports
+ * and checksum.  Sets \p checksumOffset to the offset of the checksum in it.
+ */
+static uint8_t*
+findTransport(ip_hdr* ip, size_t len, bool isOutbound, size_t& checksumOffset)
+{
+  size_t headerLen = ip->ip_hl * 4;
+  len = std::min<size_t>(len, ntohs(ip->ip_len));
+  if ((ntohs(ip->ip_off) & IP_OFFMASK) != 0 || headerLen < sizeof(ip_hdr)) {
+    return nullptr;
+  }
+
+  uint8_t* transport = reinterpret_cast<uint8_t*>(ip) + headerLen;
+  switch (ip->ip_p) {
+  case ip_protocol_tcp:
+    checksumOffset = 16;
+    return len >= headerLen + 20 ? transport : nullptr;
+  case ip_protocol_udp:
+    checksumOffset = 6;
+    return len >= headerLen + 8 ? transport : nullptr;
+  case ip_protocol_icmp:
+    checksumOffset = 2;
+    if (len < headerLen + 8 || transport[0] != (isOutbound ? ICMP_ECHO_REQUEST : ICMP_ECHO_REPLY)) {
+      return nullptr;
+    }
+    return transport;
+  default:
+    return nullptr;
+  }
+}
+
+/**
+ * Whether \p ip is an ICMP error, which quotes the header of the datagram it is about
+ */
+static bool
+isIcmpError(const ip_hdr* ip, size_t len)
+{
+  size_t headerLen = ip->ip_hl * 4;
+  if (ip->ip_p != ip_protocol_icmp || (ntohs(ip->ip_off) & IP_OFFMASK) != 0 ||
+      std::min<size_t>(len, ntohs(ip->ip_len)) <= headerLen) {
+    return false;
+  }
+  uint8_t type = reinterpret_cast<const uint8_t*>(ip)[headerLen];
+  return type == ICMP_DEST_UNREACHABLE || type == ICMP_TIME_EXCEEDED || type == ICMP_PARAMETER_PROBLEM;
+}
+
+/**
+ * Replace the source (\p isSource) or destination address of \p ip, updating its
+ * header checksum incrementally (RFC 1624)
+ */
+static void
+rewriteAddress(ip_hdr* ip, bool isSource, uint32_t newAddress)
+{
+  uint32_t oldAddress = isSource ? ip->ip_src : ip->ip_dst;
+  ip->ip_sum = checksumAdjust(checksumAdjust(ip->ip_sum, oldAddress, newAddress),
+                              oldAddress >> 16, newAddress >> 16);
+  if (isSource) {
+    ip->ip_src = newAddress;
+  }
+  else {
+    ip->ip_dst = newAddress;
+  }
+}
+
+/**
+ * Replace the source (\p isSource) or destination address of \p ip, and the transport
+ * port at \p port, updating the IP and the transport checksum at \p checksum (none if
+ * nullptr, as in a truncated quote) incrementally
+ */
+static void
+rewrite(ip_hdr* ip, bool isSource, uint32_t newAddress, uint8_t* port, uint16_t newPort,
+        uint8_t* checksum)
+{
+  uint32_t oldAddress = isSource ? ip->ip_src : ip->ip_dst;
+  uint16_t oldPort = load16(port);
+
+  // a UDP checksum of zero means there is none; ICMP has no pseudo-header
+  uint16_t sum = checksum != nullptr ? load16(checksum) : 0;
+  if (checksum != nullptr && (ip->ip_p != ip_protocol_udp || sum != 0)) {
+    if (ip->ip_p != ip_protocol_icmp) {
+      sum = checksumAdjust(checksumAdjust(sum, oldAddress, newAddress), oldAddress >> 16, newAddress >> 16);
+    }
+    sum = checksumAdjust(sum, oldPort, newPort);
+    // and so a computed zero is sent as its other form (RFC 768)
+    if (ip->ip_p == ip_protocol_udp && sum == 0) {
+      sum = 0xffff;
+    }
+    store16(checksum, sum);
+  }
+
+  rewriteAddress(ip, isSource, newAddress);
+  store16(port, newPort);
+}
+
+NaptTable::NaptTable(const Config& config)
+  : m_config(config)
+  , m_address(config.address)
+  , m_start(std::chrono::steady_clock::now())
+  , m_now(0)
+  , m_nCreated(0)
+  , m_nExpired(0)
+  , m_nExhausted(0)
+  , m_shouldStop(false)
+{
+  static_assert(sizeof(Entry) == 32, "two translations should share a cache line");
+
+  if (m_config.portMin == 0 || m_config.portMin > m_config.portMax) {
+    throw std::invalid_argument("NAPT port range " + std::to_string(m_config.portMin) + "-" +
+                                std::to_string(m_config.portMax) + " is empty");
+  }
+
+  // every shard needs a port of its own
+  size_t nPorts = m_config.portMax - m_config.portMin + 1;
+  size_t nShards = 1;
+  while (nShards < m_config.nShards && nShards * 2 <= nPorts) {
+    nShards <<= 1;
+  }
+  m_shardMask = nShards - 1;
+  m_portsPerShard = nPorts / nShards;
+
+  uint32_t nEntries = std::max<size_t>(1, m_config.maxTranslations / nShards);
+  size_t nBuckets = 1;
+  while (nBuckets < nEntries) {
+    nBuckets <<= 1;
+  }
+
+  // anonymous mappings are zero pages until written, so only used entries and
+  // chains take memory
+  m_shards = new Shard[nShards];
+  for (size_t i = 0; i < nShards; ++i) {
+    Shard& shard = m_shards[i];
+    void* entries = mmap(nullptr, nEntries * sizeof(Entry), PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    void* heads = mmap(nullptr, 2 * nBuckets * sizeof(std::atomic<uint32_t>), PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (entries == MAP_FAILED || heads == MAP_FAILED) {
+      throw std::bad_alloc();
+    }
+
+    shard.entries = static_cast<Entry*>(entries);
+    shard.nEntries = nEntries;
+    shard.outHeads = static_cast<std::atomic<uint32_t>*>(heads);
+    shard.inHeads = shard.outHeads + nBuckets;
+    shard.bucketMask = nBuckets - 1;
+    shard.nRemoved.store(0, std::memory_order_relaxed);
+    shard.nUsed = 0;
+    shard.expireNext = 0;
+    shard.firstPort = m_config.portMin + i * m_portsPerShard;
+    shard.nextPort = 0;
+  }
+
+  m_thread = std::thread(std::bind(&NaptTable::run, this));
+}
+
+NaptTable::~NaptTable()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_stopMutex);
+    m_shouldStop = true;
+  }
+  m_stopCv.notify_one();
+  m_thread.join();
+
+  for (size_t i = 0; i <= m_shardMask; ++i) {
+    munmap(m_shards[i].entries, m_shards[i].nEntries * sizeof(Entry));
+    munmap(m_shards[i].outHeads, 2 * (m_shards[i].bucketMask + 1) * sizeof(std::atomic<uint32_t>));
+  }
+  delete[] m_shards;
+}
+
+template<class Match>
+bool
+NaptTable::find(Shard& shard, const std::atomic<uint32_t>& head, std::atomic<uint32_t> Entry::* next,
+                const Match& match, Mapping& mapping, bool isLocked) const
+{
+  for (int attempt = 0; attempt < MAX_LOCK_FREE_ATTEMPTS || isLocked; ++attempt) {
+    uint32_t nRemoved = shard.nRemoved.load(std::memory_order_acquire);
+    uint32_t index = head.load(std::memory_order_acquire);
+    size_t nHops = 0;
+    while (index != 0 && (isLocked || nHops++ < MAX_LOCK_FREE_HOPS)) {
+      Entry& entry = shard.entries[index - 1];
+      uint32_t sequence = entry.sequence.load(std::memory_order_acquire);
+      Mapping copy = {&entry, entry.insideAddr, entry.insidePort, entry.externalPort};
+      bool isMatch = (sequence & 1) == 0 && match(entry);
+      uint32_t nextIndex = (entry.*next).load(std::memory_order_acquire);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (isMatch && entry.sequence.load(std::memory_order_relaxed) == sequence) {
+        mapping = copy;
+        return true;
+      }
+      index = nextIndex;
+    }
+
+    if (isLocked || (index == 0 && shard.nRemoved.load(std::memory_order_acquire) == nRemoved)) {
+      return false;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  return find(shard, head, next, match, mapping, true);
+}
+
+bool
+NaptTable::create(Shard& shard, uint64_t hash, uint8_t protocol, uint32_t insideAddr, uint16_t insidePort,
+                  uint32_t remoteAddr, uint16_t remotePort, Mapping& mapping)
+{
+  if (shard.freeEntries.empty() && shard.nUsed == shard.nEntries) {
+    m_nExhausted.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  // the external port only has to be unique per remote endpoint
+  for (uint32_t nTried = 0; nTried < m_portsPerShard; ++nTried) {
+    uint16_t externalPort = htons(shard.firstPort + shard.nextPort);
+    shard.nextPort = shard.nextPort + 1 == m_portsPerShard ? 0 : shard.nextPort + 1;
+
+    uint64_t inHash = hashInbound(protocol, remoteAddr, remotePort, externalPort);
+    std::atomic<uint32_t>& inHead = shard.inHeads[inHash & shard.bucketMask];
+    Mapping existing;
+    auto isTaken = [=] (const Entry& entry) {
+      return entry.externalPort == externalPort && entry.remoteAddr == remoteAddr &&
+             entry.remotePort == remotePort && entry.protocol == protocol;
+    };
+    if (find(shard, inHead, &Entry::inNext, isTaken, existing, true)) {
+      continue;
+    }
+
+    // removed entries first, so that a small table stays in few cache lines
+    uint32_t index;
+    if (!shard.freeEntries.empty()) {
+      index = shard.freeEntries.back();
+      shard.freeEntries.pop_back();
+    }
+    else {
+      index = ++shard.nUsed;
+    }
+    Entry& entry = shard.entries[index - 1];
+
+    uint32_t sequence = entry.sequence.load(std::memory_order_relaxed);
+    entry.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    entry.insideAddr = insideAddr;
+    entry.remoteAddr = remoteAddr;
+    entry.insidePort = insidePort;
+    entry.remotePort = remotePort;
+    entry.externalPort = externalPort;
+    entry.protocol = protocol;
+    entry.lastUsed.store(m_now.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    entry.isClosing.store(0, std::memory_order_relaxed);
+    std::atomic<uint32_t>& outHead = shard.outHeads[hash & shard.bucketMask];
+    entry.outNext.store(outHead.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    entry.inNext.store(inHead.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    entry.sequence.store(sequence + 2, std::memory_order_release);
+
+    outHead.store(index, std::memory_order_release);
+    inHead.store(index, std::memory_order_release);
+
+    mapping = {&entry, insideAddr, insidePort, externalPort};
+    m_nCreated.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  m_nExhausted.fetch_add(1, std::memory_order_relaxed);
+  return false;
+}
+
+void
+NaptTable::remove(Shard& shard, uint32_t index)
+{
+  Entry& entry = shard.entries[index - 1];
+
+  uint64_t outHash = hashOutbound(entry.protocol, entry.insideAddr, entry.insidePort,
+                                  entry.remoteAddr, entry.remotePort);
+  std::atomic<uint32_t>* link = &shard.outHeads[outHash & shard.bucketMask];
+  while (link->load(std::memory_order_relaxed) != index) {
+    link = &shard.entries[link->load(std::memory_order_relaxed) - 1].outNext;
+  }
+  link->store(entry.outNext.load(std::memory_order_relaxed), std::memory_order_release);
+
+  uint64_t inHash = hashInbound(entry.protocol, entry.remoteAddr, entry.remotePort, entry.externalPort);
+  link = &shard.inHeads[inHash & shard.bucketMask];
+  while (link->load(std::memory_order_relaxed) != index) {
+    link = &shard.entries[link->load(std::memory_order_relaxed) - 1].inNext;
+  }
+  link->store(entry.inNext.load(std::memory_order_relaxed), std::memory_order_release);
+
+  // before the entry can be reused and its links point into another chain
+  shard.nRemoved.fetch_add(1, std::memory_order_release);
+
+  uint32_t sequence = entry.sequence.load(std::memory_order_relaxed);
+  entry.sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  entry.protocol = 0;
+  entry.sequence.store(sequence + 2, std::memory_order_release);
+
+  shard.freeEntries.push_back(index);
+}
+
+void
+NaptTable::touch(Entry& entry, const uint8_t* tcpHeader)
+{
+  // written only when it changes, so that busy translations do not bounce between cores
+  uint32_t now = m_now.load(std::memory_order_relaxed);
+  if (entry.lastUsed.load(std::memory_order_relaxed) != now) {
+    entry.lastUsed.store(now, std::memory_order_relaxed);
+  }
+
+  if (tcpHeader != nullptr) {
+    uint8_t flags = tcpHeader[13];
+    uint8_t isClosing = (flags & (TCP_FIN | TCP_RST)) != 0;
+    if ((isClosing || (flags & TCP_SYN) != 0) &&
+        entry.isClosing.load(std::memory_order_relaxed) != isClosing) {
+      entry.isClosing.store(isClosing, std::memory_order_relaxed);
+    }
+  }
+}
+
+bool
+NaptTable::translateOutbound(ip_hdr* ip, size_t len)
+{
+  if (isIcmpError(ip, len)) {
+    return translateIcmpError(ip, len, true);
+  }
+
+  size_t checksumOffset;
+  uint8_t* transport = findTransport(ip, len, true, checksumOffset);
+  if (transport == nullptr) {
+    return false;
+  }
+
+  // ICMP echo requests are mapped by their identifier, as if it was the source port
+  uint8_t protocol = ip->ip_p;
+  size_t portOffset = protocol == ip_protocol_icmp ? 4 : 0;
+  uint32_t insideAddr = ip->ip_src;
+  uint32_t remoteAddr = ip->ip_dst;
+  uint16_t insidePort = load16(transport + portOffset);
+  uint16_t remotePort = protocol == ip_protocol_icmp ? 0 : load16(transport + 2);
+
+  uint64_t hash = hashOutbound(protocol, insideAddr, insidePort, remoteAddr, remotePort);
+  Shard& shard = m_shards[shardOfHash(hash, m_shardMask)];
+  const std::atomic<uint32_t>& head = shard.outHeads[hash & shard.bucketMask];
+  auto isFlow = [=] (const Entry& entry) {
+    return entry.insideAddr == insideAddr && entry.remoteAddr == remoteAddr &&
+           entry.insidePort == insidePort && entry.remotePort == remotePort && entry.protocol == protocol;
+  };
+
+  Mapping mapping;
+  if (!find(shard, head, &Entry::outNext, isFlow, mapping, false)) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (!find(shard, head, &Entry::outNext, isFlow, mapping, true) &&
+        !create(shard, hash, protocol, insideAddr, insidePort, remoteAddr, remotePort, mapping)) {
+      return false;
+    }
+  }
+
+  touch(*mapping.entry, protocol == ip_protocol_tcp ? transport : nullptr);
+  rewrite(ip, true, getAddress(), transport + portOffset, mapping.externalPort, transport + checksumOffset);
+  return true;
+}
+
+bool
+NaptTable::translateInbound(ip_hdr* ip, size_t len)
+{
+  if (ip->ip_dst != getAddress()) {
+    return false;
+  }
+  if (isIcmpError(ip, len)) {
+    return translateIcmpError(ip, len, false);
+  }
+
+  size_t checksumOffset;
+  uint8_t* transport = findTransport(ip, len, false, checksumOffset);
+  if (transport == nullptr) {
+    return false;
+  }
+
+  uint8_t protocol = ip->ip_p;
+  size_t portOffset = protocol == ip_protocol_icmp ? 4 : 2;
+  uint32_t remoteAddr = ip->ip_src;
+  uint16_t remotePort = protocol == ip_protocol_icmp ? 0 : load16(transport);
+  uint16_t externalPort = load16(transport + portOffset);
+
+  Shard* shard = findShardOfPort(externalPort);
+  if (shard == nullptr) {
+    return false;
+  }
+  uint64_t hash = hashInbound(protocol, remoteAddr, remotePort, externalPort);
+  auto isFlow = [=] (const Entry& entry) {
+    return entry.externalPort == externalPort && entry.remoteAddr == remoteAddr &&
+           entry.remotePort == remotePort && entry.protocol == protocol;
+  };
+
+  Mapping mapping;
+  if (!find(*shard, shard->inHeads[hash & shard->bucketMask], &Entry::inNext, isFlow, mapping, false)) {
+    return false;
+  }
+
+  touch(*mapping.entry, protocol == ip_protocol_tcp ? transport : nullptr);
+  rewrite(ip, false, mapping.insideAddr, transport + portOffset, mapping.insidePort, transport + checksumOffset);
+  return true;
+}
+
+bool
+NaptTable::translateIcmpError(ip_hdr* ip, size_t len, bool isOutbound)
+{
+  // the quoted header and the first 8 bytes of its payload, which hold the ports
+  size_t headerLen = ip->ip_hl * 4;
+  len = std::min<size_t>(len, ntohs(ip->ip_len));
+  if (len < headerLen + 8 + sizeof(ip_hdr) + 8) {
+    return false;
+  }
+  uint8_t* icmp = reinterpret_cast<uint8_t*>(ip) + headerLen;
+  ip_hdr* quoted = reinterpret_cast<ip_hdr*>(icmp + 8);
+  size_t quotedHeaderLen = quoted->ip_hl * 4;
+  size_t quotedLen = len - headerLen - 8;
+  if (quotedHeaderLen < sizeof(ip_hdr) || quotedLen < quotedHeaderLen + 8 ||
+      (ntohs(quoted->ip_off) & IP_OFFMASK) != 0) {
+    return false;
+  }
+  uint8_t* transport = reinterpret_cast<uint8_t*>(quoted) + quotedHeaderLen;
+  size_t transportLen = quotedLen - quotedHeaderLen;
+
+  // the quoted datagram went the other way, as translated: an error from outside quotes
+  // an outbound datagram, from its external address and port to the remote endpoint
+  uint8_t protocol = quoted->ip_p;
+  size_t checksumOffset;
+  switch (protocol) {
+  case ip_protocol_tcp:
+    checksumOffset = 16;
+    break;
+  case ip_protocol_udp:
+    checksumOffset = 6;
+    break;
+  case ip_protocol_icmp:
+    if (transport[0] != (isOutbound ? ICMP_ECHO_REPLY : ICMP_ECHO_REQUEST)) {
+      return false;
+    }
+    checksumOffset = 2;
+    break;
+  default:
+    return false;
+  }
+  bool isIcmp = protocol == ip_protocol_icmp;
+  size_t localPortOffset = isIcmp ? 4 : (isOutbound ? 2 : 0);
+  uint32_t remoteAddr = isOutbound ? quoted->ip_src : quoted->ip_dst;
+  uint16_t remotePort = isIcmp ? 0 : load16(transport + (isOutbound ? 0 : 2));
+  uint16_t localPort = load16(transport + localPortOffset);
+
+  Mapping mapping;
+  if (isOutbound) {
+    uint32_t insideAddr = quoted->ip_dst;
+    uint64_t hash = hashOutbound(protocol, insideAddr, localPort, remoteAddr, remotePort);
+    Shard& shard = m_shards[shardOfHash(hash, m_shardMask)];
+    auto isFlow = [=] (const Entry& entry) {
+      return entry.insideAddr == insideAddr && entry.remoteAddr == remoteAddr &&
+             entry.insidePort == localPort && entry.remotePort == remotePort && entry.protocol == protocol;
+    };
+    if (!find(shard, shard.outHeads[hash & shard.bucketMask], &Entry::outNext, isFlow, mapping, false)) {
+      return false;
+    }
+  }
+  else {
+    Shard* shard = quoted->ip_src == getAddress() ? findShardOfPort(localPort) : nullptr;
+    if (shard == nullptr) {
+      return false;
+    }
+    uint64_t hash = hashInbound(protocol, remoteAddr, remotePort, localPort);
+    auto isFlow = [=] (const Entry& entry) {
+      return entry.externalPort == localPort && entry.remoteAddr == remoteAddr &&
+             entry.remotePort == remotePort && entry.protocol == protocol;
+    };
+    if (!find(*shard, shard->inHeads[hash & shard->bucketMask], &Entry::inNext, isFlow, mapping, false)) {
+      return false;
+    }
+  }
+
+  // the quote is covered by the ICMP checksum: every word the rewrite changes in it is
+  // carried over (RFC 5508 REQ-4); quotes start at an even offset of the ICMP message
+  size_t coveredLen = quotedHeaderLen + (std::min<size_t>(transportLen, 20) & ~size_t(1));
+  uint8_t before[60 + 20];
+  memcpy(before, quoted, coveredLen);
+
+  uint8_t* checksum = transportLen >= checksumOffset + 2 ? transport + checksumOffset : nullptr;
+  if (isOutbound) {
+    rewrite(quoted, false, getAddress(), transport + localPortOffset, mapping.externalPort, checksum);
+  }
+  else {
+    rewrite(quoted, true, mapping.insideAddr, transport + localPortOffset, mapping.insidePort, checksum);
+  }
+
+  uint16_t icmpSum = load16(icmp + 2);
+  const uint8_t* after = reinterpret_cast<const uint8_t*>(quoted);
+  for (size_t offset = 0; offset < coveredLen; offset += 2) {
+    uint16_t oldWord = load16(before + offset);
+    uint16_t newWord = load16(after + offset);
+    if (oldWord != newWord) {
+      icmpSum = checksumAdjust(icmpSum, oldWord, newWord);
+    }
+  }
+  store16(icmp + 2, icmpSum);
+
+  // errors do not keep a translation alive (RFC 5508 REQ-6), so it is not touched
+  rewriteAddress(ip, isOutbound, isOutbound ? getAddress() : mapping.insideAddr);
+  return true;
+}
+
+NaptTable::Shard*
+NaptTable::findShardOfPort(uint16_t externalPort) const
+{
+  uint32_t port = ntohs(externalPort);
+  if (port < m_config.portMin) {
+    return nullptr;
+  }
+  size_t index = (port - m_config.portMin) / m_portsPerShard;
+  return index <= m_shardMask ? &m_shards[index] : nullptr;
+}
+
+size_t
+NaptTable::size() const
+{
+  size_t nActive = 0;
+  for (size_t i = 0; i <= m_shardMask; ++i) {
+    std::lock_guard<std::mutex> lock(m_shards[i].mutex);
+    nActive += m_shards[i].nUsed - m_shards[i].freeEntries.size();
+  }
+  return nActive;
+}
+
+void
+NaptTable::run()
+{
+  std::unique_lock<std::mutex> lock(m_stopMutex);
+  while (!m_shouldStop) {
+    m_stopCv.wait_for(lock, std::chrono::seconds(1));
+    if (m_shouldStop) {
+      break;
+    }
+    lock.unlock();
+    auto elapsed = std::chrono::steady_clock::now() - m_start;
+    m_now.store(std::chrono::duration_cast<std::chrono::seconds>(elapsed).count(), std::memory_order_relaxed);
+    expire();
+    lock.lock();
+  }
+}
+
+void
+NaptTable::expire()
+{
+  const uint32_t now = m_now.load(std::memory_order_relaxed);
+
+  for (size_t i = 0; i <= m_shardMask; ++i) {
+    Shard& shard = m_shards[i];
+    uint32_t nLeft;
+    {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      nLeft = std::min(shard.nUsed, std::max(EXPIRE_BATCH, (shard.nUsed + EXPIRE_SWEEP_TICKS - 1) / EXPIRE_SWEEP_TICKS));
+    }
+    // released between batches, so that creating a translation never waits for long
+    while (nLeft > 0) {
+      uint32_t count = std::min(nLeft, EXPIRE_BATCH);
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      expireSlice(shard, now, count);
+      nLeft -= count;
+    }
+  }
+}
+
+void
+NaptTable::expireSlice(Shard& shard, uint32_t now, uint32_t count)
+{
+  for (; count > 0; --count) {
+    if (shard.expireNext >= shard.nUsed) {
+      shard.expireNext = 0;
+    }
+    uint32_t index = ++shard.expireNext;
+    const Entry& entry = shard.entries[index - 1];
+    uint32_t timeout;
+    switch (entry.protocol) {
+    case 0:
+      continue;
+    case ip_protocol_tcp:
+      timeout = entry.isClosing.load(std::memory_order_relaxed) ? m_config.tcpTransitoryTimeoutSec
+                                                                : m_config.tcpTimeoutSec;
+      break;
+    case ip_protocol_udp:
+      timeout = m_config.udpTimeoutSec;
+      break;
+    default:
+      timeout = m_config.icmpTimeoutSec;
+      break;
+    }
+    if (now - entry.lastUsed.load(std::memory_order_relaxed) > timeout) {
+      remove(shard, index);
+      m_nExpired.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+}
+
+void
+NaptTable::print(std::ostream& os) const
+{
+  os << "NAT address " << ipToString(getAddress())
+     << ", ports " << m_config.portMin << "-" << m_config.portMin + (m_shardMask + 1) * m_portsPerShard - 1
+     << " in " << m_shardMask + 1 << " shards"
+     << ", translations: " << size() << " of " << (m_shardMask + 1) * m_shards[0].nEntries
+     << ", created: " << m_nCreated.load(std::memory_order_relaxed)
+     << ", expired: " << m_nExpired.load(std::memory_order_relaxed)
+     << ", failed: " << m_nExhausted.load(std::memory_order_relaxed) << "\n";
+}
+
+std::ostream&
+operator<<(std::ostream& os, const NaptTable& napt)
+{
+  napt.print(os);
+  return os;
+}
+
+} // namespace simple_router
@@ -0,0 +1,258 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * This header file defines the stateful source NAPT (RFC 3022) of datagrams leaving
+ * through the outside interface.
+ */
+
+#ifndef SIMPLE_ROUTER_CORE_NAPT_HPP
+#define SIMPLE_ROUTER_CORE_NAPT_HPP
+
+#include "protocol.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+namespace simple_router {
+
+/**
+ * Translation table of the NAPT
+ *
+ * TCP, UDP and ICMP echo datagrams from the inside get the external address and an
+ * external port (the echo identifier for ICMP) as their source; replies to that address
+ * and port get the inside address and port back.  Mappings are per 5-tuple (address and
+ * port dependent, RFC 4787), so an external port is reused towards different remote
+ * endpoints and one address carries far more than 64k translations.  ICMP errors about
+ * translated datagrams follow the translation of the datagram they quote (RFC 5508).
+ *
+ * The table is split into shards, each owning a slice of the external port range, its
+ * own translations and two chained hash tables (by inside 5-tuple and by remote endpoint
+ * and external port).  An outbound datagram picks its shard by flow hash, an inbound one
+ * by its destination port.  Lookups take no lock: translations live in a fixed array of
+ * the shard, are never freed, and carry a sequence number that is odd while a writer
+ * changes them, so a reader copies one and keeps it only if the sequence did not change.
+ * Creating and expiring translations take the shard's mutex; a lookup that misses is
+ * repeated under it before a new translation is created.  A background thread expires
+ * translations idle for longer than the timeout of their protocol, checking a slice of
+ * every shard each second and holding its mutex for a bounded batch at a time.
+ * Entries and chain heads are allocated up front but only touched once used, so a
+ * table sized for millions of translations costs memory only as they are created.
+ */
+class NaptTable
+{
+public:
+  struct Config
+  {
+    uint32_t address = 0;                //< external address, network byte order
+    uint16_t portMin = 1024;             //< external ports, also used as ICMP identifiers
+    uint16_t portMax = 65535;
+    size_t nShards = 64;                 //< rounded up to a power of two
+    size_t maxTranslations = 1 << 22;    //< split evenly over the shards
+    uint32_t udpTimeoutSec = 300;        //< RFC 4787 REQ-5
+    uint32_t tcpTimeoutSec = 7440;       //< established, RFC 5382 REQ-5
+    uint32_t tcpTransitoryTimeoutSec = 240; //< after a FIN or RST
+    uint32_t icmpTimeoutSec = 60;        //< RFC 5508 REQ-1
+  };
+
+  /**
+   * @throw std::invalid_argument if the port range is empty
+   */
+  explicit
+  NaptTable(const Config& config);
+
+  ~NaptTable();
+
+  /**
+   * Translate the source of the outbound IPv4 datagram \p ip of \p len bytes, creating a
+   * translation for a new flow, and update its checksums incrementally
+   *
+   * An ICMP error about an inbound translated datagram is translated as that datagram
+   * was, in reverse: see translateIcmpError().
+   *
+   * @return false if the datagram cannot be translated: not TCP, UDP, an ICMP echo
+   *         request or error, a non-initial fragment, or no translation or port left
+   */
+  bool
+  translateOutbound(ip_hdr* ip, size_t len);
+
+  /**
+   * Translate the destination of the inbound IPv4 datagram \p ip of \p len bytes back to
+   * the inside address and port, and update its checksums incrementally
+   *
+   * An ICMP error about an outbound translated datagram, such as a time exceeded for a
+   * traceroute probe or a fragmentation needed, goes to the inside host that sent it.
+   *
+   * @return false if no translation matches
+   */
+  bool
+  translateInbound(ip_hdr* ip, size_t len);
+
+  /**
+   * Get the external address, network byte order
+   */
+  uint32_t
+  getAddress() const;
+
+  /**
+   * Set the external address.  Existing translations keep their ports.
+   */
+  void
+  setAddress(uint32_t address);
+
+  /**
+   * Number of active translations
+   */
+  size_t
+  size() const;
+
+  void
+  print(std::ostream& os) const;
+
+private:
+  struct Entry
+  {
+    std::atomic<uint32_t> sequence; //< odd while the entry is being changed
+    std::atomic<uint32_t> outNext;  //< next entry of the outbound chain, index + 1, 0 at the end
+    std::atomic<uint32_t> inNext;   //< next entry of the inbound chain
+    std::atomic<uint32_t> lastUsed; //< m_now of the last translated datagram
+    uint32_t insideAddr;
+    uint32_t remoteAddr;
+    uint16_t insidePort;            //< network byte order, like the other ports
+    uint16_t remotePort;            //< 0 for ICMP
+    uint16_t externalPort;
+    uint8_t protocol;               //< 0 for a free entry
+    std::atomic<uint8_t> isClosing; //< a TCP FIN or RST was seen
+  };
+
+  struct Shard
+  {
+    std::mutex mutex;
+    Entry* entries;
+    uint32_t nEntries;
+    std::atomic<uint32_t>* outHeads;   //< chain heads by outbound hash, index + 1
+    std::atomic<uint32_t>* inHeads;    //< chain heads by inbound hash
+    size_t bucketMask;
+    std::atomic<uint32_t> nRemoved;    //< tells a reader whether the chain it walked changed
+    std::vector<uint32_t> freeEntries; //< index + 1 of removed entries
+    uint32_t nUsed;                    //< entries ever used; those past it are untouched
+    uint32_t expireNext;               //< offset of the next entry expire() checks
+    uint32_t firstPort;                //< host byte order
+    uint32_t nextPort;                 //< offset of the next port to try
+  };
+
+  /**
+   * Fields of a translation as a reader copied them
+   */
+  struct Mapping
+  {
+    Entry* entry;
+    uint32_t insideAddr;
+    uint16_t insidePort;
+    uint16_t externalPort;
+  };
+
+  /**
+   * Walk the chain at \p head, following the \p next links, for an entry \p match accepts
+   *
+   * Without \p isLocked, the walk takes no lock and is repeated if a translation of the
+   * shard was removed meanwhile, as the reader may have been led into another chain; the
+   * last attempt takes the shard's mutex.
+   */
+  template<class Match>
+  bool
+  find(Shard& shard, const std::atomic<uint32_t>& head, std::atomic<uint32_t> Entry::* next,
+       const Match& match, Mapping& mapping, bool isLocked) const;
+
+  /**
+   * Create the translation of a new outbound flow, with the shard's mutex held
+   */
+  bool
+  create(Shard& shard, uint64_t hash, uint8_t protocol, uint32_t insideAddr, uint16_t insidePort,
+         uint32_t remoteAddr, uint16_t remotePort, Mapping& mapping);
+
+  /**
+   * Unlink and free the entry at \p index, with the shard's mutex held
+   */
+  void
+  remove(Shard& shard, uint32_t index);
+
+  Shard*
+  findShardOfPort(uint16_t externalPort) const;
+
+  /**
+   * Translate the ICMP error \p ip of \p len bytes by the translation of the datagram it
+   * quotes (RFC 5508): the quoted header and ports and the outer source (\p isOutbound)
+   * or destination address, with the IP, quoted and ICMP checksums updated
+   */
+  bool
+  translateIcmpError(ip_hdr* ip, size_t len, bool isOutbound);
+
+  void
+  touch(Entry& entry, const uint8_t* tcpHeader);
+
+  void
+  run();
+
+  void
+  expire();
+
+  /**
+   * Expire the idle translations among the next \p count entries of \p shard, with its
+   * mutex held
+   */
+  void
+  expireSlice(Shard& shard, uint32_t now, uint32_t count);
+
+private:
+  Config m_config;
+  std::atomic<uint32_t> m_address;
+  Shard* m_shards;
+  size_t m_shardMask;
+  uint32_t m_portsPerShard;
+
+  std::chrono::steady_clock::time_point m_start;
+  std::atomic<uint32_t> m_now; //< seconds since m_start, advanced by the expiry thread
+  std::atomic<uint64_t> m_nCreated;
+  std::atomic<uint64_t> m_nExpired;
+  std::atomic<uint64_t> m_nExhausted;
+
+  std::mutex m_stopMutex;
+  std::condition_variable m_stopCv;
+  bool m_shouldStop;
+  std::thread m_thread;
+};
+
+inline uint32_t
+NaptTable::getAddress() const
+{
+  return m_address.load(std::memory_order_relaxed);
+}
+
+inline void
+NaptTable::setAddress(uint32_t address)
+{
+  m_address.store(address, std::memory_order_relaxed);
+}
+
+std::ostream&
+operator<<(std::ostream& os, const NaptTable& napt);
+
+} // namespace simple_router
+
+#endif // SIMPLE_ROUTER_CORE_NAPT_HPP
@@ -0,0 +1,222 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "neighbor-state.hpp"
+#include "logger.hpp"
+#include "table-dump.hpp"
+
+#include <functional>
+#include <stdexcept>
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace simple_router {
+
+const uint32_t NeighborState::MAGIC;
+const uint32_t NeighborState::VERSION;
+
+static const size_t HEADER_SIZE = 24;
+
+static void
+putUint32(uint8_t* out, uint32_t value)
+{
+  value = htonl(value);
+  memcpy(out, &value, 4);
+}
+
+static uint32_t
+getUint32(const uint8_t* in)
+{
+  uint32_t value;
+  memcpy(&value, in, 4);
+  return ntohl(value);
+}
+
+void
+saveNeighborState(const std::string& file, const NeighborState& state)
+{
+  auto now = steady_clock::now();
+
+  Buffer arpRecords;
+  encodeArpEntries(state.arp, now, arpRecords);
+
+  Buffer data(HEADER_SIZE + arpRecords.size() + state.ndp.size() * NEIGHBOR_STATE_RECORD_SIZE, 0);
+  uint64_t timestamp = time(nullptr);
+  putUint32(data.data(), NeighborState::MAGIC);
+  putUint32(data.data() + 4, NeighborState::VERSION);
+  putUint32(data.data() + 8, timestamp >> 32);
+  putUint32(data.data() + 12, timestamp & 0xffffffff);
+  putUint32(data.data() + 16, state.arp.size());
+  putUint32(data.data() + 20, state.ndp.size());
+  std::copy(arpRecords.begin(), arpRecords.end(), data.begin() + HEADER_SIZE);
+
+  uint8_t* record = data.data() + HEADER_SIZE + arpRecords.size();
+  for (const auto& entry : state.ndp) {
+    entry.ip.toBytes(record);
+    memcpy(record + 16, entry.mac, ETHER_ADDR_LEN);
+    auto age = std::chrono::duration_cast<seconds>(now - entry.timeAdded).count();
+    putUint32(record + 24, std::max<int64_t>(age, 0));
+    record += NEIGHBOR_STATE_RECORD_SIZE;
+  }
+
+  std::string tmpFile = file + ".tmp";
+  FILE* fp = fopen(tmpFile.c_str(), "wb");
+  if (fp == nullptr) {
+    throw std::runtime_error("Cannot open `" + tmpFile + "`: " + strerror(errno));
+  }
+  bool isWritten = fwrite(data.data(), 1, data.size(), fp) == data.size() &&
+                   fflush(fp) == 0 && fsync(fileno(fp)) == 0;
+  fclose(fp);
+  if (!isWritten || rename(tmpFile.c_str(), file.c_str()) != 0) {
+    std::string error = strerror(errno);
+    unlink(tmpFile.c_str());
+    throw std::runtime_error("Cannot write `" + file + "`: " + error);
+  }
+}
+
+bool
+loadNeighborState(const std::string& file, seconds maxAge, NeighborState& state)
+{
+  FILE* fp = fopen(file.c_str(), "rb");
+  if (fp == nullptr) {
+    return false;
+  }
+  Buffer data;
+  uint8_t chunk[4096];
+  size_t nRead;
+  while ((nRead = fread(chunk, 1, sizeof(chunk), fp)) > 0) {
+    data.insert(data.end(), chunk, chunk + nRead);
+  }
+  fclose(fp);
+
+  if (data.size() < HEADER_SIZE ||
+      getUint32(data.data()) != NeighborState::MAGIC ||
+      getUint32(data.data() + 4) != NeighborState::VERSION) {
+    return false;
+  }
+  int64_t timestamp = (static_cast<uint64_t>(getUint32(data.data() + 8)) << 32) | getUint32(data.data() + 12);
+  size_t nArp = getUint32(data.data() + 16);
+  size_t nNdp = getUint32(data.data() + 20);
+  if (data.size() != HEADER_SIZE + nArp * ARP_DUMP_RECORD_SIZE + nNdp * NEIGHBOR_STATE_RECORD_SIZE) {
+    return false;
+  }
+
+  // ages in the file are relative to the snapshot; a clock that went backwards counts as no downtime
+  int64_t downtime = std::max<int64_t>(time(nullptr) - timestamp, 0);
+  auto now = steady_clock::now();
+
+  state.arp.clear();
+  const uint8_t* record = data.data() + HEADER_SIZE;
+  for (size_t i = 0; i < nArp; ++i, record += ARP_DUMP_RECORD_SIZE) {
+    int64_t age = getUint32(record + 12) + downtime;
+    if (record[10] == 0 || age >= maxAge.count()) {
+      continue;
+    }
+    ArpEntryInfo entry;
+    memcpy(&entry.ip, record, 4);
+    memcpy(entry.mac, record + 4, ETHER_ADDR_LEN);
+    entry.timeAdded = now - seconds(age);
+    entry.isValid = true;
+    state.arp.push_back(entry);
+  }
+
+  state.ndp.clear();
+  for (size_t i = 0; i < nNdp; ++i, record += NEIGHBOR_STATE_RECORD_SIZE) {
+    int64_t age = getUint32(record + 24) + downtime;
+    if (age >= maxAge.count()) {
+      continue;
+    }
+    NeighborEntryInfo entry;
+    entry.ip = Ipv6Address::fromBytes(record);
+    memcpy(entry.mac, record + 16, ETHER_ADDR_LEN);
+    entry.timeAdded = now - seconds(age);
+    state.ndp.push_back(entry);
+  }
+  return true;
+}
+
+NeighborStateSaver::NeighborStateSaver(const ArpCache& arp, const NeighborCache& ndp,
+                                       const std::string& file, seconds interval)
+  : m_arp(arp)
+  , m_ndp(ndp)
+  , m_file(file)
+  , m_interval(interval)
+  , m_shouldStop(false)
+  , m_thread(std::bind(&NeighborStateSaver::run, this))
+{
+}
+
+NeighborStateSaver::~NeighborStateSaver()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_shouldStop = true;
+  }
+  m_cv.notify_one();
+  m_thread.join();
+
+  save();
+}
+
+void
+NeighborStateSaver::save()
+{
+  NeighborState state;
+  for (const auto& entry : m_arp.getEntries()) {
+    if (entry.isValid) {
+      state.arp.push_back(entry);
+    }
+  }
+  state.ndp = m_ndp.getEntries();
+  if (state.arp.empty() && state.ndp.empty()) {
+    return;
+  }
+
+  try {
+    saveNeighborState(m_file, state);
+  }
+  catch (const std::runtime_error& e) {
+    SR_LOG_WARN("Cannot save neighbor state: " << e.what());
+  }
+}
+
+size_t
+NeighborStateSaver::restore(ArpCache& arp, NeighborCache& ndp)
+{
+  NeighborState state;
+  if (!loadNeighborState(m_file, SR_ARPCACHE_TO, state)) {
+    return 0;
+  }
+  return arp.restoreEntries(state.arp) + ndp.restoreEntries(state.ndp);
+}
+
+void
+NeighborStateSaver::run()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (!m_shouldStop) {
+    m_cv.wait_for(lock, m_interval);
+    if (m_shouldStop) {
+      break;
+    }
+    lock.unlock();
+    save();
+    lock.lock();
+  }
+}
+
+} // namespace simple_router
@@ -0,0 +1,115 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * This header file defines the neighbor state file used for warm restarts: a snapshot
+ * of the ARP and IPv6 neighbor caches that the router saves periodically and on
+ * shutdown, and reloads when it is reset.
+ */
+
+#ifndef SIMPLE_ROUTER_CORE_NEIGHBOR_STATE_HPP
+#define SIMPLE_ROUTER_CORE_NEIGHBOR_STATE_HPP
+
+#include "arp-cache.hpp"
+#include "ndp-cache.hpp"
+
+#include <condition_variable>
+
+namespace simple_router {
+
+/**
+ * Contents of a neighbor state file
+ *
+ * The file, in network byte order, is a 24 byte header: magic (4), version (4),
+ * wall clock time of the snapshot in seconds since the epoch (8), number of ARP
+ * records (4), number of neighbor records (4); followed by the ARP records, in the
+ * ARP_DUMP_RECORD_SIZE format of the table dumps, and the neighbor records of
+ * NEIGHBOR_STATE_RECORD_SIZE bytes: IPv6 address (16), MAC (6), padding (2), age
+ * in seconds (4).
+ */
+struct NeighborState
+{
+  static const uint32_t MAGIC = 0x53524e53; // "SRNS"
+  static const uint32_t VERSION = 1;
+
+  std::vector<ArpEntryInfo> arp;
+  std::vector<NeighborEntryInfo> ndp;
+};
+
+const size_t NEIGHBOR_STATE_RECORD_SIZE = 28;
+
+/**
+ * Write \p state to \p file, through a temporary file renamed over it, so a crash
+ * never leaves a partial snapshot behind
+ *
+ * @throw std::runtime_error if the file cannot be written
+ */
+void
+saveNeighborState(const std::string& file, const NeighborState& state);
+
+/**
+ * Read the entries of \p file that are still younger than \p maxAge, counting the
+ * time since the snapshot was taken.  Their timeAdded is set accordingly.
+ *
+ * @return false if \p file does not exist or is not a valid neighbor state file
+ */
+bool
+loadNeighborState(const std::string& file, seconds maxAge, NeighborState& state);
+
+/**
+ * Saves the ARP and neighbor caches to a file every interval and when destroyed,
+ * and restores them from it
+ */
+class NeighborStateSaver
+{
+public:
+  NeighborStateSaver(const ArpCache& arp, const NeighborCache& ndp, const std::string& file,
+                     seconds interval);
+
+  ~NeighborStateSaver();
+
+  /**
+   * Save the valid entries of both caches.  When there are none, e.g. right after
+   * startup, the file is left alone, so the last snapshot survives until it is restored.
+   */
+  void
+  save();
+
+  /**
+   * Restore the entries of the file that are younger than SR_ARPCACHE_TO into
+   * \p arp and \p ndp (see ArpCache::restoreEntries)
+   *
+   * @return number of entries restored
+   */
+  size_t
+  restore(ArpCache& arp, NeighborCache& ndp);
+
+private:
+  void
+  run();
+
+private:
+  const ArpCache& m_arp;
+  const NeighborCache& m_ndp;
+  std::string m_file;
+  seconds m_interval;
+
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  bool m_shouldStop;
+  std::thread m_thread;
+};
+
+} // namespace simple_router
+
+#endif // SIMPLE_ROUTER_CORE_NEIGHBOR_STATE_HPP
@@ -0,0 +1,278 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "output-queue.hpp"
+#include "token-bucket.hpp"
+
+#include <iomanip>
+#include <limits>
+
+namespace simple_router {
+
+const char*
+trafficClassToString(TrafficClass trafficClass)
+{
+  switch (trafficClass) {
+  case CLASS_PRIORITY:
+    return "priority";
+  case CLASS_INTERACTIVE:
+    return "interactive";
+  case CLASS_BEST_EFFORT:
+    return "best-effort";
+  case CLASS_BULK:
+    return "bulk";
+  default:
+    return "unknown";
+  }
+}
+
+TrafficClass
+trafficClassOf(const uint8_t* frame, size_t len)
+{
+  if (len < sizeof(ethernet_hdr) + sizeof(ip_hdr)) {
+    return CLASS_PRIORITY;
+  }
+  const ethernet_hdr* eth = reinterpret_cast<const ethernet_hdr*>(frame);
+  if (eth->ether_type != htons(ethertype_ip)) {
+    return CLASS_PRIORITY;
+  }
+
+  const ip_hdr* ip = reinterpret_cast<const ip_hdr*>(frame + sizeof(ethernet_hdr));
+  uint8_t dscp = ip->ip_tos >> 2;
+  if (dscp == 46 || dscp == 48 || dscp == 56) { // EF, CS6, CS7
+    return CLASS_PRIORITY;
+  }
+  if (dscp >= 24 && dscp <= 40) {               // CS3, AF3x, CS4, AF4x, CS5
+    return CLASS_INTERACTIVE;
+  }
+  if (dscp >= 8 && dscp <= 14) {                // CS1, AF1x
+    return CLASS_BULK;
+  }
+  return CLASS_BEST_EFFORT;
+}
+
+OutputQueue::OutputQueue(const std::string& ifName, const Config& config)
+  : m_ifName(ifName)
+  , m_config(config)
+{
+}
+
+bool
+OutputQueue::enqueue(const Buffer& frame, TrafficClass trafficClass)
+{
+  if (m_counters.bytes[trafficClass] + frame.size() > m_config.limitBytes[trafficClass]) {
+    ++m_counters.drops[trafficClass];
+    return false;
+  }
+
+  m_queues[trafficClass].push_back(frame);
+  m_counters.bytes[trafficClass] += frame.size();
+  ++m_counters.packets[trafficClass];
+  return true;
+}
+
+bool
+OutputQueue::isEmpty() const
+{
+  for (const auto& queue : m_queues) {
+    if (!queue.empty()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void
+OutputQueue::pop(TrafficClass trafficClass, Buffer& frame)
+{
+  std::deque<Buffer>& queue = m_queues[trafficClass];
+  frame.swap(queue.front());
+  queue.pop_front();
+  m_counters.bytes[trafficClass] -= frame.size();
+  --m_counters.packets[trafficClass];
+}
+
+bool
+OutputQueue::dequeue(Buffer& frame)
+{
+  if (!m_queues[CLASS_PRIORITY].empty()) {
+    pop(CLASS_PRIORITY, frame);
+    return true;
+  }
+
+  bool hasBacklog = false;
+  for (size_t c = CLASS_PRIORITY + 1; c < N_TRAFFIC_CLASSES; ++c) {
+    hasBacklog = hasBacklog || !m_queues[c].empty();
+  }
+  if (!hasBacklog) {
+    return false;
+  }
+
+  // deficit round robin: each visit to a backlogged class adds its quantum, and the
+  // class sends while its head frame fits into the deficit
+  for (;;) {
+    std::deque<Buffer>& queue = m_queues[m_current];
+    if (queue.empty()) {
+      m_deficit[m_current] = 0;
+    }
+    else {
+      if (!m_hasQuantum) {
+        m_deficit[m_current] += m_config.quantum[m_current];
+        m_hasQuantum = true;
+      }
+      if (queue.front().size() <= m_deficit[m_current]) {
+        m_deficit[m_current] -= queue.front().size();
+        pop(static_cast<TrafficClass>(m_current), frame);
+        if (queue.empty()) {
+          m_deficit[m_current] = 0;
+        }
+        return true;
+      }
+    }
+
+    m_current = m_current + 1 < N_TRAFFIC_CLASSES ? m_current + 1 : CLASS_PRIORITY + 1;
+    m_hasQuantum = false;
+  }
+}
+
+void
+OutputQueue::charge(size_t bytes, uint64_t now)
+{
+  if (m_config.rateBps <= 0) {
+    return;
+  }
+  m_nextSendTime = std::max(m_nextSendTime, now) + static_cast<uint64_t>(bytes * 8 * 1e9 / m_config.rateBps);
+}
+
+EgressScheduler::EgressScheduler(const OutputQueue::Config& config, const Transmit& transmit)
+  : m_config(config)
+  , m_transmit(transmit)
+  , m_shouldStop(false)
+{
+  for (size_t c = CLASS_PRIORITY + 1; c < N_TRAFFIC_CLASSES; ++c) {
+    // a zero quantum would never let the class send
+    m_config.quantum[c] = std::max<size_t>(m_config.quantum[c], 1);
+  }
+  m_thread = std::thread(std::bind(&EgressScheduler::run, this));
+}
+
+EgressScheduler::~EgressScheduler()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_shouldStop = true;
+  }
+  m_cv.notify_one();
+  m_thread.join();
+}
+
+void
+EgressScheduler::setInterfaces(const std::vector<std::string>& ifNames)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  m_queues.clear();
+  for (const auto& name : ifNames) {
+    m_queues.push_back(OutputQueue(name, m_config));
+  }
+  m_nextQueue = 0;
+}
+
+bool
+EgressScheduler::enqueue(const Buffer& frame, uint32_t ifIndex)
+{
+  TrafficClass trafficClass = trafficClassOf(frame.data(), frame.size());
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (ifIndex >= m_queues.size() || !m_queues[ifIndex].enqueue(frame, trafficClass)) {
+      return false;
+    }
+  }
+  m_cv.notify_one();
+  return true;
+}
+
+void
+EgressScheduler::run()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  Buffer frame;
+
+  while (!m_shouldStop) {
+    uint64_t now = TokenBucket::nowNs();
+    uint64_t wakeAt = std::numeric_limits<uint64_t>::max();
+    bool hasSent = false;
+
+    // one frame per interface in turn, so a busy interface does not delay the others
+    for (size_t i = 0; i < m_queues.size(); ++i) {
+      size_t index = (m_nextQueue + i) % m_queues.size();
+      OutputQueue& queue = m_queues[index];
+      if (queue.isEmpty()) {
+        continue;
+      }
+      if (queue.getNextSendTime() > now) {
+        wakeAt = std::min(wakeAt, queue.getNextSendTime());
+        continue;
+      }
+
+      queue.dequeue(frame);
+      queue.charge(frame.size(), now);
+      std::string ifName = queue.getIfName();
+      m_nextQueue = index + 1;
+
+      lock.unlock();
+      m_transmit(frame, ifName);
+      lock.lock();
+      hasSent = true;
+      break;
+    }
+
+    if (hasSent) {
+      continue;
+    }
+    if (wakeAt == std::numeric_limits<uint64_t>::max()) {
+      m_cv.wait(lock);
+    }
+    else {
+      m_cv.wait_for(lock, std::chrono::nanoseconds(wakeAt - now));
+    }
+  }
+}
+
+void
+EgressScheduler::print(std::ostream& os) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  os << "\nIface      Class          Queued pkts  Queued bytes       Drops\n"
+     << "-----------------------------------------------------------------\n";
+  for (const auto& queue : m_queues) {
+    const OutputQueue::Counters& counters = queue.getCounters();
+    for (size_t c = 0; c < N_TRAFFIC_CLASSES; ++c) {
+      os << std::left << std::setw(11) << queue.getIfName()
+         << std::setw(13) << trafficClassToString(static_cast<TrafficClass>(c)) << std::right
+         << std::setw(13) << counters.packets[c] << std::setw(14) << counters.bytes[c]
+         << std::setw(12) << counters.drops[c] << "\n";
+    }
+  }
+}
+
+std::ostream&
+operator<<(std::ostream& os, const EgressScheduler& scheduler)
+{
+  scheduler.print(os);
+  return os;
+}
+
+} // namespace simple_router
@@ -0,0 +1,191 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * This header file defines the per-interface egress queues and the thread that
+ * drains them with strict priority plus deficit round robin.
+ */
+
+#ifndef SIMPLE_ROUTER_CORE_OUTPUT_QUEUE_HPP
+#define SIMPLE_ROUTER_CORE_OUTPUT_QUEUE_HPP
+
+#include "protocol.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <thread>
+
+namespace simple_router {
+
+enum TrafficClass {
+  CLASS_PRIORITY,    //< EF, CS6, CS7 and non-IP control frames (ARP); served first
+  CLASS_INTERACTIVE, //< AF3x, AF4x, CS3..CS5
+  CLASS_BEST_EFFORT, //< default and everything not listed
+  CLASS_BULK,        //< CS1 (scavenger), AF1x
+  N_TRAFFIC_CLASSES
+};
+
+const char*
+trafficClassToString(TrafficClass trafficClass);
+
+/**
+ * Class of the Ethernet frame \p frame, from the DSCP bits of its IPv4 header
+ */
+TrafficClass
+trafficClassOf(const uint8_t* frame, size_t len);
+
+/**
+ * Queues of one egress interface
+ *
+ * Not thread-safe; EgressScheduler serializes access.
+ */
+class OutputQueue
+{
+public:
+  struct Config
+  {
+    size_t limitBytes[N_TRAFFIC_CLASSES] = {64 * 1024, 256 * 1024, 256 * 1024, 256 * 1024};
+    /**
+     * Bytes each DRR class may send per round; the priority class has none
+     */
+    size_t quantum[N_TRAFFIC_CLASSES] = {0, 4500, 3000, 1500};
+    double rateBps = 0; //< shaping rate in bits per second, 0 for unshaped
+  };
+
+  struct Counters
+  {
+    size_t bytes[N_TRAFFIC_CLASSES] = {};
+    size_t packets[N_TRAFFIC_CLASSES] = {};
+    uint64_t drops[N_TRAFFIC_CLASSES] = {};
+  };
+
+  OutputQueue(const std::string& ifName, const Config& config);
+
+  /**
+   * @return false if the class queue is over its byte limit (the frame is dropped)
+   */
+  bool
+  enqueue(const Buffer& frame, TrafficClass trafficClass);
+
+  /**
+   * Move the next frame to send into \p frame
+   */
+  bool
+  dequeue(Buffer& frame);
+
+  bool
+  isEmpty() const;
+
+  /**
+   * Earliest time (steady_clock nanoseconds) the shaper allows the next frame out
+   */
+  uint64_t
+  getNextSendTime() const
+  {
+    return m_nextSendTime;
+  }
+
+  /**
+   * Account \p bytes sent at \p now against the shaping rate
+   */
+  void
+  charge(size_t bytes, uint64_t now);
+
+  const std::string&
+  getIfName() const
+  {
+    return m_ifName;
+  }
+
+  const Counters&
+  getCounters() const
+  {
+    return m_counters;
+  }
+
+private:
+  void
+  pop(TrafficClass trafficClass, Buffer& frame);
+
+private:
+  std::string m_ifName;
+  Config m_config;
+  std::deque<Buffer> m_queues[N_TRAFFIC_CLASSES];
+  Counters m_counters;
+
+  size_t m_deficit[N_TRAFFIC_CLASSES] = {};
+  size_t m_current = CLASS_INTERACTIVE;
+  bool m_hasQuantum = false; //< whether the current class already got its quantum this round
+
+  uint64_t m_nextSendTime = 0;
+};
+
+/**
+ * Egress queues of all interfaces and the thread that drains them
+ *
+ * Frames are classified and queued by the forwarding threads; the drain thread hands
+ * them to \p transmit, paced per interface by the shaping rate.  Shaping is what
+ * makes the router rather than the transport the bottleneck, so that under
+ * congestion the queueing (and dropping) happens here, by class.
+ */
+class EgressScheduler
+{
+public:
+  typedef std::function<void(const Buffer& frame, const std::string& ifName)> Transmit;
+
+  EgressScheduler(const OutputQueue::Config& config, const Transmit& transmit);
+
+  ~EgressScheduler();
+
+  /**
+   * Replace the queues with empty queues for interfaces \p ifNames, indexed by
+   * Interface::index
+   */
+  void
+  setInterfaces(const std::vector<std::string>& ifNames);
+
+  /**
+   * @return false if the frame was dropped because its queue is full
+   */
+  bool
+  enqueue(const Buffer& frame, uint32_t ifIndex);
+
+  void
+  print(std::ostream& os) const;
+
+private:
+  void
+  run();
+
+private:
+  OutputQueue::Config m_config;
+  Transmit m_transmit;
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::vector<OutputQueue> m_queues;
+  size_t m_nextQueue = 0;
+
+  bool m_shouldStop;
+  std::thread m_thread;
+};
+
+std::ostream&
+operator<<(std::ostream& os, const EgressScheduler& scheduler);
+
+} // namespace simple_router
+
+#endif // SIMPLE_ROUTER_CORE_OUTPUT_QUEUE_HPP
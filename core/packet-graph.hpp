@@ -0,0 +1,106 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * This header file defines the nodes of the vector packet-processing graph and the
+ * packet descriptors passed between them.
+ */
+
+#ifndef SIMPLE_ROUTER_CORE_PACKET_GRAPH_HPP
+#define SIMPLE_ROUTER_CORE_PACKET_GRAPH_HPP
+
+#include "protocol.hpp"
+#include "interface.hpp"
+#include "routing-table.hpp"
+
+namespace simple_router {
+
+/**
+ * Most packets a node handles per call; larger batches are split
+ */
+const size_t GRAPH_VECTOR_SIZE = 256;
+
+/**
+ * Nodes of the data path, in the order the dispatcher runs them.  Every edge
+ * points to a later node, so one pass over the nodes drains the graph.
+ */
+enum GraphNode {
+  NODE_ETHERNET_INPUT,    //< Receive accounting, destination MAC filter, ethertype demux
+  NODE_ARP_INPUT,         //< ARP requests and replies
+  NODE_IP4_INPUT,         //< Policer, header validation, local delivery, TTL update
+  NODE_IP6_INPUT,         //< IPv6 validation, local delivery, hop limit, lookup and rewrite
+  NODE_NAT44_OUT2IN,      //< Destination translation of datagrams to the NAT address
+  NODE_IP4_LOOKUP,        //< Longest prefix match of the whole vector at once
+  NODE_NAT44_IN2OUT,      //< Source translation of datagrams leaving through the NAT outside
+  NODE_IP4_REWRITE,       //< Next hop resolution and Ethernet header rewrite
+  NODE_INTERFACE_OUTPUT,  //< Hand-off to the egress queues or the transport
+  N_GRAPH_NODES
+};
+
+/**
+ * One received frame on its way through the graph
+ */
+struct PacketDescriptor
+{
+  const uint8_t* frame;          //< as received, valid until the batch is handled
+  size_t size;
+  const Interface* iface;        //< receiving interface
+  bool isExcess;                 //< over the policed rate of its source, to be remarked
+  Buffer packet;                 //< private copy of an IP frame, which forwarding modifies
+  const RoutingTableEntry* rte;
+  const Interface* outIface;
+};
+
+/**
+ * Indices of the descriptors waiting at each node
+ */
+class GraphFrames
+{
+public:
+  GraphFrames()
+    : m_counts()
+  {
+  }
+
+  void
+  enqueue(GraphNode node, uint16_t packet)
+  {
+    m_packets[node][m_counts[node]++] = packet;
+  }
+
+  size_t
+  size(GraphNode node) const
+  {
+    return m_counts[node];
+  }
+
+  const uint16_t*
+  packets(GraphNode node) const
+  {
+    return m_packets[node];
+  }
+
+  void
+  clear(GraphNode node)
+  {
+    m_counts[node] = 0;
+  }
+
+private:
+  uint16_t m_counts[N_GRAPH_NODES];
+  uint16_t m_packets[N_GRAPH_NODES][GRAPH_VECTOR_SIZE];
+};
+
+} // namespace simple_router
+
+#endif // SIMPLE_ROUTER_CORE_PACKET_GRAPH_HPP
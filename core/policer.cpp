@@ -0,0 +1,154 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "policer.hpp"
+#include "utils.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace simple_router {
+
+IngressPolicer::Policer::Policer(const Rule& rule)
+  : rule(rule)
+  , bucket(rule.rate, rule.burst)
+  , nPassed(0)
+  , nExcess(0)
+{
+}
+
+IngressPolicer::IngressPolicer()
+  : m_trie(1, Node{{-1, -1}, -1})
+{
+}
+
+void
+IngressPolicer::load(const std::string& file)
+{
+  std::ifstream input(file.c_str());
+  if (!input) {
+    throw std::runtime_error("Cannot open policer rules `" + file + "`");
+  }
+
+  std::string line;
+  while (std::getline(input, line)) {
+    line = line.substr(0, line.find('#'));
+    std::istringstream ruleLine(line);
+    std::string prefix, action = "drop";
+    Rule rule;
+    if (!(ruleLine >> prefix)) {
+      continue;
+    }
+    if (!(ruleLine >> rule.rate >> rule.burst)) {
+      throw std::runtime_error("Policer rule `" + line + "` needs a rate and a burst");
+    }
+    ruleLine >> action;
+
+    uint32_t address;
+    int length;
+    if (!parseIpv4Prefix(prefix, address, length)) {
+      throw std::runtime_error("Invalid prefix `" + prefix + "` in policer rule");
+    }
+    if (action != "drop" && action != "mark") {
+      throw std::runtime_error("Invalid policer action `" + action + "`, expected drop or mark");
+    }
+
+    rule.prefix = address;
+    rule.length = length;
+    rule.action = action == "drop" ? ACTION_DROP : ACTION_MARK;
+    addRule(rule);
+  }
+}
+
+void
+IngressPolicer::addRule(const Rule& rule)
+{
+  uint32_t host = ntohl(rule.prefix);
+  size_t node = 0;
+  for (uint8_t depth = 0; depth < rule.length; ++depth) {
+    int bit = (host >> (31 - depth)) & 1;
+    if (m_trie[node].child[bit] < 0) {
+      m_trie[node].child[bit] = m_trie.size();
+      m_trie.push_back(Node{{-1, -1}, -1});
+    }
+    node = m_trie[node].child[bit];
+  }
+
+  // a second rule for the same prefix replaces the first
+  if (m_trie[node].policer >= 0) {
+    m_policers[m_trie[node].policer].reset(new Policer(rule));
+  }
+  else {
+    m_trie[node].policer = m_policers.size();
+    m_policers.emplace_back(new Policer(rule));
+  }
+  Rule& stored = m_policers[m_trie[node].policer]->rule;
+  stored.prefix = rule.length == 0 ? 0 : htonl(host & (~0u << (32 - rule.length)));
+}
+
+IngressPolicer::Verdict
+IngressPolicer::police(uint32_t src, uint64_t now)
+{
+  uint32_t host = ntohl(src);
+  int32_t match = m_trie[0].policer;
+  int32_t node = 0;
+  for (int shift = 31; shift >= 0; --shift) {
+    node = m_trie[node].child[(host >> shift) & 1];
+    if (node < 0) {
+      break;
+    }
+    if (m_trie[node].policer >= 0) {
+      match = m_trie[node].policer;
+    }
+  }
+  if (match < 0) {
+    return VERDICT_PASS;
+  }
+
+  Policer& policer = *m_policers[match];
+  if (policer.bucket.consume(now)) {
+    policer.nPassed.fetch_add(1, std::memory_order_relaxed);
+    return VERDICT_PASS;
+  }
+  policer.nExcess.fetch_add(1, std::memory_order_relaxed);
+  return policer.rule.action == ACTION_DROP ? VERDICT_DROP : VERDICT_MARK;
+}
+
+void
+IngressPolicer::print(std::ostream& os) const
+{
+  os << "\nPolicer             Rate pps     Burst  Action          Passed          Excess\n"
+     << "--------------------------------------------------------------------------------\n";
+  for (const auto& policer : m_policers) {
+    const Rule& rule = policer->rule;
+    os << std::left << std::setw(18)
+       << (ipToString(rule.prefix) + "/" + std::to_string(rule.length)) << std::right
+       << std::setw(10) << static_cast<uint64_t>(rule.rate)
+       << std::setw(10) << static_cast<uint64_t>(rule.burst) << "  "
+       << std::left << std::setw(6) << (rule.action == ACTION_DROP ? "drop" : "mark") << std::right
+       << std::setw(16) << policer->nPassed.load(std::memory_order_relaxed)
+       << std::setw(16) << policer->nExcess.load(std::memory_order_relaxed) << "\n";
+  }
+}
+
+std::ostream&
+operator<<(std::ostream& os, const IngressPolicer& policer)
+{
+  policer.print(os);
+  return os;
+}
+
+} // namespace simple_router
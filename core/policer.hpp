@@ -0,0 +1,142 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * This header file defines the ingress policer that limits the packet rate of
+ * source prefixes before any routing work is done.
+ */
+
+#ifndef SIMPLE_ROUTER_CORE_POLICER_HPP
+#define SIMPLE_ROUTER_CORE_POLICER_HPP
+
+#include "protocol.hpp"
+#include "checksum.hpp"
+#include "token-bucket.hpp"
+
+#include <atomic>
+#include <memory>
+#include <ostream>
+
+namespace simple_router {
+
+/**
+ * DSCP that excess traffic is re-marked to: CS1, the lower-effort class
+ */
+const uint8_t DSCP_CS1 = 8;
+
+/**
+ * Set the DSCP bits of \p ip to \p dscp, keeping ECN, and update the header checksum
+ */
+inline void
+remarkDscp(ip_hdr* ip, uint8_t dscp)
+{
+  // TOS shares a 16-bit word of the header with version and header length
+  uint16_t oldWord;
+  memcpy(&oldWord, ip, sizeof(oldWord));
+  ip->ip_tos = (dscp << 2) | (ip->ip_tos & 0x03);
+  uint16_t newWord;
+  memcpy(&newWord, ip, sizeof(newWord));
+
+  ip->ip_sum = checksumAdjust(ip->ip_sum, oldWord, newWord);
+}
+
+/**
+ * Per-source-prefix packet rate limits applied on ingress
+ *
+ * Each rule has its own bucket, shared by all sources inside the prefix; a source
+ * is policed by its longest matching rule only.  Rules are added before traffic
+ * starts, after which police() takes no lock.
+ */
+class IngressPolicer
+{
+public:
+  enum Action {
+    ACTION_DROP,
+    ACTION_MARK, //< forward excess packets re-marked to DSCP_CS1
+  };
+
+  enum Verdict {
+    VERDICT_PASS,
+    VERDICT_DROP,
+    VERDICT_MARK,
+  };
+
+  struct Rule
+  {
+    uint32_t prefix; //< network byte order
+    uint8_t length;
+    double rate;     //< packets per second
+    double burst;    //< packets
+    Action action;
+  };
+
+  IngressPolicer();
+
+  /**
+   * Load rules from \p file, one per line: `prefix/length rate burst [drop|mark]`,
+   * with rate and burst in packets.  Blank lines and `#` comments are ignored.
+   *
+   * @throws std::runtime_error on a malformed line
+   */
+  void
+  load(const std::string& file);
+
+  void
+  addRule(const Rule& rule);
+
+  /**
+   * Charge a packet from \p src (network byte order) to its policer
+   */
+  Verdict
+  police(uint32_t src, uint64_t now);
+
+  size_t
+  size() const
+  {
+    return m_policers.size();
+  }
+
+  void
+  print(std::ostream& os) const;
+
+private:
+  struct Policer
+  {
+    explicit
+    Policer(const Rule& rule);
+
+    Rule rule;
+    AtomicTokenBucket bucket;
+    std::atomic<uint64_t> nPassed;
+    std::atomic<uint64_t> nExcess;
+  };
+
+  /**
+   * Binary trie node; children and policer are indices, -1 for none
+   */
+  struct Node
+  {
+    int32_t child[2];
+    int32_t policer;
+  };
+
+  std::vector<std::unique_ptr<Policer>> m_policers;
+  std::vector<Node> m_trie;
+};
+
+std::ostream&
+operator<<(std::ostream& os, const IngressPolicer& policer);
+
+} // namespace simple_router
+
+#endif // SIMPLE_ROUTER_CORE_POLICER_HPP
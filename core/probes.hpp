@@ -0,0 +1,61 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * This header file defines the USDT probes of the router, provider `simple_router`.
+ *
+ * A probe compiles to a single nop and an ELF note that tracers use to find it, so it
+ * costs nothing until perf or bpftrace attaches to it.  Probes are only built if
+ * <sys/sdt.h> (systemtap-sdt-dev) is installed, and can be left out with
+ * -DSR_WITHOUT_PROBES.  Addresses are passed in network byte order, names as C
+ * strings.  See tracing/ for example bpftrace scripts, and list them with
+ *
+ *     bpftrace -l 'usdt:./router:simple_router:*'
+ *
+ *     packet_receive(ifIndex, size, etherType)
+ *     packet_drop(reason, reasonName, count)   DropReason and dropReasonToString()
+ *     packet_send(ifIndex, size)
+ *     route_lookup(dst, gw, ifName)           gw 0 and ifName "" if there is no route
+ *     arp_miss(nextHop, ifName)
+ *     arp_queue(nextHop, nPending)             packet queued behind an ARP request
+ *     arp_request(nextHop, nTimesSent)         request (re)sent by the ARP ticker
+ *     arp_resolve(ip, nPending)                reply received, pending packets sent
+ *     arp_give_up(nextHop, nPending)           no reply, pending packets dropped
+ *     arp_expire(ip)                           stale cache entry removed
+ *     ndp_miss(nextHopHi, nextHopLo, ifName)   IPv6 addresses as two 64-bit halves in
+ *     ndp_resolve(ipHi, ipLo, nPending)        host byte order (see Ipv6Address)
+ */
+
+#ifndef SIMPLE_ROUTER_CORE_PROBES_HPP
+#define SIMPLE_ROUTER_CORE_PROBES_HPP
+
+#if !defined(SR_WITHOUT_PROBES) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define SR_HAVE_PROBES 1
+#endif
+#endif
+
+#ifdef SR_HAVE_PROBES
+#define SR_PROBE1(name, a1) DTRACE_PROBE1(simple_router, name, a1)
+#define SR_PROBE2(name, a1, a2) DTRACE_PROBE2(simple_router, name, a1, a2)
+#define SR_PROBE3(name, a1, a2, a3) DTRACE_PROBE3(simple_router, name, a1, a2, a3)
+#define SR_PROBE4(name, a1, a2, a3, a4) DTRACE_PROBE4(simple_router, name, a1, a2, a3, a4)
+#else
+#define SR_PROBE1(name, a1) do {} while (false)
+#define SR_PROBE2(name, a1, a2) do {} while (false)
+#define SR_PROBE3(name, a1, a2, a3) do {} while (false)
+#define SR_PROBE4(name, a1, a2, a3, a4) do {} while (false)
+#endif
+
+#endif // SIMPLE_ROUTER_CORE_PROBES_HPP
@@ -104,6 +104,44 @@ struct ip_hdr
 } __attribute__ ((packed)) ;
 
 
+/*
+ * Structure of the IPv6 header, without extension headers.  The fields are prefixed
+ * ipv6_ rather than ip6_, which <netinet/ip6.h> defines as macros.
+ */
+struct ipv6_hdr
+{
+  uint32_t ipv6_vtcf;              /* version, traffic class, flow label */
+  uint16_t ipv6_plen;              /* payload length */
+  uint8_t ipv6_nxt;                /* next header */
+  uint8_t ipv6_hlim;               /* hop limit */
+  uint8_t ipv6_src[16];            /* source address */
+  uint8_t ipv6_dst[16];            /* destination address */
+} __attribute__ ((packed)) ;
+
+/*
+ * Structure of an NDP neighbor solicitation or advertisement (ICMPv6 135/136),
+ * followed by options
+ */
+struct ndp_hdr
+{
+  uint8_t ndp_type;
+  uint8_t ndp_code;
+  uint16_t ndp_sum;
+  uint32_t ndp_flags;              /* router, solicited, override (advertisement only) */
+  uint8_t ndp_target[16];          /* target address */
+} __attribute__ ((packed)) ;
+
+/*
+ * NDP source/target link-layer address option for Ethernet
+ */
+struct ndp_lladdr_opt
+{
+  uint8_t ndp_opt_type;
+  uint8_t ndp_opt_len;             /* in units of 8 bytes */
+  uint8_t ndp_opt_mac[6];
+} __attribute__ ((packed)) ;
+
+
 /*
  *  Ethernet packet header prototype.  Too many O/S's define this differently.
  *  Easy enough to solve that and define it here.
@@ -122,11 +160,15 @@ static const uint8_t BroadcastEtherAddr[ETHER_ADDR_LEN] = {0xFF, 0xFF, 0xFF, 0xF
 
 enum ip_protocol {
   ip_protocol_icmp = 0x0001,
+  ip_protocol_tcp = 0x0006,
+  ip_protocol_udp = 0x0011,
+  ip_protocol_icmpv6 = 0x003a,
 };
 
 enum ethertype {
   ethertype_arp = 0x0806,
   ethertype_ip = 0x0800,
+  ethertype_ipv6 = 0x86dd,
 };
 
 enum arp_opcode {
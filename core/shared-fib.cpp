@@ -0,0 +1,392 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "shared-fib.hpp"
+#include "table-dump.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace simple_router {
+
+const uint32_t SharedFibControl::MAGIC;
+const uint32_t SharedFibControl::VERSION;
+const uint32_t SharedFibSegment::MAGIC;
+const uint32_t SharedFibSegment::VERSION;
+
+static std::string
+segmentName(const std::string& name, uint64_t generation)
+{
+  return name + "." + std::to_string(generation);
+}
+
+static size_t
+alignUp(size_t offset)
+{
+  return (offset + 63) & ~size_t(63);
+}
+
+/**
+ * Map all of the existing segment \p name
+ *
+ * @return nullptr, with errno set, if it cannot be opened or mapped
+ */
+static void*
+mapSegment(const std::string& name, bool isWritable, size_t& size)
+{
+  int fd = shm_open(name.c_str(), isWritable ? O_RDWR : O_RDONLY, 0);
+  if (fd < 0) {
+    return nullptr;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return nullptr;
+  }
+  size = st.st_size;
+  void* memory = mmap(nullptr, size, isWritable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  return memory == MAP_FAILED ? nullptr : memory;
+}
+
+/**
+ * Whether \p count records of \p recordSize bytes at \p offset fit a segment of \p size bytes
+ */
+static bool
+isWithin(uint64_t offset, uint64_t count, uint64_t recordSize, uint64_t size)
+{
+  return offset <= size && count <= (size - offset) / recordSize;
+}
+
+/**
+ * Whether every entry of \p fib is a value of at most \p nValues or, above the last
+ * level, a chunk within its tables.  A chunk is checked once, so a segment that
+ * references it many times costs no more, and is corrupt if used at both levels.
+ */
+static bool
+isTrieValid(const FibView& fib, uint32_t nValues)
+{
+  const uint32_t CHUNK_FLAG = FibView::CHUNK_FLAG;
+  const size_t CHUNK_SIZE = 256;
+  std::vector<uint8_t> levels(fib.nChunkEntries / CHUNK_SIZE, 0);
+
+  // whether the chunk of entry can be used at level; it is queued on its first reference
+  auto checkChunk = [&] (uint32_t entry, uint8_t level, std::vector<uint32_t>& next) {
+    uint32_t chunk = entry & ~CHUNK_FLAG;
+    if (chunk >= levels.size() || (levels[chunk] != 0 && levels[chunk] != level)) {
+      return false;
+    }
+    if (levels[chunk] == 0) {
+      levels[chunk] = level;
+      next.push_back(chunk);
+    }
+    return true;
+  };
+
+  std::vector<uint32_t> chunks2;
+  for (size_t i = 0; i < FibView::ROOT_SIZE; ++i) {
+    uint32_t entry = fib.root[i];
+    if ((entry & CHUNK_FLAG) ? !checkChunk(entry, 2, chunks2) : entry > nValues) {
+      return false;
+    }
+  }
+
+  std::vector<uint32_t> chunks3;
+  for (uint32_t chunk : chunks2) {
+    for (size_t i = 0; i < CHUNK_SIZE; ++i) {
+      uint32_t entry = fib.chunks[chunk * CHUNK_SIZE + i];
+      if ((entry & CHUNK_FLAG) ? !checkChunk(entry, 3, chunks3) : entry > nValues) {
+        return false;
+      }
+    }
+  }
+
+  for (uint32_t chunk : chunks3) {
+    for (size_t i = 0; i < CHUNK_SIZE; ++i) {
+      uint32_t entry = fib.chunks[chunk * CHUNK_SIZE + i];
+      if ((entry & CHUNK_FLAG) || entry > nValues) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * Whether the data segment \p segment of \p size bytes, starting with \p header, can
+ * be used as is: every table within the segment, every value of the trie a route,
+ * and every name field NUL terminated
+ */
+static bool
+isSegmentValid(const uint8_t* segment, size_t size, const SharedFibSegment& header)
+{
+  if (size < sizeof(header) || header.magic != SharedFibSegment::MAGIC ||
+      header.version != SharedFibSegment::VERSION || header.size != size ||
+      !isWithin(header.routesOffset, header.nRoutes, ROUTE_DUMP_RECORD_SIZE, size) ||
+      !isWithin(header.routes6Offset, header.nRoutes6, SHARED_FIB_ROUTE6_SIZE, size) ||
+      header.rootOffset % sizeof(uint32_t) != 0 || header.chunksOffset % sizeof(uint32_t) != 0 ||
+      !isWithin(header.rootOffset, FibView::ROOT_SIZE, sizeof(uint32_t), size) ||
+      !isWithin(header.chunksOffset, header.nChunkEntries, sizeof(uint32_t), size) ||
+      header.nChunkEntries % 256 != 0) {
+    return false;
+  }
+
+  const uint8_t* record = segment + header.routesOffset;
+  for (size_t i = 0; i < header.nRoutes; ++i, record += ROUTE_DUMP_RECORD_SIZE) {
+    if (record[12 + MAX_IFNAME_LENGTH] != 0) {
+      return false;
+    }
+  }
+  record = segment + header.routes6Offset;
+  for (size_t i = 0; i < header.nRoutes6; ++i, record += SHARED_FIB_ROUTE6_SIZE) {
+    if (record[32] > 128 || record[36 + MAX_IFNAME_LENGTH] != 0) {
+      return false;
+    }
+  }
+
+  FibView fib;
+  fib.root = reinterpret_cast<const uint32_t*>(segment + header.rootOffset);
+  fib.chunks = reinterpret_cast<const uint32_t*>(segment + header.chunksOffset);
+  fib.nChunkEntries = header.nChunkEntries;
+  return isTrieValid(fib, header.nRoutes);
+}
+
+uint64_t
+SharedFib::publish(const std::string& name, const std::vector<RoutingTableEntry>& routes, const FibView& fib,
+                   const std::vector<RoutingTableEntry6>& routes6)
+{
+  // encoded first, so that a name too long for its record fails before anything is created
+  Buffer records;
+  encodeRoutingEntries(routes, records);
+  Buffer records6(routes6.size() * SHARED_FIB_ROUTE6_SIZE, 0);
+  uint8_t* record = records6.data();
+  for (const auto& route : routes6) {
+    route.dest.toBytes(record);
+    route.gw.toBytes(record + 16);
+    record[32] = route.length;
+    encodeIfName(route.ifName, record + 36);
+    record += SHARED_FIB_ROUTE6_SIZE;
+  }
+
+  int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+  if (fd < 0) {
+    throw std::runtime_error("Cannot create FIB segment `" + name + "`: " + strerror(errno));
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (st.st_size == 0 && ftruncate(fd, sizeof(SharedFibControl)) != 0)) {
+    close(fd);
+    throw std::runtime_error("Cannot size FIB segment `" + name + "`: " + strerror(errno));
+  }
+  void* memory = mmap(nullptr, sizeof(SharedFibControl), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED) {
+    throw std::runtime_error("Cannot map FIB segment `" + name + "`: " + strerror(errno));
+  }
+  SharedFibControl* control = static_cast<SharedFibControl*>(memory);
+  if (st.st_size == 0) {
+    control->magic = SharedFibControl::MAGIC;
+    control->version = SharedFibControl::VERSION;
+  }
+  else if (control->magic != SharedFibControl::MAGIC || control->version != SharedFibControl::VERSION) {
+    munmap(memory, sizeof(SharedFibControl));
+    throw std::runtime_error("`" + name + "` is not a FIB segment");
+  }
+
+  uint64_t previous = __atomic_load_n(&control->generation, __ATOMIC_ACQUIRE);
+  uint64_t generation = previous + 1;
+
+  SharedFibSegment header;
+  memset(&header, 0, sizeof(header));
+  header.magic = SharedFibSegment::MAGIC;
+  header.version = SharedFibSegment::VERSION;
+  header.generation = generation;
+  header.nRoutes = routes.size();
+  header.nRoutes6 = routes6.size();
+  header.nChunkEntries = fib.nChunkEntries;
+  header.routesOffset = sizeof(SharedFibSegment);
+  header.routes6Offset = header.routesOffset + routes.size() * ROUTE_DUMP_RECORD_SIZE;
+  header.rootOffset = alignUp(header.routes6Offset + routes6.size() * SHARED_FIB_ROUTE6_SIZE);
+  header.chunksOffset = header.rootOffset + FibView::ROOT_SIZE * sizeof(uint32_t);
+  header.size = header.chunksOffset + fib.nChunkEntries * sizeof(uint32_t);
+
+  // O_EXCL: a concurrent publisher of the same generation fails instead of mixing tables
+  std::string dataName = segmentName(name, generation);
+  fd = shm_open(dataName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd < 0 || ftruncate(fd, header.size) != 0) {
+    std::string error = strerror(errno);
+    if (fd >= 0) {
+      close(fd);
+      shm_unlink(dataName.c_str());
+    }
+    munmap(control, sizeof(SharedFibControl));
+    throw std::runtime_error("Cannot create FIB segment `" + dataName + "`: " + error);
+  }
+  memory = mmap(nullptr, header.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED) {
+    std::string error = strerror(errno);
+    shm_unlink(dataName.c_str());
+    munmap(control, sizeof(SharedFibControl));
+    throw std::runtime_error("Cannot map FIB segment `" + dataName + "`: " + error);
+  }
+
+  uint8_t* segment = static_cast<uint8_t*>(memory);
+  memcpy(segment, &header, sizeof(header));
+
+  std::copy(records.begin(), records.end(), segment + header.routesOffset);
+  std::copy(records6.begin(), records6.end(), segment + header.routes6Offset);
+
+  memcpy(segment + header.rootOffset, fib.root, FibView::ROOT_SIZE * sizeof(uint32_t));
+  if (fib.nChunkEntries != 0) {
+    memcpy(segment + header.chunksOffset, fib.chunks, fib.nChunkEntries * sizeof(uint32_t));
+  }
+  munmap(memory, header.size);
+
+  __atomic_store_n(&control->generation, generation, __ATOMIC_RELEASE);
+  munmap(control, sizeof(SharedFibControl));
+
+  if (previous != 0) {
+    shm_unlink(segmentName(name, previous).c_str());
+  }
+  return generation;
+}
+
+void
+SharedFib::remove(const std::string& name)
+{
+  size_t size = 0;
+  void* memory = mapSegment(name, false, size);
+  if (memory != nullptr) {
+    if (size >= sizeof(SharedFibControl)) {
+      uint64_t generation = __atomic_load_n(&static_cast<SharedFibControl*>(memory)->generation,
+                                            __ATOMIC_ACQUIRE);
+      shm_unlink(segmentName(name, generation).c_str());
+    }
+    munmap(memory, size);
+  }
+  shm_unlink(name.c_str());
+}
+
+SharedFib::SharedFib(const std::string& name)
+  : m_control(nullptr)
+  , m_segment(nullptr)
+  , m_size(0)
+  , m_generation(0)
+{
+  size_t controlSize = 0;
+  void* control = mapSegment(name, false, controlSize);
+  if (control == nullptr) {
+    throw std::runtime_error("Cannot map FIB segment `" + name + "`: " + strerror(errno));
+  }
+  m_control = static_cast<const SharedFibControl*>(control);
+  if (controlSize < sizeof(SharedFibControl) || m_control->magic != SharedFibControl::MAGIC ||
+      m_control->version != SharedFibControl::VERSION) {
+    munmap(control, controlSize);
+    throw std::runtime_error("`" + name + "` is not a FIB segment");
+  }
+
+  // the publisher unlinks the previous generation right after the swap, so a
+  // generation read just before one may be gone: read it again
+  void* memory = nullptr;
+  for (int attempt = 0; memory == nullptr && attempt < 3; ++attempt) {
+    m_generation = __atomic_load_n(&m_control->generation, __ATOMIC_ACQUIRE);
+    if (m_generation == 0) {
+      break;
+    }
+    memory = mapSegment(segmentName(name, m_generation), false, m_size);
+  }
+  if (memory == nullptr) {
+    munmap(control, sizeof(SharedFibControl));
+    throw std::runtime_error("No FIB published in `" + name + "`");
+  }
+  m_segment = static_cast<const uint8_t*>(memory);
+
+  // everything is checked before any of it is used, as the segment is another process's
+  SharedFibSegment header;
+  memcpy(&header, m_segment, std::min(sizeof(header), m_size));
+  if (!isSegmentValid(m_segment, m_size, header)) {
+    munmap(memory, m_size);
+    munmap(control, sizeof(SharedFibControl));
+    throw std::runtime_error("FIB segment `" + segmentName(name, m_generation) + "` is corrupt");
+  }
+
+  m_fib.root = reinterpret_cast<const uint32_t*>(m_segment + header.rootOffset);
+  m_fib.chunks = reinterpret_cast<const uint32_t*>(m_segment + header.chunksOffset);
+  m_fib.nChunkEntries = header.nChunkEntries;
+
+  m_routes.reserve(header.nRoutes);
+  const uint8_t* record = m_segment + header.routesOffset;
+  for (size_t i = 0; i < header.nRoutes; ++i, record += ROUTE_DUMP_RECORD_SIZE) {
+    RoutingTableEntry route;
+    memcpy(&route.dest, record, 4);
+    memcpy(&route.mask, record + 4, 4);
+    memcpy(&route.gw, record + 8, 4);
+    route.ifName = decodeIfName(record + 12);
+    m_routes.push_back(std::move(route));
+  }
+
+  std::vector<Fib6Prefix> prefixes6;
+  m_routes6.reserve(header.nRoutes6);
+  record = m_segment + header.routes6Offset;
+  for (size_t i = 0; i < header.nRoutes6; ++i, record += SHARED_FIB_ROUTE6_SIZE) {
+    RoutingTableEntry6 route;
+    route.dest = Ipv6Address::fromBytes(record);
+    route.gw = Ipv6Address::fromBytes(record + 16);
+    route.length = record[32];
+    route.ifName = decodeIfName(record + 36);
+    prefixes6.push_back({route.dest, route.length, static_cast<uint32_t>(i + 1)});
+    m_routes6.push_back(std::move(route));
+  }
+  m_fib6.build(prefixes6);
+}
+
+SharedFib::~SharedFib()
+{
+  munmap(const_cast<uint8_t*>(m_segment), m_size);
+  munmap(const_cast<SharedFibControl*>(m_control), sizeof(SharedFibControl));
+}
+
+void
+SharedFib::findBatch(const uint32_t* ips, size_t count, const RoutingTableEntry** entries) const
+{
+  const size_t BATCH = 32;
+  uint32_t addresses[BATCH];
+  uint32_t indices[BATCH];
+  for (size_t start = 0; start < count; start += BATCH) {
+    size_t n = std::min(BATCH, count - start);
+    for (size_t i = 0; i < n; ++i) {
+      addresses[i] = ntohl(ips[start + i]);
+    }
+    m_fib.lookupBatch(addresses, n, indices);
+    for (size_t i = 0; i < n; ++i) {
+      entries[start + i] = indices[i] == 0 ? nullptr : &m_routes[indices[i] - 1];
+    }
+  }
+}
+
+size_t
+SharedFib::getMemoryUsage() const
+{
+  return m_routes.capacity() * sizeof(RoutingTableEntry) + m_fib6.getMemoryUsage() +
+         m_routes6.capacity() * sizeof(RoutingTableEntry6);
+}
+
+} // namespace simple_router
@@ -0,0 +1,186 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * This header file defines the shared memory FIB: a compiled routing table that one
+ * process publishes into a named POSIX shared memory segment and that the routers on
+ * the same host map read-only instead of building their own.
+ */
+
+#ifndef SIMPLE_ROUTER_CORE_SHARED_FIB_HPP
+#define SIMPLE_ROUTER_CORE_SHARED_FIB_HPP
+
+#include "fib.hpp"
+#include "fib6.hpp"
+#include "routing-table.hpp"
+
+namespace simple_router {
+
+/**
+ * Layout of the control segment, named after the FIB (e.g. "/simple-router-fib")
+ *
+ * It only holds the generation currently published.  Every generation is a separate
+ * data segment named "<name>.<generation>", which is never modified once the control
+ * segment points to it; a new generation is published by writing its data segment
+ * and then swapping the generation number.  The publisher unlinks the previous data
+ * segment, and routers that still map it keep it alive until they move on.
+ */
+struct SharedFibControl
+{
+  static const uint32_t MAGIC = 0x53524643; // "SRFC"
+  static const uint32_t VERSION = 1;
+
+  uint32_t magic;
+  uint32_t version;
+  uint64_t generation; //< 0 if nothing was published yet
+};
+
+/**
+ * Header of a data segment, followed by the route records in the
+ * ROUTE_DUMP_RECORD_SIZE format of the table dumps (in the order of the values of the
+ * trie), the IPv6 route records of SHARED_FIB_ROUTE6_SIZE bytes: destination (16),
+ * gateway (16), prefix length (1), padding (3), interface name (16, NUL padded), and
+ * the root and chunk tables of the trie.  Header fields are in host byte order.
+ */
+struct SharedFibSegment
+{
+  static const uint32_t MAGIC = 0x53524644; // "SRFD"
+  static const uint32_t VERSION = 1;
+
+  uint32_t magic;
+  uint32_t version;
+  uint64_t generation;
+  uint32_t nRoutes;
+  uint32_t nRoutes6;
+  uint64_t nChunkEntries;
+  uint64_t routesOffset;
+  uint64_t routes6Offset;
+  uint64_t rootOffset;
+  uint64_t chunksOffset;
+  uint64_t size;
+};
+
+const size_t SHARED_FIB_ROUTE6_SIZE = 52;
+
+/**
+ * Read-only mapping of one generation of a shared FIB
+ *
+ * The IPv4 trie is used in place.  The route entries are copied out, since lookups
+ * return RoutingTableEntry pointers, and the (usually small) IPv6 table is built
+ * locally from its records.
+ */
+class SharedFib
+{
+public:
+  /**
+   * Map the current generation of \p name
+   *
+   * @throw std::runtime_error if nothing is published under \p name
+   */
+  explicit SharedFib(const std::string& name);
+
+  ~SharedFib();
+
+  SharedFib(const SharedFib&) = delete;
+
+  SharedFib&
+  operator=(const SharedFib&) = delete;
+
+  /**
+   * Publish \p routes, whose positions (counting from 1) are the values of \p fib,
+   * and \p routes6 as the next generation of \p name
+   *
+   * @return the new generation
+   * @throw std::runtime_error if the segments cannot be created
+   */
+  static uint64_t
+  publish(const std::string& name, const std::vector<RoutingTableEntry>& routes, const FibView& fib,
+          const std::vector<RoutingTableEntry6>& routes6);
+
+  /**
+   * Unlink the control and current data segment of \p name
+   */
+  static void
+  remove(const std::string& name);
+
+  uint64_t
+  getGeneration() const
+  {
+    return m_generation;
+  }
+
+  /**
+   * @return false once a newer generation has been published
+   */
+  bool
+  isCurrent() const
+  {
+    return __atomic_load_n(&m_control->generation, __ATOMIC_ACQUIRE) == m_generation;
+  }
+
+  const RoutingTableEntry*
+  find(uint32_t ip) const
+  {
+    uint32_t index = m_fib.lookup(ntohl(ip));
+    return index == 0 ? nullptr : &m_routes[index - 1];
+  }
+
+  void
+  findBatch(const uint32_t* ips, size_t count, const RoutingTableEntry** entries) const;
+
+  const RoutingTableEntry6*
+  findIpv6(const Ipv6Address& ip) const
+  {
+    uint32_t index = m_fib6.lookup(ip);
+    return index == 0 ? nullptr : &m_routes6[index - 1];
+  }
+
+  const std::vector<RoutingTableEntry>&
+  getRoutes() const
+  {
+    return m_routes;
+  }
+
+  const std::vector<RoutingTableEntry6>&
+  getIpv6Routes() const
+  {
+    return m_routes6;
+  }
+
+  /**
+   * Bytes of this process's own copies, not counting the shared segment
+   */
+  size_t
+  getMemoryUsage() const;
+
+  size_t
+  getSegmentSize() const
+  {
+    return m_size;
+  }
+
+private:
+  const SharedFibControl* m_control;
+  const uint8_t* m_segment;
+  size_t m_size;
+  uint64_t m_generation;
+
+  FibView m_fib;
+  std::vector<RoutingTableEntry> m_routes;
+  std::vector<RoutingTableEntry6> m_routes6;
+  Fib6 m_fib6;
+};
+
+} // namespace simple_router
+
+#endif // SIMPLE_ROUTER_CORE_SHARED_FIB_HPP
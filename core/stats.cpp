@@ -0,0 +1,228 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "stats.hpp"
+
+#include <functional>
+#include <iomanip>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace simple_router {
+
+const char*
+dropReasonToString(DropReason reason)
+{
+  switch (reason) {
+  case DROP_BAD_CHECKSUM:
+    return "bad-checksum";
+  case DROP_TTL_EXPIRED:
+    return "ttl-expired";
+  case DROP_NO_ROUTE:
+    return "no-route";
+  case DROP_ARP_FAILURE:
+    return "arp-failure";
+  case DROP_NOT_FOR_US:
+    return "not-for-us";
+  case DROP_UNKNOWN_ETHERTYPE:
+    return "unknown-ethertype";
+  case DROP_MALFORMED:
+    return "malformed";
+  case DROP_LOCAL:
+    return "local";
+  case DROP_UNKNOWN_IFACE:
+    return "unknown-iface";
+  case DROP_QUEUE_FULL:
+    return "queue-full";
+  case DROP_POLICED:
+    return "policed";
+  case DROP_NDP_FAILURE:
+    return "ndp-failure";
+  case DROP_NAT:
+    return "nat";
+  case DROP_ACL:
+    return "acl";
+  default:
+    return "unknown";
+  }
+}
+
+PacketStats::PacketStats()
+  : m_blocks(&PacketStats::newBlock, &PacketStats::deleteBlock)
+{
+}
+
+PacketStats::Block*
+PacketStats::newBlock()
+{
+  // whole cache lines, so that blocks of different threads never share one
+  size_t size = (sizeof(Block) + 63) & ~size_t(63);
+  void* memory = nullptr;
+  if (posix_memalign(&memory, 64, size) != 0) {
+    throw std::bad_alloc();
+  }
+  Block* block = new (memory) Block;
+  for (auto& iface : block->ifaces) {
+    for (auto& counter : iface) {
+      counter.store(0, std::memory_order_relaxed);
+    }
+  }
+  for (auto& counter : block->drops) {
+    counter.store(0, std::memory_order_relaxed);
+  }
+  return block;
+}
+
+void
+PacketStats::deleteBlock(Block* block)
+{
+  block->~Block();
+  free(block);
+}
+
+void
+PacketStats::setInterfaces(const std::vector<std::string>& names)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_ifNames = names;
+}
+
+StatsSnapshot
+PacketStats::aggregate() const
+{
+  StatsSnapshot snapshot;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    snapshot.ifNames = m_ifNames;
+  }
+  m_blocks.forEach([&snapshot] (const Block& block) {
+    for (size_t i = 0; i < STATS_MAX_IFACES; ++i) {
+      snapshot.ifaces[i].rxPackets += block.ifaces[i][0].load(std::memory_order_relaxed);
+      snapshot.ifaces[i].rxBytes += block.ifaces[i][1].load(std::memory_order_relaxed);
+      snapshot.ifaces[i].txPackets += block.ifaces[i][2].load(std::memory_order_relaxed);
+      snapshot.ifaces[i].txBytes += block.ifaces[i][3].load(std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < N_DROP_REASONS; ++i) {
+      snapshot.drops[i] += block.drops[i].load(std::memory_order_relaxed);
+    }
+  });
+  return snapshot;
+}
+
+std::ostream&
+operator<<(std::ostream& os, const StatsSnapshot& stats)
+{
+  os << "\nIface        RX packets      RX bytes  TX packets      TX bytes\n"
+     << "----------------------------------------------------------------\n";
+  for (size_t i = 0; i < stats.ifNames.size() && i < STATS_MAX_IFACES; ++i) {
+    const IfaceCounters& c = stats.ifaces[i];
+    os << std::left << std::setw(10) << stats.ifNames[i] << std::right
+       << std::setw(13) << c.rxPackets << std::setw(14) << c.rxBytes
+       << std::setw(12) << c.txPackets << std::setw(14) << c.txBytes << "\n";
+  }
+
+  os << "\nDrop reason              Packets\n"
+     << "--------------------------------\n";
+  for (size_t i = 0; i < N_DROP_REASONS; ++i) {
+    os << std::left << std::setw(20) << dropReasonToString(static_cast<DropReason>(i)) << std::right
+       << std::setw(12) << stats.drops[i] << "\n";
+  }
+  os << std::endl;
+  return os;
+}
+
+StatsPublisher::StatsPublisher(const PacketStats& stats, const std::string& name,
+                               std::chrono::milliseconds interval)
+  : m_stats(stats)
+  , m_name(name)
+  , m_interval(interval)
+  , m_shouldStop(false)
+{
+  int fd = shm_open(m_name.c_str(), O_CREAT | O_RDWR, 0644);
+  if (fd < 0) {
+    throw std::runtime_error("Cannot create stats segment `" + m_name + "`: " + strerror(errno));
+  }
+  if (ftruncate(fd, sizeof(StatsSegment)) != 0) {
+    close(fd);
+    throw std::runtime_error("Cannot size stats segment `" + m_name + "`: " + strerror(errno));
+  }
+  void* memory = mmap(nullptr, sizeof(StatsSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED) {
+    throw std::runtime_error("Cannot map stats segment `" + m_name + "`: " + strerror(errno));
+  }
+
+  m_segment = static_cast<StatsSegment*>(memory);
+  memset(static_cast<void*>(m_segment), 0, sizeof(StatsSegment));
+  m_segment->magic = StatsSegment::MAGIC;
+  m_segment->version = StatsSegment::VERSION;
+  m_segment->nDropReasons = N_DROP_REASONS;
+
+  m_thread = std::thread(std::bind(&StatsPublisher::run, this));
+}
+
+StatsPublisher::~StatsPublisher()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_stopMutex);
+    m_shouldStop = true;
+  }
+  m_stopCv.notify_one();
+  m_thread.join();
+
+  munmap(m_segment, sizeof(StatsSegment));
+  shm_unlink(m_name.c_str());
+}
+
+void
+StatsPublisher::run()
+{
+  std::unique_lock<std::mutex> lock(m_stopMutex);
+  while (!m_shouldStop) {
+    lock.unlock();
+    publish();
+    lock.lock();
+    m_stopCv.wait_for(lock, m_interval);
+  }
+}
+
+void
+StatsPublisher::publish()
+{
+  StatsSnapshot snapshot = m_stats.aggregate();
+  timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+
+  uint64_t sequence = m_segment->sequence;
+  __atomic_store_n(&m_segment->sequence, sequence + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+
+  m_segment->timestamp = static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+  m_segment->nIfaces = std::min(snapshot.ifNames.size(), STATS_MAX_IFACES);
+  for (size_t i = 0; i < m_segment->nIfaces; ++i) {
+    strncpy(m_segment->ifNames[i], snapshot.ifNames[i].c_str(), sizeof(m_segment->ifNames[i]) - 1);
+  }
+  memcpy(m_segment->ifaces, snapshot.ifaces, sizeof(snapshot.ifaces));
+  memcpy(m_segment->drops, snapshot.drops, sizeof(snapshot.drops));
+
+  __atomic_store_n(&m_segment->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+} // namespace simple_router
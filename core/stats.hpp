@@ -0,0 +1,223 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * This header file defines the packet and drop counters of the router and the layout
+ * of the shared memory segment they are published in.
+ */
+
+#ifndef SIMPLE_ROUTER_CORE_STATS_HPP
+#define SIMPLE_ROUTER_CORE_STATS_HPP
+
+#include "protocol.hpp"
+#include "thread-blocks.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <ostream>
+#include <thread>
+
+namespace simple_router {
+
+const size_t STATS_MAX_IFACES = 16;
+
+enum DropReason {
+  DROP_BAD_CHECKSUM,      //< IPv4 header checksum mismatch
+  DROP_TTL_EXPIRED,       //< TTL reached zero
+  DROP_NO_ROUTE,          //< No routing table entry for the destination
+  DROP_ARP_FAILURE,       //< Next hop did not answer ARP requests
+  DROP_NOT_FOR_US,        //< Frame or ARP request addressed to somebody else
+  DROP_UNKNOWN_ETHERTYPE, //< Neither ARP, IPv4 nor IPv6
+  DROP_MALFORMED,         //< Truncated or otherwise invalid packet
+  DROP_LOCAL,             //< Addressed to the router, which does not handle it
+  DROP_UNKNOWN_IFACE,     //< Received on an interface the router does not know
+  DROP_QUEUE_FULL,        //< Egress queue of the class over its byte limit
+  DROP_POLICED,           //< Source prefix over its ingress rate
+  DROP_NDP_FAILURE,       //< IPv6 next hop did not answer neighbor solicitations
+  DROP_NAT,               //< Leaving through the NAT outside interface, but not translatable
+  DROP_ACL,               //< Denied by an ACL rule
+  N_DROP_REASONS
+};
+
+const char*
+dropReasonToString(DropReason reason);
+
+struct IfaceCounters
+{
+  uint64_t rxPackets = 0;
+  uint64_t rxBytes = 0;
+  uint64_t txPackets = 0;
+  uint64_t txBytes = 0;
+};
+
+/**
+ * Aggregated view of all counters
+ */
+struct StatsSnapshot
+{
+  std::vector<std::string> ifNames;
+  IfaceCounters ifaces[STATS_MAX_IFACES];
+  uint64_t drops[N_DROP_REASONS] = {};
+};
+
+std::ostream&
+operator<<(std::ostream& os, const StatsSnapshot& stats);
+
+/**
+ * Packet counters of the router
+ *
+ * Each thread that updates counters gets its own cache-line aligned block, so the
+ * forwarding path only performs plain (relaxed) stores to memory no other thread
+ * writes.  Readers sum all blocks.
+ */
+class PacketStats
+{
+public:
+  PacketStats();
+
+  void
+  rx(uint32_t ifIndex, size_t bytes);
+
+  void
+  tx(uint32_t ifIndex, size_t bytes);
+
+  void
+  drop(DropReason reason, uint64_t count = 1);
+
+  /**
+   * Set the names of the interfaces, indexed by Interface::index
+   */
+  void
+  setInterfaces(const std::vector<std::string>& names);
+
+  StatsSnapshot
+  aggregate() const;
+
+private:
+  struct Block
+  {
+    std::atomic<uint64_t> ifaces[STATS_MAX_IFACES][4];
+    std::atomic<uint64_t> drops[N_DROP_REASONS];
+  };
+
+  static void
+  increment(std::atomic<uint64_t>& counter, uint64_t value);
+
+  static Block*
+  newBlock();
+
+  static void
+  deleteBlock(Block* block);
+
+private:
+  ThreadBlocks<Block> m_blocks;
+  mutable std::mutex m_mutex;
+  std::vector<std::string> m_ifNames;
+};
+
+inline void
+PacketStats::increment(std::atomic<uint64_t>& counter, uint64_t value)
+{
+  // single writer per block: no need for an atomic read-modify-write
+  counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+inline void
+PacketStats::rx(uint32_t ifIndex, size_t bytes)
+{
+  if (ifIndex < STATS_MAX_IFACES) {
+    Block& block = m_blocks.get();
+    increment(block.ifaces[ifIndex][0], 1);
+    increment(block.ifaces[ifIndex][1], bytes);
+  }
+}
+
+inline void
+PacketStats::tx(uint32_t ifIndex, size_t bytes)
+{
+  if (ifIndex < STATS_MAX_IFACES) {
+    Block& block = m_blocks.get();
+    increment(block.ifaces[ifIndex][2], 1);
+    increment(block.ifaces[ifIndex][3], bytes);
+  }
+}
+
+inline void
+PacketStats::drop(DropReason reason, uint64_t count)
+{
+  increment(m_blocks.get().drops[reason], count);
+}
+
+/**
+ * Layout of the shared memory stats segment
+ *
+ * The segment is rewritten by the router every publish interval.  Readers map it
+ * read-only and use the sequence number as a seqlock: it is odd while the router
+ * is writing, so a reader copies the segment, and retries if the sequence was odd
+ * or changed during the copy.  All fields are in host byte order.
+ */
+struct StatsSegment
+{
+  static const uint32_t MAGIC = 0x53525354; // "SRST"
+  static const uint32_t VERSION = 1;
+
+  uint32_t magic;
+  uint32_t version;
+  uint64_t sequence;
+  uint64_t timestamp; //< nanoseconds since the epoch of the last update
+  uint32_t nIfaces;
+  uint32_t nDropReasons;
+  char ifNames[STATS_MAX_IFACES][16];
+  IfaceCounters ifaces[STATS_MAX_IFACES];
+  uint64_t drops[N_DROP_REASONS];
+};
+
+/**
+ * Periodically copies aggregated counters into a POSIX shared memory segment
+ */
+class StatsPublisher
+{
+public:
+  /**
+   * @param name shm_open name of the segment, e.g. "/simple-router-stats"
+   * @throw std::runtime_error if the segment cannot be created
+   */
+  StatsPublisher(const PacketStats& stats, const std::string& name,
+                 std::chrono::milliseconds interval);
+
+  ~StatsPublisher();
+
+private:
+  void
+  run();
+
+  void
+  publish();
+
+private:
+  const PacketStats& m_stats;
+  std::string m_name;
+  std::chrono::milliseconds m_interval;
+  StatsSegment* m_segment;
+
+  std::mutex m_stopMutex;
+  std::condition_variable m_stopCv;
+  bool m_shouldStop;
+  std::thread m_thread;
+};
+
+} // namespace simple_router
+
+#endif // SIMPLE_ROUTER_CORE_STATS_HPP
@@ -0,0 +1,148 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "table-dump.hpp"
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+
+#include <string.h>
+
+namespace simple_router {
+
+const size_t DumpCursors::MAX_OPEN_DUMPS;
+const size_t DumpCursors::MAX_PAGE_RECORDS;
+
+void
+encodeIfName(const std::string& name, uint8_t* field)
+{
+  if (name.size() > MAX_IFNAME_LENGTH) {
+    throw std::runtime_error("Interface name `" + name + "` is longer than " +
+                             std::to_string(MAX_IFNAME_LENGTH) + " characters");
+  }
+  memset(field, 0, MAX_IFNAME_LENGTH + 1);
+  memcpy(field, name.data(), name.size());
+}
+
+std::string
+decodeIfName(const uint8_t* field)
+{
+  const char* name = reinterpret_cast<const char*>(field);
+  return std::string(name, strnlen(name, MAX_IFNAME_LENGTH + 1));
+}
+
+void
+encodeArpEntries(const std::vector<ArpEntryInfo>& entries, time_point now, Buffer& records)
+{
+  records.assign(entries.size() * ARP_DUMP_RECORD_SIZE, 0);
+  uint8_t* record = records.data();
+  for (const auto& entry : entries) {
+    uint32_t age = htonl(static_cast<uint32_t>(
+      std::max<int64_t>(std::chrono::duration_cast<seconds>(now - entry.timeAdded).count(), 0)));
+    memcpy(record, &entry.ip, 4);
+    memcpy(record + 4, entry.mac, ETHER_ADDR_LEN);
+    record[10] = entry.isValid ? 1 : 0;
+    memcpy(record + 12, &age, 4);
+    record += ARP_DUMP_RECORD_SIZE;
+  }
+}
+
+void
+encodeRoutingEntries(const std::vector<RoutingTableEntry>& entries, Buffer& records)
+{
+  records.assign(entries.size() * ROUTE_DUMP_RECORD_SIZE, 0);
+  uint8_t* record = records.data();
+  for (const auto& entry : entries) {
+    memcpy(record, &entry.dest, 4);
+    memcpy(record + 4, &entry.mask, 4);
+    memcpy(record + 8, &entry.gw, 4);
+    encodeIfName(entry.ifName, record + 12);
+    record += ROUTE_DUMP_RECORD_SIZE;
+  }
+}
+
+DumpCursors::DumpCursors(size_t recordSize, const Snapshot& snapshot, std::chrono::seconds idleTimeout)
+  : m_recordSize(recordSize)
+  , m_snapshot(snapshot)
+  , m_idleTimeout(idleTimeout)
+{
+  // cursors of an earlier run of the router are not mistaken for open ones
+  m_nextCursor = static_cast<uint64_t>(std::random_device()() & 0xffffff) << 20 | 1;
+}
+
+DumpCursors::Page
+DumpCursors::next(uint64_t cursor, size_t maxRecords)
+{
+  auto now = steady_clock::now();
+  std::shared_ptr<const Buffer> records;
+  size_t offset = 0;
+
+  if (cursor == 0) {
+    // copy outside of m_mutex, the table is only locked by m_snapshot itself
+    auto snapshot = std::make_shared<Buffer>();
+    m_snapshot(*snapshot);
+    records = snapshot;
+  }
+  else {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto dump = m_dumps.find(cursor);
+    if (dump == m_dumps.end()) {
+      throw std::out_of_range("Dump cursor is not open");
+    }
+    records = dump->second.records;
+    offset = dump->second.offset;
+    m_dumps.erase(dump);
+  }
+
+  size_t nRecords = std::min(std::max<size_t>(maxRecords, 1), MAX_PAGE_RECORDS);
+  size_t end = std::min(records->size(), offset + nRecords * m_recordSize);
+
+  Page page;
+  page.cursor = 0;
+  page.records.assign(records->begin() + offset, records->begin() + end);
+
+  if (end < records->size()) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    expire(now);
+    page.cursor = m_nextCursor++;
+    m_dumps[page.cursor] = Dump{records, end, now};
+  }
+  return page;
+}
+
+void
+DumpCursors::expire(steady_clock::time_point now)
+{
+  for (auto dump = m_dumps.begin(); dump != m_dumps.end(); ) {
+    if (now - dump->second.lastUsed > m_idleTimeout) {
+      dump = m_dumps.erase(dump);
+    }
+    else {
+      ++dump;
+    }
+  }
+
+  while (m_dumps.size() >= MAX_OPEN_DUMPS) {
+    auto oldest = std::min_element(m_dumps.begin(), m_dumps.end(),
+                                   [] (const std::pair<const uint64_t, Dump>& a,
+                                       const std::pair<const uint64_t, Dump>& b) {
+                                     return a.second.lastUsed < b.second.lastUsed;
+                                   });
+    m_dumps.erase(oldest);
+  }
+}
+
+} // namespace simple_router
@@ -0,0 +1,140 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * This header file defines the paged, cursor based dumps of the router tables
+ * served by the Tester interface.
+ */
+
+#ifndef SIMPLE_ROUTER_CORE_TABLE_DUMP_HPP
+#define SIMPLE_ROUTER_CORE_TABLE_DUMP_HPP
+
+#include "protocol.hpp"
+#include "arp-cache.hpp"
+#include "routing-table.hpp"
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace simple_router {
+
+/**
+ * ARP dump record, 16 bytes in network byte order: IPv4 address (4), MAC (6),
+ * valid flag (1), padding (1), age in seconds (4)
+ */
+const size_t ARP_DUMP_RECORD_SIZE = 16;
+
+/**
+ * Routing table dump record, 28 bytes in network byte order: destination (4),
+ * mask (4), gateway (4), interface name (16, NUL padded)
+ */
+const size_t ROUTE_DUMP_RECORD_SIZE = 28;
+
+/**
+ * Longest interface name that fits the 16-byte NUL-padded name field of a record.
+ * Tables reject longer names when loading, so that names are never cut.
+ */
+const size_t MAX_IFNAME_LENGTH = 15;
+
+/**
+ * Copy \p name into the 16-byte name field \p field
+ *
+ * @throw std::runtime_error if \p name is longer than MAX_IFNAME_LENGTH
+ */
+void
+encodeIfName(const std::string& name, uint8_t* field);
+
+/**
+ * Name in the 16-byte name field \p field
+ */
+std::string
+decodeIfName(const uint8_t* field);
+
+void
+encodeArpEntries(const std::vector<ArpEntryInfo>& entries, time_point now, Buffer& records);
+
+void
+encodeRoutingEntries(const std::vector<RoutingTableEntry>& entries, Buffer& records);
+
+/**
+ * Open dumps of one table
+ *
+ * The first call takes a snapshot of the table and every further call returns the
+ * next page of the snapshot, so the table is locked once per dump, only for the
+ * copy, and a client that pages slowly never blocks the router.  Dumps that are
+ * not continued for a while are dropped, as are the least recently used ones when
+ * too many are open.
+ */
+class DumpCursors
+{
+public:
+  /**
+   * Encodes the current table content as records of the dump
+   */
+  typedef std::function<void(Buffer& records)> Snapshot;
+
+  struct Page
+  {
+    uint64_t cursor; //< pass to the next call, 0 after the last page
+    Buffer records;
+  };
+
+  static const size_t MAX_OPEN_DUMPS = 16;
+  static const size_t MAX_PAGE_RECORDS = 4096;
+
+  DumpCursors(size_t recordSize, const Snapshot& snapshot,
+              std::chrono::seconds idleTimeout = std::chrono::seconds(60));
+
+  /**
+   * Get up to \p maxRecords records of the dump \p cursor.  Cursor 0 starts a new
+   * dump.
+   *
+   * @throw std::out_of_range if \p cursor is not an open dump (finished, expired
+   *        or never returned)
+   */
+  Page
+  next(uint64_t cursor, size_t maxRecords);
+
+  size_t
+  getRecordSize() const
+  {
+    return m_recordSize;
+  }
+
+private:
+  struct Dump
+  {
+    std::shared_ptr<const Buffer> records;
+    size_t offset;
+    steady_clock::time_point lastUsed;
+  };
+
+  void
+  expire(steady_clock::time_point now);
+
+private:
+  const size_t m_recordSize;
+  const Snapshot m_snapshot;
+  const std::chrono::seconds m_idleTimeout;
+
+  std::mutex m_mutex;
+  std::map<uint64_t, Dump> m_dumps;
+  uint64_t m_nextCursor;
+};
+
+} // namespace simple_router
+
+#endif // SIMPLE_ROUTER_CORE_TABLE_DUMP_HPP
@@ -0,0 +1,185 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * This header file defines a registry of per-thread blocks, the storage behind the
+ * counters and records that forwarding threads write without sharing cache lines.
+ */
+
+#ifndef SIMPLE_ROUTER_CORE_THREAD_BLOCKS_HPP
+#define SIMPLE_ROUTER_CORE_THREAD_BLOCKS_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace simple_router {
+
+/**
+ * One Block per thread, created on the thread's first get()
+ *
+ * The calling thread's block is cached in a thread_local keyed by registry id rather
+ * than address, so that a registry allocated where an old one was does not reuse a
+ * freed block.  Blocks live until the registry is destroyed.
+ */
+template<class Block>
+class ThreadBlocks
+{
+public:
+  typedef std::function<Block*()> Factory;
+  typedef std::function<void(Block*)> Deleter;
+
+  ThreadBlocks(const Factory& factory, const Deleter& deleter);
+
+  ~ThreadBlocks();
+
+  ThreadBlocks(const ThreadBlocks&) = delete;
+
+  ThreadBlocks&
+  operator=(const ThreadBlocks&) = delete;
+
+  /**
+   * Block of the calling thread, created if needed
+   */
+  Block&
+  get();
+
+  /**
+   * Block of the calling thread, or nullptr if it has not called get() yet
+   */
+  Block*
+  find() const;
+
+  /**
+   * Call \p visit with every block, while no thread can add one
+   */
+  template<class Visit>
+  void
+  forEach(Visit visit) const;
+
+private:
+  struct Cache
+  {
+    uint64_t id;
+    Block* block;
+  };
+
+  static Cache&
+  getCache();
+
+  static uint64_t
+  nextId();
+
+  Block&
+  registerThread();
+
+private:
+  const uint64_t m_id;
+  Factory m_factory;
+  Deleter m_deleter;
+  mutable std::mutex m_mutex;
+  std::vector<std::pair<std::thread::id, Block*>> m_blocks;
+};
+
+template<class Block>
+ThreadBlocks<Block>::ThreadBlocks(const Factory& factory, const Deleter& deleter)
+  : m_id(nextId())
+  , m_factory(factory)
+  , m_deleter(deleter)
+{
+}
+
+template<class Block>
+ThreadBlocks<Block>::~ThreadBlocks()
+{
+  for (auto& block : m_blocks) {
+    m_deleter(block.second);
+  }
+}
+
+template<class Block>
+typename ThreadBlocks<Block>::Cache&
+ThreadBlocks<Block>::getCache()
+{
+  static thread_local Cache cache = {0, nullptr};
+  return cache;
+}
+
+template<class Block>
+uint64_t
+ThreadBlocks<Block>::nextId()
+{
+  static std::atomic<uint64_t> id(1);
+  return id++;
+}
+
+template<class Block>
+inline Block&
+ThreadBlocks<Block>::get()
+{
+  Cache& cache = getCache();
+  if (cache.id != m_id) {
+    cache.block = &registerThread();
+    cache.id = m_id;
+  }
+  return *cache.block;
+}
+
+template<class Block>
+inline Block*
+ThreadBlocks<Block>::find() const
+{
+  Cache& cache = getCache();
+  return cache.id == m_id ? cache.block : nullptr;
+}
+
+template<class Block>
+template<class Visit>
+void
+ThreadBlocks<Block>::forEach(Visit visit) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (const auto& block : m_blocks) {
+    visit(*block.second);
+  }
+}
+
+template<class Block>
+Block&
+ThreadBlocks<Block>::registerThread()
+{
+  auto id = std::this_thread::get_id();
+  {
+    // the thread may have used another registry since, evicting this one from the cache
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& block : m_blocks) {
+      if (block.first == id) {
+        return *block.second;
+      }
+    }
+  }
+
+  // only this thread adds a block for its id, so it can be created unlocked
+  Block* block = m_factory();
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_blocks.push_back({id, block});
+  return *block;
+}
+
+} // namespace simple_router
+
+#endif // SIMPLE_ROUTER_CORE_THREAD_BLOCKS_HPP
@@ -0,0 +1,156 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * This header file defines a token bucket rate limiter.
+ */
+
+#ifndef SIMPLE_ROUTER_CORE_TOKEN_BUCKET_HPP
+#define SIMPLE_ROUTER_CORE_TOKEN_BUCKET_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace simple_router {
+
+/**
+ * Token bucket that refills lazily on use
+ *
+ * Not thread-safe; callers serialize access.  Tokens can be packets or bytes.
+ */
+class TokenBucket
+{
+public:
+  /**
+   * @param rate  tokens added per second; 0 or less means no limit
+   * @param burst bucket capacity, i.e. the largest burst admitted at once
+   */
+  explicit
+  TokenBucket(double rate = 0, double burst = 0)
+  {
+    configure(rate, burst);
+  }
+
+  void
+  configure(double rate, double burst)
+  {
+    m_rate = rate / 1e9;
+    m_burst = burst;
+    m_tokens = burst;
+    m_lastRefill = 0;
+  }
+
+  bool
+  isLimited() const
+  {
+    return m_rate > 0;
+  }
+
+  /**
+   * Take \p tokens from the bucket if it holds that many at time \p now
+   * (nanoseconds, see nowNs())
+   */
+  bool
+  consume(uint64_t now, double tokens = 1)
+  {
+    if (!isLimited()) {
+      return true;
+    }
+
+    if (now > m_lastRefill) {
+      m_tokens = std::min(m_burst, m_tokens + (now - m_lastRefill) * m_rate);
+      m_lastRefill = now;
+    }
+    if (m_tokens < tokens) {
+      return false;
+    }
+    m_tokens -= tokens;
+    return true;
+  }
+
+  static uint64_t
+  nowNs()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+private:
+  double m_rate; //< tokens per nanosecond
+  double m_burst;
+  double m_tokens;
+  uint64_t m_lastRefill;
+};
+
+/**
+ * Token bucket that can be shared by threads without a lock
+ *
+ * Implemented as the generic cell rate algorithm: instead of a token count it keeps
+ * the theoretical arrival time of the next conforming packet, so consuming is one
+ * compare-and-swap.  Tokens are whole packets.
+ */
+class AtomicTokenBucket
+{
+public:
+  /**
+   * @param rate  packets per second; 0 or less means no limit
+   * @param burst largest burst admitted at once, at least one packet
+   */
+  explicit
+  AtomicTokenBucket(double rate = 0, double burst = 1)
+    : m_interval(rate > 0 ? static_cast<uint64_t>(1e9 / rate) : 0)
+    , m_tolerance(static_cast<uint64_t>((std::max(burst, 1.0) - 1) * m_interval))
+    , m_tat(0)
+  {
+  }
+
+  bool
+  isLimited() const
+  {
+    return m_interval != 0;
+  }
+
+  /**
+   * Take one token if the bucket has one at time \p now (nanoseconds, see
+   * TokenBucket::nowNs())
+   */
+  bool
+  consume(uint64_t now)
+  {
+    if (!isLimited()) {
+      return true;
+    }
+
+    uint64_t tat = m_tat.load(std::memory_order_relaxed);
+    for (;;) {
+      uint64_t base = std::max(tat, now);
+      if (base - now > m_tolerance) {
+        return false;
+      }
+      if (m_tat.compare_exchange_weak(tat, base + m_interval, std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+  }
+
+private:
+  const uint64_t m_interval;  //< nanoseconds per token
+  const uint64_t m_tolerance; //< how far the arrival time may run ahead of now
+  std::atomic<uint64_t> m_tat;
+};
+
+} // namespace simple_router
+
+#endif // SIMPLE_ROUTER_CORE_TOKEN_BUCKET_HPP
@@ -28,6 +28,7 @@
  */
 
 #include "utils.hpp"
+#include "checksum.hpp"
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -38,17 +39,7 @@ namespace simple_router {
 uint16_t
 cksum(const void* _data, int len)
 {
-  const uint8_t* data = reinterpret_cast<const uint8_t*>(_data);
-  uint32_t sum;
-
-  for (sum = 0;len >= 2; data += 2, len -= 2)
-    sum += data[0] << 8 | data[1];
-  if (len > 0)
-    sum += data[0] << 8;
-  while (sum > 0xffff)
-    sum = (sum >> 16) + (sum & 0xffff);
-  sum = htons (~sum);
-  return sum ? sum : 0xffff;
+  return checksum(_data, len > 0 ? len : 0);
 }
 
 
@@ -79,6 +70,27 @@ macToString(const Buffer& macAddr)
   return std::string(s);
 }
 
+bool
+parseIpv4Prefix(const std::string& text, uint32_t& address, int& length)
+{
+  size_t slash = text.find('/');
+  length = 32;
+  if (slash != std::string::npos) {
+    char* end = nullptr;
+    long value = strtol(text.c_str() + slash + 1, &end, 10);
+    if (end == text.c_str() + slash + 1 || *end != '\0' || value < 0 || value > 32) {
+      return false;
+    }
+    length = value;
+  }
+  in_addr parsed;
+  if (inet_aton(text.substr(0, slash).c_str(), &parsed) == 0) {
+    return false;
+  }
+  address = parsed.s_addr;
+  return true;
+}
+
 std::string
 ipToString(uint32_t ip)
 {
@@ -98,155 +110,155 @@ ipToString(const in_addr& address)
 }
 
 /* Prints out formatted Ethernet address, e.g. 00:11:22:33:44:55 */
-void print_addr_eth(const uint8_t* addr) {
+void print_addr_eth(const uint8_t* addr, FILE* out) {
   int pos = 0;
   uint8_t cur;
   for (; pos < ETHER_ADDR_LEN; pos++) {
     cur = addr[pos];
     if (pos > 0)
-      fprintf(stderr, ":");
-    fprintf(stderr, "%02X", cur);
+      fprintf(out, ":");
+    fprintf(out, "%02X", cur);
   }
-  fprintf(stderr, "\n");
+  fprintf(out, "\n");
 }
 
 /* Prints out IP address as a string from in_addr */
-void print_addr_ip(struct in_addr address) {
+void print_addr_ip(struct in_addr address, FILE* out) {
   char buf[INET_ADDRSTRLEN];
   if (inet_ntop(AF_INET, &address, buf, 100) == NULL)
-    fprintf(stderr,"inet_ntop error on address conversion\n");
+    fprintf(out,"inet_ntop error on address conversion\n");
   else
-    fprintf(stderr, "%s\n", buf);
+    fprintf(out, "%s\n", buf);
 }
 
-void print_addr_ip_int(uint32_t ip)
+void print_addr_ip_int(uint32_t ip, FILE* out)
 {
   in_addr addr;
   addr.s_addr = ntohl(ip);
-  print_addr_ip(addr);
+  print_addr_ip(addr, out);
 }
 
 /* Prints out fields in Ethernet header. */
 void
-print_hdr_eth(const uint8_t* buf) {
+print_hdr_eth(const uint8_t* buf, FILE* out) {
   const ethernet_hdr *ehdr = (const ethernet_hdr *)buf;
-  fprintf(stderr, "ETHERNET header:\n");
-  fprintf(stderr, "\tdestination: ");
-  print_addr_eth(ehdr->ether_dhost);
-  fprintf(stderr, "\tsource: ");
-  print_addr_eth(ehdr->ether_shost);
-  fprintf(stderr, "\ttype: %d\n", ntohs(ehdr->ether_type));
+  fprintf(out, "ETHERNET header:\n");
+  fprintf(out, "\tdestination: ");
+  print_addr_eth(ehdr->ether_dhost, out);
+  fprintf(out, "\tsource: ");
+  print_addr_eth(ehdr->ether_shost, out);
+  fprintf(out, "\ttype: %d\n", ntohs(ehdr->ether_type));
 }
 
 /* Prints out fields in IP header. */
-void print_hdr_ip(const uint8_t* buf) {
+void print_hdr_ip(const uint8_t* buf, FILE* out) {
   const ip_hdr *iphdr = (const ip_hdr *)(buf);
-  fprintf(stderr, "IP header:\n");
-  fprintf(stderr, "\tversion: %d\n", iphdr->ip_v);
-  fprintf(stderr, "\theader length: %d\n", iphdr->ip_hl);
-  fprintf(stderr, "\ttype of service: %d\n", iphdr->ip_tos);
-  fprintf(stderr, "\tlength: %d\n", ntohs(iphdr->ip_len));
-  fprintf(stderr, "\tid: %d\n", ntohs(iphdr->ip_id));
+  fprintf(out, "IP header:\n");
+  fprintf(out, "\tversion: %d\n", iphdr->ip_v);
+  fprintf(out, "\theader length: %d\n", iphdr->ip_hl);
+  fprintf(out, "\ttype of service: %d\n", iphdr->ip_tos);
+  fprintf(out, "\tlength: %d\n", ntohs(iphdr->ip_len));
+  fprintf(out, "\tid: %d\n", ntohs(iphdr->ip_id));
 
   if (ntohs(iphdr->ip_off) & IP_DF)
-    fprintf(stderr, "\tfragment flag: DF\n");
+    fprintf(out, "\tfragment flag: DF\n");
   else if (ntohs(iphdr->ip_off) & IP_MF)
-    fprintf(stderr, "\tfragment flag: MF\n");
+    fprintf(out, "\tfragment flag: MF\n");
   else if (ntohs(iphdr->ip_off) & IP_RF)
-    fprintf(stderr, "\tfragment flag: R\n");
+    fprintf(out, "\tfragment flag: R\n");
 
-  fprintf(stderr, "\tfragment offset: %d\n", ntohs(iphdr->ip_off) & IP_OFFMASK);
-  fprintf(stderr, "\tTTL: %d\n", iphdr->ip_ttl);
-  fprintf(stderr, "\tprotocol: %d\n", iphdr->ip_p);
+  fprintf(out, "\tfragment offset: %d\n", ntohs(iphdr->ip_off) & IP_OFFMASK);
+  fprintf(out, "\tTTL: %d\n", iphdr->ip_ttl);
+  fprintf(out, "\tprotocol: %d\n", iphdr->ip_p);
 
   /*Keep checksum in NBO*/
-  fprintf(stderr, "\tchecksum: %d\n", iphdr->ip_sum);
+  fprintf(out, "\tchecksum: %d\n", iphdr->ip_sum);
 
-  fprintf(stderr, "\tsource: ");
-  print_addr_ip_int(ntohl(iphdr->ip_src));
+  fprintf(out, "\tsource: ");
+  print_addr_ip_int(ntohl(iphdr->ip_src), out);
 
-  fprintf(stderr, "\tdestination: ");
-  print_addr_ip_int(ntohl(iphdr->ip_dst));
+  fprintf(out, "\tdestination: ");
+  print_addr_ip_int(ntohl(iphdr->ip_dst), out);
 }
 
 /* Prints out ICMP header fields */
-void print_hdr_icmp(const uint8_t* buf) {
+void print_hdr_icmp(const uint8_t* buf, FILE* out) {
   const icmp_hdr *hdr = reinterpret_cast<const icmp_hdr*>(buf);
-  fprintf(stderr, "ICMP header:\n");
-  fprintf(stderr, "\ttype: %d\n", hdr->icmp_type);
-  fprintf(stderr, "\tcode: %d\n", hdr->icmp_code);
+  fprintf(out, "ICMP header:\n");
+  fprintf(out, "\ttype: %d\n", hdr->icmp_type);
+  fprintf(out, "\tcode: %d\n", hdr->icmp_code);
   /* Keep checksum in NBO */
-  fprintf(stderr, "\tchecksum: %d\n", hdr->icmp_sum);
+  fprintf(out, "\tchecksum: %d\n", hdr->icmp_sum);
 }
 
 
 /* Prints out fields in ARP header */
-void print_hdr_arp(const uint8_t* buf) {
+void print_hdr_arp(const uint8_t* buf, FILE* out) {
   const arp_hdr *hdr = reinterpret_cast<const arp_hdr*>(buf);
-  fprintf(stderr, "ARP header\n");
-  fprintf(stderr, "\thardware type: %d\n", ntohs(hdr->arp_hrd));
-  fprintf(stderr, "\tprotocol type: %d\n", ntohs(hdr->arp_pro));
-  fprintf(stderr, "\thardware address length: %d\n", hdr->arp_hln);
-  fprintf(stderr, "\tprotocol address length: %d\n", hdr->arp_pln);
-  fprintf(stderr, "\topcode: %d\n", ntohs(hdr->arp_op));
-
-  fprintf(stderr, "\tsender hardware address: ");
-  print_addr_eth(hdr->arp_sha);
-  fprintf(stderr, "\tsender ip address: ");
-  print_addr_ip_int(ntohl(hdr->arp_sip));
-
-  fprintf(stderr, "\ttarget hardware address: ");
-  print_addr_eth(hdr->arp_tha);
-  fprintf(stderr, "\ttarget ip address: ");
-  print_addr_ip_int(ntohl(hdr->arp_tip));
+  fprintf(out, "ARP header\n");
+  fprintf(out, "\thardware type: %d\n", ntohs(hdr->arp_hrd));
+  fprintf(out, "\tprotocol type: %d\n", ntohs(hdr->arp_pro));
+  fprintf(out, "\thardware address length: %d\n", hdr->arp_hln);
+  fprintf(out, "\tprotocol address length: %d\n", hdr->arp_pln);
+  fprintf(out, "\topcode: %d\n", ntohs(hdr->arp_op));
+
+  fprintf(out, "\tsender hardware address: ");
+  print_addr_eth(hdr->arp_sha, out);
+  fprintf(out, "\tsender ip address: ");
+  print_addr_ip_int(ntohl(hdr->arp_sip), out);
+
+  fprintf(out, "\ttarget hardware address: ");
+  print_addr_eth(hdr->arp_tha, out);
+  fprintf(out, "\ttarget ip address: ");
+  print_addr_ip_int(ntohl(hdr->arp_tip), out);
 }
 
 /* Prints out all possible headers, starting from Ethernet */
-void print_hdrs(const uint8_t* buf, uint32_t length) {
+void print_hdrs(const uint8_t* buf, uint32_t length, FILE* out) {
 
   /* Ethernet */
   size_t minlength = sizeof(ethernet_hdr);
   if (length < minlength) {
-    fprintf(stderr, "Failed to print ETHERNET header, insufficient length\n");
+    fprintf(out, "Failed to print ETHERNET header, insufficient length\n");
     return;
   }
 
   uint16_t ethtype = ethertype(buf);
-  print_hdr_eth(buf);
+  print_hdr_eth(buf, out);
 
   if (ethtype == ethertype_ip) { /* IP */
     minlength += sizeof(ip_hdr);
     if (length < minlength) {
-      fprintf(stderr, "Failed to print IP header, insufficient length\n");
+      fprintf(out, "Failed to print IP header, insufficient length\n");
       return;
     }
 
-    print_hdr_ip(buf + sizeof(ethernet_hdr));
+    print_hdr_ip(buf + sizeof(ethernet_hdr), out);
     uint8_t ip_proto = ip_protocol(buf + sizeof(ethernet_hdr));
 
     if (ip_proto == ip_protocol_icmp) { /* ICMP */
       minlength += sizeof(icmp_hdr);
       if (length < minlength)
-        fprintf(stderr, "Failed to print ICMP header, insufficient length\n");
+        fprintf(out, "Failed to print ICMP header, insufficient length\n");
       else
-        print_hdr_icmp(buf + sizeof(ethernet_hdr) + sizeof(ip_hdr));
+        print_hdr_icmp(buf + sizeof(ethernet_hdr) + sizeof(ip_hdr), out);
     }
   }
   else if (ethtype == ethertype_arp) { /* ARP */
     minlength += sizeof(arp_hdr);
     if (length < minlength)
-      fprintf(stderr, "Failed to print ARP header, insufficient length\n");
+      fprintf(out, "Failed to print ARP header, insufficient length\n");
     else
-      print_hdr_arp(buf + sizeof(ethernet_hdr));
+      print_hdr_arp(buf + sizeof(ethernet_hdr), out);
   }
   else {
-    fprintf(stderr, "Unrecognized Ethernet Type: %d\n", ethtype);
+    fprintf(out, "Unrecognized Ethernet Type: %d\n", ethtype);
   }
 }
 
-void print_hdrs(const Buffer& buffer)
+void print_hdrs(const Buffer& buffer, FILE* out)
 {
-  print_hdrs(buffer.data(), buffer.size());
+  print_hdrs(buffer.data(), buffer.size(), out);
 }
 
 
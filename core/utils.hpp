@@ -32,6 +32,8 @@
 
 #include "protocol.hpp"
 
+#include <stdio.h>
+
 namespace simple_router {
 
 uint16_t cksum(const void* data, int len);
@@ -50,15 +52,23 @@ ipToString(uint32_t ip);
 std::string
 ipToString(const in_addr& address);
 
-void print_hdr_eth(const uint8_t* buf);
-void print_hdr_ip(const uint8_t* buf);
-void print_hdr_icmp(const uint8_t* buf);
-void print_hdr_arp(const uint8_t* buf);
+/**
+ * Parse "address/length"; a plain address is a /32.  The address is not masked.
+ *
+ * @return false if \p text is not an IPv4 prefix
+ */
+bool
+parseIpv4Prefix(const std::string& text, uint32_t& address, int& length);
+
+void print_hdr_eth(const uint8_t* buf, FILE* out = stderr);
+void print_hdr_ip(const uint8_t* buf, FILE* out = stderr);
+void print_hdr_icmp(const uint8_t* buf, FILE* out = stderr);
+void print_hdr_arp(const uint8_t* buf, FILE* out = stderr);
 
 /* prints all headers, starting from eth */
-void print_hdrs(const uint8_t* buf, uint32_t length);
+void print_hdrs(const uint8_t* buf, uint32_t length, FILE* out = stderr);
 
-void print_hdrs(const Buffer& buffer);
+void print_hdrs(const Buffer& buffer, FILE* out = stderr);
 
 } // namespace simple_router
 
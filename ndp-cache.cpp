@@ -0,0 +1,282 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "ndp-cache.hpp"
+#include "core/utils.hpp"
+#include "core/logger.hpp"
+#include "core/interface.hpp"
+#include "core/probes.hpp"
+#include "simple-router.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <string.h>
+
+namespace simple_router {
+
+NeighborCache::NeighborCache(SimpleRouter& router)
+  : m_router(router)
+  , m_shouldStop(false)
+  , m_tickerThread(std::bind(&NeighborCache::ticker, this))
+{
+}
+
+NeighborCache::~NeighborCache()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_stopMutex);
+    m_shouldStop = true;
+  }
+  m_stopCv.notify_one();
+  m_tickerThread.join();
+}
+
+bool
+NeighborCache::lookup(const Ipv6Address& ip, uint8_t* mac) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  auto entry = m_entries.find(ip);
+  if (entry == m_entries.end()) {
+    return false;
+  }
+  memcpy(mac, entry->second.mac, ETHER_ADDR_LEN);
+  return true;
+}
+
+std::shared_ptr<NeighborRequest>
+NeighborCache::queueRequest(const Ipv6Address& ip, const Buffer& packet, const std::string& iface)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  auto request = findRequest(ip);
+  if (request == m_requests.end()) {
+    request = m_requests.insert(m_requests.end(), std::make_shared<NeighborRequest>(ip));
+  }
+
+  (*request)->packets.push_back({packet, iface});
+  return *request;
+}
+
+void
+NeighborCache::removeRequest(const std::shared_ptr<NeighborRequest>& request)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_requests.remove(request);
+}
+
+std::shared_ptr<NeighborRequest>
+NeighborCache::insertNeighbor(const uint8_t* mac, const Ipv6Address& ip)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  NeighborEntry& entry = m_entries[ip];
+  memcpy(entry.mac, mac, ETHER_ADDR_LEN);
+  entry.timeAdded = steady_clock::now();
+  entry.isConfirmed = true;
+  entry.nProbesSent = 0;
+
+  auto request = findRequest(ip);
+  return request != m_requests.end() ? *request : nullptr;
+}
+
+std::shared_ptr<NeighborRequest>
+NeighborCache::updateNeighbor(const Ipv6Address& ip, const uint8_t* mac, bool isSolicited, bool isOverride)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  auto entry = m_entries.find(ip);
+  if (entry == m_entries.end()) {
+    //only an advertisement carrying the address completes a pending resolution
+    auto request = findRequest(ip);
+    if (request == m_requests.end() || mac == nullptr) {
+      return nullptr;
+    }
+    NeighborEntry& added = m_entries[ip];
+    memcpy(added.mac, mac, ETHER_ADDR_LEN);
+    added.timeAdded = steady_clock::now();
+    return *request;
+  }
+
+  bool isNewMac = mac != nullptr && memcmp(entry->second.mac, mac, ETHER_ADDR_LEN) != 0;
+  if (isNewMac && !isOverride) {
+    return nullptr;
+  }
+  if (isNewMac) {
+    memcpy(entry->second.mac, mac, ETHER_ADDR_LEN);
+  }
+  if (isSolicited) {
+    entry->second.timeAdded = steady_clock::now();
+    entry->second.isConfirmed = true;
+    entry->second.nProbesSent = 0;
+  }
+  return nullptr;
+}
+
+std::list<std::shared_ptr<NeighborRequest>>::iterator
+NeighborCache::findRequest(const Ipv6Address& ip)
+{
+  return std::find_if(m_requests.begin(), m_requests.end(),
+                      [&ip] (const std::shared_ptr<NeighborRequest>& request) {
+                        return request->ip == ip;
+                      });
+}
+
+void
+NeighborCache::clear()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  m_entries.clear();
+  m_requests.clear();
+}
+
+void
+NeighborCache::ticker()
+{
+  std::unique_lock<std::mutex> stopLock(m_stopMutex);
+  while (!m_shouldStop) {
+    m_stopCv.wait_for(stopLock, std::chrono::seconds(1));
+    if (m_shouldStop) {
+      break;
+    }
+    stopLock.unlock();
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      periodicCheck();
+    }
+    stopLock.lock();
+  }
+}
+
+void
+NeighborCache::periodicCheck()
+{
+  auto now = steady_clock::now();
+
+  for (auto request = m_requests.begin(); request != m_requests.end(); ) {
+    if ((*request)->nTimesSent >= MAX_SENT_TIME) {
+      SR_LOG_DEBUG("No neighbor advertisement from " << ipv6ToString((*request)->ip) << ", dropping "
+                   << (*request)->packets.size() << " packets");
+      m_router.getStats().drop(DROP_NDP_FAILURE, (*request)->packets.size());
+      SR_PROBE3(packet_drop, DROP_NDP_FAILURE, dropReasonToString(DROP_NDP_FAILURE),
+                (*request)->packets.size());
+      request = m_requests.erase(request);
+      continue;
+    }
+
+    const Interface* iface = m_router.findIfaceByName((*request)->packets.front().iface);
+    if (iface != nullptr) {
+      uint8_t solicitation[NDP_FRAME_SIZE];
+      size_t size = buildNeighborSolicitation(solicitation, sizeof(solicitation), iface->addr.data(),
+                                              iface->ipv6Source(), (*request)->ip);
+      m_router.sendPacket(Buffer(solicitation, solicitation + size), *iface);
+    }
+    (*request)->timeSent = now;
+    ++(*request)->nTimesSent;
+    ++request;
+  }
+
+  for (auto entry = m_entries.begin(); entry != m_entries.end(); ) {
+    if (now - entry->second.timeAdded > SR_ARPCACHE_TO) {
+      entry = m_entries.erase(entry);
+      continue;
+    }
+
+    //restored entries: solicit the known MAC directly until the neighbor answers
+    if (!entry->second.isConfirmed) {
+      const Interface* iface = findNeighborIface(entry->first);
+      if (iface == nullptr || entry->second.nProbesSent >= MAX_SENT_TIME) {
+        SR_LOG_DEBUG("Restored neighbor " << ipv6ToString(entry->first) << " not confirmed, removing it");
+        entry = m_entries.erase(entry);
+        continue;
+      }
+      uint8_t solicitation[NDP_FRAME_SIZE];
+      size_t size = buildNeighborSolicitation(solicitation, sizeof(solicitation), iface->addr.data(),
+                                              iface->ipv6Source(), entry->first, entry->second.mac);
+      m_router.sendPacket(Buffer(solicitation, solicitation + size), *iface);
+      ++entry->second.nProbesSent;
+    }
+    ++entry;
+  }
+}
+
+const Interface*
+NeighborCache::findNeighborIface(const Ipv6Address& ip) const
+{
+  const RoutingTable& table = m_router.getRoutingTable();
+  for (const auto& route : table.getIpv6Entries()) {
+    if (route.gw == ip) {
+      return m_router.findIfaceByName(route.ifName);
+    }
+  }
+  const RoutingTableEntry6* route = table.findIpv6(ip);
+  return route != nullptr ? m_router.findIfaceByName(route->ifName) : nullptr;
+}
+
+std::vector<NeighborEntryInfo>
+NeighborCache::getEntries() const
+{
+  std::vector<NeighborEntryInfo> entries;
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  entries.reserve(m_entries.size());
+  for (const auto& entry : m_entries) {
+    NeighborEntryInfo info;
+    info.ip = entry.first;
+    memcpy(info.mac, entry.second.mac, ETHER_ADDR_LEN);
+    info.timeAdded = entry.second.timeAdded;
+    entries.push_back(info);
+  }
+  return entries;
+}
+
+size_t
+NeighborCache::restoreEntries(const std::vector<NeighborEntryInfo>& entries)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  size_t nRestored = 0;
+  for (const auto& info : entries) {
+    if (m_entries.count(info.ip) != 0) {
+      continue;
+    }
+    NeighborEntry& entry = m_entries[info.ip];
+    memcpy(entry.mac, info.mac, ETHER_ADDR_LEN);
+    entry.timeAdded = info.timeAdded;
+    entry.isConfirmed = false;
+    ++nRestored;
+  }
+  return nRestored;
+}
+
+std::ostream&
+operator<<(std::ostream& os, const NeighborCache& cache)
+{
+  os << "\nMAC            IPv6                      AGE\n"
+     << "-----------------------------------------------------------\n";
+
+  std::lock_guard<std::mutex> lock(cache.m_mutex);
+  auto now = steady_clock::now();
+  for (const auto& entry : cache.m_entries) {
+    os << macToString(Buffer(entry.second.mac, entry.second.mac + ETHER_ADDR_LEN)) << "   "
+       << ipv6ToString(entry.first) << "   "
+       << std::chrono::duration_cast<seconds>(now - entry.second.timeAdded).count() << " seconds\n";
+  }
+  os << std::endl;
+  return os;
+}
+
+} // namespace simple_router
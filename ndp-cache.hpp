@@ -0,0 +1,178 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * This header file defines the IPv6 neighbor cache, the NDP counterpart of ArpCache.
+ */
+
+#ifndef SIMPLE_ROUTER_NDP_CACHE_HPP
+#define SIMPLE_ROUTER_NDP_CACHE_HPP
+
+#include "arp-cache.hpp"
+#include "core/ipv6.hpp"
+
+#include <condition_variable>
+#include <unordered_map>
+
+namespace simple_router {
+class Interface;
+
+struct NeighborRequest
+{
+  NeighborRequest(const Ipv6Address& ip)
+    : ip(ip)
+    , nTimesSent(0)
+  {
+  }
+
+  Ipv6Address ip;
+  time_point timeSent;
+  uint32_t nTimesSent;
+  std::list<PendingPacket> packets;
+};
+
+struct NeighborEntry
+{
+  uint8_t mac[ETHER_ADDR_LEN];
+  time_point timeAdded;
+
+  /**
+   * False for entries restored by NeighborCache::restoreEntries() until the neighbor
+   * answers one of the unicast solicitations sent to it
+   */
+  bool isConfirmed = true;
+  uint32_t nProbesSent = 0;
+};
+
+/**
+ * Copy of a cache entry, see NeighborCache::getEntries()
+ */
+struct NeighborEntryInfo
+{
+  Ipv6Address ip;
+  uint8_t mac[ETHER_ADDR_LEN];
+  time_point timeAdded;
+};
+
+/**
+ * IPv6 address to MAC mappings learned from neighbor solicitations and
+ * advertisements, and the packets waiting for one
+ *
+ * Unlike ArpCache, entries are kept in a hash table and lookup() copies the MAC
+ * out, so the forwarding path neither scans a list nor touches a shared_ptr
+ * reference count.  Entries expire SR_ARPCACHE_TO after they were learned;
+ * unanswered solicitations are repeated every second up to MAX_SENT_TIME times.
+ */
+class NeighborCache
+{
+public:
+  NeighborCache(SimpleRouter& router);
+
+  ~NeighborCache();
+
+  /**
+   * Copy the MAC of neighbor \p ip to \p mac
+   *
+   * @return false if the neighbor is not known
+   */
+  bool
+  lookup(const Ipv6Address& ip, uint8_t* mac) const;
+
+  /**
+   * Queue \p packet, to be sent on \p iface once \p ip is resolved
+   */
+  std::shared_ptr<NeighborRequest>
+  queueRequest(const Ipv6Address& ip, const Buffer& packet, const std::string& iface);
+
+  void
+  removeRequest(const std::shared_ptr<NeighborRequest>& request);
+
+  /**
+   * Insert or refresh the mapping of \p ip to \p mac
+   *
+   * @return the pending request of \p ip, or nullptr if there is none
+   */
+  std::shared_ptr<NeighborRequest>
+  insertNeighbor(const uint8_t* mac, const Ipv6Address& ip);
+
+  /**
+   * Apply a neighbor advertisement for \p ip (RFC 4861 7.2.5).  Neighbors neither
+   * cached nor being resolved are not added.  \p mac, nullptr if the advertisement
+   * has no target link-layer address, resolves a pending request, and replaces a
+   * different cached MAC only if \p isOverride.  \p isSolicited confirms the entry.
+   *
+   * @return the pending request of \p ip if the advertisement resolved it, or nullptr
+   */
+  std::shared_ptr<NeighborRequest>
+  updateNeighbor(const Ipv6Address& ip, const uint8_t* mac, bool isSolicited, bool isOverride);
+
+  void
+  clear();
+
+  /**
+   * Copy all entries
+   */
+  std::vector<NeighborEntryInfo>
+  getEntries() const;
+
+  /**
+   * Add the \p entries not already in the cache, keeping their timeAdded, and
+   * re-validate them with unicast solicitations (see ArpCache::restoreEntries)
+   *
+   * @return number of entries added
+   */
+  size_t
+  restoreEntries(const std::vector<NeighborEntryInfo>& entries);
+
+private:
+  /**
+   * Thread which expires entries and repeats or gives up solicitations, once a second
+   */
+  void
+  ticker();
+
+  void
+  periodicCheck();
+
+  std::list<std::shared_ptr<NeighborRequest>>::iterator
+  findRequest(const Ipv6Address& ip);
+
+  /**
+   * Interface to send solicitations for neighbor \p ip on: that of a route through
+   * \p ip, or else of the route to \p ip
+   */
+  const Interface*
+  findNeighborIface(const Ipv6Address& ip) const;
+
+private:
+  SimpleRouter& m_router;
+
+  std::unordered_map<Ipv6Address, NeighborEntry, Ipv6AddressHash> m_entries;
+  std::list<std::shared_ptr<NeighborRequest>> m_requests;
+
+  std::mutex m_stopMutex;
+  std::condition_variable m_stopCv;
+  bool m_shouldStop;
+  mutable std::mutex m_mutex;
+  std::thread m_tickerThread;
+
+  friend std::ostream&
+  operator<<(std::ostream& os, const NeighborCache& cache);
+};
+
+std::ostream&
+operator<<(std::ostream& os, const NeighborCache& cache);
+
+} // namespace simple_router
+
+#endif // SIMPLE_ROUTER_NDP_CACHE_HPP
@@ -15,8 +15,15 @@
  */
 
 #include "routing-table.hpp"
+#include "core/logger.hpp"
+#include "core/shared-fib.hpp"
+#include "core/table-dump.hpp"
 #include "core/utils.hpp"
 
+#include <algorithm>
+#include <functional>
+#include <map>
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
@@ -25,63 +32,304 @@
 
 namespace simple_router {
 
-//helper function to sort routing table entries by mask length
-bool sortMaskLengths(RoutingTableEntry& rte1, RoutingTableEntry& rte2){
-  if (rte1.mask > rte2.mask){
-    return true;
-  }
-  else{
-    return false;
-  }
-}
-
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
 // IMPLEMENT THIS METHOD
 RoutingTableEntry
 RoutingTable::lookup(uint32_t ip) const
 {
-  // FILL THIS IN
-  //longest-prefix matching algorithm
-  //find entry in table which has longest prefix matching with incoming packet's destination IP
-  //forward packet to corresponding next hop
+  const RoutingTableEntry* entry = find(ip);
+  if (entry == nullptr) {
+    //routing table entry not found
+    throw std::runtime_error("Routing entry not found");
+  }
+  return *entry;
+}
+
+const RoutingTableEntry*
+RoutingTable::find(uint32_t ip) const
+{
+  const SharedFib* shared = m_shared.load(std::memory_order_acquire);
+  if (shared != nullptr) {
+    return shared->find(ip);
+  }
+  const CompiledTable& table = getCompiled();
+  if (!table.isFibUsable) {
+    return findLinear(table, ip);
+  }
+
+  uint32_t index = table.fib.lookup(ntohl(ip));
+  return index == 0 ? nullptr : &table.routes[index - 1];
+}
+
+const RoutingTableEntry6*
+RoutingTable::findIpv6(const Ipv6Address& ip) const
+{
+  const SharedFib* shared = m_shared.load(std::memory_order_acquire);
+  if (shared != nullptr) {
+    return shared->findIpv6(ip);
+  }
+  const CompiledTable& table = getCompiled();
+
+  uint32_t index = table.fib6.lookup(ip);
+  return index == 0 ? nullptr : &table.routes6[index - 1];
+}
+
+void
+RoutingTable::findBatch(const uint32_t* ips, size_t count, const RoutingTableEntry** entries) const
+{
+  const SharedFib* shared = m_shared.load(std::memory_order_acquire);
+  if (shared != nullptr) {
+    shared->findBatch(ips, count, entries);
+    return;
+  }
+  const CompiledTable& table = getCompiled();
+  if (!table.isFibUsable) {
+    for (size_t i = 0; i < count; ++i) {
+      entries[i] = findLinear(table, ips[i]);
+    }
+    return;
+  }
+
+  const size_t BATCH = 32;
+  uint32_t addresses[BATCH];
+  uint32_t indices[BATCH];
+  for (size_t start = 0; start < count; start += BATCH) {
+    size_t n = std::min(BATCH, count - start);
+    for (size_t i = 0; i < n; ++i) {
+      addresses[i] = ntohl(ips[start + i]);
+    }
+    table.fib.lookupBatch(addresses, n, indices);
+    for (size_t i = 0; i < n; ++i) {
+      entries[start + i] = indices[i] == 0 ? nullptr : &table.routes[indices[i] - 1];
+    }
+  }
+}
+
+size_t
+RoutingTable::getMemoryUsage() const
+{
+  const SharedFib* shared = m_shared.load(std::memory_order_acquire);
+  if (shared != nullptr) {
+    return shared->getMemoryUsage();
+  }
+  const CompiledTable& table = getCompiled();
+  return table.fib.getMemoryUsage() + table.routes.capacity() * sizeof(RoutingTableEntry) +
+         table.fib6.getMemoryUsage() + table.routes6.capacity() * sizeof(RoutingTableEntry6);
+}
+
+//longest-prefix matching for tables the compiled structure cannot hold (non-contiguous masks)
+const RoutingTableEntry*
+RoutingTable::findLinear(const CompiledTable& table, uint32_t ip)
+{
+  //entries are sorted by longest mask so first match should be longest matched prefix
+  for (const auto& rte : table.routes) {
+    uint32_t rte_masked_dest = rte.dest & rte.mask;   //mask destination
+    uint32_t rte_masked_ip = ip & rte.mask;   //mask IP address
+    if (rte_masked_dest == rte_masked_ip) {
+      return &rte;
+    }
+  }
+  return nullptr;
+}
+
+const RoutingTable::CompiledTable&
+RoutingTable::getCompiled() const
+{
+  if (!m_isBuilt.load(std::memory_order_acquire)) {
+    build();
+  }
+  return *m_compiled.load(std::memory_order_acquire);
+}
+
+void
+RoutingTable::build() const
+{
+  std::lock_guard<std::mutex> lock(m_buildMutex);
+  if (m_isBuilt.load(std::memory_order_relaxed)) {
+    return;
+  }
+
+  std::unique_ptr<CompiledTable> table(new CompiledTable);
+  table->routes.assign(m_entries.begin(), m_entries.end());
+
+  std::vector<FibPrefix> prefixes;
+  table->isFibUsable = true;
+  for (size_t i = 0; i < table->routes.size(); ++i) {
+    int length = maskToLength(table->routes[i].mask);
+    if (length < 0) {
+      table->isFibUsable = false;
+      break;
+    }
+    prefixes.push_back({ntohl(table->routes[i].dest & table->routes[i].mask), static_cast<uint8_t>(length),
+                        static_cast<uint32_t>(i + 1)});
+  }
+
+  if (table->isFibUsable) {
+    table->fib.build(prefixes);
+  }
+  else {
+    std::stable_sort(table->routes.begin(), table->routes.end(), [] (const RoutingTableEntry& a, const RoutingTableEntry& b) {
+        return ntohl(a.mask) > ntohl(b.mask);
+      });
+  }
+
+  table->routes6.assign(m_entries6.begin(), m_entries6.end());
+  std::vector<Fib6Prefix> prefixes6;
+  prefixes6.reserve(table->routes6.size());
+  for (size_t i = 0; i < table->routes6.size(); ++i) {
+    prefixes6.push_back({table->routes6[i].dest, table->routes6[i].length, static_cast<uint32_t>(i + 1)});
+  }
+  table->fib6.build(prefixes6);
+
+  // a lookup still on the replaced table has until the next rebuild to finish
+  m_compiledRetired = std::move(m_compiledCurrent);
+  m_compiledCurrent = std::move(table);
+  m_compiled.store(m_compiledCurrent.get(), std::memory_order_release);
+  m_isBuilt.store(true, std::memory_order_release);
+}
+
+bool
+RoutingTable::compress()
+{
+  // next hops are numbered from 1; 0 means no route
+  std::vector<std::pair<uint32_t, std::string>> nextHops;
+  std::map<std::pair<uint32_t, std::string>, uint32_t> nextHopIds;
+
+  std::vector<FibPrefix> prefixes;
+  for (const auto& entry : m_entries) {
+    int length = maskToLength(entry.mask);
+    if (length < 0) {
+      return false;
+    }
 
-  //sort through routing table entries and sort by mask length
-  std::list<RoutingTableEntry> sorted_routing_table(m_entries);  //create new routing table for sorting
+    auto nextHop = std::make_pair(entry.gw, entry.ifName);
+    auto id = nextHopIds.insert({nextHop, nextHops.size() + 1});
+    if (id.second) {
+      nextHops.push_back(nextHop);
+    }
+    prefixes.push_back({ntohl(entry.dest & entry.mask), static_cast<uint8_t>(length), id.first->second});
+  }
 
-  //use sortMaskLengths function to sort routing table from longest mask length to shortest
-  sorted_routing_table.sort(sortMaskLengths);
+  m_entries.clear();
+  for (const auto& prefix : compressPrefixes(prefixes)) {
+    uint32_t mask = prefix.length == 0 ? 0 : htonl(~0u << (32 - prefix.length));
+    const auto& nextHop = nextHops[prefix.value - 1];
+    m_entries.push_back({htonl(prefix.prefix), nextHop.first, mask, nextHop.second});
+  }
+  m_isBuilt = false;
+  return true;
+}
+uint64_t
+RoutingTable::publishShared(const std::string& name) const
+{
+  const CompiledTable& table = getCompiled();
+  if (!table.isFibUsable) {
+    throw std::runtime_error("Cannot publish a routing table with non-contiguous masks");
+  }
+  return SharedFib::publish(name, table.routes, table.fib.getView(), table.routes6);
+}
 
-  //iterate through routing table
-  for (std::list<RoutingTableEntry>::const_iterator rte_iterator = sorted_routing_table.begin(); rte_iterator != sorted_routing_table.end(); rte_iterator++){
-    uint32_t rte_dest = rte_iterator->dest;
-    uint32_t rte_mask = rte_iterator->mask;
-    uint32_t rte_masked_dest = rte_dest & rte_mask;   //mask destination
-    uint32_t rte_masked_ip = ip & rte_mask;   //mask IP address
+void
+RoutingTable::attachShared(const std::string& name, std::chrono::milliseconds interval)
+{
+  std::unique_ptr<SharedFib> next(new SharedFib(name));
+  {
+    std::lock_guard<std::mutex> lock(m_watchMutex);
+    // lookups may still use the mapping attached before, which is freed on the next swap
+    m_sharedRetired = std::move(m_sharedCurrent);
+    m_sharedCurrent = std::move(next);
+    m_shared.store(m_sharedCurrent.get(), std::memory_order_release);
+  }
+  if (!m_watchThread.joinable()) {
+    m_watchThread = std::thread(std::bind(&RoutingTable::watchShared, this, name, interval));
+  }
+}
 
-    //check if masked dest equals masked IP
-    //entries are sorted by longest mask so first match should be longest matched prefix
-    if (rte_masked_dest == rte_masked_ip){
-      RoutingTableEntry rte = *(rte_iterator);  //dereference routing table entry
-      return rte;
+void
+RoutingTable::watchShared(std::string name, std::chrono::milliseconds interval)
+{
+  std::unique_lock<std::mutex> lock(m_watchMutex);
+  while (!m_shouldStop) {
+    m_watchCv.wait_for(lock, interval);
+    if (m_shouldStop || m_sharedCurrent->isCurrent()) {
+      continue;
+    }
+
+    try {
+      std::unique_ptr<SharedFib> next(new SharedFib(name));
+      // lookups that loaded the retired pointer had a whole interval to finish
+      m_sharedRetired = std::move(m_sharedCurrent);
+      m_sharedCurrent = std::move(next);
+      m_shared.store(m_sharedCurrent.get(), std::memory_order_release);
+    }
+    catch (const std::runtime_error& e) {
+      SR_LOG_WARN("Cannot attach new shared FIB generation: " << e.what());
     }
   }
+}
+
+uint64_t
+RoutingTable::getSharedGeneration() const
+{
+  const SharedFib* shared = m_shared.load(std::memory_order_acquire);
+  return shared != nullptr ? shared->getGeneration() : 0;
+}
+
+size_t
+RoutingTable::size() const
+{
+  const SharedFib* shared = m_shared.load(std::memory_order_acquire);
+  return shared != nullptr ? shared->getRoutes().size() : m_entries.size();
+}
+
+std::vector<RoutingTableEntry>
+RoutingTable::getEntries() const
+{
+  const SharedFib* shared = m_shared.load(std::memory_order_acquire);
+  if (shared != nullptr) {
+    return shared->getRoutes();
+  }
+  return std::vector<RoutingTableEntry>(m_entries.begin(), m_entries.end());
+}
 
-  //routing table entry not found
-  throw std::runtime_error("Routing entry not found");
+std::vector<RoutingTableEntry6>
+RoutingTable::getIpv6Entries() const
+{
+  const SharedFib* shared = m_shared.load(std::memory_order_acquire);
+  if (shared != nullptr) {
+    return shared->getIpv6Routes();
+  }
+  return std::vector<RoutingTableEntry6>(m_entries6.begin(), m_entries6.end());
 }
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
 
 // You should not need to touch the rest of this code.
 
+RoutingTable::RoutingTable()
+{
+}
+
+RoutingTable::~RoutingTable()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_watchMutex);
+    m_shouldStop = true;
+  }
+  m_watchCv.notify_one();
+  if (m_watchThread.joinable()) {
+    m_watchThread.join();
+  }
+}
+
 bool
 RoutingTable::load(const std::string& file)
 {
   FILE* fp;
   char  line[BUFSIZ];
-  char  dest[32];
-  char  gw[32];
+  char  dest[64];
+  char  gw[64];
   char  mask[32];
   char  iface[32];
   struct in_addr dest_addr;
@@ -96,7 +344,29 @@ RoutingTable::load(const std::string& file)
   fp = fopen(file.c_str(), "r");
 
   while (fgets(line, BUFSIZ, fp) != 0) {
-    sscanf(line,"%s %s %s %s", dest, gw, mask, iface);
+    if (sscanf(line, "%63s", dest) != 1 || dest[0] == '#') {
+      continue;
+    }
+
+    //IPv6 route: prefix/length gateway iface
+    if (strchr(dest, ':') != nullptr) {
+      RoutingTableEntry6 entry6;
+      int length = 0;
+      if (sscanf(line, "%63s %63s %31s", dest, gw, iface) != 3 ||
+          !parseIpv6Prefix(dest, entry6.dest, length) || !parseIpv6(gw, entry6.gw) ||
+          strlen(iface) > MAX_IFNAME_LENGTH) {
+        fprintf(stderr, "Error loading routing table, invalid IPv6 route: %s", line);
+        fclose(fp);
+        return false;
+      }
+      entry6.dest = entry6.dest.mask(length);
+      entry6.length = length;
+      entry6.ifName = iface;
+      addIpv6Entry(std::move(entry6));
+      continue;
+    }
+
+    sscanf(line,"%63s %63s %31s %31s", dest, gw, mask, iface);
     if (inet_aton(dest, &dest_addr) == 0) {
       fprintf(stderr,
               "Error loading routing table, cannot convert %s to valid IP\n",
@@ -116,8 +386,18 @@ RoutingTable::load(const std::string& file)
       return false;
     }
 
+    if (strlen(iface) > MAX_IFNAME_LENGTH) {
+      fprintf(stderr,
+              "Error loading routing table, interface name %s is longer than %zu characters\n",
+              iface, MAX_IFNAME_LENGTH);
+      fclose(fp);
+      return false;
+    }
+
     addEntry({dest_addr.s_addr, gw_addr.s_addr, mask_addr.s_addr, iface});
   }
+  fclose(fp);
+  build();
   return true;
 }
 
@@ -125,6 +405,14 @@ void
 RoutingTable::addEntry(RoutingTableEntry entry)
 {
   m_entries.push_back(std::move(entry));
+  m_isBuilt = false;
+}
+
+void
+RoutingTable::addIpv6Entry(RoutingTableEntry6 entry)
+{
+  m_entries6.push_back(std::move(entry));
+  m_isBuilt = false;
 }
 
 std::ostream&
@@ -137,13 +425,33 @@ operator<<(std::ostream& os, const RoutingTableEntry& entry)
   return os;
 }
 
+std::ostream&
+operator<<(std::ostream& os, const RoutingTableEntry6& entry)
+{
+  os << ipv6ToString(entry.dest) << "/" << static_cast<int>(entry.length) << "\t"
+     << ipv6ToString(entry.gw) << "\t"
+     << entry.ifName;
+  return os;
+}
+
 std::ostream&
 operator<<(std::ostream& os, const RoutingTable& table)
 {
+  uint64_t generation = table.getSharedGeneration();
+  if (generation != 0) {
+    os << "Shared FIB generation " << generation << "\n";
+  }
   os << "Destination\tGateway\t\tMask\tIface\n";
-  for (const auto& entry : table.m_entries) {
+  for (const auto& entry : table.getEntries()) {
     os << entry << "\n";
   }
+  auto entries6 = table.getIpv6Entries();
+  if (!entries6.empty()) {
+    os << "\nIPv6 destination\tGateway\tIface\n";
+    for (const auto& entry : entries6) {
+      os << entry << "\n";
+    }
+  }
   return os;
 }
 
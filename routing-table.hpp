@@ -18,10 +18,19 @@
 #define SIMPLE_ROUTER_ROUTING_TABLE_HPP
 
 #include "core/protocol.hpp"
+#include "core/fib.hpp"
+#include "core/fib6.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 namespace simple_router {
+class SharedFib;
 
 struct RoutingTableEntry
 {
@@ -31,12 +40,24 @@ struct RoutingTableEntry
   std::string ifName;
 };
 
+struct RoutingTableEntry6
+{
+  Ipv6Address dest;
+  uint8_t length;
+  Ipv6Address gw; //< unspecified for on-link destinations
+  std::string ifName;
+};
+
 /**
  * Routing table of the simple router
  */
 class RoutingTable
 {
 public:
+  RoutingTable();
+
+  ~RoutingTable();
+
   /**
    * IMPLEMENT THIS METHOD
    *
@@ -48,14 +69,151 @@ public:
   RoutingTableEntry
   lookup(uint32_t ip) const;
 
+  /**
+   * Longest-prefix match without the exception: nullptr if no entry matches.  The
+   * entry stays valid until the table is next modified.
+   */
+  const RoutingTableEntry*
+  find(uint32_t ip) const;
+
+  /**
+   * find() of \p count addresses at once, faster per address on tables that do not
+   * fit in cache
+   */
+  void
+  findBatch(const uint32_t* ips, size_t count, const RoutingTableEntry** entries) const;
+
+  /**
+   * IPv6 longest-prefix match: nullptr if no entry matches.  The entry stays valid
+   * until the table is next modified.
+   */
+  const RoutingTableEntry6*
+  findIpv6(const Ipv6Address& ip) const;
+
+  /**
+   * Load IPv4 lines (`dest gw mask iface`) and IPv6 lines (`prefix/length gw iface`)
+   * from \p file; blank lines and lines starting with # are skipped
+   */
   bool
   load(const std::string& file);
 
   void
   addEntry(RoutingTableEntry entry);
 
+  void
+  addIpv6Entry(RoutingTableEntry6 entry);
+
+  /**
+   * Replace the entries with the smallest set of prefixes that sends every address
+   * to the same gateway and interface (see compressPrefixes())
+   *
+   * @return false, leaving the entries unchanged, if a mask is not contiguous
+   */
+  bool
+  compress();
+
+  /**
+   * Publish the entries as the next generation of the shared FIB \p name (see
+   * SharedFib), for other processes to attachShared()
+   *
+   * @return the new generation
+   * @throw std::runtime_error if a mask is not contiguous or the segment cannot be
+   *        created
+   */
+  uint64_t
+  publishShared(const std::string& name) const;
+
+  /**
+   * Serve lookups from the shared FIB \p name instead of the entries of this table,
+   * and switch to each newer generation within \p interval of its publication.  The
+   * previous generation stays mapped until the next switch, so lookups in progress
+   * are never left with an unmapped table.
+   *
+   * @throw std::runtime_error if nothing is published under \p name
+   */
+  void
+  attachShared(const std::string& name, std::chrono::milliseconds interval = std::chrono::seconds(1));
+
+  /**
+   * Generation of the attached shared FIB, 0 if not attached
+   */
+  uint64_t
+  getSharedGeneration() const;
+
+  size_t
+  size() const;
+
+  /**
+   * Copy of the IPv4 entries, or of the routes of the shared FIB if attached
+   */
+  std::vector<RoutingTableEntry>
+  getEntries() const;
+
+  std::vector<RoutingTableEntry6>
+  getIpv6Entries() const;
+
+  /**
+   * Bytes used by the lookup structure
+   */
+  size_t
+  getMemoryUsage() const;
+
+  /**
+   * Compile the entries into the lookup structure.  Otherwise the first lookup after
+   * a change does it.
+   */
+  void
+  build() const;
+
+private:
+  /**
+   * Lookup structure compiled from the entries
+   */
+  struct CompiledTable
+  {
+    std::vector<RoutingTableEntry> routes; //< sorted by mask length if !isFibUsable
+    Fib fib;
+    bool isFibUsable = false;
+    std::vector<RoutingTableEntry6> routes6;
+    Fib6 fib6;
+  };
+
+  /**
+   * Current lookup structure, compiled first if the entries changed
+   */
+  const CompiledTable&
+  getCompiled() const;
+
+  static const RoutingTableEntry*
+  findLinear(const CompiledTable& table, uint32_t ip);
+
+  /**
+   * Thread attaching newer generations of the shared FIB
+   */
+  void
+  watchShared(std::string name, std::chrono::milliseconds interval);
+
 private:
   std::list<RoutingTableEntry> m_entries;
+  std::list<RoutingTableEntry6> m_entries6;
+
+  // lookup structure, rebuilt from m_entries after every change.  A rebuild swaps
+  // in a new table and keeps the previous one until the next rebuild, like the
+  // generations of the shared FIB, so lookups in progress never see it change.
+  mutable std::mutex m_buildMutex;
+  mutable std::atomic<bool> m_isBuilt{false};
+  mutable std::atomic<const CompiledTable*> m_compiled{nullptr};
+  mutable std::unique_ptr<CompiledTable> m_compiledCurrent;
+  mutable std::unique_ptr<CompiledTable> m_compiledRetired;
+
+  // attached shared FIB, used instead of all of the above
+  std::atomic<const SharedFib*> m_shared{nullptr};
+  std::unique_ptr<SharedFib> m_sharedCurrent;
+  std::unique_ptr<SharedFib> m_sharedRetired;
+  std::mutex m_watchMutex;
+  std::condition_variable m_watchCv;
+  bool m_shouldStop = false;
+  std::thread m_watchThread;
 
   friend std::ostream&
   operator<<(std::ostream& os, const RoutingTable& table);
@@ -64,6 +222,9 @@ private:
 std::ostream&
 operator<<(std::ostream& os, const RoutingTableEntry& entry);
 
+std::ostream&
+operator<<(std::ostream& os, const RoutingTableEntry6& entry);
+
 std::ostream&
 operator<<(std::ostream& os, const RoutingTable& table);
 
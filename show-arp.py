@@ -13,7 +13,7 @@
 # You should have received a copy of the GNU General Public License along with this program.
 # If not, see <http://www.gnu.org/licenses/>.
 
-import os, sys, logging, Ice, traceback
+import os, sys, logging, socket, struct, Ice, traceback
 
 log = logging.getLogger("CS118")
 logging.basicConfig(stream=sys.stderr)
@@ -27,6 +27,35 @@ if not slice_dir:
 Ice.loadSlice("", ["-I%s" % slice_dir, "core/pox.ice"])
 import pox
 
+PAGE_RECORDS = 1024
+
+def dump(fetch):
+    """Yield the records of a paged Tester dump, one page per call"""
+    cursor = 0
+    while True:
+        page = fetch(cursor, PAGE_RECORDS)
+        for offset in range(0, len(page.records), page.recordSize):
+            yield page.records[offset:offset + page.recordSize]
+        cursor = page.cursor
+        if cursor == 0:
+            break
+
+def printArp(tester):
+    print "\nMAC                 IP               AGE      VALID"
+    print "----------------------------------------------------"
+    for record in dump(tester.dumpArp):
+        ip, mac, valid, age = struct.unpack("!4s6sBxI", record)
+        print "%-19s %-16s %-8s %d" % (":".join("%02x" % b for b in bytearray(mac)),
+                                       socket.inet_ntoa(ip), "%ds" % age, valid)
+
+def printRoutingTable(tester):
+    print "\nDestination      Gateway          Mask             Iface"
+    print "---------------------------------------------------------"
+    for record in dump(tester.dumpRoutingTable):
+        dest, mask, gw, ifName = struct.unpack("!4s4s4s16s", record)
+        print "%-16s %-16s %-16s %s" % (socket.inet_ntoa(dest), socket.inet_ntoa(gw),
+                                        socket.inet_ntoa(mask), ifName.rstrip(b"\0").decode())
+
 class Client(Ice.Application):
     def run(self, args):
 
@@ -36,9 +65,21 @@ class Client(Ice.Application):
             raise RuntimeError("Invalid proxy")
 
         if len(args) < 2 or args[1] == "arp":
-            print tester.getArp()
+            printArp(tester)
+        elif args[1] == "ndp":
+            print tester.getNeighbors()
+        elif args[1] == "stats":
+            print tester.getStats()
+        elif args[1] == "latency":
+            if len(args) > 2 and args[2] in ("on", "off"):
+                tester.setLatencyEnabled(args[2] == "on")
+            elif len(args) > 2 and args[2] == "reset":
+                tester.resetLatency()
+            print tester.getLatency()
+        elif args[1] == "flight":
+            print tester.getFlightRecorder(int(args[2]) if len(args) > 2 else 0)
         else:
-            print tester.getRoutingTable()
+            printRoutingTable(tester)
         return 0
  
 app = Client()
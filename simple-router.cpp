@@ -16,7 +16,12 @@
 
 #include "simple-router.hpp"
 #include "core/utils.hpp"
+#include "core/checksum.hpp"
+#include "core/icmp.hpp"
+#include "core/logger.hpp"
+#include "core/probes.hpp"
 
+#include <algorithm>
 #include <fstream>
 
 namespace simple_router {
@@ -25,78 +30,224 @@ namespace simple_router {
 //////////////////////////////////////////////////////////////////////////
 // IMPLEMENT THIS METHOD
 void
-SimpleRouter::handlePacket(const Buffer& packet, const std::string& inIface)
+SimpleRouter::handlePacket(const uint8_t* frame, size_t size, const std::string& inIface)
 {
-  std::cerr << "Got packet of size " << packet.size() << " on interface " << inIface << std::endl;
+  SR_LOG_DEBUG("Got packet of size " << size << " on interface " << inIface);
+
+  PacketDescriptor packet;
+  packet.frame = frame;
+  packet.size = size;
+  dispatch(&packet, 1, inIface);
+}
+
+void
+SimpleRouter::handlePackets(const uint8_t* const* frames, const size_t* sizes, size_t count,
+                            const std::string& inIface)
+{
+  SR_LOG_DEBUG("Got " << count << " packets on interface " << inIface);
+
+  //descriptors, and the buffers of their IPv4 copies, are reused by every vector of the batch
+  PacketDescriptor packets[GRAPH_VECTOR_SIZE];
+  for (size_t first = 0; first < count; first += GRAPH_VECTOR_SIZE) {
+    size_t n = std::min(count - first, GRAPH_VECTOR_SIZE);
+    for (size_t i = 0; i < n; ++i) {
+      packets[i].frame = frames[first + i];
+      packets[i].size = sizes[first + i];
+    }
+    dispatch(packets, n, inIface);
+  }
+}
+
+//helper function to run a vector of at most GRAPH_VECTOR_SIZE packets received on inIface through the graph
+void SimpleRouter::dispatch(PacketDescriptor* packets, size_t count, const std::string& inIface){
+  uint64_t totalStart = m_latency.start();
 
   const Interface* iface = findIfaceByName(inIface);
   if (iface == nullptr) {
-    std::cerr << "Received packet, but interface is unknown, ignoring" << std::endl;
+    SR_LOG_WARN("Received packet, but interface is unknown, ignoring");
+    for (size_t i = 0; i < count; ++i) {
+      drop(DROP_UNKNOWN_IFACE);
+    }
+    m_latency.record(STAGE_TOTAL, totalStart, count);
     return;
   }
 
-  //debugging
-  std::cerr << "Before processing packet" << std::endl;
-  print_hdrs(packet);
+  GraphFrames frames;
+  for (size_t i = 0; i < count; ++i) {
+    packets[i].iface = iface;
+    frames.enqueue(NODE_ETHERNET_INPUT, i);
+  }
+  runGraph(packets, frames, NODE_ETHERNET_INPUT);
+  m_latency.record(STAGE_TOTAL, totalStart, count);
+}
+
+//helper function to run every node from first on, each over all packets waiting for it
+void SimpleRouter::runGraph(PacketDescriptor* packets, GraphFrames& frames, GraphNode first){
+  for (int node = first; node < N_GRAPH_NODES; ++node) {
+    GraphNode current = static_cast<GraphNode>(node);
+    size_t count = frames.size(current);
+    if (count == 0) {
+      continue;
+    }
+
+    const uint16_t* indices = frames.packets(current);
+    switch (current) {
+    case NODE_ETHERNET_INPUT:
+      ethernetInput(packets, indices, count, frames);
+      break;
+    case NODE_ARP_INPUT:
+      arpInput(packets, indices, count);
+      break;
+    case NODE_IP4_INPUT:
+      ip4Input(packets, indices, count, frames);
+      break;
+    case NODE_IP6_INPUT:
+      ip6Input(packets, indices, count, frames);
+      break;
+    case NODE_NAT44_OUT2IN:
+      nat44OutToIn(packets, indices, count, frames);
+      break;
+    case NODE_IP4_LOOKUP:
+      ip4Lookup(packets, indices, count, frames);
+      break;
+    case NODE_NAT44_IN2OUT:
+      nat44InToOut(packets, indices, count, frames);
+      break;
+    case NODE_IP4_REWRITE:
+      ip4Rewrite(packets, indices, count, frames);
+      break;
+    case NODE_INTERFACE_OUTPUT:
+      interfaceOutput(packets, indices, count);
+      break;
+    default:
+      break;
+    }
+    frames.clear(current);
+  }
+}
 
-  //std::cerr << getRoutingTable() << std::endl;
+//graph node ethernet-input
+void SimpleRouter::ethernetInput(PacketDescriptor* packets, const uint16_t* indices, size_t count, GraphFrames& frames){
+  for (size_t i = 0; i < count; ++i) {
+    PacketDescriptor& packet = packets[indices[i]];
+    const Interface* iface = packet.iface;
 
-  // FILL THIS IN
+    m_stats.rx(iface->index, packet.size);
+    SR_PROBE3(packet_receive, iface->index, packet.size,
+              packet.size >= sizeof(ethernet_hdr) ? ethertype(packet.frame) : 0);
 
-  // get ethernet header
-  ethernet_hdr header;
-  memcpy(&header, packet.data(), sizeof(ethernet_hdr)); //copy e-header from packet to header var
+    if (m_capture) {
+      m_capture->capture(packet.frame, packet.size, iface->index, PacketCapture::DIRECTION_IN);
+    }
+
+    //a sampled packet goes through the rest of the graph on its own, so that the stages
+    //in its flight record are not those of the whole vector; the vector is split there,
+    //the packets before it going first, so that packets still leave in order
+    if (m_flight.begin(iface->index, packet.frame, packet.size)) {
+      m_flight.suspend();
+      runGraph(packets, frames, static_cast<GraphNode>(NODE_ETHERNET_INPUT + 1));
+      m_flight.resume();
+
+      GraphNode next = classifyFrame(packet);
+      if (next != N_GRAPH_NODES) {
+        GraphFrames single;
+        single.enqueue(next, indices[i]);
+        runGraph(packets, single, next);
+      }
+      m_flight.mark(STAGE_TOTAL);
+      m_flight.end();
+      continue;
+    }
+
+    GraphNode next = classifyFrame(packet);
+    if (next != N_GRAPH_NODES) {
+      frames.enqueue(next, indices[i]);
+    }
+  }
+}
+
+//helper function to check the Ethernet header of a received frame, returning the node that handles
+//its payload, or N_GRAPH_NODES if the frame is dropped or already handled
+GraphNode SimpleRouter::classifyFrame(PacketDescriptor& packet){
+  const uint8_t* frame = packet.frame;
+  size_t size = packet.size;
 
-  //get addresses
-  std::string packet_address = macToString(packet); //get MAC address of packet
-  std::string iface_address = macToString(iface->addr); //get address of interface
+  if (size < sizeof(ethernet_hdr)) {
+    SR_LOG_DEBUG("Frame shorter than Ethernet header, ignoring");
+    drop(DROP_MALFORMED);
+    return N_GRAPH_NODES;
+  }
 
-  //set broadcast addresses
-  std::string broadcast_address_low = "ff:ff:ff:ff:ff:ff";  //lowercase
-  std::string broadcast_address_up = "FF:FF:FF:FF:FF:FF";  //uppercase
+  //REQ 2 - ignore Ethernet frames not destined to router
+  //checked first, so that foreign frames cost one integer compare
+  if (!packet.iface->accepts(macToInteger(frame))) {
+    SR_LOG_DEBUG("Ethernet frames not destined to router.");
+    drop(DROP_NOT_FOR_US);
+    return N_GRAPH_NODES; //drop packet
+  }
+
+  //debugging
+  SR_LOG_TRACE_FRAME(frame, size);
 
-  //REQ 1 - ignore Ethernet frames other than ARP and IPv4
+  //REQ 1 - ignore Ethernet frames other than ARP, IPv4 and IPv6
   uint16_t ether_type;
-  ether_type = ethertype((const uint8_t*)packet.data());  //get frame type;
+  ether_type = ethertype(frame);  //get frame type;
 
   if (ether_type == ethertype_arp){
-    std::cerr << "Type is ARP" << std::endl;
-    handleARP(packet, iface);
+    SR_LOG_DEBUG("Type is ARP");
+    return NODE_ARP_INPUT;
   }
   else if (ether_type == ethertype_ip){
-    std::cerr << "Type is IPv4" << std::endl;
-    handleIP(packet, iface);
+    SR_LOG_DEBUG("Type is IPv4");
+    return NODE_IP4_INPUT;
+  }
+  else if (ether_type == ethertype_ipv6){
+    SR_LOG_DEBUG("Type is IPv6");
+    return NODE_IP6_INPUT;
   }
   else {
-    std::cerr << "Type is neither ARP nor IPv4. Ignore frame." << std::endl;
-    return;
+    SR_LOG_DEBUG("Type is neither ARP, IPv4 nor IPv6. Ignore frame.");
+    drop(DROP_UNKNOWN_ETHERTYPE);
+    return N_GRAPH_NODES;
   }
+}
 
-  //REQ 2 - ignore Ethernet frames not destined to router
-  //dest. HW address is neither corresponding MAC address of interface nor broadcast address
-  if ((packet_address != broadcast_address_low) && (packet_address != broadcast_address_up) && (packet_address != iface_address)){
-    std::cerr << "Ethernet frames not destined to router." << std::endl;
-    return; //drop packet
+//graph node arp-input
+void SimpleRouter::arpInput(PacketDescriptor* packets, const uint16_t* indices, size_t count){
+  for (size_t i = 0; i < count; ++i) {
+    const PacketDescriptor& packet = packets[indices[i]];
+    handleARP(packet.frame, packet.size, packet.iface);
+    m_flight.mark(STAGE_ARP_INPUT);
   }
 }
 
 //helper function to handle ARP requests/replies
-void SimpleRouter::handleARP(const Buffer& packet, const Interface* iface){
+void SimpleRouter::handleARP(const uint8_t* frame, size_t size, const Interface* iface){
+  LatencyScope timing(m_latency, STAGE_ARP_INPUT);
+
+  if (size < sizeof(ethernet_hdr) + sizeof(arp_hdr)) {
+    SR_LOG_DEBUG("Invalid packet: ARP packet too short");
+    drop(DROP_MALFORMED);
+    return;
+  }
+
   //get ARP header
-  arp_hdr* arp_header = (arp_hdr*)(packet.data() + sizeof(ethernet_hdr)); //pointer to beginning of ARP header
+  const arp_hdr* arp_header = (const arp_hdr*)(frame + sizeof(ethernet_hdr)); //pointer to beginning of ARP header
   uint16_t arp_operation = ntohs(arp_header->arp_op); //check to see if ARP request or ARP reply
 
   //ARP request
   if (arp_operation == arp_op_request){
-    std::cerr << "ARP REQUEST" << std::endl;
+    SR_LOG_DEBUG("ARP REQUEST");
 
     //make sure ARP target address is same as interface address
     if (iface->ip != arp_header->arp_tip){
-      std::cerr << "ARP IP address does not match interface IP address." << std::endl;
+      SR_LOG_DEBUG("ARP IP address does not match interface IP address.");
+      drop(DROP_NOT_FOR_US);
       return; //drop packet
     }
 
     //create reply and send back
+    m_flight.setVerdict(VERDICT_LOCAL);
     uint8_t buff_length = sizeof(ethernet_hdr) + sizeof(arp_hdr);
     Buffer reply_buffer(buff_length);    //create buffer for ARP reply
     uint8_t* arp_reply = (uint8_t *)reply_buffer.data();
@@ -120,15 +271,16 @@ void SimpleRouter::handleARP(const Buffer& packet, const Interface* iface){
     a_header_reply->arp_tip = arp_header->arp_sip;   //set ARP request sender IP address as new target IP address
 
     //debugging
-    std::cerr << "After ARP response created" << std::endl;
-    print_hdrs(reply_buffer);
+    SR_LOG_TRACE("After ARP response created");
+    SR_LOG_TRACE_HDRS(reply_buffer);
 
     //send ARP reply back
-    sendPacket(reply_buffer, iface->name);
+    sendPacket(reply_buffer, *iface);
   }
   //ARP reply
   else if (arp_operation == arp_op_reply){
-    std::cerr << "ARP RESPONSE" << std::endl;
+    SR_LOG_DEBUG("ARP RESPONSE");
+    m_flight.setVerdict(VERDICT_LOCAL);
 
     //record IP-MAC mapping information in ARP cache
     uint32_t sip = arp_header->arp_sip;   //source IP address of ARP reply
@@ -151,8 +303,8 @@ void SimpleRouter::handleARP(const Buffer& packet, const Interface* iface){
         memcpy(e_header->ether_shost, iface->addr.data(), ETHER_ADDR_LEN); //copy interface address as source address
         memcpy(e_header->ether_dhost, arp_header->arp_sha, ETHER_ADDR_LEN); //copy ARP reply's source HW address as new dest address
 
-        std::cerr << "SENDING PENDING PACKET" << std::endl;
-        print_hdrs(pp_iterator->packet);
+        SR_LOG_DEBUG("SENDING PENDING PACKET");
+        SR_LOG_TRACE_HDRS(pp_iterator->packet);
 
         //send out all corresponding enqueued packets for the ARP entry
         sendPacket(pp_iterator->packet, pp_iterator->iface);
@@ -160,103 +312,296 @@ void SimpleRouter::handleARP(const Buffer& packet, const Interface* iface){
 
       //Frees all memory associated with this arp request entry. If this arp request
       //entry is on the arp request queue, it is removed from the queue.
+      SR_PROBE2(arp_resolve, sip, arp_req->packets.size());
       m_arp.removeRequest(arp_req);
     }
   }
   else{
-    std::cerr << "ARP operation is neither a request nor a reply." << std::endl;
+    SR_LOG_DEBUG("ARP operation is neither a request nor a reply.");
+    drop(DROP_MALFORMED);
     return; //drop packet
   }
 }
 
-//helper function to handle IP packets
-void SimpleRouter::handleIP(const Buffer& packet, const Interface* iface){
-  //get IP packet
-  Buffer ip_packet(packet);
-  ip_hdr* ip_header = (ip_hdr*)(ip_packet.data() + sizeof(ethernet_hdr)); //pointer to beginning of IP header
+//graph node ip4-input
+void SimpleRouter::ip4Input(PacketDescriptor* packets, const uint16_t* indices, size_t count, GraphFrames& frames){
+  uint64_t validateStart = m_latency.start();
+
+  for (size_t i = 0; i < count; ++i) {
+    PacketDescriptor& packet = packets[indices[i]];
+    const uint8_t* frame = packet.frame;
+    size_t size = packet.size;
+    const Interface* iface = packet.iface;
+
+    //verify min length of IP packet
+    if (size < (sizeof(ethernet_hdr) + sizeof(ip_hdr))){
+      SR_LOG_DEBUG("Invalid packet: IP packet size smaller than size of ethernet + IP headers");
+      drop(DROP_MALFORMED);
+      continue; //drop packet
+    }
 
-  //verify checksum
-  uint16_t cs = ip_header->ip_sum;    //get IP packet checksum
-  ip_header->ip_sum = 0;
-  uint16_t expected_cs = cksum(ip_header, sizeof(ip_hdr));  //expected checksum
-  //compare checksums
-  if (cs != expected_cs){
-    std::cerr << "Invalid packet: checksum does not match expected checksum" << std::endl;
-    return; //drop packet
-  }
+    //police by source before any routing or ARP work is spent on the packet
+    packet.isExcess = false;
+    if (m_policer) {
+      const ip_hdr* ip_header = reinterpret_cast<const ip_hdr*>(frame + sizeof(ethernet_hdr));
+      IngressPolicer::Verdict verdict = m_policer->police(ip_header->ip_src, TokenBucket::nowNs());
+      if (verdict == IngressPolicer::VERDICT_DROP) {
+        SR_LOG_DEBUG("Source " << ipToString(ip_header->ip_src) << " over its policed rate");
+        drop(DROP_POLICED);
+        continue;
+      }
+      packet.isExcess = verdict == IngressPolicer::VERDICT_MARK;
+    }
 
-  //verify min length of IP packet
-  if (packet.size() < (sizeof(ethernet_hdr) + sizeof(ip_hdr))){
-    std::cerr << "Invalid packet: IP packet size smaller than size of ethernet + IP headers" << std::endl;
-    return; //drop packet
-  }
-  if (ip_header->ip_len < sizeof(ip_hdr)){
-    std::cerr << "Invalid packet: length of IP packet smaller than IP header" << std::endl;
-    return; //drop packet
+    //get IP packet: the one copy of the frame, which forwarding modifies
+    packet.packet.assign(frame, frame + size);
+    ip_hdr* ip_header = (ip_hdr*)(packet.packet.data() + sizeof(ethernet_hdr)); //pointer to beginning of IP header
+
+    //verify checksum
+    uint16_t cs = ip_header->ip_sum;    //get IP packet checksum
+    ip_header->ip_sum = 0;
+    uint16_t expected_cs = cksum(ip_header, sizeof(ip_hdr));  //expected checksum
+    //compare checksums
+    if (cs != expected_cs){
+      SR_LOG_DEBUG("Invalid packet: checksum does not match expected checksum");
+      drop(DROP_BAD_CHECKSUM);
+      continue; //drop packet
+    }
+
+    if (ntohs(ip_header->ip_len) < sizeof(ip_hdr)){
+      SR_LOG_DEBUG("Invalid packet: length of IP packet smaller than IP header");
+      drop(DROP_MALFORMED);
+      continue; //drop packet
+    }
+
+    //filter by 5-tuple, including datagrams to the router itself
+    if (m_acl && m_acl->classify(makeFlowKey(ip_header, size - sizeof(ethernet_hdr))) == AclClassifier::ACTION_DENY) {
+      SR_LOG_DEBUG("Datagram from " << ipToString(ip_header->ip_src) << " denied by ACL");
+      drop(DROP_ACL);
+      continue; //drop packet
+    }
+
+    //excess traffic of a policed source with the mark action continues at lower priority
+    if (packet.isExcess) {
+      ip_header->ip_sum = cs;
+      remarkDscp(ip_header, DSCP_CS1);
+      cs = ip_header->ip_sum;
+    }
+
+    ip_header->ip_sum = cs;
+
+    //replies to translated flows arrive for the NAT address on the outside interface
+    if (m_napt && iface->index == m_naptIface && ip_header->ip_dst == m_napt->getAddress()) {
+      frames.enqueue(NODE_NAT44_OUT2IN, indices[i]);
+      continue;
+    }
+
+    //(1) datagrams destined to router
+    if (isLocalIP(ip_header->ip_dst)) {
+      handleLocalIP(packet.packet, iface);
+      continue;
+    }
+
+    //(2) datagrams to be forwarded
+    if (!updateTtl(packet)) {
+      continue; //drop packet
+    }
+    m_flight.mark(STAGE_IP_VALIDATE);
+    frames.enqueue(NODE_IP4_LOOKUP, indices[i]);
   }
 
-  //(1) datagrams destined to router
+  m_latency.record(STAGE_IP_VALIDATE, validateStart, count);
+}
+
+//helper function to check whether ip is the address of one of the router's interfaces
+bool SimpleRouter::isLocalIP(uint32_t ip) const{
   //iterate through all interfaces to see if IP address matches with dest. IP address of IPv4 packet
   for (std::set<Interface>::const_iterator if_iterator = m_ifaces.begin(); if_iterator != m_ifaces.end(); if_iterator++) {
-    //datagram destined to router
-    if (ip_header->ip_dst == if_iterator->ip) {
-      std::cerr << "Datagram destined to router. Dropping packet." << std::endl;
-      return; //drop packet
+    if (ip == if_iterator->ip) {
+      return true;
     }
   }
+  return false;
+}
+
+//helper function to decrement the TTL of a datagram to be forwarded, whose header checksum is valid,
+//returning false if the datagram expired instead
+bool SimpleRouter::updateTtl(PacketDescriptor& packet){
+  ip_hdr* ip_header = (ip_hdr*)(packet.packet.data() + sizeof(ethernet_hdr));
 
-  //(2) datagrams to be forwarded
-  //decrement time to live
-  ip_header->ip_ttl = ip_header->ip_ttl - 1;
   //make sure time hasn't expired
-  if (ip_header->ip_ttl <= 0) {
-    std::cerr << "Time to live has run out. Dropping packet." << std::endl;
-    return; //drop packet
+  if (ip_header->ip_ttl <= 1) {
+    SR_LOG_DEBUG("Time to live has run out. Dropping packet.");
+    drop(DROP_TTL_EXPIRED);
+    sendIcmpError(packet.frame, packet.size, packet.iface, ICMP_TIME_EXCEEDED, 0);
+    return false;
   }
 
-  //recompute checksum 
-  ip_header->ip_sum = 0;
-  ip_header->ip_sum = cksum(ip_header, sizeof(ip_hdr));
+  //decrement time to live, updating the checksum instead of recomputing it
+  decrementTtl(ip_header);
+  return true;
+}
+
+//graph node nat44-out2in
+void SimpleRouter::nat44OutToIn(PacketDescriptor* packets, const uint16_t* indices, size_t count, GraphFrames& frames){
+  for (size_t i = 0; i < count; ++i) {
+    PacketDescriptor& packet = packets[indices[i]];
+    ip_hdr* ip_header = (ip_hdr*)(packet.packet.data() + sizeof(ethernet_hdr));
 
-  //use longest prefix match algorithm to find next-hop IP address in routing table
-  RoutingTableEntry rte = m_routingTable.lookup(ip_header->ip_dst);  
-  const Interface* ip_if = findIfaceByName(rte.ifName); //find interface of routing table entry
+    //no translation: addressed to the router itself, which shares the interface address
+    if (!m_napt->translateInbound(ip_header, packet.packet.size() - sizeof(ethernet_hdr))) {
+      if (isLocalIP(ip_header->ip_dst)) {
+        handleLocalIP(packet.packet, packet.iface);
+      }
+      else {
+        SR_LOG_DEBUG("No NAT translation for datagram from " << ipToString(ip_header->ip_src));
+        drop(DROP_NAT);
+      }
+      continue;
+    }
+
+    if (!updateTtl(packet)) {
+      continue; //drop packet
+    }
+    m_flight.mark(STAGE_IP_VALIDATE);
+    frames.enqueue(NODE_IP4_LOOKUP, indices[i]);
+  }
+}
+
+//graph node ip4-lookup
+void SimpleRouter::ip4Lookup(PacketDescriptor* packets, const uint16_t* indices, size_t count, GraphFrames& frames){
+  //use longest prefix match algorithm to find next-hop IP address in routing table,
+  //for the whole vector at once so that the table walks overlap
+  uint64_t lookupStart = m_latency.start();
+  uint32_t destinations[GRAPH_VECTOR_SIZE];
+  const RoutingTableEntry* routes[GRAPH_VECTOR_SIZE];
+  for (size_t i = 0; i < count; ++i) {
+    const Buffer& ip_packet = packets[indices[i]].packet;
+    destinations[i] = ((const ip_hdr*)(ip_packet.data() + sizeof(ethernet_hdr)))->ip_dst;
+  }
+  m_routingTable.findBatch(destinations, count, routes);
+  m_latency.record(STAGE_ROUTE_LOOKUP, lookupStart, count);
+
+  const RoutingTableEntry* lastRoute = nullptr;
+  const Interface* lastIface = nullptr;
+  for (size_t i = 0; i < count; ++i) {
+    PacketDescriptor& packet = packets[indices[i]];
+    const RoutingTableEntry* rte = routes[i];
+    SR_PROBE3(route_lookup, destinations[i], rte != nullptr ? rte->gw : 0,
+              rte != nullptr ? rte->ifName.c_str() : "");
+    if (rte == nullptr) {
+      SR_LOG_DEBUG("No route to " << ipToString(destinations[i]) << ". Dropping packet.");
+      drop(DROP_NO_ROUTE);
+      sendIcmpError(packet.frame, packet.size, packet.iface, ICMP_DEST_UNREACHABLE, ICMP_NET_UNREACHABLE);
+      continue; //drop packet
+    }
+    m_flight.mark(STAGE_ROUTE_LOOKUP);
+
+    //find interface of routing table entry, once per run of packets on the same route
+    if (rte != lastRoute) {
+      lastRoute = rte;
+      lastIface = findIfaceByName(rte->ifName);
+    }
+    if (lastIface == nullptr) {
+      SR_LOG_WARN("Route to " << ipToString(destinations[i]) << " uses unknown interface " << rte->ifName);
+      drop(DROP_NO_ROUTE);
+      continue; //drop packet
+    }
+
+    if (m_flows) {
+      const ip_hdr* ip_header = (const ip_hdr*)(packet.packet.data() + sizeof(ethernet_hdr));
+      m_flows->update(ip_header, packet.packet.size() - sizeof(ethernet_hdr));
+    }
+
+    packet.rte = rte;
+    packet.outIface = lastIface;
+    if (m_napt && lastIface->index == m_naptIface && packet.iface->index != m_naptIface) {
+      frames.enqueue(NODE_NAT44_IN2OUT, indices[i]);
+    }
+    else {
+      frames.enqueue(NODE_IP4_REWRITE, indices[i]);
+    }
+  }
+}
+
+//graph node nat44-in2out
+void SimpleRouter::nat44InToOut(PacketDescriptor* packets, const uint16_t* indices, size_t count, GraphFrames& frames){
+  for (size_t i = 0; i < count; ++i) {
+    PacketDescriptor& packet = packets[indices[i]];
+    ip_hdr* ip_header = (ip_hdr*)(packet.packet.data() + sizeof(ethernet_hdr));
+
+    if (!m_napt->translateOutbound(ip_header, packet.packet.size() - sizeof(ethernet_hdr))) {
+      SR_LOG_DEBUG("Cannot translate datagram from " << ipToString(ip_header->ip_src)
+                   << " to " << ipToString(ip_header->ip_dst));
+      drop(DROP_NAT);
+      continue; //drop packet
+    }
+    frames.enqueue(NODE_IP4_REWRITE, indices[i]);
+  }
+}
+
+//graph node ip4-rewrite
+void SimpleRouter::ip4Rewrite(PacketDescriptor* packets, const uint16_t* indices, size_t count, GraphFrames& frames){
+  uint64_t lookupStart = m_latency.start();
+
+  //consecutive packets mostly share their next hop, which is then looked up once
+  std::shared_ptr<ArpEntry> ae;
+  for (size_t i = 0; i < count; ++i) {
+    PacketDescriptor& packet = packets[indices[i]];
+    const RoutingTableEntry& rte = *packet.rte;
+    const Interface* ip_if = packet.outIface;
+
+    if (ae == nullptr || ae->ip != rte.gw) {
+      ae = m_arp.lookup(rte.gw); //check if an IP->MAC mapping is in the cache
+    }
+    m_flight.mark(STAGE_ARP_LOOKUP);
+
+    //if entry not found in Arp cache, router should queue received packet and send ARP request to discover IP->MAC mapping
+    if (ae == nullptr) {
+      requestArp(packet.packet, rte, ip_if);
+      continue;
+    }
+
+    //if entry found in Arp cache, forward packet to next hop
+    //set pointer of ethernet header to beginning of IP packet
+    ethernet_hdr* ip_eth_header = (ethernet_hdr *)packet.packet.data();
+    memcpy(ip_eth_header->ether_shost, ip_if->addr.data(), ETHER_ADDR_LEN); //set source as IP interface address
+    memcpy(ip_eth_header->ether_dhost, ae->mac.data(), ETHER_ADDR_LEN); //set destination to MAC address found in arp entry
+    ip_eth_header->ether_type = htons(ethertype_ip);  //set type to IP packet
+    frames.enqueue(NODE_INTERFACE_OUTPUT, indices[i]);
+  }
+
+  m_latency.record(STAGE_ARP_LOOKUP, lookupStart, count);
+}
+
+//graph node interface-output
+void SimpleRouter::interfaceOutput(PacketDescriptor* packets, const uint16_t* indices, size_t count){
+  //IPv4 and IPv6 packets reach this node by different paths; they leave in the order they arrived
+  uint16_t order[GRAPH_VECTOR_SIZE];
+  std::copy(indices, indices + count, order);
+  if (!std::is_sorted(order, order + count)) {
+    std::sort(order, order + count);
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    const PacketDescriptor& packet = packets[order[i]];
+
+    //forward packet to next hop
+    sendPacket(packet.packet, *packet.outIface);
+    m_flight.setVerdict(VERDICT_FORWARDED);
+  }
+}
+
+//helper function to send an IP packet to the next hop of route rte, resolving its MAC address first
+void SimpleRouter::forwardIP(Buffer& ip_packet, const RoutingTableEntry& rte, const Interface* ip_if){
+  uint64_t lookupStart = m_latency.start();
   std::shared_ptr<ArpEntry> ae = m_arp.lookup(rte.gw); //check if an IP->MAC mapping is in the cache
+  m_latency.record(STAGE_ARP_LOOKUP, lookupStart);
+  m_flight.mark(STAGE_ARP_LOOKUP);
 
   //if entry not found in Arp cache, router should queue received packet and send ARP request to discover IP->MAC mapping
   if (ae == nullptr) {
-    //queue received packet
-    std::shared_ptr<ArpRequest> ar = m_arp.queueRequest(ip_header->ip_dst, ip_packet, ip_if->name);
-
-    //send ARP request
-    uint8_t buff_length = sizeof(ethernet_hdr) + sizeof(arp_hdr);
-    Buffer request_buffer(buff_length);    //create buffer for ARP reply
-    uint8_t* arp_req = (uint8_t *)request_buffer.data();
-
-    //create request ethernet header
-    ethernet_hdr* e_header_req = (ethernet_hdr *)arp_req;   //sets pointer to ethernet header of arp_req
-    memcpy(e_header_req->ether_shost, ip_if->addr.data(), ETHER_ADDR_LEN);  //copy IP interface address to source address
-    memcpy(e_header_req->ether_dhost, BroadcastEtherAddr, ETHER_ADDR_LEN);  //copy Broadcast address to destination address
-    e_header_req->ether_type = htons(ethertype_arp);  //set ethernet type as ARP
-
-    //create request ARP header
-    arp_hdr* a_header_req = (arp_hdr*)(arp_req + sizeof(ethernet_hdr));  //sets point to arp header of arp_req
-    a_header_req->arp_hrd = htons(arp_hrd_ethernet);  //set format of hardware address
-    a_header_req->arp_pro = htons(ethertype_ip);  //set protocol as IP
-    a_header_req->arp_hln = ETHER_ADDR_LEN; //length of hardware address is 6 bytes
-    a_header_req->arp_pln = 4;  //length of protocol address is 4 bytes
-    a_header_req->arp_op = htons(arp_op_request); //set ARP operation as request
-    memcpy(a_header_req->arp_sha, ip_if->addr.data(), ETHER_ADDR_LEN); //copy IP interface address as sender HW address
-    a_header_req->arp_sip = ip_if->ip;  //set IP interface address as sender IP address
-    memcpy(a_header_req->arp_tha, BroadcastEtherAddr, ETHER_ADDR_LEN); //copy Broadcast address as new target HW address
-    a_header_req->arp_tip = ip_header->ip_dst;   //set IP packet destination address as new target IP address
-
-    //debugging for FORWARDING TEST
-    std::cerr << "FORWARDING: creating ARP request" << std::endl;
-    print_hdrs(request_buffer);
-
-    //send ARP request back
-    sendPacket(request_buffer, ip_if->name);
+    requestArp(ip_packet, rte, ip_if);
   }
   //if entry found in Arp cache, forward packet to next hop
   else {
@@ -267,8 +612,400 @@ void SimpleRouter::handleIP(const Buffer& packet, const Interface* iface){
     ip_eth_header->ether_type = htons(ethertype_ip);  //set type to IP packet
 
     //forward packet to next hop
-    sendPacket(ip_packet, ip_if->name);
+    sendPacket(ip_packet, *ip_if);
+    m_flight.setVerdict(VERDICT_FORWARDED);
+  }
+}
+
+//helper function to queue an IP packet until the next hop of route rte answers ARP, and ask it
+void SimpleRouter::requestArp(const Buffer& ip_packet, const RoutingTableEntry& rte, const Interface* ip_if){
+  const ip_hdr* ip_header = (const ip_hdr*)(ip_packet.data() + sizeof(ethernet_hdr));
+  SR_PROBE2(arp_miss, rte.gw, ip_if->name.c_str());
+
+  //queue received packet
+  std::shared_ptr<ArpRequest> ar = m_arp.queueRequest(ip_header->ip_dst, ip_packet, ip_if->name);
+  m_flight.setVerdict(VERDICT_ARP_PENDING);
+
+  //send ARP request
+  uint8_t buff_length = sizeof(ethernet_hdr) + sizeof(arp_hdr);
+  Buffer request_buffer(buff_length);    //create buffer for ARP reply
+  uint8_t* arp_req = (uint8_t *)request_buffer.data();
+
+  //create request ethernet header
+  ethernet_hdr* e_header_req = (ethernet_hdr *)arp_req;   //sets pointer to ethernet header of arp_req
+  memcpy(e_header_req->ether_shost, ip_if->addr.data(), ETHER_ADDR_LEN);  //copy IP interface address to source address
+  memcpy(e_header_req->ether_dhost, BroadcastEtherAddr, ETHER_ADDR_LEN);  //copy Broadcast address to destination address
+  e_header_req->ether_type = htons(ethertype_arp);  //set ethernet type as ARP
+
+  //create request ARP header
+  arp_hdr* a_header_req = (arp_hdr*)(arp_req + sizeof(ethernet_hdr));  //sets point to arp header of arp_req
+  a_header_req->arp_hrd = htons(arp_hrd_ethernet);  //set format of hardware address
+  a_header_req->arp_pro = htons(ethertype_ip);  //set protocol as IP
+  a_header_req->arp_hln = ETHER_ADDR_LEN; //length of hardware address is 6 bytes
+  a_header_req->arp_pln = 4;  //length of protocol address is 4 bytes
+  a_header_req->arp_op = htons(arp_op_request); //set ARP operation as request
+  memcpy(a_header_req->arp_sha, ip_if->addr.data(), ETHER_ADDR_LEN); //copy IP interface address as sender HW address
+  a_header_req->arp_sip = ip_if->ip;  //set IP interface address as sender IP address
+  memcpy(a_header_req->arp_tha, BroadcastEtherAddr, ETHER_ADDR_LEN); //copy Broadcast address as new target HW address
+  a_header_req->arp_tip = ip_header->ip_dst;   //set IP packet destination address as new target IP address
+
+  //debugging for FORWARDING TEST
+  SR_LOG_DEBUG("FORWARDING: creating ARP request");
+  SR_LOG_TRACE_HDRS(request_buffer);
+
+  //send ARP request back
+  sendPacket(request_buffer, *ip_if);
+}
+
+//helper function to answer datagrams addressed to one of the router's interfaces
+void SimpleRouter::handleLocalIP(Buffer& ip_packet, const Interface* iface){
+  const ip_hdr* ip_header = (const ip_hdr*)(ip_packet.data() + sizeof(ethernet_hdr));
+  size_t ip_end = sizeof(ethernet_hdr) + ntohs(ip_header->ip_len);  //end of the datagram, before any Ethernet padding
+  size_t icmp_offset = sizeof(ethernet_hdr) + ip_header->ip_hl * 4;
+
+  if (ip_header->ip_p == ip_protocol_icmp && ip_header->ip_hl * 4 >= sizeof(ip_hdr) && ip_end <= ip_packet.size() &&
+      ip_end >= icmp_offset + sizeof(icmp_hdr) && ip_packet[icmp_offset] == ICMP_ECHO_REQUEST) {
+    //a valid checksum over the whole message (checksum field included) sums to 0xffff
+    if (checksum(ip_packet.data() + icmp_offset, ip_end - icmp_offset) != 0xffff) {
+      SR_LOG_DEBUG("Invalid echo request: bad ICMP checksum");
+      drop(DROP_BAD_CHECKSUM);
+      return;
+    }
+    sendEchoReply(ip_packet, iface);
+    return;
+  }
+
+  SR_LOG_DEBUG("Datagram destined to router. Dropping packet.");
+  drop(DROP_LOCAL);
+  if (ip_header->ip_p == ip_protocol_udp || ip_header->ip_p == ip_protocol_tcp) {
+    sendIcmpError(ip_packet.data(), ip_packet.size(), iface, ICMP_DEST_UNREACHABLE, ICMP_PORT_UNREACHABLE);
+  }
+}
+
+//helper function to answer the echo request in ip_packet, subject to the ICMP rate limits; the
+//request is the router's private copy, so the reply is built in place
+void SimpleRouter::sendEchoReply(Buffer& ip_packet, const Interface* iface){
+  bool isIpv6 = ethertype(ip_packet.data()) == ethertype_ipv6;
+  const uint8_t* ip_header = ip_packet.data() + sizeof(ethernet_hdr);
+  uint32_t source = isIpv6 ? Ipv6AddressHash()(Ipv6Address::fromBytes(((const ipv6_hdr*)ip_header)->ipv6_src))
+                           : ((const ip_hdr*)ip_header)->ip_src;
+  if (!m_icmp.admit(source)) {
+    drop(DROP_LOCAL);
+    return;
+  }
+
+  m_flight.setVerdict(VERDICT_LOCAL);
+  if (isIpv6) {
+    buildIcmp6EchoReply(ip_packet.data(), ip_packet.size(), ip_packet.data(), ip_packet.size());
+    sendBack(ip_packet, ip_packet.data(), iface);
+  }
+  else {
+    ip_packet.resize(buildIcmpEchoReply(ip_packet.data(), ip_packet.size(), ip_packet.data(), ip_packet.size()));
+    sendIcmp(ip_packet);
+  }
+}
+
+//helper function returning the calling thread's buffer for ICMP errors, sized to size; reused,
+//so that generating errors does not allocate
+static Buffer& getErrorBuffer(size_t size){
+  static thread_local Buffer message;
+  message.resize(size);
+  return message;
+}
+
+//helper function to report a dropped datagram to its source, subject to the ICMP rate limits
+void SimpleRouter::sendIcmpError(const uint8_t* original, size_t len, const Interface* iface, uint8_t type, uint8_t code){
+  if (!isIcmpErrorAllowed(original, len)) {
+    return;
+  }
+  const ip_hdr* ip_header = (const ip_hdr*)(original + sizeof(ethernet_hdr));
+  if (!m_icmp.admit(ip_header->ip_src)) {
+    return;
+  }
+
+  Buffer& message = getErrorBuffer(ICMP_ERROR_FRAME_SIZE);
+  buildIcmpError(message.data(), message.size(), type, code, iface->ip, original, len);
+  sendIcmp(message);
+}
+
+//helper function to count a dropped packet and record it as the verdict of the packet being handled
+void SimpleRouter::drop(DropReason reason){
+  m_stats.drop(reason);
+  m_flight.setVerdict(reason);
+  SR_PROBE3(packet_drop, reason, dropReasonToString(reason), 1);
+}
+
+//helper function to route an ICMP message generated by the router
+void SimpleRouter::sendIcmp(Buffer& message){
+  const ip_hdr* ip_header = (const ip_hdr*)(message.data() + sizeof(ethernet_hdr));
+
+  const RoutingTableEntry* rte = m_routingTable.find(ip_header->ip_dst);
+  if (rte == nullptr) {
+    SR_LOG_DEBUG("No route back to " << ipToString(ip_header->ip_dst) << " for ICMP message");
+    return;
   }
+  const Interface* ip_if = findIfaceByName(rte->ifName);
+  if (ip_if == nullptr) {
+    return;
+  }
+  forwardIP(message, *rte, ip_if);
+}
+
+//graph node ip6-input
+void SimpleRouter::ip6Input(PacketDescriptor* packets, const uint16_t* indices, size_t count, GraphFrames& frames){
+  for (size_t i = 0; i < count; ++i) {
+    PacketDescriptor& packet = packets[indices[i]];
+    const uint8_t* frame = packet.frame;
+    const Interface* iface = packet.iface;
+    uint64_t validateStart = m_latency.start();
+
+    //verify min length, version and payload length
+    if (packet.size < sizeof(ethernet_hdr) + sizeof(ipv6_hdr)) {
+      SR_LOG_DEBUG("Invalid packet: IPv6 packet size smaller than size of ethernet + IPv6 headers");
+      drop(DROP_MALFORMED);
+      continue; //drop packet
+    }
+    const ipv6_hdr* in_header = (const ipv6_hdr*)(frame + sizeof(ethernet_hdr));
+    //the datagram ends at its payload length, before any Ethernet padding
+    size_t size = sizeof(ethernet_hdr) + sizeof(ipv6_hdr) + ntohs(in_header->ipv6_plen);
+    if ((ntohl(in_header->ipv6_vtcf) >> 28) != 6 || size > packet.size) {
+      SR_LOG_DEBUG("Invalid packet: bad IPv6 version or payload length");
+      drop(DROP_MALFORMED);
+      continue; //drop packet
+    }
+
+    Ipv6Address dst = Ipv6Address::fromBytes(in_header->ipv6_dst);
+    if (dst.isUnspecified()) {
+      drop(DROP_MALFORMED);
+      continue; //drop packet
+    }
+
+    //(1) datagrams destined to router
+    if (isLocalIPv6(dst)) {
+      packet.packet.assign(frame, frame + size);
+      handleLocalIPv6(packet.packet, iface);
+      continue;
+    }
+
+    //(2) datagrams to be forwarded; link-local addresses never leave their link
+    if (dst.isMulticast() || dst.isLinkLocal()) {
+      SR_LOG_DEBUG("IPv6 destination " << ipv6ToString(dst) << " is not forwarded. Dropping packet.");
+      drop(DROP_NOT_FOR_US);
+      continue; //drop packet
+    }
+    if (Ipv6Address::fromBytes(in_header->ipv6_src).isLinkLocal()) {
+      drop(DROP_NO_ROUTE);
+      sendIcmp6Error(frame, size, iface, ICMP6_DEST_UNREACHABLE, ICMP6_BEYOND_SCOPE);
+      continue; //drop packet
+    }
+
+    if (in_header->ipv6_hlim <= 1) {
+      SR_LOG_DEBUG("Hop limit has run out. Dropping packet.");
+      drop(DROP_TTL_EXPIRED);
+      sendIcmp6Error(frame, size, iface, ICMP6_TIME_EXCEEDED, 0);
+      continue; //drop packet
+    }
+    m_latency.record(STAGE_IP_VALIDATE, validateStart);
+    m_flight.mark(STAGE_IP_VALIDATE);
+
+    uint64_t lookupStart = m_latency.start();
+    const RoutingTableEntry6* rte = m_routingTable.findIpv6(dst);
+    if (rte == nullptr) {
+      SR_LOG_DEBUG("No route to " << ipv6ToString(dst) << ". Dropping packet.");
+      drop(DROP_NO_ROUTE);
+      sendIcmp6Error(frame, size, iface, ICMP6_DEST_UNREACHABLE, ICMP6_NO_ROUTE);
+      continue; //drop packet
+    }
+    m_latency.record(STAGE_ROUTE_LOOKUP, lookupStart);
+    m_flight.mark(STAGE_ROUTE_LOOKUP);
+    const Interface* ip_if = findIfaceByName(rte->ifName);
+    if (ip_if == nullptr) {
+      SR_LOG_WARN("Route to " << ipv6ToString(dst) << " uses unknown interface " << rte->ifName);
+      drop(DROP_NO_ROUTE);
+      continue; //drop packet
+    }
+
+    //get IP packet: the one copy of the frame; there is no header checksum to update
+    packet.packet.assign(frame, frame + size);
+    ((ipv6_hdr*)(packet.packet.data() + sizeof(ethernet_hdr)))->ipv6_hlim--;
+    if (rewriteIPv6(packet.packet, rte->gw.isUnspecified() ? dst : rte->gw, ip_if)) {
+      packet.outIface = ip_if;
+      frames.enqueue(NODE_INTERFACE_OUTPUT, indices[i]);
+    }
+  }
+}
+
+//helper function to check whether ip is one of the router's IPv6 addresses or a link-local
+//multicast group (the Ethernet filter only lets the joined ones through)
+bool SimpleRouter::isLocalIPv6(const Ipv6Address& ip) const{
+  if (ip.isMulticast() && (ip.hi >> 48) == 0xff02) {
+    return true;
+  }
+  for (std::set<Interface>::const_iterator if_iterator = m_ifaces.begin(); if_iterator != m_ifaces.end(); if_iterator++) {
+    if (ip == if_iterator->ip6 || ip == if_iterator->linkLocal) {
+      return true;
+    }
+  }
+  return false;
+}
+
+//helper function to address an IPv6 packet to nextHop, returning false if it is queued instead
+//until nextHop answers a neighbor solicitation
+bool SimpleRouter::rewriteIPv6(Buffer& ip_packet, const Ipv6Address& nextHop, const Interface* ip_if){
+  uint64_t lookupStart = m_latency.start();
+  uint8_t mac[ETHER_ADDR_LEN];
+  bool isKnown = m_ndp.lookup(nextHop, mac);
+  m_latency.record(STAGE_ARP_LOOKUP, lookupStart);
+  m_flight.mark(STAGE_ARP_LOOKUP);
+
+  ethernet_hdr* ip_eth_header = (ethernet_hdr *)ip_packet.data();
+  memcpy(ip_eth_header->ether_shost, ip_if->addr.data(), ETHER_ADDR_LEN);
+  ip_eth_header->ether_type = htons(ethertype_ipv6);
+
+  //queue the packet until the neighbor answers the solicitation
+  if (!isKnown) {
+    SR_PROBE3(ndp_miss, nextHop.hi, nextHop.lo, ip_if->name.c_str());
+    m_ndp.queueRequest(nextHop, ip_packet, ip_if->name);
+    m_flight.setVerdict(VERDICT_ARP_PENDING);
+
+    uint8_t solicitation[NDP_FRAME_SIZE];
+    size_t size = buildNeighborSolicitation(solicitation, sizeof(solicitation), ip_if->addr.data(),
+                                            ip_if->ipv6Source(), nextHop);
+    sendPacket(Buffer(solicitation, solicitation + size), *ip_if);
+    return false;
+  }
+
+  memcpy(ip_eth_header->ether_dhost, mac, ETHER_ADDR_LEN);
+  return true;
+}
+
+//helper function to answer neighbor discovery and echo requests addressed to the router
+void SimpleRouter::handleLocalIPv6(Buffer& ip_packet, const Interface* iface){
+  const ipv6_hdr* ip_header = (const ipv6_hdr*)(ip_packet.data() + sizeof(ethernet_hdr));
+  const size_t icmp_offset = sizeof(ethernet_hdr) + sizeof(ipv6_hdr);
+  const size_t icmp_len = ntohs(ip_header->ipv6_plen);
+  Ipv6Address src = Ipv6Address::fromBytes(ip_header->ipv6_src);
+
+  if (ip_header->ipv6_nxt != ip_protocol_icmpv6) {
+    SR_LOG_DEBUG("IPv6 datagram destined to router. Dropping packet.");
+    drop(DROP_LOCAL);
+    if (ip_header->ipv6_nxt == ip_protocol_udp || ip_header->ipv6_nxt == ip_protocol_tcp) {
+      sendIcmp6Error(ip_packet.data(), ip_packet.size(), iface, ICMP6_DEST_UNREACHABLE, ICMP6_PORT_UNREACHABLE);
+    }
+    return;
+  }
+  //a valid checksum over the pseudo-header and message sums to 0xffff
+  if (icmp_len < sizeof(icmp_hdr) ||
+      icmp6Checksum(ip_header, ip_packet.data() + icmp_offset, icmp_len) != 0xffff) {
+    SR_LOG_DEBUG("Invalid ICMPv6 message: too short or bad checksum");
+    drop(DROP_BAD_CHECKSUM);
+    return;
+  }
+
+  uint8_t type = ip_packet[icmp_offset];
+  if (type == ICMP6_NEIGHBOR_SOLICITATION || type == ICMP6_NEIGHBOR_ADVERTISEMENT) {
+    //NDP messages that crossed a router are forged
+    if (ip_header->ipv6_hlim != NDP_HOP_LIMIT || icmp_len < sizeof(ndp_hdr)) {
+      drop(DROP_MALFORMED);
+      return;
+    }
+    const ndp_hdr* ndp = (const ndp_hdr*)(ip_packet.data() + icmp_offset);
+    Ipv6Address target = Ipv6Address::fromBytes(ndp->ndp_target);
+    const uint8_t* options = ip_packet.data() + icmp_offset + sizeof(ndp_hdr);
+    size_t options_len = icmp_len - sizeof(ndp_hdr);
+    const uint8_t* eth_src = ((const ethernet_hdr*)ip_packet.data())->ether_shost;
+
+    if (type == ICMP6_NEIGHBOR_ADVERTISEMENT) {
+      uint32_t flags = ntohl(ndp->ndp_flags);
+      bool isSolicited = (flags & NDP_FLAG_SOLICITED) != 0;
+      //RFC 4861 7.1.2: a solicited advertisement is a unicast answer, and never about a group
+      if (target.isMulticast() || (isSolicited && Ipv6Address::fromBytes(ip_header->ipv6_dst).isMulticast())) {
+        drop(DROP_MALFORMED);
+        return;
+      }
+      const uint8_t* mac = findLinkLayerAddress(options, options_len, NDP_OPT_TARGET_LLADDR);
+      m_flight.setVerdict(VERDICT_LOCAL);
+      sendToNeighbor(m_ndp.updateNeighbor(target, mac, isSolicited, (flags & NDP_FLAG_OVERRIDE) != 0), mac);
+      return;
+    }
+
+    if (target.isUnspecified() || (target != iface->ip6 && target != iface->linkLocal)) {
+      drop(DROP_NOT_FOR_US);
+      return;
+    }
+    //duplicate address detection probes come from ::, there is nobody to answer
+    if (src.isUnspecified()) {
+      drop(DROP_LOCAL);
+      return;
+    }
+    const uint8_t* mac = findLinkLayerAddress(options, options_len, NDP_OPT_SOURCE_LLADDR);
+    if (mac == nullptr) {
+      mac = eth_src;
+    }
+    m_flight.setVerdict(VERDICT_LOCAL);
+    sendToNeighbor(m_ndp.insertNeighbor(mac, src), mac);
+
+    uint8_t advertisement[NDP_FRAME_SIZE];
+    size_t size = buildNeighborAdvertisement(advertisement, sizeof(advertisement), iface->addr.data(),
+                                             target, mac, src);
+    sendPacket(Buffer(advertisement, advertisement + size), *iface);
+    return;
+  }
+
+  if (type == ICMP6_ECHO_REQUEST && !Ipv6Address::fromBytes(ip_header->ipv6_dst).isMulticast()) {
+    sendEchoReply(ip_packet, iface);
+    return;
+  }
+
+  drop(DROP_LOCAL);
+}
+
+//helper function to send the packets that waited for a neighbor resolved to mac, if any
+void SimpleRouter::sendToNeighbor(const std::shared_ptr<NeighborRequest>& request, const uint8_t* mac){
+  if (request == nullptr) {
+    return;
+  }
+
+  for (auto& pending : request->packets) {
+    ethernet_hdr* e_header = (ethernet_hdr *)pending.packet.data();
+    memcpy(e_header->ether_dhost, mac, ETHER_ADDR_LEN);
+    sendPacket(pending.packet, pending.iface);
+  }
+  SR_PROBE3(ndp_resolve, request->ip.hi, request->ip.lo, request->packets.size());
+  m_ndp.removeRequest(request);
+}
+
+//helper function to report a dropped IPv6 datagram to its source, subject to the ICMP rate limits
+void SimpleRouter::sendIcmp6Error(const uint8_t* original, size_t len, const Interface* iface, uint8_t type, uint8_t code){
+  if (!isIcmp6ErrorAllowed(original, len)) {
+    return;
+  }
+  const ipv6_hdr* ip_header = (const ipv6_hdr*)(original + sizeof(ethernet_hdr));
+  if (!m_icmp.admit(Ipv6AddressHash()(Ipv6Address::fromBytes(ip_header->ipv6_src)))) {
+    return;
+  }
+
+  Buffer& message = getErrorBuffer(ICMP6_ERROR_FRAME_MAX_SIZE);
+  size_t size = buildIcmp6Error(message.data(), message.size(), type, code, iface->ipv6Source(),
+                                original, len);
+  if (size == 0) {
+    return;
+  }
+  message.resize(size);
+  sendBack(message, original, iface);
+}
+
+//helper function to send an ICMPv6 message to the neighbor the frame original came from,
+//which is on the path back to its source without a route or neighbor lookup
+void SimpleRouter::sendBack(Buffer& reply, const uint8_t* original, const Interface* iface){
+  ethernet_hdr* e_header = (ethernet_hdr *)reply.data();
+  const ethernet_hdr* original_header = (const ethernet_hdr *)original;
+  uint8_t dhost[ETHER_ADDR_LEN];
+  memcpy(dhost, original_header->ether_shost, ETHER_ADDR_LEN);
+  memcpy(e_header->ether_dhost, dhost, ETHER_ADDR_LEN);
+  memcpy(e_header->ether_shost, iface->addr.data(), ETHER_ADDR_LEN);
+  e_header->ether_type = htons(ethertype_ipv6);
+  sendPacket(reply, *iface);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -277,13 +1014,123 @@ void SimpleRouter::handleIP(const Buffer& packet, const Interface* iface){
 // You should not need to touch the rest of this code.
 SimpleRouter::SimpleRouter()
   : m_arp(*this)
+  , m_ndp(*this)
 {
 }
 
 void
 SimpleRouter::sendPacket(const Buffer& packet, const std::string& outIface)
 {
-  m_pox->begin_sendPacket(packet, outIface);
+  const Interface* iface = findIfaceByName(outIface);
+  if (iface == nullptr) {
+    SR_LOG_WARN("Cannot send packet on unknown interface " << outIface);
+    return;
+  }
+
+  sendPacket(packet, *iface);
+}
+
+void
+SimpleRouter::sendPacket(const Buffer& packet, const Interface& outIface)
+{
+  //timed here rather than in transmit(), which runs on the drain thread when queues are enabled
+  LatencyScope timing(m_latency, STAGE_SEND);
+  if (m_egress) {
+    if (!m_egress->enqueue(packet, outIface.index)) {
+      drop(DROP_QUEUE_FULL);
+    }
+  }
+  else {
+    transmit(packet, outIface);
+  }
+  m_flight.mark(STAGE_SEND);
+}
+
+void
+SimpleRouter::transmit(const Buffer& packet, const Interface& outIface)
+{
+  m_stats.tx(outIface.index, packet.size());
+  SR_PROBE2(packet_send, outIface.index, packet.size());
+
+  if (m_capture) {
+    m_capture->capture(packet.data(), packet.size(), outIface.index, PacketCapture::DIRECTION_OUT);
+  }
+
+  if (m_localInjector != nullptr) {
+    m_localInjector->sendPacket(packet, outIface.name);
+  }
+  else {
+    //marshalled straight from our buffer
+    m_pox->begin_sendPacket(std::make_pair(packet.data(), packet.data() + packet.size()), outIface.name);
+  }
+}
+
+void
+SimpleRouter::setLocalInjector(LocalPacketInjector* injector)
+{
+  m_localInjector = injector;
+}
+
+void
+SimpleRouter::enableFlowExport(const FlowTable::Config& config)
+{
+  m_flows.reset(new FlowTable(config));
+}
+
+void
+SimpleRouter::loadPolicer(const std::string& file)
+{
+  std::unique_ptr<IngressPolicer> policer(new IngressPolicer);
+  policer->load(file);
+  m_policer = std::move(policer);
+}
+
+void
+SimpleRouter::loadAcl(const std::string& file, std::chrono::milliseconds reloadInterval)
+{
+  std::unique_ptr<AclClassifier> acl(new AclClassifier);
+  acl->load(file);
+  if (reloadInterval.count() > 0) {
+    acl->watch(file, reloadInterval);
+  }
+  m_acl = std::move(acl);
+}
+
+void
+SimpleRouter::enableNapt(const std::string& outsideIface, const NaptTable::Config& config)
+{
+  m_napt.reset(new NaptTable(config));
+  m_naptIfName = outsideIface;
+  m_isNaptAddressOfIface = config.address == 0;
+}
+
+void
+SimpleRouter::enableOutputQueues(const OutputQueue::Config& config)
+{
+  m_egress.reset(new EgressScheduler(config, [this] (const Buffer& packet, const std::string& ifName) {
+        const Interface* iface = findIfaceByName(ifName);
+        if (iface != nullptr) {
+          transmit(packet, *iface);
+        }
+      }));
+}
+
+void
+SimpleRouter::enableStatsExport(const std::string& name, std::chrono::milliseconds interval)
+{
+  m_statsPublisher.reset(new StatsPublisher(m_stats, name, interval));
+}
+
+void
+SimpleRouter::enableWarmRestart(const std::string& file, std::chrono::seconds interval)
+{
+  m_neighborState.reset(new NeighborStateSaver(m_arp, m_ndp, file, interval));
+}
+
+void
+SimpleRouter::enableCapture(const PacketCapture::Config& config)
+{
+  m_capture.reset(new PacketCapture(config));
 }
 
 bool
@@ -311,6 +1158,27 @@ SimpleRouter::loadIfconfig(const std::string& ifconfig)
   }
 }
 
+void
+SimpleRouter::loadIfconfig6(const std::string& ifconfig)
+{
+  std::ifstream iff(ifconfig.c_str());
+  std::string line;
+  while (std::getline(iff, line)) {
+    std::istringstream ifLine(line);
+    std::string iface, ip;
+    if (!(ifLine >> iface >> ip) || iface[0] == '#') {
+      continue;
+    }
+
+    Ipv6Address address;
+    if (!parseIpv6(ip, address) || address.isMulticast() || address.isUnspecified()) {
+      throw std::runtime_error("Invalid IPv6 address `" + ip + "` for interface `" + iface + "`");
+    }
+
+    m_ifNameToIp6Map[iface] = address;
+  }
+}
+
 void
 SimpleRouter::printIfaces(std::ostream& os)
 {
@@ -370,22 +1238,70 @@ SimpleRouter::findIfaceByName(const std::string& name) const
 void
 SimpleRouter::reset(const pox::Ifaces& ports)
 {
-  std::cerr << "Resetting SimpleRouter with " << ports.size() << " ports" << std::endl;
+  SR_LOG_INFO("Resetting SimpleRouter with " << ports.size() << " ports");
 
+  //keep what the caches learned across the reset; nothing is saved on the first one
+  if (m_neighborState) {
+    m_neighborState->save();
+  }
   m_arp.clear();
+  m_ndp.clear();
   m_ifaces.clear();
 
+  std::vector<std::string> ifNames;
   for (const auto& iface : ports) {
     auto ip = m_ifNameToIpMap.find(iface.name);
     if (ip == m_ifNameToIpMap.end()) {
-      std::cerr << "IP_CONFIG missing information about interface `" + iface.name + "`. Skipping it" << std::endl;
+      SR_LOG_WARN("IP_CONFIG missing information about interface `" + iface.name + "`. Skipping it");
       continue;
     }
 
-    m_ifaces.insert(Interface(iface.name, iface.mac, ip->second));
+    Interface newIface(iface.name, iface.mac, ip->second, ifNames.size());
+    auto ip6 = m_ifNameToIp6Map.find(iface.name);
+    if (ip6 != m_ifNameToIp6Map.end()) {
+      newIface.ip6 = ip6->second;
+    }
+    //all-nodes and the solicited-node groups of our addresses, for neighbor discovery
+    uint8_t group[ETHER_ADDR_LEN];
+    multicastMac(ALL_NODES_ADDRESS, group);
+    newIface.joinMulticast(group);
+    multicastMac(solicitedNodeAddress(newIface.linkLocal), group);
+    newIface.joinMulticast(group);
+    if (!newIface.ip6.isUnspecified()) {
+      multicastMac(solicitedNodeAddress(newIface.ip6), group);
+      newIface.joinMulticast(group);
+    }
+
+    m_ifaces.insert(newIface);
+    ifNames.push_back(iface.name);
   }
 
-  printIfaces(std::cerr);
+  m_stats.setInterfaces(ifNames);
+  if (m_capture) {
+    m_capture->setInterfaces(ifNames);
+  }
+  if (m_egress) {
+    m_egress->setInterfaces(ifNames);
+  }
+
+  if (m_napt) {
+    const Interface* outside = findIfaceByName(m_naptIfName);
+    if (outside == nullptr) {
+      SR_LOG_WARN("NAT outside interface `" + m_naptIfName + "` is unknown, not translating");
+    }
+    m_naptIface = outside != nullptr ? outside->index : UINT32_MAX;
+    if (outside != nullptr && m_isNaptAddressOfIface) {
+      m_napt->setAddress(outside->ip);
+    }
+  }
+
+  for (const auto& iface : m_ifaces) {
+    SR_LOG_INFO(iface);
+  }
+
+  if (m_neighborState) {
+    SR_LOG_INFO("Restored " << m_neighborState->restore(m_arp, m_ndp) << " ARP and neighbor entries");
+  }
 }
 
 
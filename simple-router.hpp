@@ -18,14 +18,41 @@
 #define SIMPLE_ROUTER_SIMPLE_ROUTER_HPP
 
 #include "arp-cache.hpp"
+#include "ndp-cache.hpp"
 #include "routing-table.hpp"
 #include "core/protocol.hpp"
 #include "core/interface.hpp"
+#include "core/capture.hpp"
+#include "core/stats.hpp"
+#include "core/latency.hpp"
+#include "core/icmp.hpp"
+#include "core/output-queue.hpp"
+#include "core/policer.hpp"
+#include "core/flow-table.hpp"
+#include "core/napt.hpp"
+#include "core/acl.hpp"
+#include "core/flight-recorder.hpp"
+#include "core/neighbor-state.hpp"
+#include "core/packet-graph.hpp"
 
 #include "pox.hpp"
 
 namespace simple_router {
 
+/**
+ * In-process replacement for the POX PacketInjector, used when the router is driven
+ * without Ice (benchmarks, traffic generator)
+ */
+class LocalPacketInjector
+{
+public:
+  virtual
+  ~LocalPacketInjector() = default;
+
+  virtual void
+  sendPacket(const Buffer& packet, const std::string& outIface) = 0;
+};
+
 class SimpleRouter
 {
 public:
@@ -43,6 +70,22 @@ public:
   void
   handlePacket(const Buffer& packet, const std::string& inIface);
 
+  /**
+   * handlePacket() of the \p size byte frame at \p frame, e.g. straight from the Ice
+   * receive buffer.  The frame is only read, and not used after the call returns.
+   */
+  void
+  handlePacket(const uint8_t* frame, size_t size, const std::string& inIface);
+
+  /**
+   * handlePacket() of \p count frames received on \p inIface, e.g. a receive burst of a
+   * batch-aware transport.  The frames go through the graph of GraphNode in vectors of
+   * up to GRAPH_VECTOR_SIZE packets, each node handling the whole vector before the next
+   * one runs.  The frames are only read, and not used after the call returns.
+   */
+  void
+  handlePackets(const uint8_t* const* frames, const size_t* sizes, size_t count, const std::string& inIface);
+
   /**
    * USE THIS METHOD TO SEND PACKETS
    *
@@ -51,6 +94,92 @@ public:
   void
   sendPacket(const Buffer& packet, const std::string& outIface);
 
+  /**
+   * Send packet \p packet on interface \p outIface, without looking the interface up by name
+   */
+  void
+  sendPacket(const Buffer& packet, const Interface& outIface);
+
+  /**
+   * Queue sent packets per interface and DSCP class, drained by a separate thread
+   * (see EgressScheduler).  Call before reset().
+   */
+  void
+  enableOutputQueues(const OutputQueue::Config& config);
+
+  /**
+   * Account forwarded packets per flow and export expired flows (see FlowTable)
+   *
+   * @throw std::runtime_error if the export file or collector cannot be set up
+   */
+  void
+  enableFlowExport(const FlowTable::Config& config);
+
+  /**
+   * Get flow table, or nullptr if flow accounting is not enabled
+   */
+  const FlowTable*
+  getFlows() const;
+
+  /**
+   * Police received IPv4 packets per source prefix with the rules in \p file
+   * (see IngressPolicer::load)
+   */
+  void
+  loadPolicer(const std::string& file);
+
+  /**
+   * Get ingress policer, or nullptr if policing is not enabled
+   */
+  const IngressPolicer*
+  getPolicer() const;
+
+  /**
+   * Filter received IPv4 datagrams with the rules in \p file (see AclClassifier::load),
+   * reloading them every \p reloadInterval if the file changed (never if zero)
+   */
+  void
+  loadAcl(const std::string& file, std::chrono::milliseconds reloadInterval);
+
+  /**
+   * Get ACL, or nullptr if filtering is not enabled
+   */
+  const AclClassifier*
+  getAcl() const;
+
+  /**
+   * Translate the source of datagrams forwarded from other interfaces out of
+   * \p outsideIface, and the destination of their replies (see NaptTable).  An external
+   * address of 0 in \p config is that of the interface.  Call before reset().
+   */
+  void
+  enableNapt(const std::string& outsideIface, const NaptTable::Config& config);
+
+  /**
+   * Get capture tap, or nullptr if capture is not enabled
+   */
+  const PacketCapture*
+  getCapture() const;
+
+  /**
+   * Get NAPT translations, or nullptr if NAPT is not enabled
+   */
+  const NaptTable*
+  getNapt() const;
+
+  /**
+   * Get egress queues, or nullptr if they are not enabled
+   */
+  const EgressScheduler*
+  getOutputQueues() const;
+
+  /**
+   * Deliver sent packets to \p injector instead of the POX controller.  The injector
+   * must outlive the router.
+   */
+  void
+  setLocalInjector(LocalPacketInjector* injector);
+
   /**
    * Load routing table information from \p rtConfig file
    */
@@ -63,18 +192,77 @@ public:
   void
   loadIfconfig(const std::string& ifconfig);
 
+  /**
+   * Load global IPv6 interface addresses (`iface address` lines).  Interfaces not
+   * listed only have their link-local address.
+   */
+  void
+  loadIfconfig6(const std::string& ifconfig);
+
+  /**
+   * Start copying received and sent frames to a pcapng capture file
+   */
+  void
+  enableCapture(const PacketCapture::Config& config);
+
+  /**
+   * Publish packet counters into shared memory segment \p name every \p interval
+   */
+  void
+  enableStatsExport(const std::string& name, std::chrono::milliseconds interval);
+
+  /**
+   * Save the ARP and neighbor caches to \p file every \p interval and on shutdown, and
+   * restore them from it on reset() (see NeighborStateSaver).  Call before reset().
+   */
+  void
+  enableWarmRestart(const std::string& file, std::chrono::seconds interval);
+
+  /**
+   * Get packet and drop counters
+   */
+  PacketStats&
+  getStats();
+
+  /**
+   * Get per-stage latency histograms
+   */
+  LatencyRecorder&
+  getLatency();
+
+  /**
+   * Get flight recorder of the last handled packets
+   */
+  FlightRecorder&
+  getFlightRecorder();
+
+  /**
+   * Get ICMP rate limiter and counters
+   */
+  IcmpResponder&
+  getIcmp();
+
   /**
    * Get routing table
    */
   const RoutingTable&
   getRoutingTable() const;
 
+  RoutingTable&
+  getRoutingTable();
+
   /**
    * Get ARP table
    */
   const ArpCache&
   getArp() const;
 
+  /**
+   * Get IPv6 neighbor cache
+   */
+  const NeighborCache&
+  getNeighbors() const;
+
   /**
    * Print router interfaces
    */
@@ -106,31 +294,159 @@ public:
   findIfaceByName(const std::string& name) const;
 
 private:
-  ArpCache m_arp;
+  PacketStats m_stats;
+  LatencyRecorder m_latency;
+  FlightRecorder m_flight;
+  IcmpResponder m_icmp;
   RoutingTable m_routingTable;
   std::set<Interface> m_ifaces;
   std::map<std::string, uint32_t> m_ifNameToIpMap;
+  std::map<std::string, Ipv6Address> m_ifNameToIp6Map;
+  std::unique_ptr<PacketCapture> m_capture;
+  std::unique_ptr<StatsPublisher> m_statsPublisher;
+  std::unique_ptr<IngressPolicer> m_policer;
+  std::unique_ptr<FlowTable> m_flows;
+  std::unique_ptr<AclClassifier> m_acl;
+  std::unique_ptr<NaptTable> m_napt;
+  std::string m_naptIfName;
+  bool m_isNaptAddressOfIface = false;
+  uint32_t m_naptIface = UINT32_MAX; //< Interface::index of the outside interface
 
   friend class Router;
   pox::PacketInjectorPrx m_pox;
+  LocalPacketInjector* m_localInjector = nullptr;
+  std::unique_ptr<EgressScheduler> m_egress;
+
+  // last, so that their ticker threads are stopped before the interfaces and counters
+  // they use are destroyed
+  ArpCache m_arp;
+  NeighborCache m_ndp;
+  std::unique_ptr<NeighborStateSaver> m_neighborState; //< after the caches it saves
 
   //helper functions
-  void handleARP(const Buffer& packet, const Interface* iface);
-  void handleIP(const Buffer& packet, const Interface* iface);
+  void drop(DropReason reason);
+  void handleARP(const uint8_t* frame, size_t size, const Interface* iface);
+  void dispatch(PacketDescriptor* packets, size_t count, const std::string& inIface);
+  void runGraph(PacketDescriptor* packets, GraphFrames& frames, GraphNode first);
+  GraphNode classifyFrame(PacketDescriptor& packet);
+  bool isLocalIP(uint32_t ip) const;
+  bool updateTtl(PacketDescriptor& packet);
+  void handleLocalIP(Buffer& ip_packet, const Interface* iface);
+  void forwardIP(Buffer& ip_packet, const RoutingTableEntry& rte, const Interface* ip_if);
+  void requestArp(const Buffer& ip_packet, const RoutingTableEntry& rte, const Interface* ip_if);
+  void sendEchoReply(Buffer& ip_packet, const Interface* iface);
+  void sendIcmpError(const uint8_t* original, size_t len, const Interface* iface, uint8_t type, uint8_t code);
+  void sendIcmp(Buffer& message);
+  bool isLocalIPv6(const Ipv6Address& ip) const;
+  void handleLocalIPv6(Buffer& ip_packet, const Interface* iface);
+  bool rewriteIPv6(Buffer& ip_packet, const Ipv6Address& nextHop, const Interface* ip_if);
+  void sendToNeighbor(const std::shared_ptr<NeighborRequest>& request, const uint8_t* mac);
+  void sendIcmp6Error(const uint8_t* original, size_t len, const Interface* iface, uint8_t type, uint8_t code);
+  void sendBack(Buffer& reply, const uint8_t* original, const Interface* iface);
+  void transmit(const Buffer& packet, const Interface& outIface);
+
+  //nodes of the packet graph, each over the count packets at indices
+  void ethernetInput(PacketDescriptor* packets, const uint16_t* indices, size_t count, GraphFrames& frames);
+  void arpInput(PacketDescriptor* packets, const uint16_t* indices, size_t count);
+  void ip4Input(PacketDescriptor* packets, const uint16_t* indices, size_t count, GraphFrames& frames);
+  void ip6Input(PacketDescriptor* packets, const uint16_t* indices, size_t count, GraphFrames& frames);
+  void nat44OutToIn(PacketDescriptor* packets, const uint16_t* indices, size_t count, GraphFrames& frames);
+  void ip4Lookup(PacketDescriptor* packets, const uint16_t* indices, size_t count, GraphFrames& frames);
+  void nat44InToOut(PacketDescriptor* packets, const uint16_t* indices, size_t count, GraphFrames& frames);
+  void ip4Rewrite(PacketDescriptor* packets, const uint16_t* indices, size_t count, GraphFrames& frames);
+  void interfaceOutput(PacketDescriptor* packets, const uint16_t* indices, size_t count);
 };
 
+inline void
+SimpleRouter::handlePacket(const Buffer& packet, const std::string& inIface)
+{
+  handlePacket(packet.data(), packet.size(), inIface);
+}
+
+inline PacketStats&
+SimpleRouter::getStats()
+{
+  return m_stats;
+}
+
+inline LatencyRecorder&
+SimpleRouter::getLatency()
+{
+  return m_latency;
+}
+
+inline FlightRecorder&
+SimpleRouter::getFlightRecorder()
+{
+  return m_flight;
+}
+
+inline IcmpResponder&
+SimpleRouter::getIcmp()
+{
+  return m_icmp;
+}
+
+inline const FlowTable*
+SimpleRouter::getFlows() const
+{
+  return m_flows.get();
+}
+
+inline const IngressPolicer*
+SimpleRouter::getPolicer() const
+{
+  return m_policer.get();
+}
+
+inline const AclClassifier*
+SimpleRouter::getAcl() const
+{
+  return m_acl.get();
+}
+
+inline const PacketCapture*
+SimpleRouter::getCapture() const
+{
+  return m_capture.get();
+}
+
+inline const NaptTable*
+SimpleRouter::getNapt() const
+{
+  return m_napt.get();
+}
+
+inline const EgressScheduler*
+SimpleRouter::getOutputQueues() const
+{
+  return m_egress.get();
+}
+
 inline const RoutingTable&
 SimpleRouter::getRoutingTable() const
 {
   return m_routingTable;
 }
 
+inline RoutingTable&
+SimpleRouter::getRoutingTable()
+{
+  return m_routingTable;
+}
+
 inline const ArpCache&
 SimpleRouter::getArp() const
 {
   return m_arp;
 }
 
+inline const NeighborCache&
+SimpleRouter::getNeighbors() const
+{
+  return m_ndp;
+}
+
 } // namespace simple_router
 
 #endif // SIMPLE_ROUTER_SIMPLE_ROUTER_HPP